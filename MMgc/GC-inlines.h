@@ -470,9 +470,9 @@ namespace MMgc
 
     REALLY_INLINE bool GC::BarrierActive()
     {
-        // Note, this will not always have the same value as IncrementalMarking
-        // in the future.
-        return marking;
+        // In generational mode the barrier also maintains the remembered set
+        // between collections.
+        return marking || stickyMarks;
     }
     
     REALLY_INLINE bool GC::Collecting()
@@ -697,6 +697,12 @@ namespace MMgc
     REALLY_INLINE PageMap::PageType GC::GetPageMapValue(uintptr_t addr) const
     {
         GCAssert(pageMap.AddrIsMappable(addr));
+#if ! defined(MMGC_USE_UNIFORM_PAGEMAP) && defined(MMGC_64BIT)
+        // The 64-bit page map caches the last leaf it visited; marker threads
+        // must not race on that cache.
+        if (m_parallelMarking)
+            return pageMap.AddrToValConcurrent(addr);
+#endif
         return pageMap.AddrToVal(addr);
     }
 
@@ -794,6 +800,11 @@ namespace MMgc
         return policy.blocksOwnedByGC();
     }
 
+    REALLY_INLINE size_t GC::GetNumCachedBlocks()
+    {
+        return blockCacheCount;
+    }
+
     REALLY_INLINE void* GC::allocaTop()
     {
         return stacktop;
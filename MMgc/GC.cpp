@@ -101,6 +101,8 @@ namespace MMgc
         greedy(config.mode == GCConfig::kGreedyGC),
         nogc(config.mode == GCConfig::kDisableGC),
         incremental(config.mode == GCConfig::kIncrementalGC),
+        generational(config.mode == GCConfig::kIncrementalGC && config.nurserySize > 0),
+        generationalRescanFlag(generational ? kRescan : 0),
         drcEnabled(config.mode != GCConfig::kDisableGC && config.drc),
         findUnmarkedPointers(false),
 #ifdef DEBUG
@@ -129,6 +131,7 @@ namespace MMgc
         collecting(false),
         performingDRCValidationTrace(false),
         presweeping(false),
+        stickyMarks(false),
         markerActive(0),
         stackCleaned(true),
         rememberedStackTop(0),
@@ -143,12 +146,17 @@ namespace MMgc
 #endif
         m_markStackOverflow(false),
         mark_item_recursion_control(20),    // About 3KB as measured with GCC 4.1 on MacOS X (144 bytes / frame), May 2009
+        m_parallelMarker(NULL),
+        m_parallelMarking(false),
+        m_parallelSweeper(NULL),
         sizeClassIndex(kSizeClassIndex),    // see comment in GC.h
         pageMap(),
         heap(gcheap),
         finalizedValue(true),
         smallEmptyPageList(NULL),
         largeEmptyPageList(NULL),
+        blockCacheSize(config.blockCacheSize < kMaxBlockCacheSize ? config.blockCacheSize : kMaxBlockCacheSize),
+        blockCacheCount(0),
         remainingQuickListBudget(0),
         victimIterator(0),
         m_roots(0),
@@ -314,6 +322,25 @@ namespace MMgc
 
         m_incrementalWork.SetDeadItem(emptyWeakRef);    // The empty weak ref is as good an object as any for this
 
+        // Helpers that have to share a processor with the mutator only slow it
+        // down, so use no more than there are spare processors.
+        {
+            int processors = VMPI_processorQtyAtBoot();
+            uint32_t spare = processors > 1 ? uint32_t(processors - 1) : 0;
+
+            // Marker helpers allocate mark stack segments, so they need a heap
+            // that can be shared between threads; and the heap graph and the
+            // marking profilers are not thread safe.
+#if defined MMGC_LOCKING && !defined MMGC_HEAP_GRAPH && !defined MMGC_CONSERVATIVE_PROFILER && !defined MMGC_POINTINESS_PROFILING
+            uint32_t markerThreads = config.markerThreads < spare ? config.markerThreads : spare;
+            if (markerThreads > 0)
+                m_parallelMarker = mmfx_new(GCParallelMarker(this, markerThreads));
+#endif
+            uint32_t sweeperThreads = config.sweeperThreads < spare ? config.sweeperThreads : spare;
+            if (sweeperThreads > 0)
+                m_parallelSweeper = mmfx_new(GCParallelSweeper(this, sweeperThreads));
+        }
+
 #ifdef MMGC_CONSERVATIVE_PROFILER
         if (demos == NULL && heap->profiler != NULL)
             demos = new AllocationSiteProfiler(this, "Conservative scanning volume incurred by allocation site");
@@ -366,6 +393,11 @@ namespace MMgc
 #ifdef MMGC_HEAP_GRAPH
         printBlacklist();
 #endif
+        mmfx_delete(m_parallelMarker);
+        m_parallelMarker = NULL;
+        mmfx_delete(m_parallelSweeper);
+        m_parallelSweeper = NULL;
+
         policy.shutdown();
         allocaShutdown();
 
@@ -424,6 +456,8 @@ namespace MMgc
             pageList = next;
         }
 
+        FlushBlockCache();
+
         pageMap.DestroyPageMapVia(heap);
 
         GCAssert(!m_roots);
@@ -563,15 +597,91 @@ namespace MMgc
             SignalMarkStackOverflow_NonGCObject();
     }
     
+    REALLY_INLINE GCMarkStack& GC::CurrentMarkStack()
+    {
+        if (m_parallelMarking) {
+            GCMarkerContext* context = m_parallelMarker->CurrentContext();
+            if (context != NULL)
+                return context->stack;
+        }
+        return m_incrementalWork;
+    }
+
     REALLY_INLINE void GC::Push_GCObject(const void *p)
     {
 #ifdef DEBUG
         WorkItemInvariants_GCObject(p);
 #endif
-        if (!m_incrementalWork.Push_GCObject(p))
+        if (!CurrentMarkStack().Push_GCObject(p))
             SignalMarkStackOverflow_GCObject(p);
     }
 
+    REALLY_INLINE bool GC::SetBitsIfUnmarked(gcbits_t& bits, gcbits_t flag)
+    {
+        if (m_parallelMarking)
+            return SetBitsIfUnmarkedAtomic(bits, flag);
+        GCAssert((bits & (kMark|kQueued)) == 0);
+        bits |= flag;
+        return true;
+    }
+
+    // Another marker thread may be claiming the same object, or writing the bits
+    // of a neighbouring object in the same word, so compare-and-swap the whole
+    // (aligned) word.  The bits arrays are word aligned and word padded, and so
+    // are the flags of a large block.
+
+    bool GC::SetBitsIfUnmarkedAtomic(gcbits_t& bits, gcbits_t flag)
+    {
+        volatile int32_t* word = (volatile int32_t*)(uintptr_t(&bits) & ~uintptr_t(3));
+        uint32_t index = uint32_t(uintptr_t(&bits) & 3);
+        union {
+            int32_t value;
+            gcbits_t bytes[4];
+        } u;
+        for (;;) {
+            int32_t old = *word;
+            u.value = old;
+            if (u.bytes[index] & (kMark|kQueued))
+                return false;
+            u.bytes[index] |= flag;
+            if (VMPI_compareAndSwap32WithBarrier(old, u.value, word))
+                return true;
+        }
+    }
+
+    REALLY_INLINE void GC::SignalExactMarkWork(size_t nbytes)
+    {
+        GCMarkerContext* context = m_parallelMarking ? m_parallelMarker->CurrentContext() : NULL;
+        if (context != NULL) {
+            context->work.objectsExact++;
+            context->work.bytesExact += uint32_t(nbytes);
+        }
+        else
+            policy.signalExactMarkWork(nbytes);
+    }
+
+    REALLY_INLINE void GC::SignalConservativeMarkWork(size_t nbytes)
+    {
+        GCMarkerContext* context = m_parallelMarking ? m_parallelMarker->CurrentContext() : NULL;
+        if (context != NULL) {
+            context->work.objectsConservative++;
+            context->work.bytesConservative += uint32_t(nbytes);
+        }
+        else
+            policy.signalConservativeMarkWork(nbytes);
+    }
+
+    REALLY_INLINE void GC::SignalPointerfreeMarkWork(size_t nbytes)
+    {
+        GCMarkerContext* context = m_parallelMarking ? m_parallelMarker->CurrentContext() : NULL;
+        if (context != NULL) {
+            context->work.objectsPointerfree++;
+            context->work.bytesPointerfree += uint32_t(nbytes);
+        }
+        else
+            policy.signalPointerfreeMarkWork(nbytes);
+    }
+
     void GC::Push_GCObject_MayFail(const void *p)
     {
 #ifdef DEBUG
@@ -606,7 +716,7 @@ namespace MMgc
 #ifdef DEBUG
     void GC::DRCValidationTrace(bool scanStack)
     {
-        if(marking) {
+        if(BarrierActive()) {
             AbortInProgressMarking();
         }
         performingDRCValidationTrace = true;
@@ -678,7 +788,10 @@ namespace MMgc
             // incrementality.
             if (!collecting && !Reaping()) {
                 if (!marking) {
-                    StartIncrementalMark();
+                    if (policy.queryMinorCollection())
+                        MinorCollect();
+                    else
+                        StartIncrementalMark();
                 }
                 else if (policy.queryEndOfCollectionCycle()) {
                     FinishIncrementalMark(true);
@@ -1054,32 +1167,49 @@ namespace MMgc
         m_markStackOverflow = false;
     }
 
+    uint32_t GC::GetSmallAllocators(GCAlloc** allocs)
+    {
+        uint32_t n = 0;
+        for(int i=0; i < kNumSizeClasses; i++) {
+            allocs[n++] = containsPointersRCAllocs[i];
+            allocs[n++] = containsPointersNonfinalizedAllocs[i];
+            allocs[n++] = containsPointersFinalizedAllocs[i];
+            allocs[n++] = noPointersNonfinalizedAllocs[i];
+            allocs[n++] = noPointersFinalizedAllocs[i];
+        }
+        allocs[n++] = bibopAllocFloat;
+        allocs[n++] = bibopAllocFloat4;
+        GCAssert(n == kNumSmallAllocators);
+        return n;
+    }
+
     void GC::Finalize()
     {
         MarkOrClearWeakRefs();
 
-        for(int i=0; i < kNumSizeClasses; i++) {
-            containsPointersRCAllocs[i]->Finalize();
-            containsPointersNonfinalizedAllocs[i]->Finalize();
-            containsPointersFinalizedAllocs[i]->Finalize();
-            noPointersNonfinalizedAllocs[i]->Finalize();
-            noPointersFinalizedAllocs[i]->Finalize();
-        }
-        bibopAllocFloat->Finalize();
-        bibopAllocFloat4->Finalize();
+        GCAlloc* allocs[kNumSmallAllocators];
+        uint32_t n = GetSmallAllocators(allocs);
+
+        // Finalizers may allocate, so run all of them before the blocks of the
+        // allocators without finalizers are examined - possibly on the sweeper's
+        // helper threads.
+        for (uint32_t i=0; i < n; i++) {
+            if (allocs[i]->containsFinalizedObjects)
+                allocs[i]->Finalize();
+        }
         largeAlloc->Finalize();
-        finalizedValue = !finalizedValue;
 
-        for(int i=0; i < kNumSizeClasses; i++) {
-            containsPointersRCAllocs[i]->m_finalized = false;
-            containsPointersNonfinalizedAllocs[i]->m_finalized = false;
-            containsPointersFinalizedAllocs[i]->m_finalized = false;
-            noPointersNonfinalizedAllocs[i]->m_finalized = false;
-            noPointersFinalizedAllocs[i]->m_finalized = false;
+        if (m_parallelSweeper != NULL)
+            m_parallelSweeper->Run(GCParallelSweeper::kScanBlocks, allocs, n);
+
+        for (uint32_t i=0; i < n; i++) {
+            if (!allocs[i]->containsFinalizedObjects)
+                allocs[i]->Finalize();
         }
+        finalizedValue = !finalizedValue;
 
-        bibopAllocFloat->m_finalized = false;
-        bibopAllocFloat4->m_finalized = false;
+        for (uint32_t i=0; i < n; i++)
+            allocs[i]->m_finalized = false;
     }
 
     void GC::SweepNeedsSweeping()
@@ -1087,6 +1217,21 @@ namespace MMgc
         TELEMETRY_METHOD(getTelemetry(), ".gc.Sweep");
         EstablishSweepInvariants();
 
+        // Sweep the items in parallel; relinking and freeing the blocks below
+        // then takes little time.  Sweeping an item calls the free hook, and
+        // the hooks and the memory profiler behind them are not thread safe,
+        // so while hooks are enabled the items are swept below, on this thread.
+#ifdef MMGC_HOOKS
+        bool parallel = m_parallelSweeper != NULL && !heap->HooksEnabled();
+#else
+        bool parallel = m_parallelSweeper != NULL;
+#endif
+        if (parallel) {
+            GCAlloc* allocs[kNumSmallAllocators];
+            uint32_t n = GetSmallAllocators(allocs);
+            m_parallelSweeper->Run(GCParallelSweeper::kPresweepBlocks, allocs, n);
+        }
+
         // clean up any pages that need sweeping
         for(int i=0; i < kNumSizeClasses; i++) {
             containsPointersRCAllocs[i]->SweepNeedsSweeping();
@@ -1232,6 +1377,9 @@ namespace MMgc
         collecting = true;
         zct.StartCollecting();
 
+        // What survives this collection is old from now on.
+        stickyMarks = generational && !destroying;
+
         SAMPLE_FRAME("[sweep]", core());
         sweeps++;
 
@@ -1324,6 +1472,8 @@ namespace MMgc
         if (heap->Config().eagerSweeping)
             SweepNeedsSweeping();
 
+        FlushBlockCache();
+
         // we potentially freed a lot of memory, tell heap to regulate
         heap->Decommit();
 
@@ -1366,7 +1516,11 @@ namespace MMgc
     {
         GCAssert(size > 0);
 
-        void *item = heapAlloc(size, GCHeap::kExpand| (zero ? GCHeap::kZero : 0) | (canFail ? GCHeap::kCanFail : 0));
+        void *item;
+        if (size == 1 && blockCacheSize > 0)
+            item = AllocCachedBlock(zero, canFail);
+        else
+            item = heapAlloc(size, GCHeap::kExpand| (zero ? GCHeap::kZero : 0) | (canFail ? GCHeap::kCanFail : 0));
 
         // mark GC pages in page map, small pages get marked one,
         // the first page of large pages is 3 and the rest are 2
@@ -1385,7 +1539,47 @@ namespace MMgc
         // Bugzilla 551833:  Unmark first so that any OOM or other action triggered
         // by heapFree does not examine bits representing pages that are gone.
         UnmarkGCPages(ptr, size);
-        heapFree(ptr, size, false);
+        if (size == 1 && blockCacheSize > 0)
+            FreeCachedBlock(ptr);
+        else
+            heapFree(ptr, size, false);
+    }
+
+    void* GC::AllocCachedBlock(bool zero, bool canFail)
+    {
+        if (blockCacheCount == 0) {
+            blockCacheCount = heap->AllocBlocks(blockCache, blockCacheSize, GCHeap::kExpand | (canFail ? GCHeap::kCanFail : 0));
+            if (blockCacheCount == 0)
+                return NULL;
+        }
+
+        void* item = blockCache[--blockCacheCount];
+        policy.signalBlockAllocation(1);
+
+        // Cached blocks may be fresh or recycled; zero them here rather than in the heap.
+        if (zero) {
+            VALGRIND_MAKE_MEM_DEFINED(item, GCHeap::kBlockSize);
+            VMPI_memset(item, 0, GCHeap::kBlockSize);
+            VALGRIND_MAKE_MEM_UNDEFINED(item, GCHeap::kBlockSize);
+        }
+        return item;
+    }
+
+    void GC::FreeCachedBlock(void* ptr)
+    {
+        policy.signalBlockDeallocation(1);
+        // Keep half so that alternating frees and allocations don't go to the heap.
+        if (blockCacheCount == blockCacheSize)
+            FlushBlockCache(blockCacheSize / 2);
+        blockCache[blockCacheCount++] = ptr;
+    }
+
+    void GC::FlushBlockCache(uint32_t keep)
+    {
+        if (blockCacheCount > keep) {
+            heap->FreeBlocks(blockCache + keep, blockCacheCount - keep);
+            blockCacheCount = keep;
+        }
     }
 
     void *GC::FindBeginningGuarded(const void *gcItem, bool allowGarbage)
@@ -1862,7 +2056,7 @@ namespace MMgc
 
     void GC::DumpMemoryInfo()
     {
-        size_t total = GetNumBlocks() * GCHeap::kBlockSize;
+        size_t total = (GetNumBlocks() + GetNumCachedBlocks()) * GCHeap::kBlockSize;
 
         size_t ask;
         size_t allocated;
@@ -1879,6 +2073,7 @@ namespace MMgc
             GCLog("[mem] \tmark rate %u mb/s\n", markRate);
         }
         GCLog("[mem] \tmark increments %d\n", markIncrements());
+        GCLog("[mem] \tblock cache %u blocks\n", unsigned(GetNumCachedBlocks()));
         GCLog("[mem] \tsweeps %d \n", sweeps);
 
         size_t total_overhead = 0;
@@ -2046,6 +2241,15 @@ namespace MMgc
 
         lastStartMarkIncrementCount = markIncrements();
 
+        // In generational mode the old objects are still marked and the remembered
+        // set may hold some of them; the incremental mark starts from scratch.
+        if (stickyMarks) {
+            stickyMarks = false;
+            ClearMarkStack();
+            m_barrierWork.Clear();
+            ClearMarks();
+        }
+
         // set the stack cleaning trigger
         stackCleaned = false;
 
@@ -2570,7 +2774,7 @@ namespace MMgc
             // object here, even if that object is being split.  Can that go wrong somehow,
             // eg, will it upset the computation of the mark rate?
 
-            policy.signalExactMarkWork(size);
+            SignalExactMarkWork(size);
             return;
         }
 #endif
@@ -2615,7 +2819,7 @@ namespace MMgc
         if (type == GCMarkStack::kGCObject)
             SetMark(userptr);
 
-        policy.signalConservativeMarkWork(size);
+        SignalConservativeMarkWork(size);
 #ifdef MMGC_CONSERVATIVE_PROFILER
         if (demos != NULL)
         {
@@ -2736,11 +2940,14 @@ namespace MMgc
                     // avoid pushing leaf objects onto the mark stack.)  If conservative marking is
                     // merely a last-ditch mechanism then there's little reason to assume that
                     // recursive marking will buy us much here.
+                    //
+                    // Recursion is off while marking in parallel: it would race on
+                    // mark_item_recursion_control and it sets no bits up front.
                     uintptr_t thisPage = val & GCHeap::kBlockMask;
-                    if(((uintptr_t)realItem & GCHeap::kBlockMask) != thisPage || mark_item_recursion_control == 0)
+                    if(((uintptr_t)realItem & GCHeap::kBlockMask) != thisPage || mark_item_recursion_control == 0 || m_parallelMarking)
                     {
-                        bits2 |= kQueued;
-                        Push_GCObject(realItem);
+                        if (SetBitsIfUnmarked(bits2, kQueued))
+                            Push_GCObject(realItem);
                     }
                     else
                     {
@@ -2751,8 +2958,8 @@ namespace MMgc
                 }
                 else
                 {
-                    bits2 |= kMark;
-                    policy.signalPointerfreeMarkWork(itemSize);
+                    if (SetBitsIfUnmarked(bits2, kMark))
+                        SignalPointerfreeMarkWork(itemSize);
                 }
 #ifdef MMGC_HEAP_GRAPH
                 markerGraph.edge(loc, GetUserPointer(item));
@@ -2799,14 +3006,14 @@ namespace MMgc
                 uint32_t itemSize = b->size - (uint32_t)DebugSize();
                 if(b->containsPointers)
                 {
-                    b->flags[0] |= kQueued;
-                    Push_GCObject(GetUserPointer(item));
+                    if (SetBitsIfUnmarked(b->flags[0], kQueued))
+                        Push_GCObject(GetUserPointer(item));
                 }
                 else
                 {
                     // doesn't need marking go right to black
-                    b->flags[0] |= kMark;
-                    policy.signalPointerfreeMarkWork(itemSize);
+                    if (SetBitsIfUnmarked(b->flags[0], kMark))
+                        SignalPointerfreeMarkWork(itemSize);
                 }
 #ifdef MMGC_HEAP_GRAPH
                 markerGraph.edge(loc, GetUserPointer(item));
@@ -2842,12 +3049,12 @@ namespace MMgc
         if ((bits2 & (kMark|kQueued)) == 0)
         {
             if (ContainsPointers(obj)) {
-                bits2 |= kQueued;
-                Push_GCObject(obj);
+                if (SetBitsIfUnmarked(bits2, kQueued))
+                    Push_GCObject(obj);
             }
             else {
-                bits2 |= kMark;
-                policy.signalPointerfreeMarkWork(Size(obj));
+                if (SetBitsIfUnmarked(bits2, kMark))
+                    SignalPointerfreeMarkWork(Size(obj));
             }
 #ifdef MMGC_HEAP_GRAPH
             markerGraph.edge(loc, obj);
@@ -2939,6 +3146,9 @@ namespace MMgc
                 if (count == 0)
                     break;
             }
+            // Plenty of work: let the helper threads in for the rest of the slice.
+            if (m_parallelMarker != NULL && count > GCParallelMarker::kMinimumWork && m_parallelMarker->Mark(ticks))
+                continue;
             if (count > checkTimeIncrements) {
                 count = checkTimeIncrements;
             }
@@ -2976,8 +3186,11 @@ namespace MMgc
             // It is possible, probably common, to enter FinishIncrementalMark without the
             // mark queue being empty.   Clear out the queue synchronously here, we don't
             // want anything pending when we start marking roots: multiple active root protectors
-            // for the same root is a mess.
+            // for the same root is a mess.  Helper marker threads can take most of this;
+            // Mark() picks up the large objects they leave behind.
             
+            if (m_parallelMarker != NULL && m_incrementalWork.Count() > GCParallelMarker::kMinimumWork)
+                m_parallelMarker->Mark(0);
             Mark();
             
             // Force repeated restarts and marking until we're done.  For discussion
@@ -3056,6 +3269,116 @@ namespace MMgc
 #endif
     }
 
+    // Generational collection.
+    //
+    // Objects cannot be moved: the stack and many objects are scanned
+    // conservatively, so any object may be pinned by an ambiguous pointer.  The
+    // young generation is therefore not a separate space but the set of unmarked
+    // objects, and promotion is in place: in generational mode sweeping keeps the
+    // marks of the survivors (see 'stickyMarks'), and a marked object is old.
+    // Young objects are allocated unmarked from the ordinary size classes, so
+    // survivors end up in the GCAlloc and GCLargeAlloc blocks they were allocated
+    // in.
+    //
+    // The write barrier stays active between collections.  A store into an old
+    // object greys it and pushes it onto m_barrierWork, exactly as during
+    // incremental marking; that stack is the remembered set.  The granularity is
+    // the object, as the barrier has no notion of cards.
+    //
+    // Initializing stores into a new object do not always go through the barrier,
+    // and a collection can promote an object before it is fully initialized.  So
+    // every object is allocated with kRescan set, and the first minor collection
+    // after the object is promoted puts it on the remembered set and clears the
+    // bit (see RememberPromotedObjects).  An object is thus scanned again however
+    // it was stored into between its promotion and that collection.  Finding the
+    // promoted objects walks the mark bits of the blocks that have had objects
+    // allocated in them since the last minor collection, and of the large objects.
+    //
+    // A minor collection marks from the roots, the stack and the remembered set.
+    // Marking stops at old objects since they are already marked, so the work is
+    // proportional to the surviving young objects, the roots and the remembered
+    // objects.  The sweep then reclaims the unmarked, that is, dead young objects.
+    // StartIncrementalMark clears all marks, so the next major collection starts
+    // from scratch and reclaims dead old objects.
+    //
+    // A minor collection is not incremental; GCConfig::nurserySize bounds its
+    // pause.  Helper marker threads take part if there are any.
+
+    void GC::MinorCollect()
+    {
+        GCAssert(generational);
+        GCAssert(!marking);
+        GCAssert(!collecting);
+        GCAssert(!Reaping());
+
+        if (markerActive)
+            return;
+
+        policy.signal(GCPolicyManager::START_MinorCollection);
+
+        // Objects that died before the last collection are still in blocks that
+        // need sweeping; get rid of them before a stale pointer on the stack
+        // can resurrect them.
+        marking = true;
+        SweepNeedsSweeping();
+
+        {
+            TELEMETRY_METHOD(getTelemetry(), ".gc.MinorCollect");
+
+            RememberPromotedObjects();
+            FlushBarrierWork();
+            MarkNonstackRoots();
+            if (m_parallelMarker != NULL && m_incrementalWork.Count() > GCParallelMarker::kMinimumWork)
+                m_parallelMarker->Mark(0);
+            MarkQueueAndStack(true);
+
+            while (m_markStackOverflow) {
+                m_markStackOverflow = false;
+                HandleMarkStackOverflow();      // may set
+                FlushBarrierWork();             //    m_markStackOverflow
+                MarkQueueAndStack(true);        //       to true again
+            }
+            ClearMarkStack();
+            m_barrierWork.Clear();
+        }
+
+#ifdef _DEBUG
+        // Old objects must not point to young ones now.
+        FindMissingWriteBarriers();
+#endif
+
+        sweepStart = VMPI_getPerformanceCounter();
+        Sweep();
+
+        policy.signal(GCPolicyManager::END_MinorCollection);
+    }
+
+    void GC::RememberPromotedObjects()
+    {
+        for(int i=0; i < kNumSizeClasses; i++) {
+            containsPointersRCAllocs[i]->RememberPromotedObjects();
+            containsPointersNonfinalizedAllocs[i]->RememberPromotedObjects();
+            containsPointersFinalizedAllocs[i]->RememberPromotedObjects();
+        }
+
+        void* ptr;
+        GCLargeAllocIterator iter(largeAlloc);
+        while (iter.GetNextMarkedObject(ptr)) {
+            if (GetGCBits(GetRealPointer(ptr)) & kRescan)
+                RememberPromoted(ptr);
+        }
+    }
+
+    void GC::RememberPromoted(const void* userptr)
+    {
+        GetGCBits(GetRealPointer(userptr)) &= ~kRescan;
+        // Objects deleted while on the remembered set (see AbortFree) have
+        // been zeroed and hold no pointers.
+        if (IsRCObject(userptr) && ((RCObject*)userptr)->composite == 0)
+            return;
+        InlineWriteBarrierTrap(userptr);
+    }
+
 #ifdef _DEBUG
     bool GC::IsWhite(const void *item)
     {
@@ -3856,15 +4179,27 @@ namespace MMgc
         if(to == kFreeMemoryIfPossible) {
             if(onThread()) {
                 Collect();
+                FlushBlockCache();
             } else {
                 //  If we're not already in the middle of collecting from another thread's GC, then try to...
                 GCAutoEnter enter(this, GCAutoEnter::kTryEnter);
                 if(enter.Entered()) {
                     Collect(false);
+                    FlushBlockCache();
                 }
                 // else nothing can be done
             }
         }
+        else if(to == kMemSoftLimit) {
+            // No collection, but don't sit on free blocks past the soft limit.
+            if(onThread()) {
+                FlushBlockCache();
+            } else {
+                GCAutoEnter enter(this, GCAutoEnter::kTryEnter);
+                if(enter.Entered())
+                    FlushBlockCache();
+            }
+        }
     }
 
 #ifdef DEBUG
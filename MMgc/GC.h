@@ -154,6 +154,8 @@ namespace avmplus
 namespace MMgc
 {
     class GCAutoEnter;
+    class GCParallelMarker;
+    class GCParallelSweeper;
 
     class   GCExactDummyClass;
     typedef GCExactDummyClass* GCExactFlag;
@@ -447,6 +449,7 @@ namespace MMgc
         friend class ZCT;
         friend class AutoRCRootSegment;
         friend class GCPolicyManager;
+        friend class GCParallelMarker;
 
         // WriteBarrier classes use private write barriers.
         template<class T> friend class WriteBarrier;
@@ -518,6 +521,22 @@ namespace MMgc
          */
         const bool incremental;
 
+        /**
+         * generational is true if the GC is incremental and the configuration
+         * asks for a nursery (GCConfig::nurserySize).  Objects that survive a
+         * collection are then old until the next incremental collection starts,
+         * and the minor collections in between trace and sweep young objects
+         * only.  See GC::MinorCollect.
+         */
+        const bool generational;
+
+        /**
+         * The bits a new object starts with in generational mode: kRescan, so
+         * that the first minor collection after the object is promoted scans it
+         * again.  Zero otherwise.
+         */
+        const gcbits_t generationalRescanFlag;
+
         /**
          * drcEnabled controls whether DRC is employed.  This is true
          * by default and disabling it is only recommended for
@@ -1501,6 +1520,16 @@ namespace MMgc
          */
         bool presweeping;
 
+        /**
+         * True in generational mode from the sweep of one collection until the
+         * next incremental mark starts.  Marked objects are then old: sweeping
+         * and finalization leave their marks alone, and the write barrier stays
+         * active so that every old object that is stored into goes onto
+         * m_barrierWork, which becomes the remembered set for the next minor
+         * collection.  Young objects are the unmarked ones.
+         */
+        bool stickyMarks;
+
         /**
          * Nonzero if IncrementalMark is currently active.  This is more specific than 'marking';
          * Collect() uses this to protect itself from recursive calls during OOM handling.
@@ -1542,6 +1571,7 @@ namespace MMgc
         GCMarkStack m_incrementalWork;
         void StartIncrementalMark();
         void FinishIncrementalMark(bool scanNativeStack, bool okToShrinkHeapTarget=true);
+        void MinorCollect();
 
         GCMarkStack m_barrierWork;
         void CheckBarrierWork();
@@ -1557,6 +1587,32 @@ namespace MMgc
         // reach.  Managed entirely within MarkItem.
         uint32_t mark_item_recursion_control;
 
+        // Non-NULL if the configuration asks for helper marker threads.
+        GCParallelMarker* m_parallelMarker;
+
+        // True while helper threads are marking alongside the mutator; mark bits
+        // must then be claimed atomically and work found on a helper thread goes
+        // onto that thread's own stack.  See GCParallelMarker.
+        bool m_parallelMarking;
+
+        // Non-NULL if the configuration asks for helper sweeper threads.
+        GCParallelSweeper* m_parallelSweeper;
+
+        // The stack that receives mark work found on the calling thread.
+        GCMarkStack& CurrentMarkStack();
+
+        // Set 'flag' in 'bits' unless the object is already marked or queued;
+        // return true if this call set it.  The caller has seen the object
+        // unmarked, so this can only fail while marking in parallel.
+        bool SetBitsIfUnmarked(gcbits_t& bits, gcbits_t flag);
+        bool SetBitsIfUnmarkedAtomic(gcbits_t& bits, gcbits_t flag);
+
+        // Report mark work to the policy manager, or to the calling helper thread's
+        // private counters.
+        void SignalExactMarkWork(size_t nbytes);
+        void SignalConservativeMarkWork(size_t nbytes);
+        void SignalPointerfreeMarkWork(size_t nbytes);
+
 #ifdef _DEBUG
         // Works on any address
         bool IsWhite(const void *item);
@@ -1666,6 +1722,15 @@ namespace MMgc
         static void DoCleanStack(void* stackPointer, void* arg);
         static void DoMarkFromStack(void* stackPointer, void* arg);
 
+        // Put the objects promoted since the last minor collection on the
+        // remembered set (see kRescan and MinorCollect).
+        void RememberPromotedObjects();
+        void RememberPromoted(const void* userptr);
+
+        // Store every small-object allocator in 'allocs', return the count.
+        uint32_t GetSmallAllocators(GCAlloc** allocs);
+        static const uint32_t kNumSmallAllocators = kNumSizeClasses*5 + 2;
+
     public:
         // Sweep all small-block pages that need sweeping
         void SweepNeedsSweeping();
@@ -1687,6 +1752,26 @@ namespace MMgc
          */
         GCLargeAlloc::LargeBlock *largeEmptyPageList;
 
+    public:
+        static const uint32_t kMaxBlockCacheSize = 32;
+
+    private:
+        // Single blocks for the small-object allocators.  With a heap shared
+        // between threads every heap allocation takes the heap lock, and
+        // each thread allocates with its own GC; so AllocBlock and FreeBlock
+        // go through this per-GC cache, which gets and returns blocks in
+        // batches.  Cached blocks are allocated in the heap but not counted
+        // as the GC's by the policy manager, though memory reports include
+        // them; the cache is emptied at the end of every sweep and when the
+        // heap asks for memory back.
+        void* AllocCachedBlock(bool zero, bool canFail);
+        void FreeCachedBlock(void* ptr);
+        void FlushBlockCache(uint32_t keep=0);
+
+        const uint32_t blockCacheSize;
+        uint32_t blockCacheCount;
+        void* blockCache[kMaxBlockCacheSize];
+
         /**
          * Free list budget management for small-block allocators
          */
@@ -1860,6 +1945,10 @@ public:
 
         size_t GetNumBlocks();
 
+        //This method returns the number of free blocks held in the GC's block
+        //cache, which GetNumBlocks does not count
+        size_t GetNumCachedBlocks();
+
         virtual void memoryStatusChange(MemoryStatus oldStatus, MemoryStatus newStatus);
 
         /* A portable replacement for alloca().
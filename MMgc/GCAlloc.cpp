@@ -153,6 +153,7 @@ namespace MMgc
         containsRCObjects(_isRC),
         containsFinalizedObjects(_isFinalized),
         m_finalized(false),
+        m_blocksScanned(false),
         m_gc(_gc)
     {
 #ifdef DEBUG
@@ -213,6 +214,7 @@ namespace MMgc
             b->alloc = this;
             b->size = m_itemSize;
             b->slowFlags = 0;
+            b->hasNewItems = false;
             if(m_gc->collecting && m_finalized)
                 b->finalizeState = m_gc->finalizedValue;
             else
@@ -429,12 +431,13 @@ namespace MMgc
         GCAssert((flags & GC::kFinalize) == 0 || containsFinalizedObjects);
 
 #if defined VMCFG_EXACT_TRACING
-        b->bits[GetBitsIndex(b, item)] = (flags & (GC::kFinalize|GC::kInternalExact));
+        b->bits[GetBitsIndex(b, item)] = (flags & (GC::kFinalize|GC::kInternalExact)) | m_gc->generationalRescanFlag;
 #elif defined VMCFG_SELECTABLE_EXACT_TRACING
-        b->bits[GetBitsIndex(b, item)] = (flags & (GC::kFinalize|m_gc->runtimeSelectableExactnessFlag));  // 0 or GC::kInternalExact
+        b->bits[GetBitsIndex(b, item)] = (flags & (GC::kFinalize|m_gc->runtimeSelectableExactnessFlag)) | m_gc->generationalRescanFlag;  // 0 or GC::kInternalExact
 #else
-        b->bits[GetBitsIndex(b, item)] = (flags & GC::kFinalize);
+        b->bits[GetBitsIndex(b, item)] = (flags & GC::kFinalize) | m_gc->generationalRescanFlag;
 #endif
+        b->hasNewItems = true;
 
 #ifdef MMGC_HOOKS
         GCHeap* heap = GCHeap::GetGCHeap();
@@ -551,10 +554,11 @@ namespace MMgc
         int bitsindex = GetBitsIndex(b, item);
 
         // We can't allow free'ing something during sweeping - it messes up
-        // the per-block statistics - or anything that's on a mark queue.
+        // the per-block statistics - or anything that's on a mark queue or
+        // the remembered set.
 
         GCAssert(m_gc->collecting == false || m_gc->marking == true);
-        if (m_gc->marking && (m_gc->collecting || b->bits[bitsindex] & kQueued)) {
+        if (m_gc->BarrierActive() && (m_gc->collecting || b->bits[bitsindex] & kQueued)) {
             m_gc->AbortFree(GetUserPointer(item));
             return;
         }
@@ -865,10 +869,12 @@ namespace MMgc
                 b->gc->AddToSmallEmptyBlockList(b);
                 putOnFreeList = false;
             } else if(numMarkedItems == (m_itemsPerBlock - b->numFree)) {
-                // nothing changed on this page, clear marks
+                // nothing changed on this page, clear marks unless they make the
+                // items old (see GC::stickyMarks)
                 // note there will be at least one free item on the page (otherwise it
                 // would not have been scanned) so the page just stays on the freelist
-                ClearMarks(b);
+                if (!m_gc->stickyMarks)
+                    ClearMarks(b);
             } else if(!b->needsSweeping()) {
                 // Removed the block from the free list earlier, check again
                 GCAssert(!(b->nextFree || b->prevFree || b == m_firstFree));
@@ -895,29 +901,16 @@ namespace MMgc
 
             // Bugzilla 725955: eagerly search for all-free blocks to
             // tighten allocated memory (and thus reduce estimated
-            // live storage fed into load calcuation).
+            // live storage fed into load calcuation).  The search may
+            // already have been done by ScanBlocks.
 
-            GCAssert(kMark == 0x1 && kFinalizable == 0x4 && kHasWeakRef == 0x8);
-
-            bool anyMarkedItems = false;
-            gcbits_t* blockbits = b->bits;
-
-            for ( char *item = b->items, *limit = b->items + m_itemSize * b->GetCount() ; item < limit ; item += m_itemSize )
-            {
-                gcbits_t& marks = blockbits[GetBitsIndex(b,item)];
-                int mq = marks & kFreelist;
-                if(mq == kFreelist)
-                    continue;
-
-                if(mq == kMark) {
-                    anyMarkedItems = true;
-                    break;
-                }
-                GCAssertMsg(!(marks & kHasWeakRef),
-                            "No unmarked object should have a weak ref at this point");
-                GCAssertMsg(!(marks & kFinalizable),
-                            "No LazySweep candidate can have kFinalizable set.");
+            bool anyMarkedItems;
+            if (m_blocksScanned) {
+                anyMarkedItems = (b->slowFlags & kFlagUnmarked) == 0;
+                b->slowFlags &= ~kFlagUnmarked;
             }
+            else
+                anyMarkedItems = AnyMarkedItems(b);
 
             if (!anyMarkedItems) {
                 // Bugzilla 725955: add to list of block to be
@@ -930,7 +923,7 @@ namespace MMgc
                 UnlinkChunk(b);
                 b->gc->AddToSmallEmptyBlockList(b);
             }
-            else if (!b->needsSweeping())
+            else if (!b->needsSweeping() && !(m_gc->stickyMarks && AllItemsMarked(b)))
             {
                 if(b->nextFree || b->prevFree || b == m_firstFree)
                     RemoveFromFreeList(b);
@@ -938,12 +931,88 @@ namespace MMgc
             }
             b->finalizeState = m_gc->finalizedValue;
         }
+        m_blocksScanned = false;
+    }
+
+    bool GCAlloc::AnyMarkedItems(GCBlock *b)
+    {
+        GCAssert(kMark == 0x1 && kFinalizable == 0x4 && kHasWeakRef == 0x8);
+
+        gcbits_t* blockbits = b->bits;
+        for ( char *item = b->items, *limit = b->items + m_itemSize * b->GetCount() ; item < limit ; item += m_itemSize )
+        {
+            gcbits_t& marks = blockbits[GetBitsIndex(b,item)];
+            int mq = marks & kFreelist;
+            if(mq == kFreelist)
+                continue;
+
+            if(mq == kMark)
+                return true;
+
+            GCAssertMsg(!(marks & kHasWeakRef),
+                        "No unmarked object should have a weak ref at this point");
+            GCAssertMsg(!(marks & kFinalizable),
+                        "No LazySweep candidate can have kFinalizable set.");
+        }
+        return false;
+    }
+
+    // In generational mode a block whose items in use are all marked has
+    // nothing to sweep, since sweeping would keep the marks anyway.
+
+    bool GCAlloc::AllItemsMarked(GCBlock *b)
+    {
+        gcbits_t* blockbits = b->bits;
+        for ( char *item = b->items, *limit = b->items + m_itemSize * b->GetCount() ; item < limit ; item += m_itemSize )
+        {
+            if((blockbits[GetBitsIndex(b,item)] & kFreelist) == 0)
+                return false;
+        }
+        return true;
+    }
+
+    // The two methods below do the part of finalization and sweeping that
+    // touches nothing but this allocator's blocks, so that GCParallelSweeper
+    // can run them for different allocators on different threads.  The block
+    // lists are left alone; LazySweepPass and Sweep pick up the results.
+
+    // Record in every block whether it has any marked items.  Only for
+    // allocators without finalizers, after all finalizers have run.
+
+    void GCAlloc::ScanBlocks()
+    {
+        if (containsFinalizedObjects)
+            return;
+        for (GCBlock* b = m_firstBlock; b != NULL; b = Next(b))
+        {
+            if (AnyMarkedItems(b))
+                b->slowFlags &= ~kFlagUnmarked;
+            else
+                b->slowFlags |= kFlagUnmarked;
+        }
+        m_blocksScanned = true;
+    }
+
+    // Sweep the items of every block that needs sweeping.
+
+    void GCAlloc::PresweepBlocks()
+    {
+        GCAssert(m_qList == NULL);
+        for (GCBlock* b = m_needsSweeping; b != NULL; b = b->nextFree)
+        {
+            GCAssert(!(b->slowFlags & kFlagSwept));
+            int oldNumFree = b->numFree;
+            SweepGuts(b);
+            m_totalAllocatedBytes -= (b->numFree - oldNumFree) * m_itemSize;
+            b->slowFlags |= kFlagSwept;
+        }
     }
 
     // OPTIMIZEME: There are several opportunities for micro-optimizations here.
 
     void GCAlloc::SweepGuts(GCBlock *b)
     {
+        const bool sticky = m_gc->stickyMarks;
         gcbits_t* blockbits = b->bits;
         for ( char *item = b->items, *limit = b->items + m_itemSize * b->GetCount() ; item < limit ; item += m_itemSize )
         {
@@ -953,8 +1022,9 @@ namespace MMgc
             int mq = marks & kFreelist;
             if(mq == kMark || mq == kQueued)    // Sweeping is lazy; don't sweep objects on the mark stack
             {
-                // live item, clear bits
-                marks &= ~kFreelist;
+                // live item, clear bits unless they make it old (see GC::stickyMarks)
+                if (!sticky)
+                    marks &= ~kFreelist;
                 continue;
             }
 
@@ -989,14 +1059,17 @@ namespace MMgc
 
     bool GCAlloc::Sweep(GCBlock *b)
     {
-        int oldNumFree;
         GCAssert(b->needsSweeping());
         GCAssert(m_qList == NULL);
         RemoveFromSweepList(b);
 
-        oldNumFree = b->numFree;
-        SweepGuts(b);
-        m_totalAllocatedBytes -= (b->numFree - oldNumFree) * m_itemSize;
+        if (b->slowFlags & kFlagSwept)
+            b->slowFlags &= ~kFlagSwept;   // PresweepBlocks did the work
+        else {
+            int oldNumFree = b->numFree;
+            SweepGuts(b);
+            m_totalAllocatedBytes -= (b->numFree - oldNumFree) * m_itemSize;
+        }
         if(b->numFree == m_itemsPerBlock)
         {
             UnlinkChunk(b);
@@ -1058,6 +1131,39 @@ namespace MMgc
         }
     }
 
+    // Only blocks that have had items allocated in them since the last call are
+    // visited.  A block keeps hasNewItems while it holds objects that are still
+    // young, so that they are found once they are promoted.
+
+    void GCAlloc::RememberPromotedObjects()
+    {
+        GCAssert(m_qList == NULL);
+        for ( GCBlock *block=m_firstBlock ; block ; block=Next(block) ) {
+            if (!block->hasNewItems)
+                continue;
+
+            bool hasYoungItems = false;
+            for ( char *item = block->items, *limit = block->items + m_itemSize * block->GetCount() ; item < limit ; item += m_itemSize ) {
+                gcbits_t& bits = GC::GetGCBits(item);
+                if ((bits & kRescan) == 0)
+                    continue;
+                switch (bits & kFreelist) {
+                    case kMark:
+                        m_gc->RememberPromoted(GetUserPointer(item));
+                        break;
+                    case kFreelist:
+                        // Free, or already on the remembered set.
+                        bits &= ~kRescan;
+                        break;
+                    default:
+                        hasYoungItems = true;
+                        break;
+                }
+            }
+            block->hasNewItems = hasYoungItems;
+        }
+    }
+
 #ifdef _DEBUG
     void GCAlloc::CheckMarks()
     {
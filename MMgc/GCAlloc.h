@@ -57,8 +57,8 @@ namespace MMgc
         kQueued=2,              // object is on the mark or barrier queues
         kFinalizable=4,         // object's destructor must be called when the object is destroyed
         kHasWeakRef=8,          // there's an entry for the object in the weakRefs table
-        kVirtualGCTrace = 16    // object derived from GCTraceableBase and has gcTrace override(s), see GCObject.h
-        // free: 32
+        kVirtualGCTrace = 16,   // object derived from GCTraceableBase and has gcTrace override(s), see GCObject.h
+        kRescan = 32            // generational mode: object to be rescanned once it is old, see GC::MinorCollect
         // free: 64
         // free: 128
     };
@@ -107,6 +107,7 @@ namespace MMgc
     {
         friend class GC;
         friend class GCAllocIterator;
+        friend class GCParallelSweeper;
         friend class ZCT;
 
     public:
@@ -131,7 +132,10 @@ namespace MMgc
         void Finalize();
         void FinalizationPass();
         void LazySweepPass();
+        void ScanBlocks();
+        void PresweepBlocks();
         void ClearMarks();
+        void RememberPromotedObjects();
 #ifdef _DEBUG
         void CheckMarks();
         void CheckFreelist();
@@ -175,6 +179,8 @@ namespace MMgc
 
         const static short kFlagNeedsSweeping = 1;  // set if the block had finalized objects and needs to be swept
         const static short kFlagWeakRefs = 2;       // set if the block may have weak refs and we should check during free
+        const static short kFlagUnmarked = 4;       // set by ScanBlocks if the block has no marked items
+        const static short kFlagSwept = 8;          // set by PresweepBlocks if the block has been swept but not yet relinked
 
         // Objects on the free list all have a next pointer in the first word and
         // the object index within its block as the second word.  Only the low 16 bits
@@ -191,6 +197,7 @@ namespace MMgc
             short numFree;          // the number of free objects in this block
             uint8_t slowFlags;      // flags for special circumstances: kFlagNeedsSweeping, etc
             bool finalizeState:1;   // whether we've been visited during the Finalize stage
+            bool hasNewItems:1;     // items allocated since the last RememberPromotedObjects may be here
             char   *items;          // pointer to the array of objects in the block
 
             int GetCount() const;
@@ -268,6 +275,7 @@ namespace MMgc
         const bool containsRCObjects;
         const bool containsFinalizedObjects;
         bool m_finalized;
+        bool m_blocksScanned;       // ScanBlocks has run since the last LazySweepPass
 
 #ifdef _DEBUG
         bool IsOnEitherList(GCBlock *b);
@@ -305,6 +313,8 @@ namespace MMgc
 
         bool Sweep(GCBlock *b);
         void SweepGuts(GCBlock *b);
+        bool AnyMarkedItems(GCBlock *b);
+        bool AllItemsMarked(GCBlock *b);
 
         void ClearMarks(GCAlloc::GCBlock* block);
         void SweepNeedsSweeping();
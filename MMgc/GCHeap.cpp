@@ -603,6 +603,93 @@ namespace MMgc
         return baseAddr;
     }
 
+    uint32_t GCHeap::AllocBlocks(void** blocks, uint32_t count, uint32_t flags)
+    {
+        GCAssert(count > 0);
+
+        uint32_t n = 0;
+        bool expand = (flags & kExpand) != 0;
+        bool zero = (flags & kZero) != 0;
+        bool profile = (flags & kProfile) != 0;
+        bool zeroed[kMaxBlockBatch];
+        {
+            MMGC_LOCK(m_spinlock);
+
+            bool saved_oomHandling = m_oomHandling;
+            m_oomHandling = saved_oomHandling && (flags & kNoOOMHandling) == 0;
+
+            // AllocHelper clears 'zero' if the block is known to be zero already.
+            zeroed[0] = zero;
+            void *baseAddr = AllocHelper(1, expand, zeroed[0], 1);
+            if (!baseAddr)
+            {
+                SendFreeMemorySignal(1);
+                zeroed[0] = zero;
+                baseAddr = AllocHelper(1, expand, zeroed[0], 1);
+            }
+            if (!baseAddr)
+            {
+                if (flags & kCanFail)
+                {
+                    m_oomHandling = saved_oomHandling;
+                    return 0;
+                } else {
+                    Abort();
+                }
+            }
+            blocks[n++] = baseAddr;
+
+            // The rest are a bonus: don't grow the heap or go over a limit for them.
+            while (n < count && n < kMaxBlockBatch && !SoftLimitExceeded() && !HardLimitExceeded())
+            {
+                zeroed[n] = zero;
+                baseAddr = AllocHelper(1, false, zeroed[n], 1);
+                if (!baseAddr)
+                    break;
+                blocks[n++] = baseAddr;
+            }
+
+            numAlloc += n;
+
+#ifdef MMGC_MEMORY_PROFILER
+            if(profile && HooksEnabled() && profiler) {
+                for (uint32_t i=0; i < n; i++)
+                    profiler->RecordAllocation(blocks[i], kBlockSize, kBlockSize, /*managed=*/false);
+            }
+#endif
+
+            if (m_oomHandling)
+            {
+                CheckForMemoryLimitsExceeded();
+            }
+
+            m_oomHandling = saved_oomHandling;
+        }
+
+        for (uint32_t i=0; i < n; i++)
+        {
+            if (zeroed[i]) {
+                VALGRIND_MAKE_MEM_DEFINED(blocks[i], kBlockSize);
+                VMPI_memset(blocks[i], 0, kBlockSize);
+                VALGRIND_MAKE_MEM_UNDEFINED(blocks[i], kBlockSize);
+            }
+        }
+
+        // As in Alloc.
+        if((flags & kCanFail) != 0 && (status == kMemSoftLimit || SoftLimitExceeded() || HardLimitExceeded() ))
+        {
+            FreeBlocks(blocks, n, profile);
+            return 0;
+        }
+
+        if (profile) {
+            for (uint32_t i=0; i < n; i++)
+                VALGRIND_MALLOCLIKE_BLOCK(blocks[i], kBlockSize, 0, zero);
+        }
+
+        return n;
+    }
+
     void *GCHeap::AllocHelper(size_t size, bool expand, bool& zero, size_t alignment)
     {
         // first try to find it in our existing free memory
@@ -718,6 +805,37 @@ namespace MMgc
         m_oomHandling = saved_oomHandling;
     }
 
+    void GCHeap::FreeBlocks(void** blocks, uint32_t count, bool profile)
+    {
+        (void)profile;
+
+        MMGC_LOCK(m_spinlock);
+
+        for (uint32_t i=0; i < count; i++)
+        {
+            HeapBlock *block = BaseAddrToBlock(blocks[i]);
+            GCAssert(block != NULL && block->size == 1);
+
+            GCAssert(numAlloc >= 1);
+            numAlloc--;
+
+#if defined(MMGC_MEMORY_PROFILER) && defined(MMGC_MEMORY_INFO)
+            if(profiler)
+                block->freeTrace = profiler->GetStackTrace();
+#endif
+
+#ifdef MMGC_MEMORY_PROFILER
+            if(profile && HooksEnabled() && profiler)
+                profiler->RecordDeallocation(blocks[i], kBlockSize);
+#endif
+
+            FreeBlock(block);
+
+            if (profile)
+                VALGRIND_FREELIKE_BLOCK(blocks[i], 0);
+        }
+    }
+
     void GCHeap::Decommit()
     {
         // keep at least initialSize free
@@ -2676,7 +2794,7 @@ namespace MMgc
             gc_allocated_total += allocated;
             gc_count += 1;
 
-            gc_total += gc->GetNumBlocks() * kBlockSize;
+            gc_total += (gc->GetNumBlocks() + gc->GetNumCachedBlocks()) * kBlockSize;
         }
 
 #ifdef MMGC_MEMORY_PROFILER
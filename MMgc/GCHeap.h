@@ -278,6 +278,9 @@ namespace MMgc
          */
         const static uint32_t kOSAllocThreshold = 256;
 
+        /** The most blocks returned by one AllocBlocks call. */
+        const static uint32_t kMaxBlockBatch = 32;
+
         /** In between sizes map this many distinct sizes to a single bin. */
         const static uint32_t kFreeListCompression = 8;
 
@@ -449,6 +452,19 @@ namespace MMgc
          */
         void *AllocNoOOM(size_t size, uint32_t flags=flags_Alloc);
 
+        /**
+         * Allocates up to 'count' single blocks, each of which can be freed on
+         * its own, while taking the heap lock only once.  The heap is expanded
+         * for the first block only; the others come from free memory, and
+         * fewer are returned if there is not enough of it or a memory limit
+         * has been reached, and at most kMaxBlockBatch are returned.  kZero
+         * and kProfile apply to every block, as in Alloc.
+         *
+         * @return the number of blocks stored in 'blocks'.  This is at least 1
+         * unless kCanFail was in flags and the allocation failed.
+         */
+        uint32_t AllocBlocks(void** blocks, uint32_t count, uint32_t flags=kExpand);
+
         /**
          * Signal that code memory is about to be allocated (accounting).  May invoke
          * OOM handling in order to make memory available if we're pushing up against
@@ -480,6 +496,13 @@ namespace MMgc
          */
         void FreeNoProfile(void *item);
 
+        /**
+         * Frees 'count' blocks returned by AllocBlocks, taking the heap lock
+         * only once.  'profile' must be true if they were allocated with
+         * kProfile.
+         */
+        void FreeBlocks(void** blocks, uint32_t count, bool profile=false);
+
         /**
          * Signal that code memory was deallocated (accounting).
          * @param size           the number of blocks
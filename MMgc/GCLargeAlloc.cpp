@@ -85,6 +85,7 @@ namespace MMgc
 
             if(m_gc->collecting && !m_startedFinalize)
                 flagbits0 |= kMark;
+            flagbits0 |= m_gc->generationalRescanFlag;
 
             block->flags[0] = flagbits0;
             block->flags[1] = flagbits1;
@@ -140,7 +141,7 @@ namespace MMgc
         // We can't allow free'ing something during Sweeping, otherwise alloc counters
         // get decremented twice and destructors will be called twice.
         GCAssert(m_gc->collecting == false || m_gc->marking == true);
-        if (m_gc->marking && (m_gc->collecting || IsProtectedAgainstFree(b))) {
+        if (m_gc->BarrierActive() && (m_gc->collecting || IsProtectedAgainstFree(b))) {
             m_gc->AbortFree(GetUserPointer(item));
             return;
         }
@@ -253,8 +254,9 @@ namespace MMgc
                 m_totalAllocatedBytes -= b->size;
                 continue;
             }
-            // clear marks
-            b->flags[0] &= ~(kMark|kQueued);
+            // clear marks unless they make the object old (see GC::stickyMarks)
+            if (!m_gc->stickyMarks)
+                b->flags[0] &= ~(kMark|kQueued);
             prev = (LargeBlock**)(&b->next);
         }
         m_startedFinalize = false;
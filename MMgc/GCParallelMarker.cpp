@@ -0,0 +1,284 @@
+/* -*- Mode: C++; c-basic-offset: 4; indent-tabs-mode: nil; tab-width: 4 -*- */
+/* vi: set ts=4 sw=4 expandtab: (add to ~/.vimrc: set modeline modelines=5) */
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "MMgc.h"
+
+namespace MMgc
+{
+    GCParallelMarker::GCParallelMarker(GC* gc, uint32_t threadCount)
+        : gc(gc)
+        , threadCount(threadCount)
+        , threadsStarted(0)
+        , threads(NULL)
+        , contexts(NULL)
+        , generation(0)
+        , running(0)
+        , nextContext(0)
+        , stopping(false)
+#ifdef MMGC_MARKSTACK_ALLOWANCE
+        , shared(0)
+#endif
+        , sharedCount(0)
+        , idle(0)
+        , participants(0)
+        , done(false)
+        , stop(false)
+    {
+        GCAssert(threadCount > 0);
+        VMPI_lockInit(&sharedLock);
+    }
+
+    GCParallelMarker::~GCParallelMarker()
+    {
+        SCOPE_LOCK_NO_SP_NAMED(locker, monitor) {
+            stopping = true;
+            locker.notifyAll();
+        }
+        if (threads) {
+            for (uint32_t i = 0; i < threadCount; i++) {
+                if (threads[i]) {
+                    threads[i]->join();
+                    mmfx_delete(threads[i]);
+                }
+            }
+            mmfx_delete_array(threads);
+            for (uint32_t i = 0; i < threadCount; i++)
+                mmfx_delete(contexts[i]);
+            mmfx_delete_array(contexts);
+        }
+        VMPI_lockDestroy(&sharedLock);
+    }
+
+    void GCParallelMarker::StartThreads()
+    {
+        contexts = mmfx_new_array(GCMarkerContext*, threadCount);
+        for (uint32_t i = 0; i < threadCount; i++)
+            contexts[i] = mmfx_new(GCMarkerContext());
+        threads = mmfx_new_array(vmbase::VMThread*, threadCount);
+        for (uint32_t i = 0; i < threadCount; i++) {
+            threads[i] = mmfx_new(vmbase::VMThread("gcmark", this));
+            if (!threads[i]->start()) {
+                mmfx_delete(threads[i]);
+                threads[i] = NULL;
+            }
+        }
+    }
+
+    bool GCParallelMarker::Mark(uint64_t deadline)
+    {
+        if (!threads)
+            StartThreads();
+
+        // Only helpers that have reached their wait loop take part, so a helper
+        // that is slow to start (or never starts) cannot hold up the step.  The
+        // count is read and the step started under one lock so that a helper
+        // arriving in between waits for the next step.
+        uint32_t helpers = 0;
+        SCOPE_LOCK_NO_SP_NAMED(locker, monitor) {
+            helpers = threadsStarted;
+            if (helpers > 0) {
+                gc->markerActive++;
+                gc->m_parallelMarking = true;
+                idle = 0;
+                participants = helpers + 1;
+                done = false;
+                stop = false;
+                generation++;
+                running = helpers;
+                locker.notifyAll();
+            }
+        }
+        if (helpers == 0)
+            return false;
+
+        MutatorMark(deadline);
+
+        stop = true;
+        SCOPE_LOCK_NO_SP_NAMED(locker, monitor) {
+            while (running > 0)
+                locker.wait();
+        }
+
+        gc->m_parallelMarking = false;
+        for (uint32_t i = 0; i < threadCount; i++) {
+            GCMarkerContext* context = contexts[i];
+            gc->policy.signalParallelMarkWork(context->work);
+            context->work.Clear();
+            Reclaim(context->deferred);
+            Reclaim(context->stack);
+        }
+        Reclaim(shared);
+        sharedCount = 0;
+        gc->markerActive--;
+        return true;
+    }
+
+    void GCParallelMarker::run()
+    {
+        // Mark stack segments come from the GCHeap, which requires an enter
+        // frame on every thread that allocates.
+        MMGC_ENTER_VOID;
+
+        GCMarkerContext* context = NULL;
+        uint32_t seen = 0;
+        SCOPE_LOCK_NO_SP(monitor) {
+            context = contexts[nextContext++];
+            // Join at the next step; the current one, if any, did not count us.
+            seen = generation;
+            threadsStarted++;
+        }
+        current = context;
+
+        for (;;) {
+            SCOPE_LOCK_NO_SP_NAMED(locker, monitor) {
+                while (generation == seen && !stopping)
+                    locker.wait();
+                if (stopping)
+                    return;
+                seen = generation;
+            }
+
+            HelperMark(context);
+
+            SCOPE_LOCK_NO_SP_NAMED(locker, monitor) {
+                if (--running == 0)
+                    locker.notifyAll();
+            }
+        }
+    }
+
+    // The mutator marks from the GC's own stack, which may also hold roots,
+    // split large objects, and protectors; it handles those itself and only
+    // ever shares plain GC objects.
+
+    void GCParallelMarker::MutatorMark(uint64_t deadline)
+    {
+        GCMarkStack& stack = gc->m_incrementalWork;
+        for (;;) {
+            for (uint32_t i=0; i < kCheckInterval && !stack.IsEmpty(); i++) {
+                const void* ptr;
+                if ((ptr = stack.Pop_GCObject()) != NULL)
+                    gc->MarkItem_GCObject(ptr);
+                else
+                    gc->MarkTopItem_NonGCObject();
+            }
+            if (stack.IsEmpty()) {
+                if (!Acquire(stack, deadline))
+                    return;
+                continue;
+            }
+            if (deadline != 0 && VMPI_getPerformanceCounter() >= deadline)
+                return;
+            if (idle > 0)
+                Share(stack);
+        }
+    }
+
+    void GCParallelMarker::HelperMark(GCMarkerContext* context)
+    {
+        GCMarkStack& stack = context->stack;
+        while (!stop) {
+            for (uint32_t i=0; i < kCheckInterval && !stack.IsEmpty(); i++) {
+                const void* ptr = stack.Pop_GCObject();
+                GCAssert(ptr != NULL);
+                // Splitting a large object protects it against GC::Free and
+                // pushes its tail onto the stack; leave all that to the mutator.
+                if (GCLargeAlloc::IsLargeBlock(GetRealPointer(ptr))) {
+                    if (!context->deferred.Push_GCObject(ptr))
+                        gc->SignalMarkStackOverflow_GCObject(ptr);
+                }
+                else
+                    gc->MarkItem_GCObject(ptr);
+            }
+            if (stack.IsEmpty()) {
+                if (!Acquire(stack, 0))
+                    return;
+            }
+            else if (idle > 0)
+                Share(stack);
+        }
+    }
+
+    void GCParallelMarker::Share(GCMarkStack& from)
+    {
+        if (sharedCount >= kBatchSize)
+            return;
+        uint32_t n = from.Count() / 2;
+        if (n > kBatchSize)
+            n = kBatchSize;
+        MMGC_LOCK(sharedLock);
+        for (uint32_t i=0; i < n; i++) {
+            const void* ptr = from.Pop_GCObject();
+            if (ptr == NULL)
+                break;
+            if (!shared.Push_GCObject(ptr)) {
+                // Popping left a segment cached in 'from', so this won't fail.
+                if (!from.Push_GCObject(ptr))
+                    gc->SignalMarkStackOverflow_GCObject(ptr);
+                break;
+            }
+        }
+        sharedCount = shared.Count();
+    }
+
+    // Take a batch from the shared stack, waiting for one if necessary.  Return
+    // false when the step is over: every participant is idle with nothing
+    // shared, or time is up.
+
+    bool GCParallelMarker::Acquire(GCMarkStack& to, uint64_t deadline)
+    {
+        bool isIdle = false;
+        for (;;) {
+            {
+                MMGC_LOCK(sharedLock);
+                if (sharedCount > 0) {
+                    if (isIdle)
+                        idle--;
+                    for (uint32_t i=0; i < kBatchSize && !shared.IsEmpty(); i++) {
+                        const void* ptr = shared.Pop_GCObject();
+                        if (!to.Push_GCObject(ptr))
+                            gc->SignalMarkStackOverflow_GCObject(ptr);
+                    }
+                    sharedCount = shared.Count();
+                    return true;
+                }
+                // Only busy threads share, so once everybody is idle with
+                // nothing shared no more work can appear.
+                if (!isIdle) {
+                    isIdle = true;
+                    if (++idle == participants)
+                        done = true;
+                }
+            }
+            while (sharedCount == 0) {
+                if (done || stop)
+                    return false;
+                if (deadline != 0 && VMPI_getPerformanceCounter() >= deadline) {
+                    stop = true;
+                    return false;
+                }
+                VMPI_threadYield();
+            }
+        }
+    }
+
+    // Move everything on a helper or shared stack back to the GC's stack.  All
+    // items are plain GC objects, so the GC's barrier-stack transfer applies;
+    // if that runs out of memory the objects are dropped as for any other mark
+    // stack overflow.
+
+    void GCParallelMarker::Reclaim(GCMarkStack& from)
+    {
+        if (from.IsEmpty())
+            return;
+        if (!gc->m_incrementalWork.TransferEverythingFrom(from)) {
+            gc->SignalMarkStackOverflow_NonGCObject();
+            const void* ptr;
+            while ((ptr = from.Pop_GCObject()) != NULL)
+                gc->SignalMarkStackOverflow_GCObject(ptr);
+        }
+    }
+}
@@ -0,0 +1,120 @@
+/* -*- Mode: C++; c-basic-offset: 4; indent-tabs-mode: nil; tab-width: 4 -*- */
+/* vi: set ts=4 sw=4 expandtab: (add to ~/.vimrc: set modeline modelines=5) */
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef __GCParallelMarker__
+#define __GCParallelMarker__
+
+namespace MMgc
+{
+    /**
+     * Marking state private to one helper thread of a GCParallelMarker.
+     */
+    class GCMarkerContext
+    {
+    public:
+#ifdef MMGC_MARKSTACK_ALLOWANCE
+        GCMarkerContext() : stack(0), deferred(0) {}
+#endif
+
+        GCMarkStack stack;      // Work found by this thread; GC objects only
+        GCMarkStack deferred;   // Large objects, which are left for the mutator
+        GCMarkWork work;        // Mark work not yet reported to the policy manager
+    };
+
+    /**
+     * GCParallelMarker lets helper threads drain the mark stack together with
+     * the mutator while the mutator is inside the collector's marking code: the
+     * incremental mark steps and the first drain of FinishIncrementalMark.
+     *
+     * The helpers never run concurrently with the mutator's own code.  The VM
+     * deletes objects explicitly (GC::Free) and exact tracers read object
+     * fields without synchronization, so marking concurrently with a running
+     * mutator is not safe; instead each mark step simply gets more threads,
+     * and the write barrier and incremental scheduling are unchanged.  Root
+     * scanning, the final root and stack scan, and split large objects remain
+     * on the mutator thread.
+     *
+     * During a parallel step the mutator keeps marking from the GC's mark stack
+     * and every helper marks from a private stack.  Whoever pushes an object
+     * first claims it by setting its queued bit with a compare-and-swap (see
+     * GC::SetBitsIfUnmarked), so each object is traced once.  Idle threads take
+     * batches of objects from a shared stack that busy threads refill.  Helpers
+     * hand large objects back to the mutator rather than splitting them, and
+     * report their mark work through a GCMarkWork rather than the policy
+     * manager.  When the step ends - no work is left anywhere, or the time
+     * slice is used up - everything still on the private and shared stacks is
+     * moved back to the GC's mark stack.
+     */
+    class GCParallelMarker : public vmbase::Runnable
+    {
+    public:
+        /**
+         * Don't bother the helpers for less work than this; waking them costs
+         * more than marking a few objects.
+         */
+        static const uint32_t kMinimumWork = 32;
+
+        GCParallelMarker(GC* gc, uint32_t threadCount);
+
+        /** Stop and join the helper threads. */
+        ~GCParallelMarker();
+
+        /**
+         * Mark in parallel until there is no work left or VMPI_getPerformanceCounter()
+         * passes 'deadline' (0 means no deadline).  Must be called on the mutator
+         * thread.  On return all unfinished work is on the GC's mark stack.
+         *
+         * @return false if no helper thread could be started, in which case no
+         *         work has been done.
+         */
+        bool Mark(uint64_t deadline);
+
+        /** The calling helper's marking state, or NULL on any other thread. */
+        GCMarkerContext* CurrentContext() const;
+
+        /** Helper thread body. */
+        void run();
+
+    private:
+        static const uint32_t kBatchSize = 32;      // Objects moved to or from the shared stack at a time
+        static const uint32_t kCheckInterval = 32;  // Objects marked between checks for hungry threads and time
+
+        void StartThreads();
+        void MutatorMark(uint64_t deadline);
+        void HelperMark(GCMarkerContext* context);
+        void Share(GCMarkStack& from);
+        bool Acquire(GCMarkStack& to, uint64_t deadline);
+        void Reclaim(GCMarkStack& from);
+
+        GC* const gc;
+        const uint32_t threadCount;
+        uint32_t threadsStarted;
+        vmbase::VMThread** threads;             // Started lazily by the first Mark()
+        GCMarkerContext** contexts;             // One per helper
+        GCThreadLocal<GCMarkerContext*> current;
+
+        vmbase::WaitNotifyMonitor monitor;      // Protects the four fields below
+        uint32_t generation;                    // Bumped to start a step
+        uint32_t running;                       // Helpers that have not finished the current step
+        uint32_t nextContext;                   // Hands out contexts to starting helpers
+        bool stopping;                          // Set by the destructor
+
+        vmpi_spin_lock_t sharedLock;            // Protects 'shared', 'idle' and 'done' updates
+        GCMarkStack shared;                     // Batches of GC objects up for grabs
+        volatile uint32_t sharedCount;          // shared.Count(), for polling without the lock
+        volatile uint32_t idle;                 // Threads that are out of work
+        uint32_t participants;                  // Helpers started plus the mutator
+        volatile bool done;                     // Every participant is idle and 'shared' is empty
+        volatile bool stop;                     // Time is up or the step is otherwise over
+    };
+
+    REALLY_INLINE GCMarkerContext* GCParallelMarker::CurrentContext() const
+    {
+        return current;
+    }
+}
+
+#endif /* __GCParallelMarker__ */
@@ -0,0 +1,128 @@
+/* -*- Mode: C++; c-basic-offset: 4; indent-tabs-mode: nil; tab-width: 4 -*- */
+/* vi: set ts=4 sw=4 expandtab: (add to ~/.vimrc: set modeline modelines=5) */
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "MMgc.h"
+
+namespace MMgc
+{
+    GCParallelSweeper::GCParallelSweeper(GC* gc, uint32_t threadCount)
+        : gc(gc)
+        , threadCount(threadCount)
+        , threads(NULL)
+        , threadsStarted(0)
+        , generation(0)
+        , running(0)
+        , stopping(false)
+        , task(kScanBlocks)
+        , allocs(NULL)
+        , count(0)
+        , next(0)
+    {
+        GCAssert(threadCount > 0);
+    }
+
+    GCParallelSweeper::~GCParallelSweeper()
+    {
+        SCOPE_LOCK_NO_SP_NAMED(locker, monitor) {
+            stopping = true;
+            locker.notifyAll();
+        }
+        if (threads) {
+            for (uint32_t i = 0; i < threadCount; i++) {
+                if (threads[i]) {
+                    threads[i]->join();
+                    mmfx_delete(threads[i]);
+                }
+            }
+            mmfx_delete_array(threads);
+        }
+    }
+
+    void GCParallelSweeper::StartThreads()
+    {
+        threads = mmfx_new_array(vmbase::VMThread*, threadCount);
+        for (uint32_t i = 0; i < threadCount; i++) {
+            threads[i] = mmfx_new(vmbase::VMThread("gcsweep", this));
+            if (!threads[i]->start()) {
+                mmfx_delete(threads[i]);
+                threads[i] = NULL;
+            }
+        }
+    }
+
+    void GCParallelSweeper::Run(Task task, GCAlloc** allocs, uint32_t count)
+    {
+        if (!threads)
+            StartThreads();
+
+        // As in GCParallelMarker, only helpers already waiting take part, and
+        // the count is read and the task posted under one lock.
+        uint32_t helpers = 0;
+        SCOPE_LOCK_NO_SP_NAMED(locker, monitor) {
+            this->task = task;
+            this->allocs = allocs;
+            this->count = count;
+            next = 0;
+            helpers = threadsStarted;
+            if (helpers > 0) {
+                generation++;
+                running = helpers;
+                locker.notifyAll();
+            }
+        }
+
+        Work();
+
+        SCOPE_LOCK_NO_SP_NAMED(locker, monitor) {
+            while (running > 0)
+                locker.wait();
+            this->allocs = NULL;
+        }
+    }
+
+    void GCParallelSweeper::run()
+    {
+        uint32_t seen = 0;
+        SCOPE_LOCK_NO_SP(monitor) {
+            seen = generation;
+            threadsStarted++;
+        }
+
+        for (;;) {
+            SCOPE_LOCK_NO_SP_NAMED(locker, monitor) {
+                while (generation == seen && !stopping)
+                    locker.wait();
+                if (stopping)
+                    return;
+                seen = generation;
+            }
+
+            Work();
+
+            SCOPE_LOCK_NO_SP_NAMED(locker, monitor) {
+                if (--running == 0)
+                    locker.notifyAll();
+            }
+        }
+    }
+
+    void GCParallelSweeper::Work()
+    {
+        for (;;) {
+            uint32_t i = uint32_t(VMPI_atomicIncAndGet32WithBarrier(&next) - 1);
+            if (i >= count)
+                return;
+            switch (task) {
+                case kScanBlocks:
+                    allocs[i]->ScanBlocks();
+                    break;
+                case kPresweepBlocks:
+                    allocs[i]->PresweepBlocks();
+                    break;
+            }
+        }
+    }
+}
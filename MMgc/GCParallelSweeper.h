@@ -0,0 +1,75 @@
+/* -*- Mode: C++; c-basic-offset: 4; indent-tabs-mode: nil; tab-width: 4 -*- */
+/* vi: set ts=4 sw=4 expandtab: (add to ~/.vimrc: set modeline modelines=5) */
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef __GCParallelSweeper__
+#define __GCParallelSweeper__
+
+namespace MMgc
+{
+    /**
+     * GCParallelSweeper spreads the per-block work of finalization and sweeping
+     * over helper threads and the mutator.
+     *
+     * Blocks of different small-object allocators are independent, so the
+     * sweeper hands out whole allocators: each thread claims the next one and
+     * runs the task on all its blocks.  The tasks only read and write the
+     * blocks' items and mark bits and the allocator's own counters (see
+     * GCAlloc::ScanBlocks and GCAlloc::PresweepBlocks); everything that touches
+     * the block lists, the GC, the policy manager or the GCHeap stays with the
+     * mutator, which acts on the results once the helpers are done.
+     *
+     * Finalizers still run on the mutator, and blocks of allocators without
+     * finalizers are still swept lazily by GCAlloc::Alloc; the sweeper takes
+     * over the two eager walks over the heap: the search for blocks without
+     * live items at the end of a collection and the sweep of all remaining
+     * blocks at the start of the next one.
+     */
+    class GCParallelSweeper : public vmbase::Runnable
+    {
+    public:
+        enum Task
+        {
+            kScanBlocks,        // GCAlloc::ScanBlocks
+            kPresweepBlocks     // GCAlloc::PresweepBlocks
+        };
+
+        GCParallelSweeper(GC* gc, uint32_t threadCount);
+
+        /** Stop and join the helper threads. */
+        ~GCParallelSweeper();
+
+        /**
+         * Run 'task' on each of the 'count' allocators in 'allocs', on the
+         * helper threads and the calling thread, and return when all are done.
+         * Must be called on the mutator thread.
+         */
+        void Run(Task task, GCAlloc** allocs, uint32_t count);
+
+        /** Helper thread body. */
+        void run();
+
+    private:
+        void StartThreads();
+        void Work();
+
+        GC* const gc;
+        const uint32_t threadCount;
+        vmbase::VMThread** threads;             // Started lazily by the first Run()
+
+        vmbase::WaitNotifyMonitor monitor;      // Protects the four fields below
+        uint32_t threadsStarted;
+        uint32_t generation;                    // Bumped to start a task
+        uint32_t running;                       // Helpers that have not finished the current task
+        bool stopping;                          // Set by the destructor
+
+        Task task;
+        GCAlloc** allocs;
+        uint32_t count;
+        volatile int32_t next;                  // Index of the next allocator to claim
+    };
+}
+
+#endif /* __GCParallelSweeper__ */
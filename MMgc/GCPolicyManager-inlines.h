@@ -93,6 +93,16 @@ namespace MMgc
         bytesScannedPointerfreeLastCollection += uint32_t(nbytes);
     }
 
+    REALLY_INLINE void GCPolicyManager::signalParallelMarkWork(const GCMarkWork& work)
+    {
+        objectsScannedExactlyLastCollection += work.objectsExact;
+        bytesScannedExactlyLastCollection += work.bytesExact;
+        objectsScannedConservativelyLastCollection += work.objectsConservative;
+        bytesScannedConservativelyLastCollection += work.bytesConservative;
+        objectsScannedPointerfreeLastCollection += work.objectsPointerfree;
+        bytesScannedPointerfreeLastCollection += work.bytesPointerfree;
+    }
+
     REALLY_INLINE void GCPolicyManager::signalFreeWork(size_t nbytes)
     {
         remainingMinorAllocationBudget += int32_t(nbytes);
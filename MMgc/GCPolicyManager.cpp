@@ -29,6 +29,14 @@ namespace MMgc
         : collectionThreshold(256) // 4KB blocks, that is, 1MB
         , markstackAllowance(0)
         , exactTracing(true)
+        , markerThreads(0)
+        , sweeperThreads(0)
+        , nurserySize(0)
+#ifdef MMGC_LOCKING
+        , blockCacheSize(8)
+#else
+        , blockCacheSize(0)
+#endif
         , drc(true)
         , validateDRC(false)
         , incrementalValidation(false)
@@ -42,6 +50,7 @@ namespace MMgc
         , timeFinalRootAndStackScan(0)
         , timeFinalizeAndSweep(0)
         , timeReapZCT(0)
+        , timeMinorCollection(0)
         , timeInLastCollection(0)
         , timeEndToEndLastCollection(0)
         , timeReapZCTLastCollection(0)
@@ -50,6 +59,7 @@ namespace MMgc
         , timeMaxFinalRootAndStackScan(0)
         , timeMaxFinalizeAndSweep(0)
         , timeMaxReapZCT(0)
+        , timeMaxMinorCollection(0)
         , timeMaxStartIncrementalMarkLastCollection(0)
         , timeMaxIncrementalMarkLastCollection(0)
         , timeMaxFinalRootAndStackScanLastCollection(0)
@@ -60,6 +70,7 @@ namespace MMgc
         , countFinalRootAndStackScan(0)
         , countFinalizeAndSweep(0)
         , countReapZCT(0)
+        , countMinorCollection(0)
         // private
         , gc(gc)
         , heap(heap)
@@ -128,6 +139,9 @@ namespace MMgc
         , remainingMajorAllocationBudget(0)
         , minorAllocationBudget(0)
         , remainingMinorAllocationBudget(0)
+        , nurseryBytes(gc->incremental ? config.nurserySize * 1024 : 0)
+        , remainingPromotionBudget(0)
+        , bytesMarkedBeforeMinorCollection(0)
         , adjustR_startTime(0)
         , adjustR_totalTime(0)
     {
@@ -290,6 +304,7 @@ namespace MMgc
             remainingMinorAllocationBudget = int32_t(remainingMajorAllocationBudget);
 
         remainingMajorAllocationBudget -= remainingMinorAllocationBudget;
+        startNurseryCycles();
         if (gc->greedy)
             remainingMinorAllocationBudget = GREEDY_TRIGGER;
     }
@@ -329,6 +344,7 @@ namespace MMgc
                   (H+remainingMajorAllocationBudget) / 1024.0);
 #endif
         remainingMajorAllocationBudget -= remainingMinorAllocationBudget;
+        startNurseryCycles();
 
         if (gc->greedy)
             remainingMinorAllocationBudget = GREEDY_TRIGGER;
@@ -359,6 +375,46 @@ namespace MMgc
             remainingMinorAllocationBudget = GREEDY_TRIGGER;
     }
 
+    // Generational mode.  The allocation budget before the next incremental mark
+    // (the first minor budget of the major cycle) becomes a promotion budget:
+    // the mutator allocates in nursery-sized slices, each ended by a minor
+    // collection, and only what a minor collection traces is charged to the
+    // promotion budget.  Once it is used up the incremental mark starts as usual,
+    // with the major budget it would have had anyway.
+    //
+    // What a minor collection traces is the surviving young objects plus the
+    // roots and the objects on the remembered set, so the charge overestimates
+    // promotion somewhat; that errs on the side of starting the major collection
+    // early.
+
+    void GCPolicyManager::startNurseryCycles()
+    {
+        remainingPromotionBudget = 0;
+        if (nurseryBytes == 0 || gc->greedy)
+            return;
+        remainingPromotionBudget = remainingMinorAllocationBudget;
+        if (remainingMinorAllocationBudget > int32_t(nurseryBytes))
+            remainingMinorAllocationBudget = int32_t(nurseryBytes);
+    }
+
+    void GCPolicyManager::adjustPolicyForNextNurseryCycle()
+    {
+        remainingPromotionBudget -= double(bytesMarked() - bytesMarkedBeforeMinorCollection);
+        if (remainingPromotionBudget <= 0) {
+            // Start the incremental mark at the next allocation.
+            remainingPromotionBudget = 0;
+            remainingMinorAllocationBudget = 0;
+        }
+        else if (remainingPromotionBudget < double(nurseryBytes))
+            remainingMinorAllocationBudget = int32_t(remainingPromotionBudget);
+        else
+            remainingMinorAllocationBudget = int32_t(nurseryBytes);
+    }
+
+    bool GCPolicyManager::queryMinorCollection() {
+        return remainingPromotionBudget > 0;
+    }
+
     // Called when an incremental mark is about to start.  The premise is that if the
     // application stays within the budget then the value returned here will correspond
     // to the desired time slice.  But if the application allocates some huge block that
@@ -477,6 +533,10 @@ namespace MMgc
             case START_FinalRootAndStackScan:
                 startAdjustingR();
                 goto common_actions;
+            case START_MinorCollection:
+                bytesMarkedBeforeMinorCollection = bytesMarked();
+                startAdjustingR();
+                goto common_actions;
             case START_FinalizeAndSweep:
 #ifdef MMGC_POLICY_PROFILING
                 heapAllocatedBeforeSweep = heap->GetTotalHeapSize();
@@ -539,6 +599,12 @@ namespace MMgc
                 timeMaxReapZCT = max(timeMaxReapZCT, elapsed);
                 timeMaxReapZCTLastCollection = max(timeMaxReapZCTLastCollection, elapsed);
                 break;
+            case END_MinorCollection:
+                countMinorCollection++;
+                timeMinorCollection += elapsed;
+                timeMaxMinorCollection = max(timeMaxMinorCollection, elapsed);
+                endAdjustingR();
+                break;
             case END_IncrementalMark:
                 countIncrementalMark++;
                 timeIncrementalMark += elapsed;
@@ -559,7 +625,7 @@ namespace MMgc
                 heap->gcManager.signalEndCollection(gc);
                 break;
         }
-        if (ev != END_ReapZCT)
+        if (ev != END_ReapZCT && ev != END_MinorCollection)
             timeInLastCollection += elapsed;
 
 #ifdef MMGC_POLICY_PROFILING
@@ -593,6 +659,9 @@ namespace MMgc
             case END_IncrementalMark:
                 adjustPolicyForNextMinorCycle();
                 break;
+            case END_MinorCollection:
+                adjustPolicyForNextNurseryCycle();
+                break;
             case END_FinalizeAndSweep:
                 adjustPolicyForNextMajorCycle(true);
                 break;
@@ -762,6 +831,12 @@ namespace MMgc
         GCLog("[gcbehavior] pause-zct-reap: last-cycle=%.1f overall=%.1f\n",
               pendingClearZCTStats ? 0.0 : ticksToMillis(timeMaxReapZCTLastCollection),
               ticksToMillis(timeMaxReapZCT));
+        if (nurseryBytes != 0) {
+            GCLog("[gcbehavior] minor-gc: collections=%u time=%.1f max-pause=%.1f\n",
+                  unsigned(countMinorCollection),
+                  ticksToMillis(timeMinorCollection),
+                  ticksToMillis(timeMaxMinorCollection));
+        }
         if (afterCollection)
         {
             GCLog("[gcbehavior] time-last-gc: in-gc=%.1f end2end=%.1f mutator-efficiency=%.2f%%\n",
@@ -16,6 +16,24 @@ namespace avmplus
 
 namespace MMgc
 {
+    /**
+     * Mark work counters, in the units of GCPolicyManager::signal*MarkWork.  A
+     * helper marker thread must not update the policy manager directly, so it
+     * counts into one of these and the mutator hands it over when marking stops.
+     */
+    struct GCMarkWork
+    {
+        GCMarkWork() { Clear(); }
+        void Clear() { VMPI_memset(this, 0, sizeof(GCMarkWork)); }
+
+        uint32_t objectsExact;
+        uint32_t bytesExact;
+        uint32_t objectsConservative;
+        uint32_t bytesConservative;
+        uint32_t objectsPointerfree;
+        uint32_t bytesPointerfree;
+    };
+
     /**
      * Configuration options for GC and GCPolicyManager construction.
      */
@@ -41,6 +59,39 @@ namespace MMgc
          */
         bool exactTracing;
 
+        /* Defaults to 0.  Set it to the number of helper threads that should
+         * drain the mark stack alongside the mutator during incremental marking
+         * (see GCParallelMarker).  The GC uses no more helpers than there are
+         * processors besides the one running the mutator.
+         */
+        uint32_t markerThreads;
+
+        /* Defaults to 0.  Set it to the number of helper threads that should
+         * scan and sweep small-object blocks alongside the mutator at the end
+         * and start of a collection (see GCParallelSweeper).  Capped like
+         * markerThreads.
+         */
+        uint32_t sweeperThreads;
+
+        /* Defaults to 0.  Set it to a size in kilobytes to collect young
+         * objects separately: between incremental collections the GC then
+         * runs a stop-the-world minor collection every time this much has
+         * been allocated, and only the survivors count towards starting the
+         * next incremental collection (see GC::MinorCollect).  Ignored unless
+         * the mode is kIncrementalGC.  A minor collection still visits every
+         * block when it sweeps, so small values (below a megabyte or so)
+         * tend to cost more than they save.
+         */
+        uint32_t nurserySize;
+
+        /* Defaults to 8 if the heap is shared between threads (MMGC_LOCKING),
+         * otherwise 0.  The number of free blocks the GC keeps for its
+         * small-object allocators, so that it takes the heap lock once per
+         * batch of blocks rather than once per block (see GC::AllocBlock).
+         * At most GC::kMaxBlockCacheSize.
+         */
+        uint32_t blockCacheSize;
+
         /* Defaults to true. Set to false to disable DRC. */
         bool drc;
         
@@ -161,7 +212,9 @@ namespace MMgc
             END_FinalizeAndSweep,           // also, end of garbage collection
             END_FinalizeAndSweepNoShrink,   // also, end of garbage collection
             START_ReapZCT,
-            END_ReapZCT
+            END_ReapZCT,
+            START_MinorCollection,
+            END_MinorCollection
         };
 
            
@@ -211,6 +264,13 @@ namespace MMgc
          */
         void signalPointerfreeMarkWork(size_t nbytes);
 
+        /**
+         * Situation: signal mark work that a helper marker thread has accumulated
+         * privately (see GCParallelMarker).  The counts are added to those reported
+         * through the three methods above.
+         */
+        void signalParallelMarkWork(const GCMarkWork& work);
+
         /**
          * Situation: signal that some number of bytes have just been successfully
          * allocated and are about to be returned to the caller of the allocator.
@@ -248,6 +308,14 @@ namespace MMgc
          */
         bool queryEndOfCollectionCycle();
 
+        /**
+         * Situation: the allocation budget has been exhausted while the GC is not
+         * marking, and we need to know whether to collect the young objects or to
+         * start an incremental collection.  This predicate returns true in the
+         * former case.
+         */
+        bool queryMinorCollection();
+
 #ifdef MMGC_POLICY_PROFILING
         /**
          * Situation: signal that one write has been examined by the write barrier and made
@@ -356,6 +424,7 @@ namespace MMgc
         uint64_t timeFinalRootAndStackScan;
         uint64_t timeFinalizeAndSweep;
         uint64_t timeReapZCT;
+        uint64_t timeMinorCollection;
 
         // The total time doing collection work (sum of the variables above except the ZCT reap
         // time) and the elapsed time from the start of StartIncrementalMark to the end of
@@ -374,6 +443,7 @@ namespace MMgc
         uint64_t timeMaxFinalRootAndStackScan;
         uint64_t timeMaxFinalizeAndSweep;
         uint64_t timeMaxReapZCT;
+        uint64_t timeMaxMinorCollection;
 
         // The maximum latcency for various collection phases during the previous collection cycle
         uint64_t timeMaxStartIncrementalMarkLastCollection;
@@ -388,6 +458,7 @@ namespace MMgc
         uint64_t countFinalRootAndStackScan;
         uint64_t countFinalizeAndSweep;
         uint64_t countReapZCT;
+        uint64_t countMinorCollection;
 
     private:
         // The following parameters can vary not just from machine to machine and
@@ -447,6 +518,15 @@ namespace MMgc
         // next one)
         void adjustPolicyForNextMinorCycle();
 
+        // Called after the budget for the next major cycle has been computed: in
+        // generational mode, split the allocation before the next incremental mark
+        // into nursery-sized slices, each ended by a minor collection
+        void startNurseryCycles();
+
+        // Called from the policy event handler when a minor collection ends: charge
+        // the bytes it traced to the budget and set up the next slice
+        void adjustPolicyForNextNurseryCycle();
+
         // ----- Private data --------------------------------------
 
         GC * const gc;
@@ -597,6 +677,17 @@ namespace MMgc
         // budget.
         int32_t remainingMinorAllocationBudget;
 
+        // The size of a nursery slice in bytes, or 0 if generational collection is off.
+        const uint32_t nurseryBytes;
+
+        // In generational mode, the part of the allocation budget before the next
+        // incremental mark that has not yet been used up by bytes surviving minor
+        // collections.  Zero when minor collections are not to be run.
+        double remainingPromotionBudget;
+
+        // Value of bytesMarked() when the current minor collection started
+        uint64_t bytesMarkedBeforeMinorCollection;
+
         // Temporaries used to compute R
         uint64_t adjustR_startTime;
         uint64_t adjustR_totalTime;
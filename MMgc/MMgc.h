@@ -257,6 +257,8 @@ namespace MMgc
 #include "GC.h"
 #include "GCObject.h"
 #include "GCWeakRef.h"
+#include "GCParallelMarker.h"
+#include "GCParallelSweeper.h"
 
 #include "Shared-inlines.h"
 #include "GCHashtable-inlines.h"
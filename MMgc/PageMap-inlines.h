@@ -286,6 +286,17 @@ namespace MMgc
                 return kNonGC;
         }
 
+        REALLY_INLINE PageType CacheT4::AddrToValConcurrent(uintptr_t addr) const
+        {
+            MMGC_STATIC_ASSERT(kNonGC == 0);
+            if (CacheHit(addr))
+                return Tiered4::LeafAddrToVal(cached_leaf_bytes, addr);
+            uint8_t* leaf = Tiered4::AddrToLeafBytes(addr);
+            if (leaf == NULL)
+                return kNonGC;
+            return Tiered4::LeafAddrToVal(leaf, addr);
+        }
+
         REALLY_INLINE void CacheT4::AddrSet(uintptr_t addr, PageType val)
         {
             bool statusFlag = UpdateCache(addr);
@@ -366,6 +366,9 @@ namespace MMgc
             using Tiered4::DestroyPageMapVia;
 
             PageType AddrToVal(uintptr_t addr) const;
+            // Like AddrToVal but leaves the cache alone, so several threads
+            // may look up addresses at once (as long as none updates the map).
+            PageType AddrToValConcurrent(uintptr_t addr) const;
             void ExpandSetAll(GCHeap *h, void *item, uint32_t np, PageType val);
             void ClearAddrs(void *item, uint32_t numpages);
         protected:
@@ -420,6 +423,7 @@ namespace MMgc
             using CacheT4::MemEnd;
             using CacheT4::AddrIsMappable;
             using CacheT4::AddrToVal;
+            using CacheT4::AddrToValConcurrent;
             using CacheT4::ClearAddrs;
 
             void DestroyPageMapVia(GCHeap *heap);
@@ -32,6 +32,8 @@ MMgc_CXXSRCS := $(MMgc_CXXSRCS) \
   $(curdir)/GCLog.cpp \
   $(curdir)/GCMemoryProfiler.cpp \
   $(curdir)/GCObject.cpp \
+  $(curdir)/GCParallelMarker.cpp \
+  $(curdir)/GCParallelSweeper.cpp \
   $(curdir)/GCPolicyManager.cpp \
   $(curdir)/GCStack.cpp \
   $(curdir)/GCTests.cpp \
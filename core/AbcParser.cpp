@@ -946,6 +946,88 @@ namespace avmplus
         }
     }
 
+    /**
+     * Skip the traits entries of an activation, returning false (with pos
+     * somewhere inside the entries) if any of them is not a plain slot or
+     * const without metadata.  Names and types are not resolved here;
+     * that happens in parseTraits when the activation is built.
+     */
+    bool AbcParser::skipSlotTraits(uint32_t nameCount)
+    {
+        // Very generous check for nameCount being way too large.
+        if (nameCount > (uint32_t)(abcEnd - pos))
+            toplevel->throwVerifyError(kCorruptABCError);
+
+        for (uint32_t i=0; i < nameCount; i++)
+        {
+            readU30(pos);                   // name
+            CHECK_POS(pos);
+            int tag = *pos++;
+            TraitKind kind = (TraitKind) (tag & 0x0f);
+            if ((kind != TRAIT_Slot && kind != TRAIT_Const) || (tag & ATTR_metadata))
+                return false;
+            readU30(pos);                   // slot id
+            readU30(pos);                   // type name
+            if (readU30(pos))               // value index
+            {
+                CHECK_POS(pos);
+                pos += 1;                   // value_kind
+            }
+        }
+        return true;
+    }
+
+    void AbcParser::parseActivationTraits(MethodInfo* info, const uint8_t* traits_pos)
+    {
+        Namespacep ns = NULL;
+        Stringp name = NULL;
+        #ifdef AVMPLUS_VERBOSE
+        if (core->config.methodNames)
+        {
+            ns = core->getPublicNamespace(pool);
+            name = core->internString(info->getMethodNameWithTraits(info->declaringTraits()));
+        }
+        #endif
+        // activation traits are raw types, not subclasses of object.  this is
+        // okay because they aren't accessable to the programming model.
+        Traits* act = parseTraits(sizeof(ScriptObject),
+                                  sizeof(ScriptObject),
+                                  NULL,
+                                  ns,
+                                  name,
+                                  NULL,
+                                  traits_pos,
+                                  TRAITSTYPE_ACTIVATION,
+                                  NULL);
+        info->init_activationTraits(act);
+    }
+
+    /**
+     * Find the traits of a method body, which follow the code and the
+     * exception table.  The body was range-checked by parseMethodBodies.
+     */
+    const uint8_t* AbcParser::activationTraitsPos(const uint8_t* body_pos) const
+    {
+        const uint8_t* p = body_pos;
+        AvmCore::skipU32(p, 4);
+        const uint32_t code_length = AvmCore::readU32(p);
+        p += code_length;
+        const uint32_t exception_count = AvmCore::readU32(p);
+        const int exception_fields = (version != (46<<16|15)) ? 5 : 4;
+        for (uint32_t i=0; i < exception_count; i++)
+            AvmCore::skipU32(p, exception_fields);
+        return p;
+    }
+
+    /*static*/ void AbcParser::parseLazyActivationTraits(const Toplevel* toplevel, MethodInfo* info)
+    {
+        PoolObject* pool = info->pool();
+        AbcParser parser(pool->core, pool->code(), const_cast<Toplevel*>(toplevel), pool->domain, NULL);
+        parser.pool = pool;
+        parser.pos = parser.activationTraitsPos(info->abc_body_pos());
+        parser.parseActivationTraits(info, parser.pos);
+    }
+
     void AbcParser::parseMethodBodies()
     {
         int bodyCount = readU30(pos);
@@ -1110,31 +1192,35 @@ namespace avmplus
                 // memory by omitting the count + traits completely.
 
                 const uint8_t* traits_pos = pos;
-                int nameCount = readU30(pos);
+                uint32_t nameCount = readU30(pos);
                 if (info->needActivation() || nameCount > 0)
                 {
-                    pos = traits_pos;
-                    Namespacep ns = NULL;
-                    Stringp name = NULL;
+                    // Activations that only declare slots are by far the common
+                    // case; skip over them here and build the Traits when the
+                    // method is resolved.  Traits::resolveSignatures resolves
+                    // every method of a class or script as it is initialized,
+                    // so this only saves work for closures and for methods of
+                    // classes and scripts that are never initialized.
+                    // Anything else (nested methods, metadata) is parsed now,
+                    // as is everything when the parse is being traced and in
+                    // AOT builds.
+                    bool lazy = true;
                     #ifdef AVMPLUS_VERBOSE
-                    if (core->config.methodNames)
+                    if (pool->isVerbose(VB_parse))
+                        lazy = false;
+                    #endif
+                    #ifdef VMCFG_AOT
+                    lazy = false;
+                    #endif
+                    if (lazy && skipSlotTraits(nameCount))
                     {
-                        ns = core->getPublicNamespace(pool);
-                        name = core->internString(info->getMethodNameWithTraits(declaringTraits));
+                        info->setLazyActivationTraits();
+                    }
+                    else
+                    {
+                        pos = traits_pos;
+                        parseActivationTraits(info, traits_pos);
                     }
-                    #endif
-                    // activation traits are raw types, not subclasses of object.  this is
-                    // okay because they aren't accessable to the programming model.
-                    Traits* act = parseTraits(sizeof(ScriptObject),
-                                                                sizeof(ScriptObject),
-                                                                NULL,
-                                                                ns,
-                                                                name,
-                                                                NULL,
-                                                                traits_pos,
-                                                                TRAITSTYPE_ACTIVATION,
-                                                                NULL);
-                    info->init_activationTraits(act);
                 }
                 else
                 {
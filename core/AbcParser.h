@@ -72,6 +72,12 @@ namespace avmplus
         static void addAOTDebugInfo(PoolObject *pool);
 #endif
 
+        /**
+         * Build the activation traits of a method whose traits were skipped
+         * by parseMethodBodies.  Called when the method is first resolved.
+         */
+        static void parseLazyActivationTraits(const Toplevel* toplevel, MethodInfo* info);
+
     protected:
         PoolObject* parse(ApiVersion apiVersion);
         MethodInfo* resolveMethodInfo(uint32_t index) const;
@@ -90,6 +96,9 @@ namespace avmplus
         void parseClassInfos();
         bool parseScriptInfos();
         void parseMethodBodies();
+        bool skipSlotTraits(uint32_t nameCount);
+        void parseActivationTraits(MethodInfo* info, const uint8_t* traits_pos);
+        const uint8_t* activationTraitsPos(const uint8_t* body_pos) const;
         void parseCpool(ApiVersion apiVersion);
         void parseExecPolicyAttributes(const uint8_t* metadata, MethodInfo* m);
         Traits* parseTraits(uint16_t sizeofInstance,
@@ -561,8 +561,23 @@ REALLY_INLINE /*static*/ bool AvmCore::getIndexFromAtom(Atom a, uint32_t *result
 
 REALLY_INLINE Atom AvmCore::allocDouble(double n)
 {
-    double *d = (double*)GetGC()->AllocDouble();
+    union {
+        double d;
+        uint64_t bits;
+    } u, cached;
+    u.d = n;
+    // Compare bits rather than values so -0 and NaN payloads keep their own boxes.
+    uint32_t h = (uint32_t(u.bits ^ (u.bits >> 32)) * 0x9E3779B1U) >> (32 - kDoubleCacheBits);
+    double *d = m_doubleCache[h];
+    if (d != NULL)
+    {
+        cached.d = *d;
+        if (cached.bits == u.bits)
+            return kDoubleType | (uintptr_t)d;
+    }
+    d = (double*)GetGC()->AllocDouble();
     *d = n;
+    m_doubleCache[h] = d;
     return kDoubleType | (uintptr_t)d;
 }
 
@@ -583,6 +598,24 @@ REALLY_INLINE Atom AvmCore::allocFloat4(const float4_t& n)
 }
 #endif // VMCFG_FLOAT
 
+REALLY_INLINE DynamicShape* AvmCore::emptyShape()
+{
+    if (m_emptyShape == NULL)
+        m_emptyShape = DynamicShape::createEmpty(gc, nextShapeId());
+    return m_emptyShape;
+}
+
+REALLY_INLINE uint32_t AvmCore::nextShapeId()
+{
+    // Ids start at 1 so that a zeroed cache never matches, and are never
+    // reused, since a cache may still hold the id of a dead shape.  Once
+    // they run out this returns 0 and objects that would need a new shape
+    // keep their properties in a hashtable instead.
+    if (m_nextShapeId == 0xFFFFFFFFU)
+        return 0;
+    return ++m_nextShapeId;
+}
+
 #ifdef VMCFG_NANOJIT
 REALLY_INLINE void AvmCore::flushBindingCachesNextSweep()
 {
@@ -59,11 +59,14 @@ namespace avmplus
     // Regex compilation cache.
 
     RegexCache::RegexCache()
-        : m_timestamp(0)
+        : m_size(AvmCore::CacheSizes::DEFAULT_REGEX)
+        , m_timestamp(0)
+        , m_sweepTimestamp(0)
         , m_wasted(0)
         , m_useful(0)
         , m_disabled(false)
     {
+        VMPI_memset(&m_stats, 0, sizeof(m_stats));
     }
 
     RegexCacheEntry& RegexCache::findCachedRegex(bool& found, String* source, String* options)
@@ -75,11 +78,12 @@ namespace avmplus
 
         size_t smallest = 0;
 
-        for ( size_t i=0 ; i < ARRAY_SIZE(m_entries) ; i++ ) {
+        for ( size_t i=0 ; i < m_size ; i++ ) {
             RegexCacheEntry& it = m_entries[i];
             if (it.match(source, options)) {
                 it.timestamp = ++m_timestamp;
                 it.hits++;
+                m_stats.hits++;
                 found = true;
                 return it;
             }
@@ -90,6 +94,9 @@ namespace avmplus
         // A miss.  Evict an entry and account for its utility.
 
         RegexCacheEntry& it = m_entries[smallest];
+        m_stats.misses++;
+        if (it.regex != NULL)
+            m_stats.evictions++;
 
         // If a cache entry was used just once then it was wasted work;
         // if wasted work dominates then disable the cache.
@@ -98,7 +105,7 @@ namespace avmplus
             m_wasted++;
         else if (it.hits > 1)
             m_useful+=it.hits-1;
-        if (m_timestamp > warmupTicks && m_wasted > m_useful*wastedWorkMultiplier) {
+        if (m_timestamp - m_sweepTimestamp > warmupTicks && m_wasted > m_useful*wastedWorkMultiplier) {
             //printf("DISABLED!\n");
             m_disabled = true;
         }
@@ -117,18 +124,43 @@ namespace avmplus
         if (m_disabled)
             return false;
 
-        for ( size_t i=0 ; i < ARRAY_SIZE(m_entries) ; i++ )
+        for ( size_t i=0 ; i < m_size ; i++ )
             if (m_entries[i].match(source, options))
                 return true;
 
         return false;
     }
 
+    void RegexCache::resize(uint32_t size)
+    {
+        if (size == 0 || size > maxCacheSize)
+            size = maxCacheSize;
+        for ( size_t i=size ; i < m_size ; i++ )
+            m_entries[i].clear();
+        m_size = size;
+    }
+
     void RegexCache::clear()
     {
         for ( size_t i=0 ; i < ARRAY_SIZE(m_entries) ; i++ )
             m_entries[i].clear();
         m_timestamp = 0;
+        m_sweepTimestamp = 0;
+        m_wasted = 0;
+        m_useful = 0;
+        m_disabled = false;
+    }
+
+    void RegexCache::sweep()
+    {
+        for ( size_t i=0 ; i < m_size ; i++ ) {
+            RegexCacheEntry& it = m_entries[i];
+            if (it.timestamp <= m_sweepTimestamp)
+                it.clear();
+            else
+                it.hits = 1;    // so that surviving is not counted as a use
+        }
+        m_sweepTimestamp = m_timestamp;
         m_wasted = 0;
         m_useful = 0;
         m_disabled = false;
@@ -156,6 +188,7 @@ namespace avmplus
         m_tbCache->resize(cs.bindings);
         m_tmCache->resize(cs.metadata);
         m_msCache->resize(cs.methods);
+        m_regexCache.resize(cs.regex);
     }
 
     void AvmCore::handleAbcUnloaded()
@@ -174,6 +207,12 @@ namespace avmplus
     const Runmode AvmCore::runmode_default = RM_mixed;
     const bool AvmCore::osr_enabled_default = OSR_ENABLED_DEFAULT;
     const uint32_t AvmCore::osr_threshold_default = OSR_THRESHOLD_DEFAULT;
+    const uint32_t AvmCore::jit_threads_default = 0; // compile synchronously
+    const uint32_t AvmCore::regex_jit_threshold_default = 16;
+#ifdef VMCFG_HALFMOON
+    const uint32_t AvmCore::tierup_threshold_default = 0; // no tiering
+    const uint32_t AvmCore::tierprofile_threshold_default = 10;
+#endif
     const uint32_t AvmCore::jitprof_level_default = 0; // no logging.
     const bool AvmCore::interrupts_default = false;
     const bool AvmCore::jitordie_default = false;
@@ -397,6 +436,13 @@ namespace avmplus
         config.runmode = runmode_default;
         config.osr_enabled = osr_enabled_default;
         config.osr_threshold = osr_threshold_default;
+        config.jit_threads = jit_threads_default;
+        config.regex_jit_threshold = regex_jit_threshold_default;
+#ifdef VMCFG_HALFMOON
+        config.tierup_threshold = tierup_threshold_default;
+        config.tierprofile_threshold = tierprofile_threshold_default;
+#endif
+        config.jitProfile = NULL;
         config.jitprof_level = jitprof_level_default;
         config.jitordie = jitordie_default;
 
@@ -437,10 +483,14 @@ namespace avmplus
         nsCount         = 0;
 
         currentMethodInfoCount = 0;
+        m_nextShapeId = 0;
+        m_unshapedNext = 0;
         numStrings = 1024; // power of 2
         numNamespaces = 1024;  // power of 2
         strings = mmfx_new_array(GCRoot::GCMember<String>, numStrings);
         namespaces = mmfx_new_array(GCRoot::GCMember<Namespace>, numNamespaces);
+        m_doubleCache = mmfx_new_array(double*, 1 << kDoubleCacheBits);
+        VMPI_memset(m_doubleCache, 0, sizeof(double*) << kDoubleCacheBits);
         console.setCore(this);
 
         kconstructor = internConstantStringLatin1("constructor");
@@ -619,6 +669,9 @@ namespace avmplus
         namespaces = NULL;
         numNamespaces = 0;
 
+        mmfx_delete_array(m_doubleCache);
+        m_doubleCache = NULL;
+
 #ifdef DEBUGGER
         delete _profiler;
         _profiler = NULL;
@@ -3687,6 +3740,26 @@ return the result of the comparison ToPrimitive(x) == y.
         livePools = node;
     }
 
+    void AvmCore::rememberUnshaped(ScriptObject* obj, DynamicShape* shape)
+    {
+        // GetWeakRef can trigger a collection, so take it before touching the records
+        MMgc::GCWeakRef* ref = obj->GetWeakRef();
+        uint32_t i = m_unshapedNext;
+        m_unshapedNext = (i + 1) % kUnshapedRecords;
+        m_unshapedObjects[i] = ref;
+        m_unshapedShapes[i] = shape;
+    }
+
+    DynamicShape* AvmCore::unshapedShape(const ScriptObject* obj) const
+    {
+        for (uint32_t i = 0; i < kUnshapedRecords; i++)
+        {
+            if (m_unshapedObjects[i] != NULL && m_unshapedObjects[i]->get() == (const void*)obj)
+                return m_unshapedShapes[i];
+        }
+        return NULL;
+    }
+
     void AvmCore::presweep()
     {
         LivePoolNode** prev = &livePools;
@@ -3749,10 +3822,20 @@ return the result of the comparison ToPrimitive(x) == y.
                 rehashNamespacesIfPossible(numNamespaces);
         }
 
-        // Clear out the regex compile cache, just to prevent big strings or regexes from
-        // hanging around.
+        // and for the boxed double cache, which must not hand out a dead box
+        if (m_doubleCache)
+        {
+            for (uint32_t i=0, n=1 << kDoubleCacheBits; i < n; i++)
+            {
+                if (m_doubleCache[i] != NULL && !GetGC()->GetMark(m_doubleCache[i]))
+                    m_doubleCache[i] = NULL;
+            }
+        }
+
+        // Clear out the stale part of the regex compile cache, just to prevent big strings
+        // or regexes from hanging around.
 
-        m_regexCache.clear();
+        m_regexCache.sweep();
 
 #ifdef DEBUGGER
         if (_sampler)
@@ -3760,6 +3843,35 @@ return the result of the comparison ToPrimitive(x) == y.
 #endif
     }
 
+#ifdef VMCFG_NANOJIT
+    void AvmCore::dumpBindingCacheStats()
+    {
+        for (LivePoolNode* node = livePools; node != NULL; node = node->next)
+        {
+            PoolObject* pool = (PoolObject*)(void*)(node->pool->get());
+            if (pool && pool->codeMgr)
+                pool->codeMgr->dumpBindingCacheStats(this);
+        }
+    }
+#endif
+
+    void AvmCore::dumpRegexStats()
+    {
+        const RegexCache::Stats& s = m_regexCache.stats();
+        console << "regex cache: " << s.hits << " hits, " << s.misses << " misses, "
+                << s.evictions << " evictions\n";
+        console << "regex exec: " << s.pcreExecs << " pcre, " << s.nativeExecs << " native, "
+                << s.nativeBails << " native bailouts\n";
+        console << "regex jit: " << s.compiled << " compiled, " << s.rejected << " rejected\n";
+    }
+
+#ifdef VMCFG_HALFMOON
+    void AvmCore::dumpTierStats()
+    {
+        ((BaseExecMgr*)exec)->dumpTierStats();
+    }
+#endif
+
     void AvmCore::postsweep()
     {
 #ifdef VMCFG_NANOJIT
@@ -3797,11 +3909,12 @@ return the result of the comparison ToPrimitive(x) == y.
 
     int AvmCore::findString(Stringp s)
     {
-        int m = numStringsCheckLoadBalance();
-
-        // compute the hash function
+        // compute the hash function; do this first, as hashing a rope flattens
+        // it, which allocates
         int hashCode = s->hashCode();
 
+        int m = numStringsCheckLoadBalance();
+
         int bitMask = m - 1;
 
         // find the slot to use
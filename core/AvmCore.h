@@ -133,6 +133,49 @@ const int kBufferPadding = 16;
          */
          bool osr_enabled;
 
+        /**
+         * Number of background threads that assemble JIT-compiled methods.
+         * Verification and LIR generation always happen on the calling thread;
+         * with jit_threads > 0 the method keeps running in the interpreter
+         * while native code is generated, and switches over once it is ready.
+         * Zero (the default) compiles synchronously.  See JitPool.
+         */
+        uint32_t jit_threads;
+
+        /**
+         * Number of executions after which a regular expression is compiled
+         * to native code (see RegExpCode); patterns the compiler can't
+         * handle keep running in pcre_exec.  Zero disables the regex JIT,
+         * as does RM_interp_all.
+         */
+        uint32_t regex_jit_threshold;
+
+#ifdef VMCFG_HALFMOON
+        /**
+         * Tiered compilation.  When tierup_threshold is nonzero, a method
+         * compiled by the baseline JIT (CodegenLIR) counts its calls, and
+         * after tierup_threshold of them it is recompiled by the optimizing
+         * JIT (halfmoon).  If the optimized code deoptimizes or halfmoon gives
+         * up, the method returns to baseline code for good.  Zero (the
+         * default) disables tiering.  Tiering only applies to RM_mixed.
+         *
+         * Halfmoon does not speculate on profiles yet, so a profiling tier
+         * in between, run for tierprofile_threshold calls, is only added
+         * when halfmoon's profiler is on (PROFILER=1, for development).
+         */
+        uint32_t tierup_threshold;
+        uint32_t tierprofile_threshold;
+#endif
+
+        /**
+         * Outcomes of JIT compilation carried over from earlier runs, used to
+         * pick the interpreter or the JIT on a method's first call, and
+         * updated as methods are compiled.  Owned by the host, which may
+         * share one profile among all its cores.  NULL (the default)
+         * disables it.  See JitProfile.
+         */
+        JitProfile* jitProfile;
+
         uint32_t jitprof_level;
         const char* compilePolicyRules; // JIT compilation override
 
@@ -245,6 +288,10 @@ const int kBufferPadding = 16;
     // significantly outweigh the uses of the entries that are used more than once,
     // that mechanism cuts the overhead of cache maintenance for programs that don't
     // benefit from the cache.
+    //
+    // Entries used since the previous GC survive the next one, so that a regex in a
+    // hot loop keeps its CompiledRegExp, and with it any native code the regex JIT
+    // made for it.
 
     class RegexCache
     {
@@ -270,6 +317,26 @@ const int kBufferPadding = 16;
          */
         bool disabled() { return m_disabled; }
 
+        /**
+         * Use the first 'size' entries, or all of them if 'size' is 0 or too large.
+         */
+        void resize(uint32_t size);
+
+        // Counters for -Dregexstats.
+        struct Stats
+        {
+            uint64_t hits;          // findCachedRegex found the regex
+            uint64_t misses;        // ... didn't
+            uint64_t evictions;     // ... and dropped another one to make room
+            uint64_t pcreExecs;     // matches run by pcre_exec
+            uint64_t nativeExecs;   // matches run by the regex JIT's code
+            uint64_t nativeBails;   // ... that were handed over to pcre_exec
+            uint32_t compiled;      // regexes compiled to native code
+            uint32_t rejected;      // regexes the regex JIT could not compile
+        };
+
+        Stats& stats() { return m_stats; }
+
     private:
         RegexCache();
 
@@ -278,21 +345,30 @@ const int kBufferPadding = 16;
          */
         void clear();
 
+        /**
+         * Called before every GC: drop the entries not used since the previous one,
+         * reenable the cache if it was disabled, reset utilization data.
+         */
+        void sweep();
+
     private:
         // These parameters are not subject to a lot of experimental validation, in
         // particular, the parameters for cache enabling/disabling are really just
         // gut feelings.  More experimental validation would be good but we don't
         // have a lot of content that uses regular expressions.
 
-        static const size_t cacheSize = 4;                  // Gut feeling: 4 is about right
+        static const size_t maxCacheSize = 64;              // Entries are roots, so they live in AvmCore
         static const uint64_t wastedWorkMultiplier = 10;    // Gut feeling: utilization should be above 10%
         static const uint64_t warmupTicks = 1000;           // Number of ticks before we start worrying about hit rate
 
-        RegexCacheEntry m_entries[cacheSize];   // Cache storage
+        RegexCacheEntry m_entries[maxCacheSize];    // Cache storage
+        size_t          m_size;                 // Entries in use, see resize()
         uint64_t        m_timestamp;            // Timestamp value for LRU
+        uint64_t        m_sweepTimestamp;       // m_timestamp at the last sweep()
         uint64_t        m_wasted;               // Utility of wasted cache entries (sum of usage counts == 1)
         uint64_t        m_useful;               // Utility of useful cache entries (sum of usage counts > 1)
         bool            m_disabled;             // true iff the cache has been (temporarily) disabled
+        Stats           m_stats;
     };
 
     /**
@@ -500,13 +576,14 @@ const int kBufferPadding = 16;
 
         struct CacheSizes
         {
-            enum { DEFAULT_BINDINGS = 32, DEFAULT_METADATA = 1, DEFAULT_METHODS = 32 };
+            enum { DEFAULT_BINDINGS = 32, DEFAULT_METADATA = 1, DEFAULT_METHODS = 32, DEFAULT_REGEX = 16 };
 
             uint16_t bindings;
             uint16_t metadata;
             uint16_t methods;
+            uint16_t regex;         // compiled regular expressions, see RegexCache
 
-            inline CacheSizes() : bindings(DEFAULT_BINDINGS), metadata(DEFAULT_METADATA), methods(DEFAULT_METHODS) {}
+            inline CacheSizes() : bindings(DEFAULT_BINDINGS), metadata(DEFAULT_METADATA), methods(DEFAULT_METHODS), regex(DEFAULT_REGEX) {}
         };
 
         bool enterEventLoop;
@@ -658,6 +735,12 @@ const int kBufferPadding = 16;
         // a running count of MethodInfos used to generate unique id's for the PoolObjects
         uint32_t currentMethodInfoCount;
 
+        // source of DynamicShape ids; never reused, 0 is never valid
+        uint32_t m_nextShapeId;
+
+        // next entry of m_unshapedObjects to reuse
+        uint32_t m_unshapedNext;
+
         // API versioning state
         ApiVersionSeries const  m_activeApiVersionSeries;
         uint32_t const          m_activeApiVersionSeriesMask;
@@ -690,6 +773,12 @@ const int kBufferPadding = 16;
         static const Runmode runmode_default;
         static const bool osr_enabled_default;
         static const uint32_t osr_threshold_default;
+        static const uint32_t jit_threads_default;
+        static const uint32_t regex_jit_threshold_default;
+#ifdef VMCFG_HALFMOON
+        static const uint32_t tierup_threshold_default;
+        static const uint32_t tierprofile_threshold_default;
+#endif
         static const uint32_t jitprof_level_default;
         static const bool interrupts_default;
         static const bool jitordie_default;
@@ -771,6 +860,13 @@ const int kBufferPadding = 16;
         // hash set containing namespaces
         GCMember<Namespace> * namespaces;
 
+        // Direct-mapped cache of recently boxed doubles, indexed by a hash of the
+        // value's bits.  GCDoubles are immutable so allocDouble() can hand out a
+        // cached box in place of a fresh one.  The table lives outside the GC heap
+        // and holds its entries weakly; presweep() clears the ones about to die.
+        static const uint32_t kDoubleCacheBits = 8;
+        double** m_doubleCache;
+
         // API versioning state
         HeapHashtable*          m_versionedURIs;
 #ifdef _DEBUG
@@ -779,6 +875,14 @@ const int kBufferPadding = 16;
 
         GCMember<UnscannedTraitsArray> _emptySupertypeList; // empty supertype list shared by many Traits
 
+        GCMember<DynamicShape> m_emptyShape; // root of the dynamic property shape tree, created lazily
+
+        // the last few objects that left their shape while a for-in loop over
+        // them was running, and the shapes they left; see rememberUnshaped()
+        static const uint32_t kUnshapedRecords = 4;
+        GCMember<MMgc::GCWeakRef> m_unshapedObjects[kUnshapedRecords];
+        GCMember<DynamicShape> m_unshapedShapes[kUnshapedRecords];
+
         FixedHeapRef<Isolate> m_isolate;
 
         // END traced private fields
@@ -2154,9 +2258,35 @@ const int kBufferPadding = 16;
         // fills the area with nullObjectAtom
         static void decrementAtomRegion_null(Atom *ar, int length);
 
+    public:
+        /** The shape of an object with no dynamic properties; see DynamicShape. */
+        DynamicShape* emptyShape();
+
+        /** A DynamicShape id that has never been handed out before, or 0 if none is left. */
+        uint32_t nextShapeId();
+
+        /**
+         * Remember that obj left shape while a for-in loop over it may still
+         * be running, so that the loop can finish in the shape's order; see
+         * DynamicSlots::nextUnshaped().  Only the last few are remembered.
+         */
+        void rememberUnshaped(ScriptObject* obj, DynamicShape* shape);
+
+        /** The shape obj left, if rememberUnshaped() still remembers it; else NULL. */
+        DynamicShape* unshapedShape(const ScriptObject* obj) const;
+
 #ifdef VMCFG_NANOJIT
     public:
         void flushBindingCachesNextSweep();
+
+        /** Print the hit/miss counters of every live binding cache to the console. */
+        void dumpBindingCacheStats();
+#endif
+        /** Print the regex cache and regex JIT counters to the console. */
+        void dumpRegexStats();
+#ifdef VMCFG_HALFMOON
+        /** Print the tiered compilation counters to the console. */
+        void dumpTierStats();
 #endif
 
 #ifdef VMCFG_TELEMETRY
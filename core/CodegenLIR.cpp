@@ -648,11 +648,15 @@ namespace avmplus
         prolog(NULL),
         skip_ins(NULL),
         specializedCallHashMap(NULL),
+        vectorLengths(NULL),
         builtinFunctionOptimizerHashMap(NULL),
         blockLabels(NULL),
         cseFilter(NULL),
         noise(),
-        jit_debug_info(NULL)
+        jit_debug_info(NULL),
+        md_codeList(NULL),
+        md_error(None)
+        verbose_only(, md_raw(false))
         DEBUGGER_ONLY(, haveDebugger(core->debugger() != NULL) )
     {
         #ifdef AVMPLUS_MAC_CARBON
@@ -1810,8 +1814,10 @@ FLOAT_ONLY(           !(v.sst_mask == (1 << SST_float)  && v.traits == FLOAT_TYP
         // OP_restarg instruction.  Those instructions will access an unconsed
         // rest array or arguments array when possible, and otherwise access a
         // constructed rest array.  (For example, if prop turns out to be "slice"
-        // we must construct the array.  This will almost never happen.) They're
-        // implemented via helper functions restargcHelper and restargHelper.
+        // we must construct the array.  This will almost never happen.)  While
+        // the array is unconsed, the length and int indices below it are read
+        // inline; everything else goes through the helper functions
+        // restargcHelper and restargHelper.
         //
         // The unconsed rest or arguments array, the argument count, the consed array,
         // and the flag that determines whether to use the unconsed or the consed array,
@@ -1910,6 +1916,11 @@ FLOAT_ONLY(           !(v.sst_mask == (1 << SST_float)  && v.traits == FLOAT_TYP
 
         varTracker->initNotNull(state);
 
+#ifdef VMCFG_HALFMOON
+        if (info->_jitTier == BaseExecMgr::kTierBaseline)
+            emitTierUpCountdown();
+#endif
+
         if (osr)
             emitOsrBranch();
 
@@ -1969,6 +1980,28 @@ FLOAT_ONLY(           !(v.sst_mask == (1 << SST_float)  && v.traits == FLOAT_TYP
         resumeCSE();
     }
 
+#ifdef VMCFG_HALFMOON
+    FUNCTION(FUNCADDR(BaseExecMgr::tierUp), SIG1(V, P), tierUp)
+
+    // Emit code to count calls to baseline code under tiered compilation:
+    //     if (--info->_abc.countdown == 0)
+    //         BaseExecMgr::tierUp(env);
+    // The count is in the MethodInfo, so calls through every MethodEnv of
+    // the method add up.
+    void CodegenLIR::emitTierUpCountdown()
+    {
+        LIns* countdown = InsConstPtr(&info->_abc.countdown);
+        LIns* count = addi(ldi(countdown, 0, ACCSET_OTHER), -1);
+        sti(count, countdown, 0, ACCSET_OTHER);
+        CodegenLabel &no_tierup_label = createLabel("no_tierup");
+        suspendCSE();
+        branchToLabel(LIR_jf, eqi0(count), no_tierup_label);
+        callIns(FUNCTIONID(tierUp), 1, env_param);
+        emitLabel(no_tierup_label);
+        resumeCSE();
+    }
+#endif
+
     void CodegenLIR::emitInitializers()
     {
         struct JitInitVisitor: public InitVisitor {
@@ -3085,11 +3118,30 @@ FLOAT_ONLY(           !(v.sst_mask == (1 << SST_float)  && v.traits == FLOAT_TYP
         {
             // See documentation in writePrologue regarding rest arguments
             AvmAssert(info->needRestOrArguments() && info->lazyRest());
+            // Until the array has been consed, its length is restArgc:
+            //   if (restLocal == NULL)
+            //     restArgc
+            //   else
+            //     call restargcHelper
+            CodegenLabel consed("consed");
+            CodegenLabel done("done");
+            LIns* result = insAlloc(sizeof(int32_t));
+            LIns* restArray = localGetp(restLocal);
+            suspendCSE();
+            branchToLabel(LIR_jf, eqp0(restArray), consed);
+            sti(restArgc, result, 0, ACCSET_STORE_ANY);
+            branchToLabel(LIR_j, NULL, done);
+
+            emitLabel(consed);
             LIns* out = callIns(FUNCTIONID(restargcHelper),
                                 2,
-                                localGetp(restLocal),
+                                restArray,
                                 restArgc);
-            localSet(sp, out, UINT_TYPE);
+            sti(out, result, 0, ACCSET_STORE_ANY);
+
+            emitLabel(done);
+            localSet(sp, ldi(result, 0, ACCSET_LOAD_ANY), UINT_TYPE);
+            resumeCSE();
             break;
         }
 
@@ -3285,19 +3337,54 @@ FLOAT_ONLY(           !(v.sst_mask == (1 << SST_float)  && v.traits == FLOAT_TYP
             // See documentation in writePrologue regarding rest arguments
             AvmAssert(info->needRestOrArguments() && info->lazyRest());
             const Multiname *multiname = pool->precomputedMultiname(opd1);
+            int32_t sp = state->sp();
+            Traits* nameType = state->value(sp).traits;
+            LIns* restArea = info->needRest() ?
+                binaryIns(LIR_addp, ap_param, InsConstPtr((void*)(ms->rest_offset()))) :
+                binaryIns(LIR_addp, ap_param, InsConstPtr((void*)sizeof(Atom)));
+            // Until the array has been consed, an index that is an int below
+            // restArgc reads the argument directly:
+            //   if (restLocal == NULL && uint(index) < restArgc)
+            //     restArea[index]
+            //   else
+            //     call restargHelper
+            CodegenLabel slow_path("slow");
+            CodegenLabel done_path("done");
+            LIns* result = insAlloc(sizeof(Atom));
+            LIns* restArray = localGetp(restLocal);
+            suspendCSE();
+            branchToLabel(LIR_jf, eqp0(restArray), slow_path);
+            LIns* index;
+            if (nameType == INT_TYPE || nameType == UINT_TYPE) {
+                // A negative int zero-extends to more than any argument count.
+                index = ui2p(localGet(sp));
+            } else {
+                AvmAssert(nameType == NULL);
+                LIns* atom = loadAtomRep(sp);
+                branchToLabel(LIR_jf, eqp(andp(atom, AtomConstants::kAtomTypeMask), AtomConstants::kIntptrType), slow_path);
+                index = rshup(atom, AtomConstants::kAtomTypeSize);
+            }
+            branchToLabel(LIR_jf, ltup(index, ui2p(restArgc)), slow_path);
+            LIns* arg = ldp(binaryIns(LIR_addp, restArea, lshp(index, sizeof(Atom) == 8 ? 3 : 2)), 0, ACCSET_OTHER);
+            stp(arg, result, 0, ACCSET_STORE_ANY);
+            branchToLabel(LIR_j, NULL, done_path);
+
+            emitLabel(slow_path);
             // The by-reference parameter &restLocal is handled specially for this
             // helper function in VarTracker::insCall and in CodegenLIR::analyze_call.
             LIns* out = callIns(FUNCTIONID(restargHelper),
                                 6,
                                 loadEnvToplevel(),
                                 InsConstPtr(multiname),
-                                loadAtomRep(state->sp()),
+                                loadAtomRep(sp),
                                 lea(restLocal << VARSHIFT(info) , vars),
                                 restArgc,
-                                (info->needRest() ?
-                                    binaryIns(LIR_addp, ap_param, InsConstPtr((void*)(ms->rest_offset()))) :
-                                    binaryIns(LIR_addp, ap_param, InsConstPtr((void*)sizeof(Atom)))));
-            localSet(state->sp()-1, out, type);
+                                restArea);
+            stp(out, result, 0, ACCSET_STORE_ANY);
+
+            emitLabel(done_path);
+            localSet(sp-1, ldp(result, 0, ACCSET_LOAD_ANY), type);
+            resumeCSE();
             break;
         }
 
@@ -3804,6 +3891,9 @@ FLOAT_ONLY(           !(v.sst_mask == (1 << SST_float)  && v.traits == FLOAT_TYP
                 vector_length: {
                     LIns *arrayData = loadIns(LIR_ldp, arrayDataOffset, localGetp(sp), ACCSET_OTHER, LOAD_NORMAL);
                     LIns *arrayLen  = loadIns(LIR_ldi, lenOffset, arrayData, ACCSET_OTHER, LOAD_NORMAL);
+                    if (!vectorLengths)
+                        vectorLengths = new (*alloc1) HashMap<LIns*, bool>(*alloc1);
+                    vectorLengths->put(arrayLen, true);
                     localSet(sp, arrayLen, type);
                     break;
                 }
@@ -3998,6 +4088,14 @@ FLOAT_ONLY(           !(v.sst_mask == (1 << SST_float)  && v.traits == FLOAT_TYP
         return specializedCall;
     }
 
+    // Is 'ins' the length of a Vector, as loaded by an inlined length getter?
+    // The length is a uint, but it never exceeds kListMaxLength, so it can
+    // be compared with an int as a signed 32-bit value.
+    bool CodegenLIR::isVectorLength(LIns* ins)
+    {
+        return vectorLengths && vectorLengths->get(ins);
+    }
+
     // Attempt to replace a call with a call to another function, using the
     // mapping given by 'specs'.  The intent is that the replacement function
     // yield equivalent semantics in the context in which it will appear, but
@@ -4941,6 +5039,182 @@ FLOAT_ONLY(           !(v.sst_mask == (1 << SST_float)  && v.traits == FLOAT_TYP
         return false;
     }
 
+    // Reads a u30 operand of an accessor body without running past its end.
+    // The callee may not have been verified yet, so nothing can be assumed.
+    static bool readAccessorOperand(const uint8_t*& pc, const uint8_t* end, uint32_t& value)
+    {
+        const uint8_t* p = pc;
+        for (int i = 0; i < 5; i++) {
+            if (p == end)
+                return false;
+            if (!(*p++ & 0x80)) {
+                value = AvmCore::readU32(pc);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * If mi is an accessor of the shape the compilers emit for
+     *
+     *     function get x():T { return _x }        // argc == 0
+     *     function set x(v:T):void { _x = v }     // argc == 1
+     *
+     * where _x is a var of type T declared by mi's class, return the slot
+     * id of _x; otherwise return -1.  The body must consist of nothing but
+     *
+     *     getlocal0 [pushscope] getlocal0 getproperty/getslot returnvalue
+     *     getlocal0 [pushscope] getlocal0 getlocal1 setproperty/initproperty/setslot returnvoid
+     *
+     * so that replacing a call by the slot access cannot change what the
+     * program observes, short of a debugger stepping into the accessor.
+     */
+    static int32_t matchAccessor(MethodInfo* mi, int argc)
+    {
+        if (mi->isNative() || !mi->abc_body_pos() ||
+            mi->needActivation() || mi->needRestOrArguments() ||
+            mi->hasExceptions() || mi->setsDxns())
+            return -1;
+
+        MethodSignaturep ms = mi->getMethodSignature();
+        if (ms->param_count() != argc || ms->local_count() < argc + 1)
+            return -1;
+        // returnvoid yields undefined, which only * and void leave alone
+        if (argc == 1 && ms->returnTraits() != NULL && ms->returnTraits() != mi->pool()->core->traits.void_itraits)
+            return -1;
+
+        const uint8_t* pc = mi->abc_body_pos();
+        AvmCore::skipU32(pc, 4);
+        uint32_t code_length = AvmCore::readU32(pc);
+        const uint8_t* end = pc + code_length;
+        if (code_length < 4 || code_length > 16)
+            return -1;
+
+        if (*pc++ != OP_getlocal0)
+            return -1;
+        if (*pc == OP_pushscope)
+            pc++;
+        if (*pc++ != OP_getlocal0)
+            return -1;
+        if (argc == 1 && (pc == end || *pc++ != OP_getlocal1))
+            return -1;
+        if (pc == end)
+            return -1;
+
+        AbcOpcode access = AbcOpcode(*pc++);
+        uint32_t index;
+        if (!readAccessorOperand(pc, end, index) || pc + 1 != end)
+            return -1;
+        if (*pc != (argc == 0 ? OP_returnvalue : OP_returnvoid))
+            return -1;
+
+        Traits* declarer = mi->declaringTraits();
+        const TraitsBindingsp tb = declarer->getTraitsBindings();
+        uint32_t slot;
+        switch (access) {
+        case OP_getproperty:
+        case OP_setproperty:
+        case OP_initproperty:
+        {
+            if ((access == OP_getproperty) != (argc == 0))
+                return -1;
+            PoolObject* pool = mi->pool();
+            if (index == 0 || index >= pool->cpool_mn_offsets.length())
+                return -1;
+            const Multiname* name = pool->precomputedMultiname(index);
+            if (!name->isBinding())
+                return -1;
+            Traitsp owner = NULL;
+            Binding b = tb->findBindingAndDeclarer(*name, owner);
+            if (!AvmCore::isSlotBinding(b) || (argc == 1 && AvmCore::isConstBinding(b)))
+                return -1;
+            slot = AvmCore::bindingToSlotId(b);
+            break;
+        }
+        case OP_getslot:
+        case OP_setslot:
+            if ((access == OP_getslot) != (argc == 0) || index == 0 || index > tb->slotCount)
+                return -1;
+            slot = index - 1;
+            break;
+        default:
+            return -1;
+        }
+
+        Traits* slotType = tb->getSlotTraits(slot);
+        if (argc == 0 ? ms->returnTraits() != slotType : ms->paramTraits(1) != slotType)
+            return -1;
+        return int32_t(slot);
+    }
+
+    /**
+     * Inline a call to a trivial getter or setter (see matchAccessor) as a
+     * slot access.  When the callee is final, or the receiver's class is, the
+     * slot access replaces the call; the verifier has already coerced the
+     * receiver to the class declaring the accessor, so that is the class
+     * checked.  Otherwise a subclass might override the accessor, so the
+     * receiver's vtable entry is compared against the callee and the call is
+     * still made if they differ.
+     */
+    bool CodegenLIR::inlineAccessor(AbcOpcode opcode, intptr_t method_id, int argc, Traits* result, MethodInfo* mi)
+    {
+        if (haveDebugger || opcode != OP_callmethod || argc > 1 || !core->config.jitconfig.opt_inline)
+            return false;
+
+        // Only same-pool callees; the pool's multinames are known to be precomputed.
+        if (mi->pool() != pool)
+            return false;
+
+        int objDisp = state->sp() - argc;
+        Traits* objType = state->value(objDisp).traits;
+        if (!objType || objType->isMachineType() || objType == STRING_TYPE || objType == NAMESPACE_TYPE || objType->isInterface())
+            return false;
+
+        bool exact = mi->isFinal() || objType->final;
+        if (!exact && !inlineFastpath)
+            return false;
+
+        int32_t slot = matchAccessor(mi, argc);
+        if (slot < 0)
+            return false;
+
+        MethodSignaturep ms = mi->getMethodSignature();
+        AvmAssert(argc == 1 || result == ms->returnTraits());
+        Traits* slotType = argc == 0 ? ms->returnTraits() : ms->paramTraits(1);
+
+        CodegenLabel call_path("accessor_call");
+        CodegenLabel done("accessor_done");
+        if (!exact) {
+            suspendCSE();
+            LIns* vtable = loadVTable(localGetp(objDisp), objType);
+            LIns* env = loadIns(LIR_ldp, int32_t(offsetof(VTable,methods)+sizeof(MethodEnv*)*method_id), vtable, ACCSET_OTHER, LOAD_CONST);
+            LIns* method = loadIns(LIR_ldp, offsetof(MethodEnv, method), env, ACCSET_OTHER, LOAD_CONST);
+            branchToLabel(LIR_jf, eqp(method, InsConstPtr(mi)), call_path);
+        }
+
+        if (argc == 0) {
+            AvmAssert(result == slotType);
+            localSet(objDisp, loadFromSlot(objDisp, slot, slotType), result);
+        } else {
+            emitSetslot(OP_setslot, slot, objDisp);
+            localSet(objDisp, undefConst, result);
+        }
+
+        if (!exact) {
+            JIT_EVENT(jit_inline_accessor_guarded);
+            branchToLabel(LIR_j, NULL, done);
+            emitLabel(call_path);
+            emitCall(opcode, method_id, argc, result, ms);
+            JIT_EVENT(jit_inline_accessor_miss);
+            emitLabel(done);
+            resumeCSE();
+        } else {
+            JIT_EVENT(jit_inline_accessor);
+        }
+        return true;
+    }
+
 #ifdef DEBUG
     /**
      * emitTypedCall is used when the Verifier has found an opportunity to early bind,
@@ -4966,6 +5240,9 @@ FLOAT_ONLY(           !(v.sst_mask == (1 << SST_float)  && v.traits == FLOAT_TYP
         if (inlineBuiltinFunction(opcode, method_id, argc, result, mi))
             return;
 
+        if (inlineAccessor(opcode, method_id, argc, result, mi))
+            return;
+
         emitCall(opcode, method_id, argc, result, ms);
     }
 #else
@@ -4974,6 +5251,9 @@ FLOAT_ONLY(           !(v.sst_mask == (1 << SST_float)  && v.traits == FLOAT_TYP
         if (inlineBuiltinFunction(opcode, method_id, argc, result, mi))
             return;
 
+        if (inlineAccessor(opcode, method_id, argc, result, mi))
+            return;
+
         emitCall(opcode, method_id, argc, result, mi->getMethodSignature());
     }
 #endif
@@ -5426,7 +5706,7 @@ FLOAT_ONLY(           !(v.sst_mask == (1 << SST_float)  && v.traits == FLOAT_TYP
                 LIns* baseRounded = binaryIns(LIR_andp, base, InsConstPtr((const void*)~uintptr_t(15)));                // & ~15
                 LIns* element = ui2p(binaryIns(LIR_lshi, index, InsConst(scale)));
                 LIns* effectiveAddress = binaryIns(LIR_addp, baseRounded, element);
-                return loadIns(load_item, 0, effectiveAddress, ACCSET_OTHER, LOAD_NORMAL);
+                return loadIns(load_item, 0, effectiveAddress, ACCSET_VECTOR_DATA, LOAD_NORMAL);
             }
 #ifdef VMCFG_64BIT
             case LIR_ldp:
@@ -5436,7 +5716,7 @@ FLOAT_ONLY(           !(v.sst_mask == (1 << SST_float)  && v.traits == FLOAT_TYP
             case LIR_ldf:
             {
                 LIns* valOffset = binaryIns(LIR_addp, arrayData, ui2p(binaryIns(LIR_lshi, index, InsConst(scale))));
-                return loadIns(load_item, int32_t(entriesOffset), valOffset, ACCSET_OTHER, LOAD_NORMAL);
+                return loadIns(load_item, int32_t(entriesOffset), valOffset, ACCSET_VECTOR_DATA, LOAD_NORMAL);
             }
             default:
                 AvmAssert(!"Bad inline vector access");
@@ -5745,7 +6025,7 @@ FLOAT_ONLY(           !(v.sst_mask == (1 << SST_float)  && v.traits == FLOAT_TYP
                     value = ldf4(value, 0 , ACCSET_OTHER);
                 }
 
-                storeIns(store_item, value, 0, effectiveAddress, ACCSET_OTHER);
+                storeIns(store_item, value, 0, effectiveAddress, ACCSET_VECTOR_DATA);
                 break;
             }
 #endif
@@ -5757,7 +6037,7 @@ FLOAT_ONLY(           !(v.sst_mask == (1 << SST_float)  && v.traits == FLOAT_TYP
             case LIR_stf:
             {
                 LIns *valOffset = binaryIns(LIR_addp, arrayData, ui2p(binaryIns(LIR_lshi, index, InsConst(scale))));
-                storeIns(store_item, value, int32_t(entriesOffset), valOffset, ACCSET_OTHER);
+                storeIns(store_item, value, int32_t(entriesOffset), valOffset, ACCSET_VECTOR_DATA);
                 break;
             }
             default:
@@ -5923,6 +6203,19 @@ FLOAT_ONLY(           !(v.sst_mask == (1 << SST_float)  && v.traits == FLOAT_TYP
         }
     }
 
+    // Does indexing an 'objType' with an int inline more than indexing it
+    // with a double?  Only asked when LIR_d2i is cheap.
+    bool CodegenLIR::hasIntIndexedAccess(Traits* objType)
+    {
+        if (!haveSSE2() || !inlineFastpath || objType == NULL)
+            return false;
+        return objType == ARRAY_TYPE ||
+               objType == VECTORINT_TYPE ||
+               objType == VECTORUINT_TYPE ||
+               objType == VECTORDOUBLE_TYPE ||
+               objType->subtypeof(VECTOROBJ_TYPE);
+    }
+
     // Try to optimize our input argument to the fastest possible type.
     // Non-negative integer constants can be considered unsigned.
     // Promotions from int/uint to number can be used as integers.
@@ -6970,6 +7263,33 @@ FLOAT_ONLY(           !(v.sst_mask == (1 << SST_float)  && v.traits == FLOAT_TYP
                         }
                     }
 #endif // VMCFG_FASTPATH_ADD_INLINE
+                    if (!bGeneratedFastPath && hasIntIndexedAccess(state->value(sp-1).traits)) {
+                        // A Number index holding an int, such as a Number
+                        // loop counter, takes the inline int-indexed path:
+                        //   i = d2i(index)
+                        //   if (i2d(i) == index)
+                        //     obj[i]
+                        //   else
+                        //     call getNativeDoubleProperty (or similar)
+                        CodegenLabel slow_path("slow");
+                        CodegenLabel done_path("done");
+                        LIns* tempResult = insAllocForTraits(result);
+                        suspendCSE();
+                        LIns* intIndex = lirout->ins1(LIR_d2i, index);
+                        branchToLabel(LIR_jf, binaryIns(LIR_eqd, i2dIns(intIndex), index), slow_path);
+                        LIns* value0 = emitGetIndexedProperty(sp-1, intIndex, result, VI_INT);
+                        stForTraits(result, value0, tempResult, 0, ACCSET_STORE_ANY);
+                        branchToLabel(LIR_j, NULL, done_path);
+
+                        emitLabel(slow_path);
+                        LIns* value1 = emitGetIndexedProperty(sp-1, index, result, VI_DOUBLE);
+                        stForTraits(result, value1, tempResult, 0, ACCSET_STORE_ANY);
+
+                        emitLabel(done_path);
+                        localSet(sp-1, ldForTraits(result, tempResult, 0, ACCSET_LOAD_ANY), result);
+                        resumeCSE();
+                        bGeneratedFastPath = true;
+                    }
                     if (!bGeneratedFastPath) {
                         LIns *value = emitGetIndexedProperty(sp-1, index, result, VI_DOUBLE);
                         localSet(sp-1, value, result);
@@ -7067,6 +7387,23 @@ FLOAT_ONLY(           !(v.sst_mask == (1 << SST_float)  && v.traits == FLOAT_TYP
                         }
                     }
 #endif // VMCFG_FASTPATH_ADD_INLINE
+                    if (!bGeneratedFastPath && hasIntIndexedAccess(state->value(sp-2).traits)) {
+                        // As for getproperty: use an int index if it is one.
+                        CodegenLabel slow_path("slow");
+                        CodegenLabel done_path("done");
+                        suspendCSE();
+                        LIns* intIndex = lirout->ins1(LIR_d2i, index);
+                        branchToLabel(LIR_jf, binaryIns(LIR_eqd, i2dIns(intIndex), index), slow_path);
+                        emitSetIndexedProperty(sp-2, sp, intIndex, VI_INT);
+                        branchToLabel(LIR_j, NULL, done_path);
+
+                        emitLabel(slow_path);
+                        emitSetIndexedProperty(sp-2, sp, index, VI_DOUBLE);
+
+                        emitLabel(done_path);
+                        resumeCSE();
+                        bGeneratedFastPath = true;
+                    }
                     if (!bGeneratedFastPath) {
                         emitSetIndexedProperty(sp-2, sp, index, VI_DOUBLE);
                     }
@@ -7576,6 +7913,8 @@ FLOAT_ONLY(           !(v.sst_mask == (1 << SST_float)  && v.traits == FLOAT_TYP
             {
                 LIns* lhs = localGet(lhsi);
                 LIns* rhs = localGet(rhsi);
+                if (isVectorLength(lhs))
+                    return binaryIns(icmp, lhs, rhs);
             #ifdef AVMPLUS_64BIT
                 // 32-bit signed and unsigned values fit in 64-bit registers
                 // so we can promote and simply do a signed 64bit compare
@@ -7593,6 +7932,8 @@ FLOAT_ONLY(           !(v.sst_mask == (1 << SST_float)  && v.traits == FLOAT_TYP
             {
                 LIns* lhs = localGet(lhsi);
                 LIns* rhs = localGet(rhsi);
+                if (isVectorLength(rhs))
+                    return binaryIns(icmp, lhs, rhs);
             #ifdef AVMPLUS_64BIT
                 // 32-bit signed and unsigned values fit in 64-bit registers
                 // so we can promote and simply do a signed 64bit compare
@@ -8343,19 +8684,63 @@ FLOAT_ONLY(           !(v.sst_mask == (1 << SST_float)  && v.traits == FLOAT_TYP
         }
     }
 
-    CodeMgr::CodeMgr(nanojit::Config* config) : codeAlloc(config), bindingCaches(NULL), jit_mgr(NULL)
+    CodeMgr::CodeMgr(nanojit::Config* config) : codeAlloc(config), bindingCaches(NULL), jit_mgr(NULL), adopted(NULL)
     {
         verbose_only( log.lcbits = 0; )
     }
 
+    CodeMgr::~CodeMgr()
+    {
+        // the list nodes live in this->allocator, which is still intact here.
+        for (AdoptedCode* a = adopted; a != NULL; a = a->next) {
+            mmfx_delete(a->code);
+            mmfx_delete(a->data);
+        }
+    }
+
+    void CodeMgr::adopt(CodeAlloc* code, Allocator* data)
+    {
+        AdoptedCode* a = new (allocator) AdoptedCode();
+        a->code = code;
+        a->data = data;
+        a->next = adopted;
+        adopted = a;
+    }
+
     void CodeMgr::flushBindingCaches()
     {
         // this clears vtable so all kObjectType receivers are invalidated.
         // of course, this field is also "tag" for primitive receivers,
         // but 0 is never a legal value there (and this is asserted when the tag is set)
-        // so this should safely invalidate those as well (though we don't really need to invalidate them)
+        // so this should safely invalidate those as well (though we don't really need to invalidate them).
+        // secondary entries hold the same weak references, so drop them too.
         for (BindingCache* b = bindingCaches; b != NULL; b = b->next)
-            b->vtable = NULL;
+            b->unbind();
+    }
+
+    void CodeMgr::dumpBindingCacheStats(AvmCore* core)
+    {
+        static const char* const kindNames[] = { "call", "get", "set" };
+        PrintWriter& out = core->console;
+        for (BindingCache* b = bindingCaches; b != NULL; b = b->next) {
+            if (b->hits == 0 && b->misses == 0)
+                continue;
+            out << kindNames[b->kind] << " ";
+            if (b->name->isAnyName() || b->name->isRtname())
+                out << "*";
+            else
+                out << b->name->getName();
+#ifdef DOPROF
+            out << " hits=" << b->hits;
+#endif
+            out << " misses=" << b->misses
+                << " polyhits=" << b->polyhits
+                << " transitions=" << b->transitions;
+            if (b->megamorphic)
+                out << " megamorphic\n";
+            else
+                out << " types=" << (b->isBound() ? 1 + b->npoly : 0) << "\n";
+        }
     }
 
     void analyze_edge(LIns* label, nanojit::BitSet &livein,
@@ -8868,20 +9253,34 @@ FLOAT_ONLY(           !(v.sst_mask == (1 << SST_float)  && v.traits == FLOAT_TYP
         return jit_debug_info;
     }
 
-    // return pointer to generated code on success, NULL on failure (frame size too large)
-    GprMethodProc CodegenLIR::emitMD()
+    // Finish the LIR for this method.  Everything that needs the GC, the
+    // AvmCore, or the pool's shared allocators happens here, so that
+    // assembleMD() can run on a background compiler thread.
+    void CodegenLIR::prepareMD()
     {
         deadvars();  // deadvars_kill() will add livep(vars) or livep(tags) if necessary
 
         // do this very last so it's after livep(vars)
         frag->lastIns = livep(undefConst);
 
-        PERFM_NTPROF_BEGIN("compile");
+        if (core->config.njconfig.globalopt) {
+            Allocator opt_alloc;
+            GlobalOpt opt(opt_alloc, core->config.njconfig);
+            if (opt.run(frag, *lir_alloc)) {
+                npe_label.labelIns = opt.remap(npe_label.labelIns);
+                upe_label.labelIns = opt.remap(upe_label.labelIns);
+                interrupt_label.labelIns = opt.remap(interrupt_label.labelIns);
+                mop_rangeCheckFailed_label.labelIns = opt.remap(mop_rangeCheckFailed_label.labelIns);
+                catch_label.labelIns = opt.remap(catch_label.labelIns);
+                call_error_label.labelIns = opt.remap(call_error_label.labelIns);
+            }
+        }
+
         mmfx_delete( alloc1 );
         alloc1 = NULL;
 
-        CodeMgr *mgr = pool->codeMgr;
         #ifdef NJ_VERBOSE
+        CodeMgr *mgr = pool->codeMgr;
         if (pool->isVerbose(LC_ReadLIR, info)) {
             StringBuffer sb(core);
             sb << info;
@@ -8927,16 +9326,18 @@ FLOAT_ONLY(           !(v.sst_mask == (1 << SST_float)  && v.traits == FLOAT_TYP
             lircfg(f, frag, &ignore, alloc, mode);
             fclose(f);
         }
+        md_raw = pool->isVerbose(VB_raw, info);
         #endif
+    }
 
-        // Use the 'active' log if we are in verbose output mode otherwise sink the output
-        LogControl* log = &(mgr->log);
-        verbose_only(
-            SinkLogControl sink;
-            log = pool->isVerbose(VB_jit,info) ? log : &sink;
-        )
-
-        Assembler *assm = new (*lir_alloc) Assembler(mgr->codeAlloc, mgr->allocator, *lir_alloc, log, core->config.njconfig);
+    // Translate the finished LIR to machine code, allocating code from codeAlloc
+    // and assembler data (constants, jump tables) from dataAlloc.  Touches only
+    // the LIR buffer, the given allocators, and the read-only njconfig, so it is
+    // safe to call off the main thread as long as nobody else uses the allocators.
+    // Returns NULL if the assembler failed.
+    GprMethodProc CodegenLIR::assembleMD(CodeAlloc& codeAlloc, Allocator& dataAlloc, LogControl* log)
+    {
+        Assembler *assm = new (*lir_alloc) Assembler(codeAlloc, dataAlloc, *lir_alloc, log, core->config.njconfig);
         #ifdef VMCFG_VTUNE
         assm->vtuneHandle = vtuneInit(info->getMethodName());
         #endif /* VMCFG_VTUNE */
@@ -8945,7 +9346,7 @@ FLOAT_ONLY(           !(v.sst_mask == (1 << SST_float)  && v.traits == FLOAT_TYP
 
         verbose_only(
             StringList asmOutput(*lir_alloc);
-            if (!pool->isVerbose(VB_raw, info))
+            if (!md_raw)
                 assm->_outputCache = &asmOutput;
         );
 
@@ -8953,7 +9354,6 @@ FLOAT_ONLY(           !(v.sst_mask == (1 << SST_float)  && v.traits == FLOAT_TYP
         LirReader reader(frag->lastIns);
         assm->assemble(frag, &reader);
         assm->endAssembly(frag);
-        PERFM_NTPROF_END("compile");
 
         verbose_only(
             assm->_outputCache = 0;
@@ -8962,24 +9362,16 @@ FLOAT_ONLY(           !(v.sst_mask == (1 << SST_float)  && v.traits == FLOAT_TYP
             }
         );
 
-        PERFM_NVPROF("IR-bytes", frag->lirbuf->byteCount());
-        PERFM_NVPROF("IR", frag->lirbuf->insCount());
-
         GprMethodProc code;
-        bool keep = !assm->error();
-        if (keep) {
+        md_error = assm->error();
+        if (md_error == None) {
             // save pointer to generated code
             code = (GprMethodProc) frag->code();
-            PERFM_NVPROF("JIT method bytes", CodeAlloc::size(assm->codeList));
-            if (jit_observer)
-                jit_observer->notifyMethodJITed(info, assm->codeList, jit_debug_info);
+            md_codeList = assm->codeList;
         } else {
-            verbose_only (if (pool->isVerbose(VB_execpolicy))
-                AvmLog("execpolicy revert to interp (%d) compiler error %d \n", info->unique_method_id(), assm->error());
-            )
             // assm puked, or we did something untested, so interpret.
             code = NULL;
-            PERFM_NVPROF("lir-error",1);
+            md_codeList = NULL;
         }
 
         #ifdef VMCFG_VTUNE
@@ -8990,20 +9382,61 @@ FLOAT_ONLY(           !(v.sst_mask == (1 << SST_float)  && v.traits == FLOAT_TYP
         return code;
     }
 
-    BindingCache::BindingCache(const Multiname* name, BindingCache* next)
-        : name(name), next(next)
+    // Report the outcome of assembleMD() to the JIT observer and in verbose
+    // output.  Must be called on the main thread.
+    void CodegenLIR::notifyMD(GprMethodProc code)
+    {
+        if (code) {
+            PERFM_NVPROF("JIT method bytes", CodeAlloc::size(md_codeList));
+            if (jit_observer)
+                jit_observer->notifyMethodJITed(info, md_codeList, jit_debug_info);
+        } else {
+            verbose_only (if (pool->isVerbose(VB_execpolicy))
+                AvmLog("execpolicy revert to interp (%d) compiler error %d \n", info->unique_method_id(), md_error);
+            )
+            PERFM_NVPROF("lir-error",1);
+        }
+    }
+
+    // return pointer to generated code on success, NULL on failure (frame size too large)
+    GprMethodProc CodegenLIR::emitMD()
+    {
+        PERFM_NTPROF_BEGIN("compile");
+        prepareMD();
+
+        // Use the 'active' log if we are in verbose output mode otherwise sink the output
+        CodeMgr *mgr = pool->codeMgr;
+        LogControl* log = &(mgr->log);
+        verbose_only(
+            SinkLogControl sink;
+            log = pool->isVerbose(VB_jit,info) ? log : &sink;
+        )
+
+        GprMethodProc code = assembleMD(mgr->codeAlloc, mgr->allocator, log);
+        PERFM_NTPROF_END("compile");
+
+        PERFM_NVPROF("IR-bytes", frag->lirbuf->byteCount());
+        PERFM_NVPROF("IR", frag->lirbuf->insCount());
+
+        notifyMD(code);
+        return code;
+    }
+
+    BindingCache::BindingCache(const Multiname* name, BindingCache* next, Kind kind)
+        : vtable(NULL), slot_offset(0), name(name), next(next), poly(NULL), npoly(0), kind(uint8_t(kind)), megamorphic(false)
+        , hits(0), misses(0), polyhits(0), transitions(0), shape_id(0)
     {}
 
     CallCache::CallCache(const Multiname* name, BindingCache* next)
-        : BindingCache(name, next), call_handler(callprop_miss)
+        : BindingCache(name, next, kCall), call_handler(callprop_miss)
     {}
 
     GetCache::GetCache(const Multiname* name, BindingCache* next)
-        : BindingCache(name, next), get_handler(getprop_miss)
+        : BindingCache(name, next, kGet), get_handler(getprop_miss)
     {}
 
     SetCache::SetCache(const Multiname* name, BindingCache* next)
-        : BindingCache(name, next), set_handler(setprop_miss)
+        : BindingCache(name, next, kSet), set_handler(setprop_miss)
     {}
 
     template class CacheBuilder<CallCache>;
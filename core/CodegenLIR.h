@@ -167,11 +167,62 @@ namespace avmplus
     //     instead of using a single set of handlers for all primitives types
     //   * OP_initproperty is rarely late bound in jit code; if this evidence changes
     //     then we should consider an inline cache for it.
+    //
+    // Polymorphism:
+    //
+    //   The fields above form the cache's primary entry, the only one the
+    //   specialized handlers look at.  When a site sees a receiver type that
+    //   doesn't match, the miss handler saves the primary entry in a small
+    //   side table (poly, allocated from the CodeMgr on first use) and
+    //   searches that table before doing a full lookup; a match is swapped
+    //   back into the primary entry.  So a site alternating between a few
+    //   types pays for a short search instead of a binding lookup.  Once
+    //   kPolyEntries secondary types are in use and yet another shows up,
+    //   the site is megamorphic: it installs a handler that always does the
+    //   generic lookup and stops caching.
+    //
+    //   Each cache counts misses, secondary-entry hits and entry
+    //   replacements, and in DOPROF builds primary entry hits too;
+    //   AvmCore::dumpBindingCacheStats() prints them (avmshell -Dcachestats).
+    //
+    // Shapes:
+    //
+    //   A get or set of a dynamic property (BKIND_NONE) on a plain object
+    //   matches on the vtable like any other entry, but the vtable says
+    //   nothing about where the property lives.  Objects that keep their
+    //   dynamic properties by shape (see DynamicShape) also let the handler
+    //   remember the id of the last shape seen and the property's index in
+    //   it (shape_id, slot_offset); a later object with the same shape is
+    //   then a load or store at that index.  A different shape is looked up
+    //   the slow way and replaces the remembered one.
 
     // binding cache common code
     class BindingCache {
     public:
-        BindingCache(const Multiname*, BindingCache* next);
+        enum Kind { kCall, kGet, kSet };
+        static const uint32_t kPolyEntries = 4; // secondary types before going megamorphic
+
+        // a saved primary entry; handler and extra are stored untyped and
+        // only interpreted by the subclass that saved them.
+        typedef void (*AnyHandler)();
+        struct Entry {
+            union {
+                VTable* vtable;
+                Atom tag;
+            };
+            union {
+                ptrdiff_t slot_offset;
+                MethodEnv* method;
+            };
+            AnyHandler handler;
+            void* extra;
+            uint32_t shape_id;
+        };
+
+        BindingCache(const Multiname*, BindingCache* next, Kind kind);
+        bool isBound() const { return vtable != NULL; }  // also covers tag != 0
+        void unbind() { vtable = NULL; npoly = 0; }
+
         union {
             VTable* vtable;         // for kObjectType receivers
             Atom tag;               // for primitive receivers
@@ -182,6 +233,15 @@ namespace avmplus
         };
         const Multiname* const name;      // multiname for this entry, saved when cache created.
         BindingCache* const next;         // singly-linked list
+        Entry* poly;                // NULL, or kPolyEntries saved entries
+        uint8_t npoly;              // number of valid entries in poly
+        uint8_t const kind;         // Kind of the subclass
+        bool megamorphic;           // gave up caching for this site
+        uint32_t hits;              // primary entry matched (DOPROF builds only)
+        uint32_t misses;            // miss handler (or megamorphic handler) ran
+        uint32_t polyhits;          // misses satisfied from poly
+        uint32_t transitions;       // primary entry replaced after the first binding
+        uint32_t shape_id;          // for dynamic gets and sets: DynamicShape id, or 0
     };
 
     // cache for late bound calls
@@ -190,6 +250,13 @@ namespace avmplus
         typedef Atom (*Handler)(CallCache&, Atom base, int argc, Atom* args, MethodEnv*);
         CallCache(const Multiname*, BindingCache* next);
         Handler call_handler;
+
+        void save(Entry& e) const {
+            e.vtable = vtable; e.method = method; e.handler = (AnyHandler) call_handler;
+        }
+        void restore(const Entry& e) {
+            vtable = e.vtable; method = e.method; call_handler = (Handler) e.handler;
+        }
     };
 
     // cache for late bound gets
@@ -198,6 +265,15 @@ namespace avmplus
         typedef Atom (*Handler)(GetCache&, MethodEnv*, Atom);
         GetCache(const Multiname*, BindingCache* next);
         Handler get_handler;
+
+        void save(Entry& e) const {
+            e.vtable = vtable; e.method = method; e.handler = (AnyHandler) get_handler;
+            e.shape_id = shape_id;
+        }
+        void restore(const Entry& e) {
+            vtable = e.vtable; method = e.method; get_handler = (Handler) e.handler;
+            shape_id = e.shape_id;
+        }
     };
 
     // bind cache for sets.  This is necessarily larger than for gets because
@@ -212,6 +288,15 @@ namespace avmplus
             Traits* slot_type;  // slot or setter type, for implicit coercion
             GC* gc;             // saved GC* for set-handlers that call WBATOM
         };
+
+        void save(Entry& e) const {
+            e.vtable = vtable; e.method = method; e.handler = (AnyHandler) set_handler;
+            e.extra = slot_type; e.shape_id = shape_id;
+        }
+        void restore(const Entry& e) {
+            vtable = e.vtable; method = e.method; set_handler = (Handler) e.handler;
+            slot_type = (Traits*) e.extra; shape_id = e.shape_id;
+        }
     };
 
     /** helper class for allocating binding caches during jit compilation */
@@ -320,6 +405,7 @@ namespace avmplus
         PrologWriter *prolog;
         LIns* skip_ins; // Skips from start of body to end of prologue.
         HashMap<LIns*, LIns*> *specializedCallHashMap;
+        HashMap<LIns*, bool> *vectorLengths; // loads of a Vector's length, which is below 2^31
         HashMap<uint32_t, uint32_t> *builtinFunctionOptimizerHashMap;
         HashMap<const uint8_t*, CodegenLabel*> *blockLabels;
         LirWriter* redirectWriter;
@@ -328,6 +414,9 @@ namespace avmplus
         verbose_only(VerboseWriter *vbWriter;)
         verbose_only(LInsPrinter* vbNames;)
         JITDebugInfo *jit_debug_info;
+        CodeList* md_codeList;      // code produced by assembleMD()
+        AssmError md_error;         // assembler status from assembleMD()
+        verbose_only( bool md_raw; )
 
 #ifdef DEBUGGER
         bool haveDebugger;
@@ -506,12 +595,16 @@ namespace avmplus
         void emitInitializers();
         void emitDebugEnter();
         void emitOsrBranch();
+#ifdef VMCFG_HALFMOON
+        void emitTierUpCountdown();
+#endif
 
         bool isPromote(LOpcode op);
         LIns* imm2Int(LIns* imm);
         LIns* coerceNumberToInt(int i);
 
         bool inlineBuiltinFunction(AbcOpcode opcode, intptr_t method_id, int argc, Traits* result, MethodInfo* mi);
+        bool inlineAccessor(AbcOpcode opcode, intptr_t method_id, int argc, Traits* result, MethodInfo* mi);
         LIns* optimizeIntCmpWithNumberCall(int callIndex, int otherIndex, LOpcode icmp, bool swap);
         LIns* optimizeStringCmpWithStringCall(int callIndex, int otherIndex, LOpcode icmp, bool swap);
 
@@ -520,6 +613,7 @@ namespace avmplus
 
         LIns* getSpecializedCall(LIns* call);
         LIns* addSpecializedCall(LIns* origCall, LIns* specializedCall);
+        bool isVectorLength(LIns* ins);
         LIns* specializeIntCall(LIns *call, const Specialization* specs);
 
         LIns* emitStringCall(int index, const CallInfo* stringCall, bool preserveNull);
@@ -586,6 +680,7 @@ namespace avmplus
 #endif
 
         LIns *optimizeIndexArgumentType(int32_t sp, Traits** indexType);
+        bool hasIntIndexedAccess(Traits* objType);
 
         JITDebugInfo* initJitDebugInfo();
 
@@ -595,6 +690,12 @@ namespace avmplus
                    OSR *osr_state);
         GprMethodProc emitMD();
 
+        // emitMD() in three steps, for compiling on a background thread.
+        // prepareMD() and notifyMD() must run on the main thread; see JitPool.
+        void prepareMD();
+        GprMethodProc assembleMD(CodeAlloc& codeAlloc, Allocator& dataAlloc, LogControl* log);
+        void notifyMD(GprMethodProc code);
+
         // May return true if JIT will always fail based on information known prior to invocation.
         static bool jitWillFail(const MethodSignaturep ms);
 
@@ -0,0 +1,129 @@
+/* -*- Mode: C++; c-basic-offset: 4; indent-tabs-mode: nil; tab-width: 4 -*- */
+/* vi: set ts=4 sw=4 expandtab: (add to ~/.vimrc: set modeline modelines=5) */
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef __avmplus_DynamicShape_inlines__
+#define __avmplus_DynamicShape_inlines__
+
+
+namespace avmplus
+{
+    REALLY_INLINE uint32_t DynamicShape::id() const
+    {
+        return m_id;
+    }
+
+    REALLY_INLINE uint32_t DynamicShape::count() const
+    {
+        return m_count;
+    }
+
+    REALLY_INLINE Atom DynamicShape::keyAt(uint32_t i) const
+    {
+        AvmAssert(i < m_count);
+        return m_keys[i];
+    }
+
+    REALLY_INLINE int32_t DynamicShape::find(Atom key) const
+    {
+        for (uint32_t i = 0; i < m_count; i++)
+            if (m_keys[i] == key)
+                return int32_t(i);
+        return -1;
+    }
+
+    REALLY_INLINE DynamicShape* DynamicSlots::shape() const
+    {
+        return m_shape;
+    }
+
+    REALLY_INLINE uint32_t DynamicSlots::capacity() const
+    {
+        return m_capacity;
+    }
+
+    REALLY_INLINE Atom DynamicSlots::get(Atom key) const
+    {
+        int32_t i = m_shape->find(key);
+        return i < 0 ? 0 : m_values[i];
+    }
+
+    REALLY_INLINE Atom DynamicSlots::valueAt(uint32_t i) const
+    {
+        AvmAssert(i < m_shape->count());
+        return m_values[i];
+    }
+
+    REALLY_INLINE void DynamicSlots::setValueAt(uint32_t i, Atom value)
+    {
+        AvmAssert(i < m_shape->count() && value != 0);
+        WBATOM(MMgc::GC::GetGC(this), this, &m_values[i], value);
+    }
+
+    REALLY_INLINE void DynamicSlots::deleteAt(uint32_t i)
+    {
+        AvmAssert(i < m_shape->count());
+        AvmCore::atomWriteBarrier_dtor(&m_values[i]);
+    }
+
+    REALLY_INLINE int DynamicSlots::positionOf(int index)
+    {
+        return (index & kBoundedBit) ? (index & kPositionMask) : index;
+    }
+
+    REALLY_INLINE int DynamicSlots::next(int index) const
+    {
+        AvmAssert(index >= 0);
+        uint32_t end = m_shape->count();
+        if (index != 0)
+        {
+            uint32_t began = uint32_t(index >> kPositionBits) & kPositionMask;
+            if (began < end)
+                end = began;
+        }
+        for (uint32_t i = uint32_t(positionOf(index)); i < end; i++)
+        {
+            if (m_values[i] != 0)
+            {
+                m_enumerating = true;
+                return kBoundedBit | int(end << kPositionBits) | int(i + 1);
+            }
+        }
+        m_enumerating = false;
+        return 0;
+    }
+
+    REALLY_INLINE bool DynamicSlots::isEnumerating() const
+    {
+        return m_enumerating;
+    }
+
+    REALLY_INLINE bool DynamicSlots::isShapeIndex(int index)
+    {
+        // InlineHashtable indices are below its MAX_CAPACITY
+        return (index & kBoundedBit) != 0;
+    }
+
+    REALLY_INLINE Atom DynamicSlots::keyAtIndex(int index) const
+    {
+        uint32_t i = uint32_t(positionOf(index) - 1);
+        return i < m_shape->count() && m_values[i] != 0 ? m_shape->keyAt(i) : nullStringAtom;
+    }
+
+    REALLY_INLINE Atom DynamicSlots::valueAtIndex(int index) const
+    {
+        uint32_t i = uint32_t(positionOf(index) - 1);
+        return i < m_shape->count() && m_values[i] != 0 ? m_values[i] : nullStringAtom;
+    }
+
+#ifdef DEBUGGER
+    REALLY_INLINE uint64_t DynamicSlots::bytesUsed() const
+    {
+        return sizeof(DynamicSlots) + (m_capacity - 1) * sizeof(Atom);
+    }
+#endif
+}
+
+#endif /* __avmplus_DynamicShape_inlines__ */
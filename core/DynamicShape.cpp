@@ -0,0 +1,135 @@
+/* -*- Mode: C++; c-basic-offset: 4; indent-tabs-mode: nil; tab-width: 4 -*- */
+/* vi: set ts=4 sw=4 expandtab: (add to ~/.vimrc: set modeline modelines=5) */
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+
+#include "avmplus.h"
+
+using namespace MMgc;
+
+namespace avmplus
+{
+    DynamicShape::DynamicShape(DynamicShape* parent, uint32_t id, uint32_t count)
+        : m_parent(parent)
+        , m_pruneAt(8)
+        , m_id(id)
+        , m_count(count)
+    {
+    }
+
+    DynamicShape::~DynamicShape()
+    {
+        // the keys were stored with WBATOM
+        AvmCore::decrementAtomRegion(m_keys, int(m_count));
+        m_count = 0;
+        m_pruneAt = 0;
+    }
+
+    /*static*/ DynamicShape* DynamicShape::createEmpty(GC* gc, uint32_t id)
+    {
+        return new (gc, kExact) DynamicShape(NULL, id, 0);
+    }
+
+    DynamicShape* DynamicShape::withKey(AvmCore* core, Atom key)
+    {
+        AvmAssert(find(key) < 0);
+        if (m_count == kMaxShared)
+            return NULL;
+
+        GC* gc = core->GetGC();
+        if (m_transitions != NULL)
+        {
+            Atom a = m_transitions->get(key);
+            if (AvmCore::isGenericObject(a))
+            {
+                GCWeakRef* wr = (GCWeakRef*)AvmCore::atomToGenericObject(a);
+                DynamicShape* child = (DynamicShape*)(void*)wr->get();
+                if (child != NULL)
+                    return child;
+            }
+        }
+
+        uint32_t const id = core->nextShapeId();
+        if (id == 0)
+            return NULL;
+        if (m_transitions == NULL)
+            m_transitions = HeapHashtable::create(gc);
+
+        size_t extra = GCHeap::CheckForCallocSizeOverflow(m_count, sizeof(Atom));
+        DynamicShape* child = new (gc, kExact, extra) DynamicShape(this, id, m_count + 1);
+        for (uint32_t i = 0; i < m_count; i++)
+            WBATOM(gc, child, &child->m_keys[i], m_keys[i]);
+        WBATOM(gc, child, &child->m_keys[m_count], key);
+
+        // the child stays alive only as long as some object (or a descendant) uses it
+        m_transitions->add(key, AvmCore::genericObjectToAtom(GC::GetWeakRef(child)));
+        if (m_transitions->getSize() >= m_pruneAt)
+            pruneTransitions();
+        return child;
+    }
+
+    void DynamicShape::pruneTransitions()
+    {
+        for (int i = m_transitions->next(0); i != 0; i = m_transitions->next(i))
+        {
+            GCWeakRef* wr = (GCWeakRef*)AvmCore::atomToGenericObject(m_transitions->valueAt(i));
+            if (wr->isNull())
+                m_transitions->remove(m_transitions->keyAt(i));
+        }
+        m_pruneAt = m_transitions->getSize() * 2 > 8 ? m_transitions->getSize() * 2 : 8;
+    }
+
+    DynamicSlots::DynamicSlots(DynamicShape* shape, uint32_t capacity)
+        : m_shape(shape)
+        , m_capacity(capacity)
+        , m_enumerating(false)
+    {
+    }
+
+    /*static*/ DynamicSlots* DynamicSlots::create(GC* gc, DynamicShape* shape, uint32_t capacity, const DynamicSlots* old)
+    {
+        AvmAssert(capacity >= shape->count() && capacity > 0);
+        size_t extra = GCHeap::CheckForCallocSizeOverflow(capacity - 1, sizeof(Atom));
+        DynamicSlots* slots = new (gc, kExact, extra) DynamicSlots(shape, capacity);
+        if (old != NULL)
+        {
+            // the references move with the values, like InlineHashtable::rehash()
+            AvmAssert(old->m_capacity <= capacity);
+            VMPI_memcpy(slots->m_values, old->m_values, old->m_capacity * sizeof(Atom));
+        }
+        return slots;
+    }
+
+    void DynamicSlots::setShape(DynamicShape* shape)
+    {
+        AvmAssert(shape->count() <= m_capacity);
+        m_shape = shape;
+    }
+
+    /*static*/ int DynamicSlots::nextUnshaped(const DynamicShape* shape, InlineHashtable* ht, int index)
+    {
+        AvmAssert(isShapeIndex(index));
+        uint32_t end = uint32_t(index >> kPositionBits) & kPositionMask;
+        if (end > shape->count())
+            end = shape->count();
+        for (uint32_t i = uint32_t(positionOf(index)); i < end; i++)
+        {
+            if (ht->getAtomPropertyIsEnumerable(shape->keyAt(i)))
+                return kBoundedBit | int(end << kPositionBits) | int(i + 1);
+        }
+        return 0;
+    }
+
+    /*static*/ Atom DynamicSlots::keyAtIndex(const DynamicShape* shape, InlineHashtable* ht, int index)
+    {
+        uint32_t i = uint32_t(positionOf(index) - 1);
+        return i < shape->count() && ht->contains(shape->keyAt(i)) ? shape->keyAt(i) : nullStringAtom;
+    }
+
+    void DynamicSlots::destroy()
+    {
+        AvmCore::decrementAtomRegion(m_values, int(m_capacity));
+    }
+}
@@ -0,0 +1,175 @@
+/* -*- Mode: C++; c-basic-offset: 4; indent-tabs-mode: nil; tab-width: 4 -*- */
+/* vi: set ts=4 sw=4 expandtab: (add to ~/.vimrc: set modeline modelines=5) */
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef __avmplus_DynamicShape__
+#define __avmplus_DynamicShape__
+
+
+namespace avmplus
+{
+    /**
+     * A DynamicShape is the ordered list of dynamic property names of a
+     * ScriptObject, shared by every object that acquired the same names in
+     * the same order.  Shapes form a tree rooted at AvmCore::emptyShape():
+     * adding a property moves an object from a shape to one of its children
+     * (withKey()), so objects built the same way -- records decoded from
+     * JSON, object literals, instances of a dynamic class that all get the
+     * same expandos -- end up sharing one shape and each holds only a
+     * DynamicSlots vector of values.
+     *
+     * Shapes are immutable once created.  Each has an id that is unique for
+     * the lifetime of the AvmCore and is never reused, so it can be cached
+     * where a Shape* could not (the JIT's GetCache and SetCache, which the
+     * GC does not trace): a stale id simply never matches again.
+     *
+     * A parent refers to its children weakly and children to their parent
+     * strongly, so the tree only holds the shapes (and their ancestors) of
+     * objects that are still alive, and an object built later along the
+     * same path still finds the same shapes.
+     *
+     * Objects that need more than kMaxShared properties, or a DontEnum one,
+     * keep their properties in an InlineHashtable instead, as do objects
+     * that would need a new shape once the ids have run out; see
+     * ScriptObject::unshape().
+     */
+    class GC_CPP_EXACT(DynamicShape, MMgc::GCFinalizedObject)
+    {
+    public:
+        /**
+         * Objects needing more dynamic properties than this fall back to an
+         * InlineHashtable; lookups in a shape are a linear scan.
+         */
+        static const uint32_t kMaxShared = 32;
+
+        static DynamicShape* createEmpty(MMgc::GC* gc, uint32_t id);
+
+        virtual ~DynamicShape();
+
+        uint32_t id() const;
+        uint32_t count() const;
+        Atom keyAt(uint32_t i) const;
+
+        /** Index of key, or -1.  Keys are interned String or int atoms. */
+        int32_t find(Atom key) const;
+
+        /**
+         * The shape with key appended, shared with every other object that
+         * added key to this shape; NULL if that would exceed kMaxShared or
+         * needs a new shape and AvmCore has no ids left.  key must not
+         * already be present.
+         */
+        DynamicShape* withKey(AvmCore* core, Atom key);
+
+    private:
+        DynamicShape(DynamicShape* parent, uint32_t id, uint32_t count);
+        void pruneTransitions();
+
+    // ------------------------ DATA SECTION BEGIN
+        GC_DATA_BEGIN(DynamicShape)
+
+    private:
+        GCMember<DynamicShape>      GC_POINTER(m_parent);
+        GCMember<HeapHashtable>     GC_POINTER(m_transitions);  // key -> GCWeakRef to child, as a generic object atom
+        uint32_t                    m_pruneAt;                  // prune dead transitions when m_transitions gets this big
+        const uint32_t              m_id;
+        uint32_t                    m_count;
+        Atom                        GC_ATOMS(m_keys[1], m_count);   // actual size is max(m_count, 1)
+
+        GC_DATA_END(DynamicShape)
+    // ------------------------ DATA SECTION END
+    };
+
+    /**
+     * The values of a shaped object's dynamic properties, in the order of
+     * its shape's keys.  A value of 0 (InlineHashtable's EMPTY) marks a
+     * property that has been deleted; its key stays in the shape so that
+     * deletion doesn't change the object's shape or disturb an enumeration
+     * in progress.
+     *
+     * The vector is referenced from the pointer field of the object's
+     * otherwise unused InlineHashtable; see ScriptObject::getDynamicSlots().
+     * It holds references to the values, which the owner releases with
+     * destroy() when it dies, as it would its InlineHashtable's.
+     */
+    class GC_CPP_EXACT(DynamicSlots, MMgc::GCTraceableObject)
+    {
+    public:
+        static const uint32_t kInitialCapacity = 4;
+
+        /** New vector for shape, copying (not re-barriering) old's values if non-NULL. */
+        static DynamicSlots* create(MMgc::GC* gc, DynamicShape* shape, uint32_t capacity, const DynamicSlots* old);
+
+        DynamicShape* shape() const;
+        void setShape(DynamicShape* shape);
+        uint32_t capacity() const;
+
+        /** Value of key, or 0 if absent or deleted. */
+        Atom get(Atom key) const;
+        Atom valueAt(uint32_t i) const;
+        void setValueAt(uint32_t i, Atom value);
+        void deleteAt(uint32_t i);
+
+        /**
+         * Enumeration with the same protocol as InlineHashtable::next(): start
+         * from 0, stop when 0 is returned.
+         *
+         * Keys are only ever appended, so a loop that adds a property on every
+         * step would never end; the index therefore also records how many keys
+         * there were when the enumeration began, and the ones added since are
+         * not visited.
+         */
+        int next(int index) const;
+        Atom keyAtIndex(int index) const;
+        Atom valueAtIndex(int index) const;
+
+        /** Whether next() has handed out an index the loop may still use. */
+        bool isEnumerating() const;
+
+        /** Whether index came from next() rather than from an InlineHashtable. */
+        static bool isShapeIndex(int index);
+
+        /** The position, counting from 1, that an index from next() stands for. */
+        static int positionOf(int index);
+
+        /**
+         * The same enumeration for an object that left shape for the hashtable
+         * ht while it was running: the rest of shape's keys, in shape's order,
+         * that ht still has as enumerable properties.  Pass index through
+         * keyAtIndex() with the same shape for the name.
+         */
+        static int nextUnshaped(const DynamicShape* shape, InlineHashtable* ht, int index);
+        static Atom keyAtIndex(const DynamicShape* shape, InlineHashtable* ht, int index);
+
+        /** Drop the references held by the values; called when the owner dies. */
+        void destroy();
+
+#ifdef DEBUGGER
+        uint64_t bytesUsed() const;
+#endif
+
+    private:
+        DynamicSlots(DynamicShape* shape, uint32_t capacity);
+
+        // enumeration index: kBoundedBit | began << kPositionBits | position
+        static const int kBoundedBit = 1 << 30;
+        static const int kPositionBits = 15;
+        static const int kPositionMask = (1 << kPositionBits) - 1;
+
+    // ------------------------ DATA SECTION BEGIN
+        GC_DATA_BEGIN(DynamicSlots)
+
+    private:
+        GCMember<DynamicShape>      GC_POINTER(m_shape);
+        const uint32_t              m_capacity;
+        mutable bool                m_enumerating;  // next() last returned an index, not 0
+        Atom                        GC_ATOMS(m_values[1], m_capacity);  // actual size is m_capacity
+
+        GC_DATA_END(DynamicSlots)
+    // ------------------------ DATA SECTION END
+    };
+}
+
+#endif /* __avmplus_DynamicShape__ */
@@ -8,6 +8,15 @@
 #include "BuiltinNatives.h"
 #include "TypeDescriber.h"
 
+//GCC only allows intrinsics if sse2 is enabled
+#if (defined(_MSC_VER) || (defined(__GNUC__) && defined(__SSE2__))) && (defined(AVMPLUS_IA32) || defined(AVMPLUS_AMD64))
+    #include <emmintrin.h>
+    #ifdef _MSC_VER
+        #include <intrin.h>
+    #endif
+    #define AVMPLUS_JSON_SSE2
+#endif
+
 namespace avmplus
 {
     // The design in this file is deliberately modeled after
@@ -36,10 +45,11 @@ namespace avmplus
     //    reviver callback has been left as a post-pass in the AS3 glue
     //    code.  (For why the reviver must be left as a post-pass, see
     //    discussion in Lars's original code on Bugzilla 584704.)
-    // 2. The parser makes no attempt to construct instances of AS3
+    // 2. JSON.parse makes no attempt to construct instances of AS3
     //    objects; it closely follows the ECMA-262 5th edition specification
     //    for how parsing behaves.  If the client wants AS3 class instances,
-    //    for now they must construct them via the reviver callback.
+    //    they must construct them via the reviver callback, or the host
+    //    can call JSONClass::parseTyped (see below).
     // 3. Since the reviver callback is a post-pass, control will not
     //    flow into AS3 code from the parser.
     //
@@ -50,15 +60,32 @@ namespace avmplus
     // unmanaged heap memory.
     //
     // The parser maintains a cursor into the input string, representing
-    // the start of the next token to be processed.  When the token
-    // is more than a single character, the entire string associated with
-    // the token is stored in a String object in the parser.
+    // the start of the next token to be processed.  An 8-bit input string
+    // is scanned in place; any other is converted to UTF-8 first.  A
+    // string token only records where its characters are, and the String
+    // is made when the value is used: values are substrings of the input
+    // when possible, and property names are looked up in a small cache of
+    // interned names keyed by the name before them in the same object, so
+    // a run of objects with the same keys interns each key once.  Numbers
+    // are converted straight from the input characters when the result is
+    // exact, which is the common case.
     //
     // Right now the parser only supports parsing String objects.  We will
     // probably generalize it beyond that, initially to ByteArrays and then
     // to classes providing a proper streaming interface to Unicode data.
     // (The IDataInput API does not currently suffice for this.)
     //
+    // JSONClass::parseTyped is the same parser, but a JSON object read
+    // where the target type calls for an instance of a class (that is,
+    // at the top, or for a var of that class type) is stored straight into
+    // a new instance of the class: values for public vars go into their
+    // slots, coerced to the slot type, and other keys are set as
+    // properties, so setters run and a sealed class throws for an unknown
+    // name.  A JSON array read for a Vector.<T> var becomes a Vector.<T>;
+    // a JSON array at the top becomes an Array of instances.  This runs
+    // class constructors and setters, so unlike JSON.parse it can enter
+    // AS3 code.
+    //
     //
     // STRINGIFICATION
     //
@@ -109,6 +136,10 @@ namespace avmplus
         // throws on syntax error.
         Atom parseNative();
 
+        // Entry point for JSONClass::parseTyped; as parseNative, but
+        // reads the value as the instance type of 'type'.
+        Atom parseNativeTyped(ClassClosure* type);
+
         // Value parser.
         //
         // Returns the parsed value, which is one of null, Boolean,
@@ -121,8 +152,35 @@ namespace avmplus
         // Returns Object for successful parse; throws on failed parse.
         ScriptObject* parseObject();
 
-        // Returns Number for successful parse; throws on failed parse.
-        Atom parseFloat(String* v);
+        // Typed value parser.  Reads a JSON object as an instance of
+        // 't' when 't' is a class defined outside the builtins, and a
+        // JSON array as a Vector when 't' is a Vector type; anything
+        // else is read by parseValue.  't' may be NULL (the * type).
+        Atom parseTypedValue(Traits* t);
+
+        // Returns an instance of 'cls' filled in from a JSON object.
+        ScriptObject* parseTypedObject(ClassClosure* cls);
+
+        // Returns an Array (if 'cls' is NULL) or an instance of the
+        // Vector class 'cls' filled in from a JSON array, reading each
+        // element as 'elementType'.
+        ScriptObject* parseTypedArray(ClassClosure* cls, Traits* elementType);
+
+        // The class whose instance type is 't', or NULL if it can't be
+        // found from the domain of the class passed to parseTyped.
+        ClassClosure* closureFor(Traits* t);
+
+        bool isRecordType(Traits* t);
+        bool isVectorType(Traits* t);
+
+        // The String value of the current '"' token.
+        String* stringValue();
+
+        // The interned name for the current '"' token, read as a
+        // property name after 'prev' (NULL for the first name in an
+        // object).  Returns NULL and sets 'index' instead when the name
+        // is an array index.
+        String* propertyName(String* prev, uint32_t& index);
 
         // Scanner.
         // Consumes the next token, stores it in 'token' and 'value'.
@@ -130,16 +188,34 @@ namespace avmplus
         // next token could not be parsed.
         void advance();
         void adv_number();
-        void adv_digits();
+        uint32_t adv_digits();
         void adv_string();
 
         wchar hexDigitValue(wchar c);
         bool isHexDigit(wchar c);
 
+        // m_src may point into m_text's buffer, which AS3 code can
+        // replace (e.g. by interning m_text); reload it after any call
+        // that can run AS3 code.
+        void reloadSource();
+
         void throwParseInputSyntaxError() {
             m_toplevel->syntaxErrorClass()->throwError(kJSONInvalidParseInput);
         }
 
+        // Longest escaped string stringValue() decodes on the stack.
+        static const uint32_t kStackStringSize = 256;
+
+        // stringValue() makes a string without escapes a substring of
+        // m_text only if it is at least 1/kSubstringShare of the input.
+        static const uint32_t kSubstringShare = 4;
+
+        // Size of m_nameCache; must be a power of two.
+        static const uint32_t kNameCacheSize = 64;
+
+        // Size of the m_types cache used by closureFor.
+        static const uint32_t kTypeCacheSize = 8;
+
     private:
         // Notes:
         // - JSONParser class is solely stack-allocated.
@@ -151,15 +227,33 @@ namespace avmplus
 
         Toplevel*  const m_toplevel;
         String*  const m_text;          // The input string
-        StUTF8String m_textUTF8;        // input string as utf8 byte array
-        uint32_t m_i;                   // Current index in 'm_textUTF8'
-        uint32_t const m_len;           // Length of 'm_textUTF8'
+        bool const m_srcIsText;         // m_src is m_text's 8-bit buffer
+        StUTF8String m_textUTF8;        // input string as utf8 byte array, if not m_srcIsText
+        const uint8_t* m_src;           // The characters being scanned
+        uint32_t m_i;                   // Current index in 'm_src'
+        uint32_t const m_len;           // Length of 'm_src'
         bool m_indexValidForText;       // Implies m_i indexes m_text correctly
         char m_token;                   // The current token
 
-        String* m_value;                // Any value associated with
-                                        // the current token (for
-                                        // numbers and strings)
+        // For a '"' token: where its characters are in m_src, and what
+        // the scan found in them.
+        uint32_t m_strStart;
+        uint32_t m_strEnd;
+        bool m_strEscapes;              // has backslash escapes
+        bool m_strHigh;                 // has bytes >= 0x80
+
+        double m_number;                // The value of a '0' token
+
+        // Interned property names, indexed by a hash of the name before
+        // them and their length; see propertyName().
+        String* m_nameCache[kNameCacheSize];
+
+        // For parseTyped: where to look up classes, and the last few
+        // found (a small round-robin cache).
+        DomainEnv* m_domainEnv;
+        Traits* m_typeTraits[kTypeCacheSize];
+        ClassClosure* m_typeClosures[kTypeCacheSize];
+        uint32_t m_typeNext;
     };
 
     // The purpose of ReturnCondition is to signal what end-result
@@ -219,12 +313,16 @@ namespace avmplus
                             bool pendingPropnameColon);
 
         // StrFoundValue is called only if holder[key] == val and is
-        // not undefined.
+        // not undefined.  If quotedKey is not NULL, it holds the
+        // quotedKeyLength bytes of key already quoted and followed by
+        // ':', to emit in place of quoting key.
         ReturnCondition StrFoundValue(Atom val,
                                       Atom key, // key is String or uint32_t
                                       ScriptObject* holder,
                                       String* pendingPrefix,
-                                      bool pendingPropnameColon);
+                                      bool pendingPropnameColon,
+                                      const utf8_t* quotedKey = NULL,
+                                      uint32_t quotedKeyLength = 0);
 
         // Attempts call to method via toplevel.
         // If method throws, returns true.
@@ -234,6 +332,7 @@ namespace avmplus
                              Atom* args,
                              Atom* recv)
         {
+            forgetNoToJSON();
             TRY(core(), kCatchAction_Rethrow)
             {
                 *recv = avmplus::op_call(m_toplevel, *method, argc, args);
@@ -254,6 +353,7 @@ namespace avmplus
                         int32_t argc,
                         Atom* recv)
         {
+            forgetNoToJSON();
             TRY(core(), kCatchAction_Rethrow)
             {
                 *recv = f->AS3_call(*thisAtom, args, argc);
@@ -268,14 +368,92 @@ namespace avmplus
             END_TRY
         }
 
+        // As TryToplevelCall, for a property get that may run a getter.
+        bool TryGetProperty(ScriptObject* holder,
+                            Multiname const* name,
+                            Atom* recv)
+        {
+            forgetNoToJSON();
+            TRY(core(), kCatchAction_Rethrow)
+            {
+                Atom holderAtom = holder->atom();
+                *recv = m_toplevel->getproperty(holderAtom, name, holder->vtable);
+                return false;
+            }
+            CATCH(Exception* exception)
+            {
+                m_exception = exception;
+                return true;
+            }
+            END_CATCH
+            END_TRY
+        }
+
         void Quote(String* value);
+        void QuoteLatin1(const uint8_t* src, uint32_t len);
+        void QuoteUTF8(const utf8_t* src, uint32_t len);
         void QuoteAtomKey(Atom key);
 
+        // The fixed properties JO emits for instances of one Traits:
+        // the readable, non-[Transient] public vars and then accessors,
+        // in the order TypeDescriber lists them.  Each entry has its
+        // name already quoted and followed by ':', and the slot to
+        // read it from when it is a var or const.  Plans are GC
+        // memory, kept alive by the serializer being on the stack.
+        struct JOPlan
+        {
+            struct Entry
+            {
+                String*  name;
+                int32_t  slot;          // -1 if not a var or const
+                uint32_t keyStart;      // offset of "name": in keys
+                uint32_t keyLength;
+            };
+
+            Traits*       traits;
+            const utf8_t* keys;
+            uint32_t      count;
+            bool          ascii;        // keys are all ASCII
+            Entry         entries[1];   // count of them
+        };
+
+        // Size of the m_plans cache used by planFor; must be a power
+        // of two.
+        static const uint32_t kPlanCacheSize = 8;
+
+        JOPlan* planFor(ScriptObject* value);
+
+        // Size of the m_noToJSON cache; must be a power of two.
+        static const uint32_t kNoToJSONCacheSize = 8;
+
+        // True if value is not an object and values of its type
+        // recently found no toJSON to call.  Only AS3 code can give a
+        // prototype a toJSON, so forgetNoToJSON is called before every
+        // callback, and a Proxy (any of whose property reads is one)
+        // found by reachesProxy turns the cache off for the rest of the
+        // stringify.
+        bool knownWithoutToJSON(Atom value) const
+        {
+            if (atomKind(value) == kObjectType || !m_noToJSONCaching)
+                return false;
+            VTable* vtable = m_toplevel->toVTable(value);
+            for (uint32_t i = 0; i < kNoToJSONCacheSize; i++) {
+                if (m_noToJSON[i] == vtable)
+                    return true;
+            }
+            return false;
+        }
+        void rememberWithoutToJSON(Atom value, VTable* vtable);
+        void forgetNoToJSON();
+        // True if obj or an object on its prototype chain is a Proxy.
+        bool reachesProxy(ScriptObject* obj);
+        void addPlanNames(ScriptObject* descs, ArrayObject* names);
+
         ReturnCondition JO(ScriptObject* value);
-        ReturnCondition JODescriptions(ScriptObject* names,
-                                       ScriptObject* value,
-                                       String* pendingPre,
-                                       String* connective);
+        ReturnCondition JOPlanEntry(JOPlan* plan,
+                                    uint32_t i,
+                                    ScriptObject* value,
+                                    String* pendingPrefix);
         ReturnCondition JOProp(Atom p,
                                ScriptObject* value,
                                String* pendingPrefix);
@@ -302,9 +480,14 @@ namespace avmplus
         void emit(char const* buf, uint32_t len);
         void emit(utf8_t const* buf, uint32_t len);
         void emit(String* chars);
+        void emitLatin1(const uint8_t* src, uint32_t len);
+        void emitNumber(double d);
+        void emitEscaped(utf8_t c);
 
         void committedToEmitFor(Atom key, String* pending,
-                                bool pendingPropnameColon);
+                                bool pendingPropnameColon,
+                                const utf8_t* quotedKey,
+                                uint32_t quotedKeyLength);
 
         bool isVectorInstance(ScriptObject* obj);
 
@@ -354,168 +537,74 @@ namespace avmplus
             MMgc::FixedMalloc* m_fixedmalloc;
         };
 
-        // The purpose of Rope is to allow the stringify code to emit
-        // its output incrementally.  Since we do not know a priori
-        // how much output may be associated with a particular input,
-        // we cannot preallocate the output buffer.  So we avoid the
-        // O(n lg n) time blowup (where n is output size) associated
-        // with automatically resizing (and recopying) the target
-        // buffer every time the emission hits the string's capacity
-        // threshold.  Instead we emit to a sequence of fixed length
-        // buffers, and then after emission is complete, we assemble
-        // the final output string in one pass, thus maintaining a
-        // O(n) time bound.  (Unlike some other rope structures, this
-        // uses a list rather than a tree; this works because the
-        // use-case is quite specialized here.)
-        struct Rope
+        // The output is emitted to a single buffer of UTF-8, grown by
+        // doubling so that emitting stays linear in the output size,
+        // and copied into the result String once at the end.  m_ascii
+        // records whether every byte emitted is ASCII, in which case
+        // the copy need not decode UTF-8.
+        //
+        // The buffer is FixedMalloc memory, so it must be freed on
+        // every path out of stringify, including exceptions.
+        struct Output
         {
-            struct Chunk
+            static const uint32_t kInitialCapacity = 4096;
+
+            Output(MMgc::FixedMalloc* fm)
+                : m_buf((utf8_t*)fm->Alloc(kInitialCapacity))
+                , m_len(0)
+                , m_cap(kInitialCapacity)
+                , m_ascii(true)
+                , m_fixedmalloc(fm)
             {
-                typedef utf8_t bufelem_t;
-
-                // Arbitrarily picking BUF_SIZE such that
-                // sizeof(Chunk) is approximately 4096 bytes.
-                static const int32_t BUF_SIZE =
-                    (4096 - 2*sizeof(intptr_t))/sizeof(bufelem_t);
-                // (Alternative BUF_SIZE with small chunks for testing)
-                // static const int32_t BUF_SIZE = 16;
-
-                Chunk* m_next;
-                int32_t m_cursor;
-                bufelem_t m_payload[BUF_SIZE];
-
-                REALLY_INLINE bool exhausted() {
-                    AvmAssert(m_cursor <= BUF_SIZE);
-                    return m_cursor == BUF_SIZE;
-                }
+            }
 
-                // amount of space left in m_payload array
-                // measured in bufelem_t's.
-                REALLY_INLINE int32_t avail() { return BUF_SIZE - m_cursor; }
-
-                REALLY_INLINE int32_t min(int32_t x, int32_t y) { return (x<y)?x:y; }
-
-                // returns amount actually written, measured in bufelem_t's
-                REALLY_INLINE int32_t emit(bufelem_t const* src, int32_t len) {
-                    int32_t write_amt = min(len, avail());
-                    AvmAssert(write_amt > 0);
-                    memcpy(&m_payload[m_cursor],
-                           src,
-                           write_amt*sizeof(bufelem_t));
-                    m_cursor += write_amt;
-                    return write_amt;
-                }
-            };
+            // Makes room for n more bytes, and returns where they go.
+            REALLY_INLINE utf8_t* reserve(uint32_t n) {
+                if (m_cap - m_len < n)
+                    grow(n);
+                return m_buf + m_len;
+            }
 
-            Chunk* newChunk(Chunk* prev) {
-                Chunk* ret = (Chunk*)m_fixedmalloc->Alloc(sizeof(Chunk));
-                prev->m_next = ret;
-                ret->m_next = NULL;
-                ret->m_cursor = 0;
-                return ret;
+            void grow(uint32_t n) {
+                uint64_t cap = uint64_t(m_cap) * 2;
+                if (cap < uint64_t(m_len) + n)
+                    cap = uint64_t(m_len) + n;
+                if (cap > 0x7FFFFFFF)
+                    MMgc::GCHeap::SignalObjectTooLarge();
+                utf8_t* buf = (utf8_t*)m_fixedmalloc->Alloc(size_t(cap));
+                VMPI_memcpy(buf, m_buf, m_len);
+                m_fixedmalloc->Free(m_buf);
+                m_buf = buf;
+                m_cap = uint32_t(cap);
             }
 
-             REALLY_INLINE void emit(char ch) {
-                 utf8_t b = ch;
-                 this->emit(&b, 1);
-             }
-             REALLY_INLINE void emit(utf8_t const* buf, int32_t len) {
-                 while (len > 0) {
-                     int32_t wrote = m_ropeEnd->emit(buf, len);
-                     len -= wrote;
-                     AvmAssert(len >= 0);
-                     buf += wrote;
-                     m_len += wrote;
-                     if (m_ropeEnd->exhausted()) {
-                         Chunk* newchunk = newChunk(m_ropeEnd);
-                         m_ropeEnd = newchunk;
-                     }
-                 }
-             }
-
-             String* toStringViaConcat(AvmCore* core) {
-                 char* concatenated = concat();
-                 int32_t len = length();
-                 String* str = core->newStringUTF8(concatenated, len);
-                 m_fixedmalloc->Free(concatenated);
-                 return str;
-             }
+            REALLY_INLINE void emit(char ch) {
+                *reserve(1) = utf8_t(ch);
+                m_len++;
+            }
 
-#if 0
-             // Bugzilla 650918: toStringViaAppend() avoids building
-             // intermediate concatenated array; but auto-growing
-             // strings suffer O(n lg n) time cost, versus O(n) for
-             // toStringViaConcat() above.  If String constructor had
-             // parameter for initial capacity, then below could win.
-             //
-             // (It would need to be vetted for correctness, of course;
-             //  in particular, multi-byte codepoints at the edges of
-             //  chunks would need to be addressed.)
-             String* toStringViaAppend(AvmCore* core) {
-                 Chunk* c = m_ropeStart;
-                 String* str = core->newStringUTF8(c->m_payload,
-                                                   c->m_cursor);
-                 c = c->m_next;
-                 while (c != NULL) {
-                     str = str->appendLatin1(c->m_payload, c->m_cursor);
-                     c = c->m_next;
-                 }
-                 return str;
-             }
-#endif
-             int32_t length() { return m_len; }
-             int32_t checkLength() {
-                 int32_t ret = 0;
-                 Chunk* r = m_ropeStart;
-                 while (r != NULL) {
-                     ret += r->m_cursor;
-                     r = r->m_next;
-                 }
-                 return ret;
-             }
-
-             // it is responsbility of caller to free the returned buffer!
-             char* concat() {
-                 AvmAssert(checkLength() == m_len);
-                 char* dst = (char*)m_fixedmalloc->Alloc(m_len);
-                 char* end = dst;
-                 Chunk* r = m_ropeStart;
-                 while (r != NULL) {
-                     memcpy(end, r->m_payload, r->m_cursor);
-                     end += r->m_cursor;
-                     r = r->m_next;
-                 }
-                 return dst;
-             }
-
-             void freeChunks() {
-                 Chunk* r = m_ropeStart;
-                 Chunk* next;
-                 while (r != NULL) {
-                     next = r->m_next;
-                     m_fixedmalloc->Free(r);
-                     r = next;
-                 }
-                 m_ropeStart = NULL;
-                 m_ropeEnd   = NULL;
-             }
-
-             Rope(MMgc::FixedMalloc* fm)
-                 : m_fixedmalloc(fm)
-                 , m_len(0)
-             {
-                 Chunk* firstChunk = (Chunk*)fm->Alloc(sizeof(Chunk));
-                 firstChunk->m_next = NULL;
-                 firstChunk->m_cursor = 0;
-                 m_ropeStart = firstChunk;
-                 m_ropeEnd   = m_ropeStart;
-             }
-
-             Chunk*             m_ropeStart;
-             Chunk*             m_ropeEnd;
-             MMgc::FixedMalloc* m_fixedmalloc;
-             int32_t            m_len;
-         };
+            REALLY_INLINE void emit(utf8_t const* buf, uint32_t len) {
+                VMPI_memcpy(reserve(len), buf, len);
+                m_len += len;
+            }
+
+            String* toString(AvmCore* core) {
+                if (m_ascii)
+                    return core->newStringLatin1((const char*)m_buf, int32_t(m_len));
+                return core->newStringUTF8((const char*)m_buf, int32_t(m_len));
+            }
+
+            void free() {
+                m_fixedmalloc->Free(m_buf);
+                m_buf = NULL;
+            }
+
+            utf8_t*            m_buf;
+            uint32_t           m_len;
+            uint32_t           m_cap;
+            bool               m_ascii;
+            MMgc::FixedMalloc* m_fixedmalloc;
+        };
 
 
     private:
@@ -548,9 +637,17 @@ namespace avmplus
 
         MMgc::FixedMalloc*     m_fixedmalloc;
 
+        JOPlan*          m_plans[kPlanCacheSize];
+        uint32_t         m_planNext;
+
+        VTable*          m_noToJSON[kNoToJSONCacheSize];
+        uint32_t         m_noToJSONNext;
+        bool             m_noToJSONCaching;
+
         // These should *only* be written-to by the emit methods
-        // and only read-from by the stringify method.
-        Rope m_rope;
+        // and only read-from by the stringify method (and planFor,
+        // which quotes names into it and takes them back out).
+        Output m_out;
     };
 
     JSONClass::JSONClass(VTable* cvtable)
@@ -570,6 +667,12 @@ namespace avmplus
         return parser.parseNative();
     }
 
+    Atom JSONClass::parseTyped(String* text, ClassClosure* type)
+    {
+        JSONParser parser(vtable->toplevel(), text);
+        return parser.parseNativeTyped(type);
+    }
+
     String* JSONClass::stringifySpecializedToString(Atom value,
                                                     ArrayObject* proplist,
                                                     FunctionObject* replacer,
@@ -584,13 +687,25 @@ namespace avmplus
     JSONParser::JSONParser(Toplevel* toplevel, String* text)
         : m_toplevel(toplevel)
         , m_text(text)
-        , m_textUTF8(text)
+        , m_srcIsText(text->getWidth() == String::k8)
+        , m_textUTF8(m_srcIsText ? Stringp(toplevel->core()->kEmptyString) : text)
+        , m_src(m_srcIsText ? String::Pointers(text).p8 : (const uint8_t*)m_textUTF8.c_str())
         , m_i(0)
-        , m_len(uint32_t(m_textUTF8.length()))
+        , m_len(m_srcIsText ? uint32_t(text->length()) : uint32_t(m_textUTF8.length()))
         , m_indexValidForText(true)
         , m_token('\0')
-        , m_value(NULL)
-    { }
+        , m_strStart(0)
+        , m_strEnd(0)
+        , m_strEscapes(false)
+        , m_strHigh(false)
+        , m_number(0)
+        , m_domainEnv(NULL)
+        , m_typeNext(0)
+    {
+        VMPI_memset(m_nameCache, 0, sizeof(m_nameCache));
+        VMPI_memset(m_typeTraits, 0, sizeof(m_typeTraits));
+        VMPI_memset(m_typeClosures, 0, sizeof(m_typeClosures));
+    }
 
         // If the reviver is null then the parser returns null, Boolean, Number/int/uint, String, Array, or Object.
 
@@ -607,6 +722,34 @@ namespace avmplus
         return atom;
     }
 
+    Atom JSONParser::parseNativeTyped(ClassClosure* type)
+    {
+        // Classes named by the JSON's target types are looked up where
+        // the caller's code would find them, else where 'type' is defined.
+        CodeContext* codeContext = m_toplevel->core()->codeContext();
+        if (codeContext != NULL)
+            m_domainEnv = codeContext->domainEnv();
+        else if (type->vtable->init != NULL)
+            m_domainEnv = type->vtable->init->domainEnv();
+
+        Traits* t = type->ivtable()->traits;
+        m_typeTraits[0] = t;
+        m_typeClosures[0] = type;
+        m_typeNext = 1;
+
+        advance();
+        Atom atom;
+        if (m_token == '[' && isRecordType(t))
+            atom = parseTypedArray(NULL, t)->atom();
+        else
+            atom = parseTypedValue(t);
+
+        if (m_token != '\0')
+            throwParseInputSyntaxError();
+
+        return atom;
+    }
+
     // Value parser.
     //
     // Returns the parsed value, which is one of null, Boolean,
@@ -625,7 +768,6 @@ namespace avmplus
     {
         m_toplevel->core()->stackCheck(m_toplevel);
 
-        String* v;
         switch (m_token) {
         case 'n':
             advance();
@@ -636,14 +778,16 @@ namespace avmplus
         case 'f':
             advance();
             return falseAtom;
-        case '"':
-            v = m_value;
+        case '"': {
+            String* v = stringValue();
             advance();
-            return v->toAtom();
-        case '0':
-            v = m_value;
+            return v->atom();
+        }
+        case '0': {
+            double d = m_number;
             advance();
-            return parseFloat(v);
+            return m_toplevel->core()->doubleToAtom(d);
+        }
         case '{': {
             ScriptObject* obj = parseObject();
             AvmAssert(obj != NULL);
@@ -660,18 +804,6 @@ namespace avmplus
         }
     }
 
-    Atom JSONParser::parseFloat(String* s)
-    {
-        AvmAssert(s != NULL);
-        double result;
-
-        // Returning kNaN becuase that matches behavior of parseFloat.
-        if (!MathUtils::convertStringToDouble(s, &result, false))
-            result = MathUtils::kNaN;
-
-        return m_toplevel->core()->doubleToAtom(result);
-    }
-
     ArrayObject* JSONParser::parseArray()
     {
         advance();
@@ -699,13 +831,15 @@ namespace avmplus
         Atom oa = m_toplevel->objectClass->constructObject();
         ScriptObject* o = AvmCore::atomToScriptObject(oa);
         if (m_token != '}') {
+            String* prev = NULL;
             for (;;) {
-                // Could short-cut the string alloc when result is
-                // parseIndex-able (e.g. specialized digits parser).
-                Atom name = parseValue();
-
-                if (! AvmCore::isString(name))
+                if (m_token != '"')
                     throwParseInputSyntaxError();
+
+                uint32_t index;
+                String* name = propertyName(prev, index);
+
+                advance();
                 if (m_token != ':')
                     throwParseInputSyntaxError();
 
@@ -714,12 +848,11 @@ namespace avmplus
                 Atom val = parseValue();
 
                 // Avoid interning if property name is parseIndex-able.
-                uint32_t recv;
-                if (m_toplevel->core()->atomToString(name)->parseIndex(recv)) {
-                    o->setUintProperty(recv, val);
+                if (name == NULL) {
+                    o->setUintProperty(index, val);
                 } else {
-                    name = m_toplevel->core()->intern(name)->atom();
-                    o->setAtomProperty(name, val);
+                    o->setAtomProperty(name->atom(), val);
+                    prev = name;
                 }
                 if (m_token != ',')
                     break;
@@ -733,6 +866,329 @@ namespace avmplus
         return o;
     }
 
+    Atom JSONParser::parseTypedValue(Traits* t)
+    {
+        m_toplevel->core()->stackCheck(m_toplevel);
+
+        if (t != NULL) {
+            if (m_token == '{' && isRecordType(t)) {
+                ClassClosure* cls = closureFor(t);
+                if (cls != NULL)
+                    return parseTypedObject(cls)->atom();
+            } else if (m_token == '[' && isVectorType(t)) {
+                ClassClosure* cls = closureFor(t);
+                if (cls != NULL)
+                    return parseTypedArray(cls, t->m_paramTraits)->atom();
+            }
+        }
+        return parseValue();
+    }
+
+    ScriptObject* JSONParser::parseTypedObject(ClassClosure* cls)
+    {
+        advance();
+
+        ScriptObject* o = cls->constructObject();
+        reloadSource();
+
+        TraitsBindingsp td = o->traits()->getTraitsBindings();
+        Namespacep publicNS = m_toplevel->core()->findPublicNamespace();
+        if (m_token != '}') {
+            String* prev = NULL;
+            for (;;) {
+                if (m_token != '"')
+                    throwParseInputSyntaxError();
+
+                uint32_t index;
+                String* name = propertyName(prev, index);
+
+                advance();
+                if (m_token != ':')
+                    throwParseInputSyntaxError();
+
+                advance();
+
+                Binding b = name != NULL ? td->findBinding(name, publicNS) : BIND_NONE;
+                if (AvmCore::isVarBinding(b)) {
+                    uint32_t slot = AvmCore::bindingToSlotId(b);
+                    Atom val = parseTypedValue(td->getSlotTraits(slot));
+                    o->coerceAndSetSlotAtom(slot, val);
+                } else {
+                    // Setters, consts and dynamic properties, with the
+                    // errors an assignment in AS3 would give.
+                    Atom val = parseValue();
+                    if (name != NULL)
+                        m_toplevel->setpropname(o->atom(), name, val);
+                    else
+                        o->setUintProperty(index, val);
+                }
+                reloadSource();
+
+                if (name != NULL)
+                    prev = name;
+                if (m_token != ',')
+                    break;
+                advance();
+            }
+        }
+        if (m_token != '}')
+            throwParseInputSyntaxError();
+
+        advance();
+        return o;
+    }
+
+    ScriptObject* JSONParser::parseTypedArray(ClassClosure* cls, Traits* elementType)
+    {
+        advance();
+
+        ScriptObject* a;
+        if (cls == NULL) {
+            a = m_toplevel->arrayClass()->newArray();
+        } else {
+            a = cls->constructObject();
+            reloadSource();
+        }
+        if (m_token != ']') {
+            for (uint32_t i = 0; ; i++) {
+                Atom val = parseTypedValue(elementType);
+                a->setUintProperty(i, val);
+                reloadSource();
+                if (m_token != ',')
+                    break;
+                advance();
+            }
+        }
+        if (m_token != ']')
+            throwParseInputSyntaxError();
+        advance();
+        return a;
+    }
+
+    bool JSONParser::isRecordType(Traits* t)
+    {
+        // Builtin classes have native parts that a JSON object can't
+        // describe; those are left to parseValue (and the coercion to
+        // the slot type).
+        return t->isInstanceType() && !t->isInterface() && !t->pool->isBuiltin && !isVectorType(t);
+    }
+
+    bool JSONParser::isVectorType(Traits* t)
+    {
+        if (t->m_paramTraits != NULL)
+            return true;
+        switch (t->builtinType) {
+        case BUILTIN_vectordouble:
+#ifdef VMCFG_FLOAT
+        case BUILTIN_vectorfloat:
+        case BUILTIN_vectorfloat4:
+#endif
+        case BUILTIN_vectorint:
+        case BUILTIN_vectorobj:
+        case BUILTIN_vectoruint:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    ClassClosure* JSONParser::closureFor(Traits* t)
+    {
+        for (uint32_t i = 0; i < kTypeCacheSize; i++) {
+            if (m_typeTraits[i] == t)
+                return m_typeClosures[i];
+        }
+
+        ClassClosure* cls = NULL;
+        if (t->m_paramTraits != NULL) {
+            ClassClosure* elementClass = closureFor(t->m_paramTraits);
+            if (elementClass != NULL)
+                cls = m_toplevel->vectorClass()->getTypedVectorClass(elementClass);
+        } else {
+            switch (t->builtinType) {
+            case BUILTIN_vectordouble:
+                cls = m_toplevel->doubleVectorClass();
+                break;
+#ifdef VMCFG_FLOAT
+            case BUILTIN_vectorfloat:
+                cls = m_toplevel->floatVectorClass();
+                break;
+            case BUILTIN_vectorfloat4:
+                cls = m_toplevel->float4VectorClass();
+                break;
+#endif
+            case BUILTIN_vectorint:
+                cls = m_toplevel->intVectorClass();
+                break;
+            case BUILTIN_vectorobj:
+                cls = m_toplevel->objectVectorClass();
+                break;
+            case BUILTIN_vectoruint:
+                cls = m_toplevel->uintVectorClass();
+                break;
+            default:
+                if (m_domainEnv != NULL) {
+                    // cf. MethodEnv::finddef
+                    AvmCore* core = m_toplevel->core();
+                    Multiname mn(t->ns(), t->name());
+                    ScriptEnv* script = core->domainMgr()->findScriptEnvInDomainEnvByMultiname(m_domainEnv, mn);
+                    if (script != NULL) {
+                        ScriptObject* global = script->global;
+                        if (!global) {
+                            global = script->initGlobal();
+                            script->coerceEnter(global->atom());
+                        }
+                        Atom a = m_toplevel->getproperty(global->atom(), &mn, global->vtable);
+                        reloadSource();
+                        if (AvmCore::isObject(a) && AvmCore::atomToScriptObject(a)->traits()->itraits == t)
+                            cls = (ClassClosure*)AvmCore::atomToScriptObject(a);
+                    }
+                }
+                break;
+            }
+        }
+
+        m_typeTraits[m_typeNext] = t;
+        m_typeClosures[m_typeNext] = cls;
+        m_typeNext = (m_typeNext + 1) & (kTypeCacheSize - 1);
+        return cls;
+    }
+
+    REALLY_INLINE void JSONParser::reloadSource()
+    {
+        if (m_srcIsText)
+            m_src = String::Pointers(m_text).p8;
+    }
+
+    String* JSONParser::stringValue()
+    {
+        AvmAssert(m_token == '"');
+        AvmCore* core = m_toplevel->core();
+
+        if (!m_strEscapes) {
+            // A substring keeps all of m_text alive for as long as the
+            // value lives, so only a value that is a large share of the
+            // input shares its characters; the rest are copied.
+            uint32_t const len = m_strEnd - m_strStart;
+            if ((m_srcIsText || m_indexValidForText) && len >= m_len / kSubstringShare)
+                return m_text->substring(m_strStart, m_strEnd);
+            if (m_srcIsText)
+                return core->newStringLatin1((const char*)&m_src[m_strStart], int32_t(len));
+            return core->newStringUTF8((const char*)&m_src[m_strStart], int32_t(len));
+        }
+
+        // adv_string has checked the escapes.  A short string whose
+        // bytes are characters is decoded on the stack and made in one go.
+        if ((m_srcIsText || !m_strHigh) && m_strEnd - m_strStart <= kStackStringSize) {
+            wchar chars[kStackStringSize];
+            int32_t n = 0;
+            for (uint32_t i = m_strStart; i < m_strEnd; i++) {
+                wchar c = m_src[i];
+                if (c == '\\') {
+                    switch (c = m_src[++i]) {
+                    case  'b': c = '\b'; break;
+                    case  'f': c = '\f'; break;
+                    case  'n': c = '\n'; break;
+                    case  'r': c = '\r'; break;
+                    case  't': c = '\t'; break;
+                    case  'u':
+                        c = wchar((hexDigitValue(m_src[i+1]) << 12)
+                                  + (hexDigitValue(m_src[i+2]) << 8)
+                                  + (hexDigitValue(m_src[i+3]) << 4)
+                                  + (hexDigitValue(m_src[i+4])));
+                        i += 4;
+                        break;
+                    default:    // '"', '/' and '\\' stand for themselves
+                        break;
+                    }
+                }
+                chars[n++] = c;
+            }
+            return core->newStringUTF16(chars, n);
+        }
+
+        String* buffer = core->newStringLatin1("");
+        uint32_t start = m_strStart;
+        uint32_t i = m_strStart;
+        while (i < m_strEnd) {
+            if (m_src[i] != '\\') {
+                i++;
+                continue;
+            }
+            if (m_srcIsText || m_indexValidForText)
+                buffer = buffer->append(m_text->substring(start, i));
+            else
+                buffer = buffer->append
+                    (core->newStringUTF8((const char*)&m_src[start], i - start));
+            i++;
+            switch (m_src[i]) {
+            case  '"': buffer = buffer->appendLatin1("\""); break;
+            case  '/': buffer = buffer->appendLatin1("/"); break;
+            case '\\': buffer = buffer->appendLatin1("\\"); break;
+            case  'b': buffer = buffer->appendLatin1("\b"); break;
+            case  'f': buffer = buffer->appendLatin1("\f"); break;
+            case  'n': buffer = buffer->appendLatin1("\n"); break;
+            case  'r': buffer = buffer->appendLatin1("\r"); break;
+            case  't': buffer = buffer->appendLatin1("\t"); break;
+            default: {
+                AvmAssert(m_src[i] == 'u');
+                wchar charcode =
+                    wchar((hexDigitValue(m_src[i+1]) << 12)
+                          + (hexDigitValue(m_src[i+2]) << 8)
+                          + (hexDigitValue(m_src[i+3]) << 4)
+                          + (hexDigitValue(m_src[i+4])));
+
+                // FSK: copied below from AS3_fromCharCode
+                // note: this code is allowed to construct a string
+                // containing illegal UTF16 sequences!
+                //
+                // FSK: I copied the note, but really should
+                // check if the example from AS3_fromCharCode also
+                // applies here, and if so, what does that imply
+                // about the JSON parser?
+                buffer = buffer->append16(&charcode, 1);
+                i += 4;
+                break;
+            }
+            }
+            i++;
+            start = i;
+        }
+        if (m_srcIsText || m_indexValidForText)
+            buffer = buffer->append(m_text->substring(start, m_strEnd));
+        else
+            buffer = buffer->append
+                (core->newStringUTF8((const char*)&m_src[start], m_strEnd - start));
+        return buffer;
+    }
+
+    String* JSONParser::propertyName(String* prev, uint32_t& index)
+    {
+        AvmAssert(m_token == '"');
+        AvmCore* core = m_toplevel->core();
+        int32_t const len = int32_t(m_strEnd - m_strStart);
+        const char* const chars = (const char*)&m_src[m_strStart];
+
+        // Only a name starting with a digit can be an array index; those,
+        // and names that aren't plain Latin-1 in m_src, go the long way.
+        if (m_strEscapes || (m_strHigh && !m_srcIsText) || (len > 0 && chars[0] >= '0' && chars[0] <= '9')) {
+            String* s = stringValue();
+            if (s->parseIndex(index))
+                return NULL;
+            return core->internString(s);
+        }
+
+        // Objects with the same keys in the same order hit the same
+        // entries, so each key is only interned once per parse.
+        uint32_t const h = (uint32_t(uintptr_t(prev) >> 3) * 31 + uint32_t(len)) & (kNameCacheSize - 1);
+        String* name = m_nameCache[h];
+        if (name == NULL || !name->equalsLatin1(chars, len)) {
+            name = core->internStringLatin1(chars, len);
+            m_nameCache[h] = name;
+        }
+        return name;
+    }
+
 
         // Scanner.
         // Consumes the next token, stores it in 'token' and 'value'.
@@ -745,7 +1201,7 @@ namespace avmplus
         m_token = '\0';
 
         while (m_i < m_len) {
-            char c = m_textUTF8.c_str()[m_i];
+            char c = char(m_src[m_i]);
             switch (c) {
             case '\t':
             case '\n':
@@ -781,9 +1237,9 @@ namespace avmplus
                 return;
             case 'n':
                 if (m_i+3 < m_len &&
-                    m_textUTF8.c_str()[m_i+1] == 'u' &&
-                    m_textUTF8.c_str()[m_i+2] == 'l' &&
-                    m_textUTF8.c_str()[m_i+3] == 'l')
+                    m_src[m_i+1] == 'u' &&
+                    m_src[m_i+2] == 'l' &&
+                    m_src[m_i+3] == 'l')
                 {
                     m_i += 4;
                     m_token = 'n';
@@ -793,9 +1249,9 @@ namespace avmplus
                 }
             case 't':
                 if (m_i+3 < m_len &&
-                    m_textUTF8.c_str()[m_i+1] == 'r' &&
-                    m_textUTF8.c_str()[m_i+2] == 'u' &&
-                    m_textUTF8.c_str()[m_i+3] == 'e')
+                    m_src[m_i+1] == 'r' &&
+                    m_src[m_i+2] == 'u' &&
+                    m_src[m_i+3] == 'e')
                 {
                     m_i += 4;
                     m_token = 't';
@@ -805,10 +1261,10 @@ namespace avmplus
                 }
             case 'f':
                 if (m_i+4 < m_len &&
-                    m_textUTF8.c_str()[m_i+1] == 'a' &&
-                    m_textUTF8.c_str()[m_i+2] == 'l' &&
-                    m_textUTF8.c_str()[m_i+3] == 's' &&
-                    m_textUTF8.c_str()[m_i+4] == 'e')
+                    m_src[m_i+1] == 'a' &&
+                    m_src[m_i+2] == 'l' &&
+                    m_src[m_i+3] == 's' &&
+                    m_src[m_i+4] == 'e')
                 {
                     m_i += 5;
                     m_token = 'f';
@@ -822,109 +1278,170 @@ namespace avmplus
         }
     }
 
+    // Powers of ten that are exact as doubles.
+    static const double kJSONPowersOfTen[23] = { 1, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10,
+                                                 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20,
+                                                 1e21, 1e22 };
+
     void JSONParser::adv_number() {
         uint32_t start = m_i;
         uint32_t c;
 
-        if (m_textUTF8.c_str()[m_i] == '-')
+        bool negative = false;
+        if (m_src[m_i] == '-') {
+            negative = true;
             m_i++;
+        }
 
-        adv_digits();
+        uint32_t const digitsStart = m_i;
+        uint32_t digits = adv_digits();
+        uint32_t const intEnd = m_i;
+        uint32_t fractionDigits = 0;
 
-        if (m_i < m_len && m_textUTF8.c_str()[m_i] == '.') {
+        if (m_i < m_len && m_src[m_i] == '.') {
             m_i++;
-            adv_digits();
+            fractionDigits = adv_digits();
+            digits += fractionDigits;
         }
-
-        if (m_i < m_len && ((c = m_textUTF8.c_str()[m_i]) == 'e' || c == 'E')) {
+        uint32_t const digitsEnd = m_i;
+
+        // MathUtils::convertStringToDouble computes a number with at most
+        // 15 digits as the digits times or divided by a power of ten, which
+        // is exact when that power is in kJSONPowersOfTen.  Do the same
+        // here without making a String; otherwise let it do the work.
+        bool fast = digits <= 15;
+        int32_t exponent = 0;
+        if (m_i < m_len && ((c = m_src[m_i]) == 'e' || c == 'E')) {
             m_i++;
-            if (m_i < m_len && ((c = m_textUTF8.c_str()[m_i]) == '-' || c == '+'))
+            bool negativeExponent = false;
+            if (m_i < m_len && ((c = m_src[m_i]) == '-' || c == '+')) {
+                negativeExponent = c == '-';
                 m_i++;
-            adv_digits();
+            }
+            uint32_t const exponentStart = m_i;
+            if (adv_digits() > 3)
+                fast = false;
+            else
+                for (uint32_t i = exponentStart; i < m_i; i++)
+                    exponent = exponent * 10 + int32_t(m_src[i] - '0');
+            if (negativeExponent)
+                exponent = -exponent;
         }
+        exponent -= int32_t(fractionDigits);
 
-        if (m_indexValidForText)
-            m_value = m_text->substring(start, m_i);
-        else
-            m_value = m_toplevel->core()->newStringUTF8(&m_textUTF8.c_str()[start], m_i - start);
+        if (fast && exponent >= -22 && exponent <= 22) {
+            uint64_t mantissa = 0;
+            for (uint32_t i = digitsStart; i < digitsEnd; i++) {
+                if (i != intEnd)
+                    mantissa = mantissa * 10 + (m_src[i] - '0');
+            }
+            double result = double(mantissa);
+            if (exponent >= 0)
+                result *= kJSONPowersOfTen[exponent];
+            else
+                result /= kJSONPowersOfTen[-exponent];
+            m_number = negative ? -result : result;
+        } else {
+            // Number literals are ASCII in UTF-8 too.
+            String* s = m_toplevel->core()->newStringLatin1((const char*)&m_src[start], m_i - start);
+            // Returning kNaN becuase that matches behavior of parseFloat.
+            if (!MathUtils::convertStringToDouble(s, &m_number, false))
+                m_number = MathUtils::kNaN;
+        }
 
         m_token = '0';
     }
 
-    void JSONParser::adv_digits()
+    uint32_t JSONParser::adv_digits()
     {
         uint32_t start = m_i;
         uint32_t c;
 
-        while (m_i < m_len && ((c = m_textUTF8.c_str()[m_i]) >= 48 && c <= 57))
+        while (m_i < m_len && ((c = m_src[m_i]) >= 48 && c <= 57))
             m_i++;
 
         if (m_i <= start)
             throwParseInputSyntaxError();
+
+        return m_i - start;
+    }
+
+#ifdef AVMPLUS_JSON_SSE2
+    /*static*/ REALLY_INLINE uint32_t lowestBit(uint32_t bits)
+    {
+        AvmAssert(bits != 0);
+    #ifdef _MSC_VER
+        unsigned long i;
+        _BitScanForward(&i, bits);
+        return uint32_t(i);
+    #else
+        return uint32_t(__builtin_ctz(bits));
+    #endif
     }
+#endif
 
     void JSONParser::adv_string()
     {
-        uint32_t start;
-        String* buffer = m_toplevel->core()->newStringLatin1("");
+        bool escapes = false;
+        bool high = false;
 
         // Consume the initial double-quote
         m_i++;
 
-        start = m_i;
-        while (m_i < m_len) {
-            uint32_t c = m_textUTF8.c_str()[m_i];
-            if (c < 32)
+        m_strStart = m_i;
+        for (;;) {
+#ifdef AVMPLUS_JSON_SSE2
+            // Skip sixteen characters at a time up to the next quote,
+            // backslash or control character.
+            while (m_i + 16 <= m_len) {
+                __m128i v = _mm_loadu_si128((const __m128i*)&m_src[m_i]);
+                __m128i stops = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('"')),
+                                                          _mm_cmpeq_epi8(v, _mm_set1_epi8('\\'))),
+                                             _mm_cmpeq_epi8(_mm_subs_epu8(v, _mm_set1_epi8(31)), _mm_setzero_si128()));
+                uint32_t stop = uint32_t(_mm_movemask_epi8(stops));
+                uint32_t highs = uint32_t(_mm_movemask_epi8(v));
+                if (stop != 0) {
+                    uint32_t n = lowestBit(stop);
+                    high |= (highs & ((1U << n) - 1)) != 0;
+                    m_i += n;
+                    break;
+                }
+                high |= highs != 0;
+                m_i += 16;
+            }
+#endif
+            if (m_i == m_len)
                 throwParseInputSyntaxError();
-            if (c >= 128)
-                m_indexValidForText = false;
+            uint32_t c = m_src[m_i];
             if (c == 34)    // double-quote
                 break;
+            if (c < 32)
+                throwParseInputSyntaxError();
+            if (c >= 128)
+                high = true;
             if (c == 92)  { // backslash
-                if (m_indexValidForText)
-                    buffer = buffer->append(m_text->substring(start, m_i));
-                else
-                    buffer = buffer->append
-                        (m_toplevel->core()->newStringUTF8
-                         (&m_textUTF8.c_str()[start], m_i - start));
+                escapes = true;
                 m_i++;
                 if (m_i == m_len)
                     throwParseInputSyntaxError();
-                switch (c = m_textUTF8.c_str()[m_i]) {
-                case  '"': buffer = buffer->appendLatin1("\""); break;
-                case  '/': buffer = buffer->appendLatin1("/"); break;
-                case '\\': buffer = buffer->appendLatin1("\\"); break;
-                case  'b': buffer = buffer->appendLatin1("\b"); break;
-                case  'f': buffer = buffer->appendLatin1("\f"); break;
-                case  'n': buffer = buffer->appendLatin1("\n"); break;
-                case  'r': buffer = buffer->appendLatin1("\r"); break;
-                case  't': buffer = buffer->appendLatin1("\t"); break;
+                switch (m_src[m_i]) {
+                case  '"':
+                case  '/':
+                case '\\':
+                case  'b':
+                case  'f':
+                case  'n':
+                case  'r':
+                case  't':
+                    break;
                 case  'u':
-                    m_i++;
-                    wchar d1, d2, d3, d4;
-                    if (m_i + 3 < m_len &&
-                        isHexDigit(d1 = m_textUTF8.c_str()[m_i]) &&
-                        isHexDigit(d2 = m_textUTF8.c_str()[m_i+1]) &&
-                        isHexDigit(d3 = m_textUTF8.c_str()[m_i+2]) &&
-                        isHexDigit(d4 = m_textUTF8.c_str()[m_i+3]))
+                    if (m_i + 4 < m_len &&
+                        isHexDigit(m_src[m_i+1]) &&
+                        isHexDigit(m_src[m_i+2]) &&
+                        isHexDigit(m_src[m_i+3]) &&
+                        isHexDigit(m_src[m_i+4]))
                     {
-                        wchar charcode =
-                            wchar((hexDigitValue(d1) << 12)
-                                  + (hexDigitValue(d2) << 8)
-                                  + (hexDigitValue(d3) << 4)
-                                  + (hexDigitValue(d4)));
-
-                        // FSK: copied below from AS3_fromCharCode
-                        // note: this code is allowed to construct a string
-                        // containing illegal UTF16 sequences!
-                        //
-                        // FSK: I copied the note, but really should
-                        // check if the example from AS3_fromCharCode also
-                        // applies here, and if so, what does that imply
-                        // about the JSON parser?
-                        buffer = buffer->append16(&charcode, 1);
-
-                        m_i += 3;
+                        m_i += 4;
                         break;
                     }
                     else
@@ -934,24 +1451,18 @@ namespace avmplus
                 default:
                     throwParseInputSyntaxError();
                 }
-                m_i++;
-                start = m_i;
             }
-            else
-                m_i++;
+            m_i++;
         }
-        if (m_indexValidForText)
-            buffer = buffer->append(m_text->substring(start, m_i));
-        else
-            buffer = buffer->append
-                (m_toplevel->core()->newStringUTF8
-                 (&m_textUTF8.c_str()[start], m_i - start));
+        m_strEnd = m_i;
+        m_strEscapes = escapes;
+        m_strHigh = high;
+        if (high && !m_srcIsText)
+            m_indexValidForText = false;
 
-        if (m_i == m_len || m_textUTF8.c_str()[m_i] != 34)  // double-quote
-            throwParseInputSyntaxError();
+        // Consume the closing double-quote
         m_i++;
 
-        m_value = buffer;
         m_token = '\"';
     }
 
@@ -992,8 +1503,14 @@ namespace avmplus
         , m_gap(gap)
         , m_exception(NULL)
         , m_fixedmalloc(MMgc::FixedMalloc::GetFixedMalloc())
-        , m_rope(m_fixedmalloc)
+        , m_planNext(0)
+        , m_noToJSONNext(0)
+        , m_noToJSONCaching(true)
+        , m_out(m_fixedmalloc)
     {
+        for (uint32_t i = 0; i < kPlanCacheSize; i++)
+            m_plans[i] = NULL;
+        forgetNoToJSON();
         m_indent = emptyString();
         m_activeValues = HeapHashtable::create(core()->GetGC());
 
@@ -1027,24 +1544,61 @@ namespace avmplus
 
     REALLY_INLINE void JSONSerializer::emit(char c)
     {
-        m_rope.emit(c);
+        m_out.emit(c);
     }
 
     REALLY_INLINE void JSONSerializer::emit(char const* buf, uint32_t len)
     {
-        m_rope.emit((utf8_t const*)buf, len);
+        m_out.emit((utf8_t const*)buf, len);
     }
 
     REALLY_INLINE void JSONSerializer::emit(utf8_t const* buf, uint32_t len)
     {
-        m_rope.emit(buf, len);
+        m_out.emit(buf, len);
     }
 
-    REALLY_INLINE void JSONSerializer::emit(String* chars)
+    void JSONSerializer::emit(String* chars)
     {
-        StUTF8String charsUTF8(chars);
-        int32_t len = charsUTF8.length();
-        m_rope.emit((const utf8_t*)charsUTF8.c_str(), len);
+        if (chars->getWidth() == String::k8) {
+            String::Pointers ptrs(chars);
+            emitLatin1(ptrs.p8, chars->length());
+        } else {
+            StUTF8String charsUTF8(chars);
+            m_out.m_ascii = false;
+            m_out.emit((const utf8_t*)charsUTF8.c_str(), charsUTF8.length());
+        }
+    }
+
+    // Emits Latin-1 characters as UTF-8.
+    void JSONSerializer::emitLatin1(const uint8_t* src, uint32_t len)
+    {
+        uint32_t start = 0;
+        for (uint32_t i = 0; i < len; i++) {
+            uint8_t c = src[i];
+            if (c < 0x80)
+                continue;
+            m_out.emit(&src[start], i - start);
+            utf8_t* dst = m_out.reserve(2);
+            dst[0] = utf8_t(0xC0 | (c >> 6));
+            dst[1] = utf8_t(0x80 | (c & 0x3F));
+            m_out.m_len += 2;
+            m_out.m_ascii = false;
+            start = i + 1;
+        }
+        m_out.emit(&src[start], len - start);
+    }
+
+    // Emits d as Number.toString would, or null if it is not finite.
+    void JSONSerializer::emitNumber(double d)
+    {
+        if (!m_toplevel->isFinite(NULL, d)) {
+            emit("null", 4);
+            return;
+        }
+        char buffer[MathUtils::kMinSizeForDouble_base10_toString];
+        int32_t len = MathUtils::kMinSizeForDouble_base10_toString;
+        char* digits = MathUtils::convertDoubleToStringBuffer(core(), d, buffer, len);
+        emit(digits, uint32_t(len));
     }
 
     REALLY_INLINE void JSONSerializer::QuoteAtomKey(Atom key)
@@ -1064,12 +1618,19 @@ namespace avmplus
 
     REALLY_INLINE void JSONSerializer::committedToEmitFor(Atom key,
                                                           String* pending,
-                                                          bool pendingPropnameColon)
+                                                          bool pendingPropnameColon,
+                                                          const utf8_t* quotedKey,
+                                                          uint32_t quotedKeyLength)
     {
-        emit(pending);
+        if (!pending->isEmpty())
+            emit(pending);
         if (pendingPropnameColon) {
-            QuoteAtomKey(key);
-            emit(':');
+            if (quotedKey != NULL) {
+                emit(quotedKey, quotedKeyLength);
+            } else {
+                QuoteAtomKey(key);
+                emit(':');
+            }
             if (!m_gap->isEmpty()) {
                 // Lars has note in his reference implementation about
                 // missing emph around "space" in ECMA-262 spec.
@@ -1165,18 +1726,18 @@ namespace avmplus
 
         switch (ret) {
         case kSomeOutput:
-            str = m_rope.toStringViaConcat(core());
-            m_rope.freeChunks();
+            str = m_out.toString(core());
+            m_out.free();
             return str;
         case kThrewException:
             exn = m_exception;
-            m_rope.freeChunks();
+            m_out.free();
             core()->throwException(exn);
         case kCycleTraversed:
-            m_rope.freeChunks();
+            m_out.free();
             m_toplevel->typeErrorClass()->throwError(1129);
         case kNoOutput:
-            m_rope.freeChunks();
+            m_out.free();
         }
         return NULL;
     }
@@ -1211,6 +1772,7 @@ namespace avmplus
         // Atom value = holder->getMultinameProperty(name);
         Atom holderAtom = holder->atom();
         VTable* vtable = m_toplevel->toVTable(holderAtom);
+        forgetNoToJSON();
         Atom value = m_toplevel->getproperty(holderAtom, name, vtable);
 
         return StrFoundValue(value, name->getName()->atom(), holder,
@@ -1233,16 +1795,48 @@ namespace avmplus
         END_TRY
     }
 
+    void JSONSerializer::rememberWithoutToJSON(Atom value, VTable* vtable)
+    {
+        if (atomKind(value) == kObjectType || !m_noToJSONCaching)
+            return;
+        m_noToJSON[m_noToJSONNext] = vtable;
+        m_noToJSONNext = (m_noToJSONNext + 1) & (kNoToJSONCacheSize - 1);
+    }
+
+    void JSONSerializer::forgetNoToJSON()
+    {
+        for (uint32_t i = 0; i < kNoToJSONCacheSize; i++)
+            m_noToJSON[i] = NULL;
+    }
+
+    bool JSONSerializer::reachesProxy(ScriptObject* obj)
+    {
+        Traits* proxyTraits = m_toplevel->builtinClasses()->get_ProxyClass()->ivtable()->traits;
+        for (; obj != NULL; obj = obj->getDelegate()) {
+            if (obj->traits()->subtypeof(proxyTraits))
+                return true;
+        }
+        return false;
+    }
+
     ReturnCondition JSONSerializer::StrFoundValue(Atom value,
                                                   Atom key,
                                                   ScriptObject* holder,
                                                   String* pendingPrefix,
-                                                  bool pendingPropnameColon)
+                                                  bool pendingPropnameColon,
+                                                  const utf8_t* quotedKey,
+                                                  uint32_t quotedKeyLength)
     {
-        if (stackOverflowCheck())
-            return kThrewException;
+        // Only objects recurse; a toJSON or replacer call makes its own
+        // stack check.
+        if (atomKind(value) == kObjectType && !core()->isNull(value)) {
+            if (stackOverflowCheck())
+                return kThrewException;
+            if (m_noToJSONCaching && reachesProxy(AvmCore::atomToScriptObject(value)))
+                m_noToJSONCaching = false;
+        }
 
-        if (!AvmCore::isNullOrUndefined(value)) {
+        if (!AvmCore::isNullOrUndefined(value) && !knownWithoutToJSON(value)) {
             Atom probe = nullObjectAtom;
             VTable* vtable = m_toplevel->toVTable(value);
 
@@ -1281,7 +1875,9 @@ namespace avmplus
             }
 
             // toJSON dispatch only when probe is Callable value.
-            if (core()->isFunction(probe)) {
+            if (probe == nullObjectAtom)
+                rememberWithoutToJSON(value, vtable);
+            else if (core()->isFunction(probe)) {
                 // toJSON takes only strings for key, regardless of what
                 // form the properties take internally.
                 if (atomIsIntptr(key)) {
@@ -1322,39 +1918,34 @@ namespace avmplus
         // Now emit the JSON string for the value.
 
         if (core()->isNull(value)) {
-            committedToEmitFor(key, pendingPrefix, pendingPropnameColon);
+            committedToEmitFor(key, pendingPrefix, pendingPropnameColon, quotedKey, quotedKeyLength);
             emit("null", 4);
             return kSomeOutput;
         }
 
         ScriptObject* obj;
         ArrayObject* array;
-        double d;
         switch (atomKind(value)) {
         case kBooleanType:
-            committedToEmitFor(key, pendingPrefix, pendingPropnameColon);
+            committedToEmitFor(key, pendingPrefix, pendingPropnameColon, quotedKey, quotedKeyLength);
             if (value == trueAtom)
                 emit("true", 4);
             else
                 emit("false", 5);
             return kSomeOutput;
         case kStringType:
-            committedToEmitFor(key, pendingPrefix, pendingPropnameColon);
+            committedToEmitFor(key, pendingPrefix, pendingPropnameColon, quotedKey, quotedKeyLength);
             Quote(core()->atomToString(value));
             return kSomeOutput;
         case kIntptrType:
         case kDoubleType:
-            committedToEmitFor(key, pendingPrefix, pendingPropnameColon);
-            d = core()->number(value);
-            if (m_toplevel->isFinite(NULL, d))
-                emit(core()->doubleToString(d));
-            else
-                emit("null", 4);
+            committedToEmitFor(key, pendingPrefix, pendingPropnameColon, quotedKey, quotedKeyLength);
+            emitNumber(core()->number(value));
             return kSomeOutput;
         case kObjectType:
             obj = AvmCore::atomToScriptObject(value);
             if (!core()->isFunction(value)) {
-                committedToEmitFor(key, pendingPrefix, pendingPropnameColon);
+                committedToEmitFor(key, pendingPrefix, pendingPropnameColon, quotedKey, quotedKeyLength);
 
                 array = obj->toArrayObject();
                 if (array != NULL)
@@ -1377,18 +1968,14 @@ namespace avmplus
             {
                 if (AvmCore::isFloat(value))
                 {
-                    committedToEmitFor(key, pendingPrefix, pendingPropnameColon);
+                    committedToEmitFor(key, pendingPrefix, pendingPropnameColon, quotedKey, quotedKeyLength);
 
-                    d = AvmCore::atomToFloat(value);
-                    if (m_toplevel->isFinite(NULL, d))
-                        emit(core()->doubleToString(d));
-                    else
-                        emit("null", 4);
+                    emitNumber(AvmCore::atomToFloat(value));
                     return kSomeOutput;
                 }
                 else if (AvmCore::isFloat4(value))
                 {
-                    committedToEmitFor(key, pendingPrefix, pendingPropnameColon);
+                    committedToEmitFor(key, pendingPrefix, pendingPropnameColon, quotedKey, quotedKeyLength);
 
                     // OPTIMIZEME: It would be better if this didn't cons a new object with a new
                     // dynamic property table every time it needed to format a float4.
@@ -1416,17 +2003,71 @@ namespace avmplus
     void JSONSerializer::Quote(String* value)
     {
         AvmAssert(value != NULL);
+        if (value->getWidth() == String::k8) {
+            String::Pointers ptrs(value);
+            QuoteLatin1(ptrs.p8, value->length());
+        } else {
+            StUTF8String valueUTF8(value);
+            m_out.m_ascii = false;
+            QuoteUTF8((const utf8_t*) valueUTF8.c_str(), valueUTF8.length());
+        }
+    }
+
+    void JSONSerializer::QuoteLatin1(const uint8_t* src, uint32_t len)
+    {
         uint32_t i = 0;
+        uint32_t start = 0;
 
-        StUTF8String valueUTF8(value);
-        const utf8_t* value_src = (const utf8_t*) valueUTF8.c_str();
+        emit('"');
 
-        uint32_t len = valueUTF8.length();
-        uint32_t start;
+        while (i < len) {
+#ifdef AVMPLUS_JSON_SSE2
+            // Skip sixteen characters at a time up to the next one that
+            // must be escaped or takes two bytes in UTF-8.
+            while (i + 16 <= len) {
+                __m128i v = _mm_loadu_si128((const __m128i*)&src[i]);
+                __m128i stops = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('"')),
+                                                          _mm_cmpeq_epi8(v, _mm_set1_epi8('\\'))),
+                                             _mm_cmpeq_epi8(_mm_subs_epu8(v, _mm_set1_epi8(31)), _mm_setzero_si128()));
+                uint32_t stop = uint32_t(_mm_movemask_epi8(stops)) | uint32_t(_mm_movemask_epi8(v));
+                if (stop != 0) {
+                    i += lowestBit(stop);
+                    break;
+                }
+                i += 16;
+            }
+            if (i == len)
+                break;
+#endif
+            uint8_t c = src[i];
+            if (c >= 32 && c != 34 && c != 92 && c < 0x80) {
+                i++;
+                continue;
+            }
 
-        char int_conv_buf[8];
-        char* ptr;
-        int32_t buflen;
+            emit(&src[start], i-start);
+            i++;
+            start = i;
+
+            if (c >= 0x80) {
+                utf8_t* dst = m_out.reserve(2);
+                dst[0] = utf8_t(0xC0 | (c >> 6));
+                dst[1] = utf8_t(0x80 | (c & 0x3F));
+                m_out.m_len += 2;
+                m_out.m_ascii = false;
+            } else {
+                emitEscaped(c);
+            }
+        }
+
+        emit(&src[start], i-start);
+        emit('\"');
+    }
+
+    void JSONSerializer::QuoteUTF8(const utf8_t* value_src, uint32_t len)
+    {
+        uint32_t i = 0;
+        uint32_t start;
 
         emit('"');
 
@@ -1442,35 +2083,46 @@ namespace avmplus
             i++;
             start = i;
 
-            emit('\\');
-            switch (c) {
-            case '\"': emit('\"'); break;
-            case '\\': emit('\\'); break;
-            case '\b': emit('b'); break;
-            case '\t': emit('t'); break;
-            case '\n': emit('n'); break;
-            case '\f': emit('f'); break;
-            case '\r': emit('r'); break;
-            default: // control character => \u####
-                buflen = sizeof(int_conv_buf);
-                ptr =
-                    MathUtils::
-                    convertIntegerToStringBuffer(c+0x10000,
-                                                 (char*)int_conv_buf,
-                                                 buflen,
-                                                 16,
-                                                 MathUtils::kTreatAsUnsigned);
-
-                emit('u');
-                emit(ptr+1, 4);
-                break;
-            }
+            emitEscaped(c);
         }
 
         emit(&value_src[start], i-start);
         emit('\"');
     }
 
+    // Emits the escape sequence for c, which is a double-quote, a
+    // backslash or a control character.
+    void JSONSerializer::emitEscaped(utf8_t c)
+    {
+        char int_conv_buf[8];
+        char* ptr;
+        int32_t buflen;
+
+        emit('\\');
+        switch (c) {
+        case '\"': emit('\"'); break;
+        case '\\': emit('\\'); break;
+        case '\b': emit('b'); break;
+        case '\t': emit('t'); break;
+        case '\n': emit('n'); break;
+        case '\f': emit('f'); break;
+        case '\r': emit('r'); break;
+        default: // control character => \u####
+            buflen = sizeof(int_conv_buf);
+            ptr =
+                MathUtils::
+                convertIntegerToStringBuffer(c+0x10000,
+                                             (char*)int_conv_buf,
+                                             buflen,
+                                             16,
+                                             MathUtils::kTreatAsUnsigned);
+
+            emit('u');
+            emit(ptr+1, 4);
+            break;
+        }
+    }
+
     bool JSONSerializer::hasTransientMetadata(ScriptObject* description)
     {
         Atom metadata =
@@ -1498,15 +2150,12 @@ namespace avmplus
         return false;
     }
 
-    ReturnCondition JSONSerializer::JODescriptions(ScriptObject* descs,
-                                                   ScriptObject* value,
-                                                   String* pendingPre,
-                                                   String* connective)
+    // Appends to names the names of the readable, non-[Transient]
+    // properties in descs, a list of TypeDescriber descriptions.
+    void JSONSerializer::addPlanNames(ScriptObject* descs, ArrayObject* names)
     {
         int32_t index;
 
-        bool emitted = false;
-
         if (descs != NULL) {
 
             for (index = descs->nextNameIndex(0);
@@ -1523,21 +2172,121 @@ namespace avmplus
                         continue;
                     Atom name =
                         description->getAtomProperty(propName("name"));
-
-                    ReturnCondition ret;
-                    ret = JOPropMultiname(name, value, pendingPre);
-                    RET_EXN_CHECK(ret);
-                    if (ret == kSomeOutput) {
-                        pendingPre = connective;
-                        emitted = true;
-                    }
+                    names->push(&name, 1);
                 }
             }
         }
-        if (emitted)
-            return kSomeOutput;
-        else
-            return kNoOutput;
+    }
+
+    JSONSerializer::JOPlan* JSONSerializer::planFor(ScriptObject* value)
+    {
+        Traits* traits = value->traits();
+        for (uint32_t i = 0; i < kPlanCacheSize; i++) {
+            if (m_plans[i] != NULL && m_plans[i]->traits == traits)
+                return m_plans[i];
+        }
+
+        // If our object has Traits, then it is an instance of an AS3
+        // class, and we want to enumerate its public non-method
+        // properties first.
+
+        // Bug 652116: support for this traversal could be provided by
+        // TypeDescriber, rather than allocating the intermediate
+        // ScriptObject dictated by TypeDescriber's public interface.
+        // It is done once per Traits, so that matters less than it did.
+
+        ArrayObject* names = m_toplevel->arrayClass()->newArray();
+
+        TypeDescriber typeDescriber(m_toplevel);
+        uint32_t flags =
+            (TypeDescriber::HIDE_OBJECT |
+             TypeDescriber::INCLUDE_VARIABLES |
+             TypeDescriber::INCLUDE_ACCESSORS |
+             TypeDescriber::INCLUDE_TRAITS |
+             TypeDescriber::INCLUDE_BASES |
+             TypeDescriber::INCLUDE_METADATA );
+        ScriptObject* valueDescription =
+            typeDescriber.describeType(value->atom(), flags);
+
+        if (valueDescription != NULL) {
+            ScriptObject* traitsDescription =
+                AvmCore::atomToScriptObject(
+                    valueDescription->getAtomProperty(propName("traits")));
+
+            // (analogous to DescribeType.as)
+            addPlanNames(AvmCore::atomToScriptObject(
+                             traitsDescription->getAtomProperty(propName("variables"))),
+                         names);
+            addPlanNames(AvmCore::atomToScriptObject(
+                             traitsDescription->getAtomProperty(propName("accessors"))),
+                         names);
+        }
+
+        uint32_t count = names->getLength();
+        size_t planSize = sizeof(JOPlan) + (count > 0 ? count - 1 : 0) * sizeof(JOPlan::Entry);
+        JOPlan* plan = (JOPlan*)core()->GetGC()->Alloc(planSize, MMgc::GC::kContainsPointers | MMgc::GC::kZero);
+        plan->traits = traits;
+        plan->count = count;
+
+        // Quote the names into the output, then take them back out.
+        uint32_t mark = m_out.m_len;
+        bool ascii = m_out.m_ascii;
+        Namespacep publicNS = core()->findPublicNamespace();
+        for (uint32_t i = 0; i < count; i++) {
+            JOPlan::Entry& entry = plan->entries[i];
+            entry.name = core()->intern(names->getUintProperty(i));
+
+            entry.keyStart = m_out.m_len - mark;
+            Quote(entry.name);
+            emit(':');
+            entry.keyLength = m_out.m_len - mark - entry.keyStart;
+
+            // Read vars and consts straight from their slots; anything
+            // else goes through getproperty, as a lookup by name would.
+            Multiname name(publicNS, entry.name);
+            Binding b = m_toplevel->getBinding(traits, &name);
+            switch (AvmCore::bindingKind(b)) {
+            case BKIND_VAR:
+            case BKIND_CONST:
+                entry.slot = int32_t(AvmCore::bindingToSlotId(b));
+                break;
+            default:
+                entry.slot = -1;
+                break;
+            }
+        }
+        uint32_t keysLength = m_out.m_len - mark;
+        utf8_t* keys = (utf8_t*)core()->GetGC()->Alloc(keysLength > 0 ? keysLength : 1, 0);
+        VMPI_memcpy(keys, m_out.m_buf + mark, keysLength);
+        plan->keys = keys;
+        plan->ascii = m_out.m_ascii;
+        m_out.m_len = mark;
+        m_out.m_ascii = ascii;
+
+        m_plans[m_planNext] = plan;
+        m_planNext = (m_planNext + 1) & (kPlanCacheSize - 1);
+        return plan;
+    }
+
+    ReturnCondition JSONSerializer::JOPlanEntry(JOPlan* plan,
+                                                uint32_t i,
+                                                ScriptObject* value,
+                                                String* pendingPrefix)
+    {
+        const JOPlan::Entry& entry = plan->entries[i];
+        if (!plan->ascii)
+            m_out.m_ascii = false;
+        Atom propValue;
+        if (entry.slot >= 0) {
+            propValue = value->getSlotAtom(uint32_t(entry.slot));
+        } else {
+            Multiname name(core()->findPublicNamespace(), entry.name);
+            if (TryGetProperty(value, &name, &propValue))
+                return kThrewException;
+        }
+        return StrFoundValue(propValue, entry.name->atom(), value,
+                             pendingPrefix, true,
+                             plan->keys + entry.keyStart, entry.keyLength);
     }
 
     ReturnCondition JSONSerializer::JO(ScriptObject* value)
@@ -1625,50 +2374,10 @@ namespace avmplus
         }
         AvmAssert(propNamesIdx == ownDynPropCount);
 
-        // In any case, if our object has Traits, then it is an
-        // instance of an AS3 class, and we want to enumerate its
-        // public non-method properties first.
-
-        // Bug 652116: support for this traversal could be provided by
-        // TypeDescriber, rather than allocating the intermediate
-        // ScriptObject dictated by TypeDescriber's public interface.
-
-        TypeDescriber typeDescriber(m_toplevel);
-        uint32_t flags =
-            (TypeDescriber::HIDE_OBJECT |
-             TypeDescriber::INCLUDE_VARIABLES |
-             TypeDescriber::INCLUDE_ACCESSORS |
-             TypeDescriber::INCLUDE_TRAITS |
-             TypeDescriber::INCLUDE_BASES |
-             TypeDescriber::INCLUDE_METADATA );
-        ScriptObject* valueDescription =
-            typeDescriber.describeType(value->atom(), flags);
-
-        if (valueDescription != NULL) {
-            ScriptObject* traitsDescription =
-                AvmCore::atomToScriptObject(
-                    valueDescription->getAtomProperty(propName("traits")));
-
+        JOPlan* plan = planFor(value);
+        for (uint32_t i = 0; i < plan->count; i++) {
             ReturnCondition ret;
-
-            // loops over descriptions (analogous to DescribeType.as)
-
-            ScriptObject* varsDescriptions =
-                AvmCore::atomToScriptObject(
-                    traitsDescription->getAtomProperty(propName("variables")));
-            ret = JODescriptions(varsDescriptions, value,
-                                 pendingPre, connective);
-            RET_EXN_CHECK(ret);
-            if (ret == kSomeOutput) {
-                pendingPre = connective;
-                emittedSomething = true;
-            }
-
-            ScriptObject* gettersDescriptions =
-                AvmCore::atomToScriptObject(
-                    traitsDescription->getAtomProperty(propName("accessors")));
-            ret = JODescriptions(gettersDescriptions, value,
-                                 pendingPre, connective);
+            ret = JOPlanEntry(plan, i, value, pendingPre);
             RET_EXN_CHECK(ret);
             if (ret == kSomeOutput) {
                 pendingPre = connective;
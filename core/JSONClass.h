@@ -17,6 +17,16 @@ namespace avmplus
     public:
         Atom parseCore(String* text);
 
+        // Parses text as JSON.parse would, except that JSON objects are
+        // read into instances of 'type' (and of the class types of its
+        // vars, recursively) and JSON arrays into Vectors where a var is
+        // a Vector type.  A JSON array at the top gives an Array of
+        // instances of 'type'.  Runs constructors and setters, and throws
+        // as assigning the values in AS3 would.  Class types are looked
+        // up in the current CodeContext's domain, else in the domain of
+        // 'type'.  For hosts; JSON.parse does not call it.
+        Atom parseTyped(String* text, ClassClosure* type);
+
         String* stringifySpecializedToString(Atom value,
                                              ArrayObject* propertyWhitelist,
                                              FunctionObject* replacerFunction,
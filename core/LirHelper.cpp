@@ -51,6 +51,19 @@ LirHelper::LirHelper(PoolObject* pool) :
 #endif
 { }
 
+LirHelper::LirHelper(AvmCore* core) :
+    pool(NULL),
+    core(core),
+    alloc1(mmfx_new(Allocator())),
+    lir_alloc(mmfx_new(Allocator())),
+    jit_observer(((BaseExecMgr*)core->exec)->jit_observer),
+#ifdef NANOJIT_IA32
+    use_cmov(core->config.njconfig.i386_use_cmov)
+#else
+    use_cmov(true)
+#endif
+{ }
+
 LirHelper::~LirHelper()
 {
     cleanup();
@@ -372,7 +385,8 @@ namespace nanojit
         "v",    // (1 << 0) == ACCSET_VARS
         "t",    // (1 << 1) == ACCSET_TAGS
         "o",    // (1 << 2) == ACCSET_OTHER
-                  "?", "?", "?", "?", "?", "?", "?", "?",   //  3..10 (unused)
+        "e",    // (1 << 3) == ACCSET_VECTOR_DATA
+                       "?", "?", "?", "?", "?", "?", "?",   //  4..10 (unused)
         "?", "?", "?", "?", "?", "?", "?", "?", "?", "?",   // 11..20 (unused)
         "?", "?", "?", "?", "?", "?", "?", "?", "?", "?",   // 21..30 (unused)
         "?"                                                 //     31 (unused)
@@ -544,6 +558,7 @@ namespace nanojit
         case avmplus::ACCSET_VARS:   ok = isVars;        break;
         case avmplus::ACCSET_TAGS:   ok = isTags;        break;
         case avmplus::ACCSET_OTHER:  ok = isUnknown;     break;
+        case avmplus::ACCSET_VECTOR_DATA: ok = isUnknown; break;
         default:
             // This assertion will fail if any single-region AccSets aren't covered
             // by the switch -- only multi-region AccSets should be handled here.
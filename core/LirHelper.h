@@ -61,10 +61,24 @@ namespace avmplus
         BindingCache* bindingCaches;    // head of linked list of all BindingCaches allocated by this codeMgr
                                         // (only for flushing... lifetime is still managed by codeAlloc)
         CodeMgr(nanojit::Config* conf);
+        ~CodeMgr();
         void flushBindingCaches();      // invalidate all binding caches for this codemgr... needed when AbcEnv is unloaded
+        void dumpBindingCacheStats(AvmCore*); // print per-cache hit/miss counters to the console
+
+        // take ownership of code and assembler data compiled by a JitPool
+        // worker into private allocators; freed along with this CodeMgr.
+        void adopt(CodeAlloc* code, Allocator* data);
 
         // DEOPT & PROFILER todo: provide some way to free code memory
         JitManager *jit_mgr;
+
+    private:
+        struct AdoptedCode {
+            CodeAlloc* code;
+            Allocator* data;
+            AdoptedCode* next;
+        };
+        AdoptedCode* adopted;
     };
 
     // AccSet conventions
@@ -81,16 +95,24 @@ namespace avmplus
     // we use ACCSET_OTHER for a catchall that does not overlap with any other
     // predefined alias set.  Future work should subdivide this set where
     // the improvements outweigh the cost of additional alias sets.
+    //
+    // ACCSET_VECTOR_DATA is split out of it so that storing a Vector element
+    // doesn't clobber the Vector's data pointer and length: a loop over a
+    // Vector can then load them once.  Only the inline element loads and
+    // stores emitted by CodegenLIR use it; everything else that writes
+    // Vector storage is a call.
 
     const AccSet ACCSET_VARS  = (1 << 0);    // values of local variables
     const AccSet ACCSET_TAGS  = (1 << 1);    // BuiltinTraits tags for local variables
     const AccSet ACCSET_OTHER = (1 << 2);
-    const uint8_t TR_NUM_USED_ACCS = 3;      // number of access regions used by Tamarin
+    const AccSet ACCSET_VECTOR_DATA = (1 << 3); // elements of typed Vectors, stored inline
+    const uint8_t TR_NUM_USED_ACCS = 4;      // number of access regions used by Tamarin
 
     /** helper code to make LIR generation nice and tidy */
     class LirHelper {
     protected:
         LirHelper(PoolObject*);
+        LirHelper(AvmCore*);    // for code that belongs to no pool
         ~LirHelper();
         void cleanup();
         
@@ -871,10 +871,6 @@ namespace avmplus
         // (As this function is used more generally it seems probable that the correct fix
         // is to add the infinity and NaN checks to the AS3 code /and/ leave them in here.)
 
-        AvmAssert(mode == DTOSTR_NORMAL || mode == DTOSTR_FIXED || mode == DTOSTR_PRECISION || mode == DTOSTR_EXPONENTIAL);
-        AvmAssert(mode != DTOSTR_PRECISION || (precision >= 1 && precision <= 21));
-        AvmAssert(mode != DTOSTR_EXPONENTIAL || (precision >= 0 && precision <= 20));
-
         switch (isInfinite(value)) {
         case -1:
             return core->newConstantStringLatin1("-Infinity");
@@ -885,6 +881,44 @@ namespace avmplus
             return core->newConstantStringLatin1("NaN");
         }
 
+        MMgc::GC::AllocaAutoPtr _buffer;
+        char* const buffer = (char*)avmStackAlloc(core, _buffer, kMinSizeForDouble_base10_toString);
+        int32_t len = kMinSizeForDouble_base10_toString;
+        char* s = convertDoubleToStringBuffer(core, value, buffer, len, mode, precision);
+        return core->newStringLatin1(s, len);
+    }
+
+    char* MathUtils::convertDoubleToStringBuffer(AvmCore* core,
+                                                 double value,
+                                                 char* buffer,
+                                                 int32_t& len,
+                                                 int32_t mode,
+                                                 int32_t precision)
+    {
+        AvmAssert(mode == DTOSTR_NORMAL || mode == DTOSTR_FIXED || mode == DTOSTR_PRECISION || mode == DTOSTR_EXPONENTIAL);
+        AvmAssert(mode != DTOSTR_PRECISION || (precision >= 1 && precision <= 21));
+        AvmAssert(mode != DTOSTR_EXPONENTIAL || (precision >= 0 && precision <= 20));
+        AvmAssert(len >= kMinSizeForDouble_base10_toString);
+
+        const char* special = NULL;
+        switch (isInfinite(value)) {
+        case -1:
+            special = "-Infinity";
+            break;
+        case 1:
+            special = "Infinity";
+            break;
+        default:
+            if (isNaN(value))
+                special = "NaN";
+            break;
+        }
+        if (special != NULL) {
+            len = (int32_t)VMPI_strlen(special);
+            VMPI_memcpy(buffer, special, len + 1);
+            return buffer;
+        }
+
         // If our double is really an integer, call our integer version which
         // is much, much faster then our double version.  (Skips a ton of _ftol
         // which are slow).
@@ -901,11 +935,9 @@ namespace avmplus
             int32_t intValue = int32_t(value);
 #endif
             if ((value == (double)(intValue)) && ((uint32_t)intValue != 0x80000000))
-                return convertIntegerToStringBase10(core, intValue, kTreatAsSigned);
+                return convertIntegerToStringBuffer(intValue, buffer, len, 10, kTreatAsSigned);
         }
 
-        MMgc::GC::AllocaAutoPtr _buffer;
-        char* const buffer = (char*)avmStackAlloc(core, _buffer, kMinSizeForDouble_base10_toString);
         const bool negative = value < 0.0;
         const bool zero = value == 0.0;
         const bool noFraction = (precision == 0);
@@ -1201,7 +1233,7 @@ namespace avmplus
             while (*t) { *s++ = *t++; }
         }
 
-        int32_t len = (int32_t)(s-buffer);
+        len = (int32_t)(s-buffer);
         s = sentinel;
         
         // Deal with the sentinel introduced for the kFraction case: we might have a leading '00.'
@@ -1223,7 +1255,8 @@ namespace avmplus
 
         mmfx_delete(d2a);
 
-        return core->newStringLatin1(s, len);
+        s[len] = '\0';
+        return s;
     }
 
     // convertStringToDouble: Converts an ASCII string in the form
@@ -230,6 +230,22 @@ namespace avmplus
                                              double value,
                                              int32_t mode = DTOSTR_NORMAL,
                                              int32_t precision = 15);
+        /**
+         * Convert a double to a string as convertDoubleToString() does, but
+         * into a buffer, without allocating a String.
+         * @param core              The AvmCore instance
+         * @param value             the value to convert
+         * @param buffer            the buffer to fill
+         * @param len               the buffer size, at least kMinSizeForDouble_base10_toString;
+         *                          takes the number of characters filled in
+         * @return                  a pointer into the buffer to the NUL-terminated result
+         */
+        static char* convertDoubleToStringBuffer(AvmCore* core,
+                                                 double value,
+                                                 char* buffer,
+                                                 int32_t& len,
+                                                 int32_t mode = DTOSTR_NORMAL,
+                                                 int32_t precision = 15);
         static bool convertStringToDouble(Stringp inStr,
                                           double *value,
                                           bool strict=false);
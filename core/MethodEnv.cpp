@@ -587,23 +587,28 @@ namespace avmplus
 
     ScriptObject* MethodEnv::op_newobject(Atom* sp, int argc) const
     {
-        // pre-size the hashtable since we know how many vars are coming
+        // literals are kept by shape (see DynamicShape), so leave the
+        // hashtable uninitialized
         Toplevel* toplevel = this->toplevel();
         AvmCore* core = toplevel->core();
         VTable* object_ivtable = toplevel->objectClass->ivtable();
 
-        ScriptObject* o = ScriptObject::create(core->GetGC(), object_ivtable, toplevel->objectClass->prototypePtr(), argc);
+        ScriptObject* o = ScriptObject::create(core->GetGC(), object_ivtable, toplevel->objectClass->prototypePtr());
 
-        for (; argc-- > 0; sp -= 2)
+        // add the properties in source order, which is the order for-in and
+        // JSON.stringify see them in; where a name repeats, the first value
+        // is kept, as it always has been
+        for (Atom* pair = sp - 2 * (argc - 1); argc-- > 0; pair += 2)
         {
-            Atom name = sp[-1];
+            Atom name = pair[-1];
             // verifier has stated this is a String, but we may see nullStringAtom
             if (!AvmCore::isString(name))
                 toplevel->throwTypeError(kConvertNullToObjectError);
 
             //todo have the verifier take care of interning too
             name = core->internString(name)->atom();
-            o->setAtomProperty(name, sp[0]);
+            if (!o->hasAtomProperty(name))
+                o->setAtomProperty(name, pair[0]);
         }
         return o;
     }
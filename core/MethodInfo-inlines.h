@@ -184,6 +184,11 @@ REALLY_INLINE void MethodInfo::setLazyRest()
     _lazyRest = 1;
 }
 
+REALLY_INLINE void MethodInfo::setLazyActivationTraits()
+{
+    _lazyActivationTraits = 1;
+}
+
 REALLY_INLINE void MethodInfo::setNeedsDxns()
 {
     _needsDxns = 1;
@@ -222,6 +227,11 @@ REALLY_INLINE void MethodInfo::setHasFailedJit()
     _hasFailedJit = 1;
 }
 
+REALLY_INLINE uint32_t MethodInfo::isJitPending() const
+{
+    return _isJitPending;
+}
+
 REALLY_INLINE uint32_t MethodInfo::isInterpreted() const
 {
     return _isInterpImpl;
@@ -360,6 +370,7 @@ REALLY_INLINE const ScopeTypeChain* MethodInfo::declaringScope() const
 
 REALLY_INLINE Traits* MethodInfo::activationTraits() const
 {
+    AvmAssert(!_lazyActivationTraits);
     return _activation.getTraits();
 }
 
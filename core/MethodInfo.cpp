@@ -774,6 +774,12 @@ namespace avmplus
             if (ms->paramTraits(0) != NULL && ms->paramTraits(0)->isInterface())
                 _hasMethodBody = 0;
 
+            if (_lazyActivationTraits)
+            {
+                AbcParser::parseLazyActivationTraits(toplevel, this);
+                _lazyActivationTraits = 0;
+            }
+
             _isResolved = 1;
             _installRefToResolvedMethodSignature(ms);
 
@@ -173,6 +173,7 @@ namespace avmplus
         uint32_t setsDxns() const;
         uint32_t isStaticInit() const;
         uint32_t hasFailedJit() const;
+        uint32_t isJitPending() const;
         uint32_t isInterpreted() const;
         uint32_t unboxThis() const;
         uint32_t onlyUntypedParameters() const;
@@ -182,6 +183,7 @@ namespace avmplus
         void setHasFailedJit();
         void setHasExceptions();
         void setLazyRest();
+        void setLazyActivationTraits();
         void setNeedsDxns();
         void setFinal();
         void setOverride();
@@ -404,6 +406,10 @@ namespace avmplus
         // set to indicate that an attempted jit compilation has failed
         uint32_t                _hasFailedJit:1;
 
+        // set while the method is queued for background jit compilation;
+        // it runs in the interpreter until the compiled code is installed.
+        uint32_t                _isJitPending:1;
+
         // true if execution mechanism is the interpreter
         uint32_t                _isInterpImpl:1;
 
@@ -416,6 +422,10 @@ namespace avmplus
         // sense in combination with _needRest or _needArguments.
         uint32_t                _lazyRest:1;
 
+        // Set by AbcParser when it skipped the activation traits of the method
+        // body; they are parsed by resolveSignature, which clears the flag.
+        uint32_t                _lazyActivationTraits:1;
+
         // Set by _buildMethodSignature if all fixed or optional parameters
         // to the function are untyped.  (We use this to optimize the 'arguments'
         // array, see RestArgAnalyzer.)
@@ -443,6 +453,12 @@ namespace avmplus
         // This does not guarantee that OSR will apply, however.  See OSR::isSupported() for details.
         uint32_t                _osr_enabled:1;
 
+#ifdef VMCFG_HALFMOON
+        // Tier of the method's compiled code under tiered compilation,
+        // one of BaseExecMgr::JitTier.
+        uint32_t                _jitTier:3;
+#endif
+
 #ifdef VMCFG_FLOAT
         // if true, the function operates on float4_t values, and needs a double VARSIZE
         uint32_t                _has128bitLocals:1;
@@ -9,6 +9,7 @@
 
 #ifdef VMCFG_NANOJIT
 #  include "CodegenLIR.h"
+#  include "exec-jitprofile.h"
 #endif
 
 namespace avmplus
@@ -68,6 +69,9 @@ namespace avmplus
         , _method_name_indices(core->GetGC(), 0)
         , _apiVersion(apiVersion)
         , _uniqueId(-1)
+#ifdef VMCFG_NANOJIT
+        , _contentHash(0)
+#endif
 #ifdef VMCFG_AOT
         , aotInfo(NULL)
         , aotRoot(NULL)
@@ -88,6 +92,20 @@ namespace avmplus
 #endif
     }
 
+#ifdef VMCFG_NANOJIT
+    uint64_t PoolObject::contentHash()
+    {
+        if (_contentHash == 0) {
+            // Start at _abcStart so pools sharing a buffer hash differently.
+            ScriptBuffer sb = code();
+            const uint8_t* end = sb.getBuffer() + sb.getSize();
+            uint64_t hash = JitProfile::hashBytes(_abcStart, size_t(end - _abcStart));
+            _contentHash = hash != 0 ? hash : 1;
+        }
+        return _contentHash;
+    }
+#endif
+
     void PoolObject::dynamicizeStrings()
     {
         if (!MMgc::GC::GetGC(this)->Destroying())
@@ -137,6 +137,12 @@ namespace avmplus
         ScriptBuffer code();
         bool isCodePointer(const uint8_t* pos);
 
+#ifdef VMCFG_NANOJIT
+        // Hash of the ABC bytes, identifying this pool's methods across runs
+        // (see JitProfile).  Computed on first use.
+        uint64_t contentHash();
+#endif
+
         int32_t uniqueId() const;
         void    setUniqueId(int32_t val);
 
@@ -259,6 +265,9 @@ namespace avmplus
         DataList<int32_t>                           GC_STRUCTURE(_method_name_indices);
         ApiVersion const                            _apiVersion;
         int32_t                                     _uniqueId; // _uniqueId + mi->method_id() produces a unique id for methods
+#ifdef VMCFG_NANOJIT
+        uint64_t                                    _contentHash; // 0 until contentHash() is first called
+#endif
 
     public:
     #ifdef AVMPLUS_VERBOSE
@@ -0,0 +1,1262 @@
+/* -*- Mode: C++; c-basic-offset: 4; indent-tabs-mode: nil; tab-width: 4 -*- */
+/* vi: set ts=4 sw=4 expandtab: (add to ~/.vimrc: set modeline modelines=5) */
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "avmplus.h"
+
+#ifdef VMCFG_NANOJIT
+#include "LirHelper.h"
+#include "RegExpCompiler.h"
+
+#include "../pcre/config.h"
+#include "../pcre/pcre_internal.h"
+
+// RegExpCompiler translates the bytecode pcre_compile made for a pattern into
+// LIR, which nanojit turns into a native matcher.  It does not parse regular
+// expression source itself: every decision about what the pattern means was
+// already taken by pcre_compile, so the two engines can't disagree about it.
+//
+// The translation is done in two steps.  parse() reads the bytecode into a
+// tree of RENodes, refusing anything it does not handle:
+//
+//   - literal characters, with or without PCRE_CASELESS
+//   - character classes, negated single characters, \d \D \s \S \w \W and '.'
+//   - ^ $ \A \z \Z \b \B, with or without PCRE_MULTILINE
+//   - greedy, lazy and possessive repeats of any of the characters above
+//   - capturing and non-capturing groups, with alternatives, and '?' and
+//     fixed counts on them (pcre_compile expands those into copies)
+//
+// Back references, lookaround, recursion, conditionals, callouts, atomic
+// groups, \p and \X, (?imsx) inside the pattern, and groups under * or +
+// or an unbounded {n,} stay in pcre_exec.
+//
+// generate() then emits a backtracking matcher in continuation-passing
+// style, entirely at compile time: what follows a node is emitted again
+// after each way that node can match, so every alternative of a group gets
+// its own copy of the rest of the pattern.  Backtracking is then just a
+// branch to the code that tries the next possibility, and captures need no
+// run-time bookkeeping, because each copy of the success code knows which
+// group closings came before it.  The price is code size, which is bounded
+// by kMaxEmitted; patterns that would need more are left to pcre.
+//
+// The matcher works on the UTF-8 bytes of the subject.  Literals compare
+// bytes, as pcre does.  Characters sets are tested on one byte, which is
+// only right for ASCII; when a set could match a non-ASCII character, the
+// matcher bails out to pcre_exec when it meets one.
+
+namespace avmplus
+{
+    // Helpers called from the generated code.
+
+    // The first position at or after 'pos' that holds 'byte', or -1.
+    static int32_t regexFindByte(const uint8_t* subject, int32_t pos, int32_t length, int32_t byte)
+    {
+        const uint8_t* p = (const uint8_t*)VMPI_memchr(subject + pos, byte, length - pos);
+        return p ? int32_t(p - subject) : -1;
+    }
+
+    // The first position at or after 'pos' that holds 'a' or 'b', or -1.
+    static int32_t regexFindEitherByte(const uint8_t* subject, int32_t pos, int32_t length, int32_t a, int32_t b)
+    {
+        for (const uint8_t *p = subject + pos, *end = subject + length; p < end; p++) {
+            if (*p == a || *p == b)
+                return int32_t(p - subject);
+        }
+        return -1;
+    }
+
+    // '^' with PCRE_MULTILINE.
+    static int32_t regexAtLineStart(const uint8_t* subject, int32_t pos, int32_t length)
+    {
+        int nllen;
+        return pos == 0 ||
+            (pos < length && _pcre_was_newline(subject + pos, NLTYPE_ANY, subject, &nllen, TRUE));
+    }
+
+    // '$' with PCRE_MULTILINE.
+    static int32_t regexAtLineEnd(const uint8_t* subject, int32_t pos, int32_t length)
+    {
+        int nllen;
+        return pos == length ||
+            _pcre_is_newline(subject + pos, NLTYPE_ANY, subject + length, &nllen, TRUE);
+    }
+
+    // '$' without PCRE_MULTILINE, and \Z: the end, or a newline just before it.
+    static int32_t regexAtEnd(const uint8_t* subject, int32_t pos, int32_t length)
+    {
+        int nllen;
+        return pos == length ||
+            (_pcre_is_newline(subject + pos, NLTYPE_ANY, subject + length, &nllen, TRUE) &&
+             pos + nllen == length);
+    }
+
+    // Where pcre_exec makes the next attempt at a PCRE_STARTLINE pattern
+    // (one that can only match at the start of a line) after a failure at
+    // 'pos' - 1: just after the next newline, which may be length + 1.
+    static int32_t regexNextLine(const uint8_t* subject, int32_t pos, int32_t length)
+    {
+        const uint8_t* p = subject + pos;
+        const uint8_t* end = subject + length;
+        int nllen;
+        while (p <= end && !_pcre_was_newline(p, NLTYPE_ANY, subject, &nllen, TRUE))
+            p++;
+        if (p[-1] == '\r' && p < end && *p == '\n')
+            p++;
+        return int32_t(p - subject);
+    }
+
+    #define FUNCADDR(addr) (uintptr_t)addr
+
+    PUREFUNCTION(FUNCADDR(regexFindByte), SIG4(I,P,I,I,I), regexFindByte)
+    PUREFUNCTION(FUNCADDR(regexFindEitherByte), SIG5(I,P,I,I,I,I), regexFindEitherByte)
+    PUREFUNCTION(FUNCADDR(regexAtLineStart), SIG3(I,P,I,I), regexAtLineStart)
+    PUREFUNCTION(FUNCADDR(regexAtLineEnd), SIG3(I,P,I,I), regexAtLineEnd)
+    PUREFUNCTION(FUNCADDR(regexAtEnd), SIG3(I,P,I,I), regexAtEnd)
+    PUREFUNCTION(FUNCADDR(regexNextLine), SIG3(I,P,I,I), regexNextLine)
+
+    /**
+     * The characters one position of a pattern can match, as a set of bytes.
+     * Only ASCII members are kept; 'wide' says whether any character above
+     * 127 is a member too, in which case the matcher bails out on non-ASCII
+     * input rather than decode it.
+     */
+    struct RECharSet
+    {
+        bool wide;
+        bool nul;               // '\0' is a member, so the terminator can't stop a scan
+        int32_t count;          // ASCII members
+        int32_t lo, hi;         // smallest and largest ASCII members
+        uint8_t member[128];
+        const uint8_t* table;   // 'member', padded to 256 bytes, in code-lifetime memory
+    };
+
+    /** A node of the pattern tree parse() builds. */
+    struct RENode
+    {
+        enum Kind { kLiteral, kSet, kRepeat, kAssert, kGroup };
+        enum Mode { kGreedy, kLazy, kPossessive };
+        enum Assertion { kStart, kEnd, kEndOrNewline, kLineStart, kLineEnd, kWordBoundary, kNotWordBoundary };
+        enum Optional { kRequired, kGreedyOptional, kLazyOptional };
+
+        static const int32_t kUnbounded = 0x7fffffff;
+
+        explicit RENode(Kind kind)
+            : kind(kind), next(NULL), slot(-1), bytes(NULL), length(0), set(NULL)
+            , min(0), max(0), mode(kGreedy), assertion(kStart)
+            , capture(0), alts(NULL), altCount(0), optional(kRequired)
+        {}
+
+        Kind kind;
+        RENode* next;           // the rest of the sequence
+        int32_t slot;           // first of this node's matcher variables, or -1
+
+        // kLiteral, and kRepeat of a literal
+        const uint8_t* bytes;
+        int32_t length;
+
+        // kSet, and kRepeat of a set
+        RECharSet* set;
+
+        // kRepeat
+        int32_t min, max;
+        Mode mode;
+
+        // kAssert
+        Assertion assertion;
+
+        // kGroup
+        int32_t capture;        // capture number, or 0
+        RENode** alts;
+        int32_t altCount;
+        Optional optional;
+    };
+
+    /**
+     * Translates the bytecode of one pcre pattern into a native matcher.
+     * See the comment at the top of this file.
+     */
+    class RegExpCompiler : public LirHelper
+    {
+    public:
+        RegExpCompiler(AvmCore* core, const real_pcre* re);
+
+        /** Build the pattern tree; false if the pattern uses anything unsupported. */
+        bool parse();
+
+        /** Emit the matcher; false if it would be too big. */
+        bool generate(Allocator& dataAlloc);
+
+        /** Assemble the matcher into 'codeAlloc', NULL on failure. */
+        void* assemble(CodeAlloc& codeAlloc, Allocator& dataAlloc);
+
+    private:
+        static const int32_t kMaxCaptures = 32;     // fits in RegExpObject's ovector
+        static const int32_t kMaxNodes = 256;
+        static const int32_t kMaxEmitted = 2000;    // nodes emitted, counting copies
+        static const int32_t kMaxLiteral = 64;
+
+        // Matcher variables; nodes that need some get theirs after these.
+        enum { kPosSlot, kStartSlot, kBudgetSlot, kFixedSlots };
+
+        /** Forward branches waiting for a label, see bind(). */
+        struct Targets
+        {
+            struct Branch
+            {
+                LIns* ins;
+                Branch* next;
+            };
+            Targets() : branches(NULL) {}
+            bool empty() const { return branches == NULL; }
+            Branch* branches;
+        };
+
+        /** What to match after a node: the rest of an enclosing group, then 'next'. */
+        struct Cont
+        {
+            const RENode* group;    // the group to close
+            const Cont* next;
+        };
+
+        /** The node that last closed each capture on the way to a point of the matcher. */
+        struct Path
+        {
+            const RENode* closed[kMaxCaptures + 1];
+        };
+
+        // parse
+        bool parseGroup(const uschar*& code, RENode::Optional optional, RENode*& group);
+        bool parseSequence(const uschar*& code, RENode*& head);
+        RENode* newNode(RENode::Kind kind);
+        RECharSet* newSet(uschar op, const uschar* arg);
+        bool flushLiteral(RENode**& tail, uint8_t* literal, int32_t& length);
+        bool addRepeat(RENode**& tail, RECharSet* set, const uschar* bytes, int32_t length,
+                       int32_t min, int32_t max, RENode::Mode mode);
+        void assignSlots(RENode* n);
+        static int32_t minLength(const RENode* n);
+
+        // generate
+        void emitSequence(const RENode* n, const Cont* k, Targets& fail, const Path& path);
+        void emitContinuation(const Cont* k, Targets& fail, const Path& path);
+        void emitRepeat(const RENode* n, LIns* pos, const Cont* k, Targets& fail, const Path& path);
+        void emitGroup(const RENode* n, LIns* pos, const Cont* k, Targets& fail, const Path& path);
+        void emitAssert(const RENode* n, LIns* pos, Targets& fail);
+        void emitItem(const RENode* n, LIns* pos, int32_t d, Targets& fail);
+        void emitSetTest(const RECharSet* set, LIns* pos, int32_t d, Targets& fail);
+        void emitBacktrack();
+        void emitSuccess(const Path& path);
+        void branchTo(Targets& targets, LOpcode op, LIns* cond);
+        void bind(Targets& targets);
+        LIns* ldv(int32_t slot);
+        void stv(LIns* value, int32_t slot);
+        LIns* byteAt(LIns* pos, int32_t d);
+        LIns* lookup(const uint8_t* table, LIns* byte);
+        LIns* cmp(LOpcode op, LIns* a, int32_t b) { return binaryIns(op, a, InsConst(b)); }
+        const uint8_t* copyTable(const uint8_t* bytes, int32_t count);
+#ifdef NJ_VERBOSE
+        bool verbose() { return core->isVerbose(VB_jit); }
+        AvmLogControl log;
+#endif
+
+        const real_pcre* const re;
+        const uschar* const tables;
+        const uint32_t ims;
+        RENode* top;
+        int32_t nodeCount;
+        int32_t slotCount;
+        int32_t emitted;
+        bool tooBig;
+
+        Allocator* dataAlloc;
+        LIns* subject;
+        LIns* length;
+        LIns* ovector;
+        LIns* vars;
+        Targets bails;
+        const uint8_t* wordTable;
+    };
+
+    RegExpCompiler::RegExpCompiler(AvmCore* core, const real_pcre* re)
+        : LirHelper(core)
+        , re(re)
+        , tables(re->tables ? re->tables : _pcre_default_tables)
+        , ims(re->options & PCRE_IMS)
+        , top(NULL)
+        , nodeCount(0)
+        , slotCount(kFixedSlots)
+        , emitted(0)
+        , tooBig(false)
+        , dataAlloc(NULL)
+        , subject(NULL)
+        , length(NULL)
+        , ovector(NULL)
+        , vars(NULL)
+        , wordTable(NULL)
+    {
+        verbose_only(log.core = core; log.lcbits = core->config.verbose_vb;)
+    }
+
+    bool RegExpCompiler::parse()
+    {
+        const uint32_t options = re->options;
+        if (!(options & PCRE_UTF8) ||
+            (options & (PCRE_DOLLAR_ENDONLY | PCRE_FIRSTLINE | PCRE_NEWLINE_BITS)) ||
+            re->top_bracket > kMaxCaptures || re->top_backref != 0)
+            return false;
+
+        // \b treats every byte above 127 as a non-word character.
+        for (int32_t c = 128; c < 256; c++) {
+            if (tables[ctypes_offset + c] & ctype_word)
+                return false;
+        }
+
+        const uschar* code = (const uschar*)re + re->name_table_offset + re->name_count * re->name_entry_size;
+        if (*code != OP_BRA || !parseGroup(code, RENode::kRequired, top) || *code != OP_END)
+            return false;
+        assignSlots(top);
+        return true;
+    }
+
+    // 'code' is at an OP_BRA or OP_CBRA; leaves it after the matching OP_KET.
+    bool RegExpCompiler::parseGroup(const uschar*& code, RENode::Optional optional, RENode*& group)
+    {
+        group = newNode(RENode::kGroup);
+        if (!group)
+            return false;
+        group->capture = *code == OP_CBRA ? GET2(code, 1 + LINK_SIZE) : 0;
+        group->optional = optional;
+
+        int32_t altCount = 1;
+        for (const uschar* alt = code + GET(code, 1); *alt == OP_ALT; alt += GET(alt, 1))
+            altCount++;
+        group->alts = new (*alloc1) RENode*[altCount];
+        group->altCount = altCount;
+
+        for (int32_t i = 0; i < altCount; i++) {
+            const uschar* end = code + GET(code, 1);
+            code += _pcre_OP_lengths[*code];
+            if (!parseSequence(code, group->alts[i]) || code != end)
+                return false;
+        }
+        if (*code != OP_KET)
+            return false;
+        code += _pcre_OP_lengths[OP_KET];
+        return true;
+    }
+
+    // Leaves 'code' at the OP_ALT or OP_KET that ends the sequence.
+    bool RegExpCompiler::parseSequence(const uschar*& code, RENode*& head)
+    {
+        RENode** tail = &head;
+        uint8_t literal[kMaxLiteral];
+        int32_t literalLength = 0;
+        head = NULL;
+
+        for (;;) {
+            const uschar op = *code;
+            RENode* node = NULL;
+
+            if (op == OP_CHAR || (op == OP_CHARNC && code[1] >= 128)) {
+                // A caseless character above 127 matches only itself without UCP.
+                int32_t n = 1 + (code[1] >= 0xc0 ? _pcre_utf8_table4[code[1] & 0x3f] : 0);
+                if (literalLength + n > kMaxLiteral && !flushLiteral(tail, literal, literalLength))
+                    return false;
+                VMPI_memcpy(literal + literalLength, code + 1, n);
+                literalLength += n;
+                code += 1 + n;
+                continue;
+            }
+            if (!flushLiteral(tail, literal, literalLength))
+                return false;
+
+            switch (op) {
+            case OP_ALT:
+            case OP_KET:
+                *tail = NULL;
+                return true;
+
+            case OP_CHARNC:
+            case OP_NOT:
+            case OP_NOT_DIGIT:
+            case OP_DIGIT:
+            case OP_NOT_WHITESPACE:
+            case OP_WHITESPACE:
+            case OP_NOT_WORDCHAR:
+            case OP_WORDCHAR:
+            case OP_ANY: {
+                RECharSet* set = newSet(op, code + 1);
+                if (!set || (node = newNode(RENode::kSet)) == NULL)
+                    return false;
+                node->set = set;
+                code += _pcre_OP_lengths[op];
+                break;
+            }
+
+            case OP_CLASS:
+            case OP_NCLASS: {
+                RECharSet* set = newSet(op, code + 1);
+                code += _pcre_OP_lengths[op];
+                int32_t min = 1, max = 1;
+                RENode::Mode mode = RENode::kGreedy;
+                const uschar rop = *code;
+                if (rop >= OP_CRSTAR && rop <= OP_CRMINRANGE) {
+                    if (rop >= OP_CRRANGE) {
+                        min = GET2(code, 1);
+                        max = GET2(code, 3);
+                        if (max == 0)
+                            max = RENode::kUnbounded;
+                    } else {
+                        static const int32_t mins[] = { 0, 0, 1, 1, 0, 0 };
+                        static const int32_t maxs[] = { RENode::kUnbounded, RENode::kUnbounded,
+                                                        RENode::kUnbounded, RENode::kUnbounded, 1, 1 };
+                        min = mins[rop - OP_CRSTAR];
+                        max = maxs[rop - OP_CRSTAR];
+                    }
+                    if ((rop - OP_CRSTAR) & 1)
+                        mode = RENode::kLazy;
+                    code += _pcre_OP_lengths[rop];
+                }
+                if (!addRepeat(tail, set, NULL, 1, min, max, mode))
+                    return false;
+                continue;
+            }
+
+            case OP_SOD:
+                node = newNode(RENode::kAssert);
+                if (node)
+                    node->assertion = RENode::kStart;
+                code++;
+                break;
+            case OP_CIRC:
+                node = newNode(RENode::kAssert);
+                if (node)
+                    node->assertion = (ims & PCRE_MULTILINE) ? RENode::kLineStart : RENode::kStart;
+                code++;
+                break;
+            case OP_DOLL:
+                node = newNode(RENode::kAssert);
+                if (node)
+                    node->assertion = (ims & PCRE_MULTILINE) ? RENode::kLineEnd : RENode::kEndOrNewline;
+                code++;
+                break;
+            case OP_EODN:
+                node = newNode(RENode::kAssert);
+                if (node)
+                    node->assertion = RENode::kEndOrNewline;
+                code++;
+                break;
+            case OP_EOD:
+                node = newNode(RENode::kAssert);
+                if (node)
+                    node->assertion = RENode::kEnd;
+                code++;
+                break;
+            case OP_WORD_BOUNDARY:
+            case OP_NOT_WORD_BOUNDARY:
+                node = newNode(RENode::kAssert);
+                if (node)
+                    node->assertion = op == OP_WORD_BOUNDARY ? RENode::kWordBoundary : RENode::kNotWordBoundary;
+                code++;
+                break;
+
+            case OP_BRA:
+            case OP_CBRA:
+                if (!parseGroup(code, RENode::kRequired, node))
+                    return false;
+                break;
+            case OP_BRAZERO:
+            case OP_BRAMINZERO:
+                code++;
+                if ((*code != OP_BRA && *code != OP_CBRA) ||
+                    !parseGroup(code, op == OP_BRAZERO ? RENode::kGreedyOptional : RENode::kLazyOptional, node))
+                    return false;
+                break;
+
+            default: {
+                // Repeats of single characters, negated characters, and types.
+                int32_t rel;
+                uschar itemOp;
+                if (op >= OP_STAR && op <= OP_POSUPTO) {
+                    rel = op - OP_STAR;
+                    itemOp = OP_CHAR;
+                } else if (op >= OP_NOTSTAR && op <= OP_NOTPOSUPTO) {
+                    rel = op - OP_NOTSTAR;
+                    itemOp = OP_NOT;
+                } else if (op >= OP_TYPESTAR && op <= OP_TYPEPOSUPTO) {
+                    rel = op - OP_TYPESTAR;
+                    itemOp = 0;
+                } else {
+                    return false;
+                }
+
+                // STAR MINSTAR PLUS MINPLUS QUERY MINQUERY UPTO MINUPTO EXACT POSSTAR POSPLUS POSQUERY POSUPTO
+                static const int8_t mins[] = { 0, 0, 1, 1, 0, 0, 0, 0, -1, 0, 1, 0, 0 };
+                static const int8_t maxs[] = { 0, 0, 0, 0, 1, 1, -1, -1, -1, 0, 0, 1, -1 };
+                static const uint8_t modes[] = { RENode::kGreedy, RENode::kLazy, RENode::kGreedy, RENode::kLazy,
+                                                 RENode::kGreedy, RENode::kLazy, RENode::kGreedy, RENode::kLazy,
+                                                 RENode::kPossessive, RENode::kPossessive, RENode::kPossessive,
+                                                 RENode::kPossessive, RENode::kPossessive };
+                const uschar* item = code + 1;
+                int32_t count = 0;
+                if (mins[rel] < 0 || maxs[rel] < 0) {
+                    count = GET2(code, 1);
+                    item += 2;
+                }
+                int32_t min = mins[rel] < 0 ? count : mins[rel];
+                int32_t max = maxs[rel] < 0 ? count : maxs[rel] == 0 ? RENode::kUnbounded : maxs[rel];
+                RENode::Mode mode = RENode::Mode(modes[rel]);
+
+                RECharSet* set = NULL;
+                const uschar* bytes = NULL;
+                int32_t n = 1;
+                if (itemOp == OP_CHAR) {
+                    if (*item < 128)
+                        set = newSet((ims & PCRE_CASELESS) ? OP_CHARNC : OP_CHAR, item);
+                    else {
+                        n = 1 + (*item >= 0xc0 ? _pcre_utf8_table4[*item & 0x3f] : 0);
+                        bytes = item;
+                    }
+                } else {
+                    set = newSet(itemOp ? itemOp : *item, item);
+                    if (!set)
+                        return false;
+                    if (!itemOp)
+                        n = _pcre_OP_lengths[*item];
+                }
+                code = item + n;
+                if (!addRepeat(tail, set, bytes, n, min, max, mode))
+                    return false;
+                continue;
+            }
+            }
+
+            if (!node)
+                return false;
+            *tail = node;
+            tail = &node->next;
+        }
+    }
+
+    RENode* RegExpCompiler::newNode(RENode::Kind kind)
+    {
+        if (++nodeCount > kMaxNodes)
+            return NULL;
+        return new (*alloc1) RENode(kind);
+    }
+
+    // The set matched by the single-character opcode 'op' with argument 'arg',
+    // or NULL if it isn't one we handle.
+    RECharSet* RegExpCompiler::newSet(uschar op, const uschar* arg)
+    {
+        const uschar* lcc = tables + lcc_offset;
+        const uschar* ctypes = tables + ctypes_offset;
+        const bool caseless = (ims & PCRE_CASELESS) != 0;
+        bool member[256];
+        bool wide;
+
+        switch (op) {
+        case OP_CHAR:
+            for (int32_t c = 0; c < 256; c++)
+                member[c] = c == arg[0];
+            wide = false;
+            break;
+        case OP_CHARNC:
+            for (int32_t c = 0; c < 256; c++)
+                member[c] = lcc[c] == lcc[arg[0]];
+            wide = false;
+            break;
+        case OP_NOT:
+            if (arg[0] >= 128)
+                return NULL;
+            for (int32_t c = 0; c < 256; c++)
+                member[c] = caseless ? lcc[c] != lcc[arg[0]] : c != arg[0];
+            wide = true;
+            break;
+        case OP_DIGIT:
+        case OP_NOT_DIGIT:
+        case OP_WHITESPACE:
+        case OP_NOT_WHITESPACE:
+        case OP_WORDCHAR:
+        case OP_NOT_WORDCHAR: {
+            const int bit = (op == OP_DIGIT || op == OP_NOT_DIGIT) ? ctype_digit :
+                            (op == OP_WHITESPACE || op == OP_NOT_WHITESPACE) ? ctype_space : ctype_word;
+            const bool negated = op == OP_NOT_DIGIT || op == OP_NOT_WHITESPACE || op == OP_NOT_WORDCHAR;
+            for (int32_t c = 0; c < 256; c++)
+                member[c] = ((ctypes[c] & bit) != 0) != negated;
+            // Above 255, \s tests isUnicodeWhiteSpace; \d and \w never match.
+            wide = negated || op == OP_WHITESPACE;
+            break;
+        }
+        case OP_ANY:
+            for (int32_t c = 0; c < 256; c++)
+                member[c] = (ims & PCRE_DOTALL) || !((c >= 0x0a && c <= 0x0d) || c == 0x85);
+            wide = true;
+            break;
+        case OP_CLASS:
+        case OP_NCLASS:
+            for (int32_t c = 0; c < 256; c++)
+                member[c] = (arg[c >> 3] & (1 << (c & 7))) != 0;
+            wide = op == OP_NCLASS;
+            break;
+        default:
+            return NULL;
+        }
+
+        RECharSet* set = new (*alloc1) RECharSet();
+        set->nul = member[0];
+        set->count = 0;
+        set->lo = set->hi = -1;
+        set->table = NULL;
+        for (int32_t c = 0; c < 256; c++) {
+            if (c < 128)
+                set->member[c] = member[c];
+            if (!member[c])
+                continue;
+            if (c >= 128) {
+                wide = true;
+                continue;
+            }
+            if (set->lo < 0)
+                set->lo = c;
+            set->hi = c;
+            set->count++;
+        }
+        set->wide = wide;
+        return set;
+    }
+
+    bool RegExpCompiler::flushLiteral(RENode**& tail, uint8_t* literal, int32_t& length)
+    {
+        if (length == 0)
+            return true;
+        RENode* node = newNode(RENode::kLiteral);
+        if (!node)
+            return false;
+        uint8_t* bytes = new (*alloc1) uint8_t[length];
+        VMPI_memcpy(bytes, literal, length);
+        node->bytes = bytes;
+        node->length = length;
+        length = 0;
+        *tail = node;
+        tail = &node->next;
+        return true;
+    }
+
+    // Appends a repeat of 'set', or of the 'length' bytes at 'bytes', to the sequence.
+    bool RegExpCompiler::addRepeat(RENode**& tail, RECharSet* set, const uschar* bytes, int32_t length,
+                                   int32_t min, int32_t max, RENode::Mode mode)
+    {
+        if (max == 0)
+            return true;
+        RENode* node;
+        if (min == 1 && max == 1) {
+            if (set) {
+                node = newNode(RENode::kSet);
+                if (node)
+                    node->set = set;
+            } else {
+                node = newNode(RENode::kLiteral);
+                if (node)
+                    node->bytes = bytes;
+            }
+        } else {
+            node = newNode(RENode::kRepeat);
+            if (node) {
+                node->set = set;
+                node->bytes = bytes;
+                node->min = min;
+                node->max = max;
+                // Nothing to give back from an exact count.
+                node->mode = min == max ? RENode::kPossessive : mode;
+            }
+        }
+        if (!node)
+            return false;
+        node->length = length;
+        *tail = node;
+        tail = &node->next;
+        return true;
+    }
+
+    void RegExpCompiler::assignSlots(RENode* n)
+    {
+        for (; n; n = n->next) {
+            if (n->kind == RENode::kRepeat) {
+                n->slot = slotCount;
+                slotCount += 2;     // where it started, where it is now
+            } else if (n->kind == RENode::kGroup) {
+                if (n->capture || n->altCount > 1 || n->optional != RENode::kRequired) {
+                    n->slot = slotCount;
+                    slotCount += 2; // where it started, where it ended
+                }
+                for (int32_t i = 0; i < n->altCount; i++)
+                    assignSlots(n->alts[i]);
+            }
+        }
+    }
+
+    // The fewest bytes the sequence 'n' can match.
+    int32_t RegExpCompiler::minLength(const RENode* n)
+    {
+        int32_t length = 0;
+        for (; n; n = n->next) {
+            switch (n->kind) {
+            case RENode::kLiteral:
+            case RENode::kSet:
+                length += n->kind == RENode::kSet ? 1 : n->length;
+                break;
+            case RENode::kRepeat:
+                length += n->min * (n->set ? 1 : n->length);
+                break;
+            case RENode::kAssert:
+                break;
+            case RENode::kGroup:
+                if (n->optional == RENode::kRequired) {
+                    int32_t least = RENode::kUnbounded;
+                    for (int32_t i = 0; i < n->altCount; i++) {
+                        int32_t alt = minLength(n->alts[i]);
+                        if (alt < least)
+                            least = alt;
+                    }
+                    length += least;
+                }
+                break;
+            }
+        }
+        return length;
+    }
+
+    //
+    // generate
+    //
+
+    LIns* RegExpCompiler::ldv(int32_t slot)
+    {
+        return ldi(vars, slot * sizeof(int32_t), ACCSET_VARS);
+    }
+
+    void RegExpCompiler::stv(LIns* value, int32_t slot)
+    {
+        sti(value, vars, slot * sizeof(int32_t), ACCSET_VARS);
+    }
+
+    // The subject is neither written nor freed while the matcher runs.
+    LIns* RegExpCompiler::byteAt(LIns* pos, int32_t d)
+    {
+        return lirout->insLoad(LIR_lduc2ui, binaryIns(LIR_addp, subject, ui2p(pos)), d, ACCSET_OTHER, LOAD_CONST);
+    }
+
+    LIns* RegExpCompiler::lookup(const uint8_t* table, LIns* byte)
+    {
+        return lirout->insLoad(LIR_lduc2ui, binaryIns(LIR_addp, InsConstPtr(table), ui2p(byte)), 0, ACCSET_OTHER, LOAD_CONST);
+    }
+
+    const uint8_t* RegExpCompiler::copyTable(const uint8_t* bytes, int32_t count)
+    {
+        uint8_t* table = new (*dataAlloc) uint8_t[256];
+        VMPI_memset(table, 0, 256);
+        VMPI_memcpy(table, bytes, count);
+        return table;
+    }
+
+    void RegExpCompiler::branchTo(Targets& targets, LOpcode op, LIns* cond)
+    {
+        Targets::Branch* b = new (*alloc1) Targets::Branch();
+        b->ins = lirout->insBranch(op, cond, NULL);
+        b->next = targets.branches;
+        targets.branches = b;
+    }
+
+    void RegExpCompiler::bind(Targets& targets)
+    {
+        LIns* target = label();
+        for (Targets::Branch* b = targets.branches; b; b = b->next)
+            b->ins->setTarget(target);
+        targets.branches = NULL;
+    }
+
+    bool RegExpCompiler::generate(Allocator& dataAlloc)
+    {
+        this->dataAlloc = &dataAlloc;
+
+        frag = new (*lir_alloc) Fragment(0 verbose_only(, 0));
+        LirBuffer* lirbuf = frag->lirbuf = new (*lir_alloc) LirBuffer(*lir_alloc);
+        lirbuf->abi = ABI_CDECL;
+        verbose_only(
+            if (verbose())
+                lirbuf->printer = new (*lir_alloc) LInsPrinter(*lir_alloc, TR_NUM_USED_ACCS);
+        )
+        LirWriter* lirout = new (*alloc1) LirBufWriter(lirbuf, core->config.njconfig);
+        debug_only(
+            lirout = validate2 = new (*alloc1) ValidateWriter(lirout, lirbuf->printer, "RegExpCompiler");
+        )
+        verbose_only(
+            if (verbose()) {
+                core->console << "compileRegExp " << re->top_bracket << " captures, " << nodeCount << " nodes\n";
+                lirout = new (*alloc1) VerboseWriter(*alloc1, lirout, lirbuf->printer, &log);
+            }
+        )
+#if defined(NANOJIT_ARM)
+        if (core->config.njconfig.soft_float)
+            lirout = new (*alloc1) SoftFloatFilter(lirout);
+#endif
+        emitStart(*alloc1, lirbuf, lirout);
+        this->lirout = lirout;
+
+        subject = param(0, "subject");
+        length = p2i(param(1, "length"));
+        LIns* start = p2i(param(2, "start"));
+        ovector = param(3, "ovector");
+        vars = lirout->insAlloc(slotCount * sizeof(int32_t));
+        verbose_only(
+            if (lirbuf->printer)
+                lirbuf->printer->lirNameMap->addName(vars, "vars");
+        )
+        debug_only(
+            void** extras = new (*alloc1) void*[2];
+            extras[0] = vars;
+            extras[1] = NULL;
+            validate1->setCheckAccSetExtras(extras);
+            validate2->setCheckAccSetExtras(extras);
+        )
+
+        const uschar* ctypes = tables + ctypes_offset;
+        uint8_t word[128];
+        for (int32_t c = 0; c < 128; c++)
+            word[c] = (ctypes[c] & ctype_word) != 0;
+        wordTable = copyTable(word, 128);
+
+        const bool anchored = (re->options & PCRE_ANCHORED) != 0;
+        const int32_t budget = MATCH_LIMIT / (2 + nodeCount);
+        Targets noMatch;
+
+        // pcre_exec refuses offsets past the end; let it say so.
+        branchTo(bails, LIR_jt, binaryIns(LIR_gti, start, length));
+        stv(start, kStartSlot);
+
+        // Each attempt starts here, at the position in kStartSlot.
+        LIns* attempt = label();
+        if (!anchored && (re->options & PCRE_FIRSTSET)) {
+            // Skip ahead to the byte every match starts with.
+            const uschar* lcc = tables + lcc_offset;
+            int32_t first = re->first_byte & 255;
+            int32_t firsts[2] = { first, first };
+            int32_t count = 1;
+            if (re->first_byte & REQ_CASELESS) {
+                first = lcc[first];
+                count = 0;
+                for (int32_t c = 0; c < 256; c++) {
+                    if (lcc[c] == first && count++ < 2)
+                        firsts[count - 1] = c;
+                }
+            }
+            if (count <= 2) {
+                LIns* found = count == 1 ?
+                    callIns(FUNCTIONID(regexFindByte), 4, subject, ldv(kStartSlot), length, InsConst(firsts[0])) :
+                    callIns(FUNCTIONID(regexFindEitherByte), 5, subject, ldv(kStartSlot), length,
+                            InsConst(firsts[0]), InsConst(firsts[1]));
+                branchTo(noMatch, LIR_jt, cmp(LIR_lti, found, 0));
+                stv(found, kStartSlot);
+            }
+        } else if (!anchored && (re->options & PCRE_STARTLINE)) {
+            // After the first attempt, skip to the start of the next line.
+            Targets first;
+            LIns* s = ldv(kStartSlot);
+            branchTo(first, LIR_jf, binaryIns(LIR_gti, s, start));
+            s = callIns(FUNCTIONID(regexNextLine), 3, subject, s, length);
+            // pcre_exec makes one last attempt past the end; it can only
+            // match if the pattern can match nothing.
+            branchTo(minLength(top) > 0 ? noMatch : bails, LIR_jt, binaryIns(LIR_gti, s, length));
+            stv(s, kStartSlot);
+            bind(first);
+        }
+        stv(ldv(kStartSlot), kPosSlot);
+        stv(InsConst(budget), kBudgetSlot);
+
+        Path path;
+        VMPI_memset(&path, 0, sizeof(path));
+        Targets retry;
+        emitSequence(top, NULL, retry, path);
+        if (tooBig)
+            return false;
+
+        if (!retry.empty()) {
+            bind(retry);
+            if (anchored) {
+                branchTo(noMatch, LIR_j, NULL);
+            } else {
+                // Bump along by one character, as pcre_exec does.
+                LIns* s = ldv(kStartSlot);
+                branchTo(noMatch, LIR_jt, binaryIns(LIR_gei, s, length));
+                stv(addi(s, 1), kStartSlot);
+                Targets charDone;
+                LIns* skip = label();
+                s = ldv(kStartSlot);
+                branchTo(charDone, LIR_jf, cmp(LIR_eqi, binaryIns(LIR_andi, byteAt(s, 0), InsConst(0xc0)), 0x80));
+                stv(addi(s, 1), kStartSlot);
+                lirout->insBranch(LIR_j, NULL, skip);
+                bind(charDone);
+                if (!(re->options & PCRE_HASCRORLF)) {
+                    // Don't start a match between the CR and LF of a CRLF.
+                    s = ldv(kStartSlot);
+                    lirout->insBranch(LIR_jf, cmp(LIR_eqi, byteAt(s, -1), '\r'), attempt);
+                    lirout->insBranch(LIR_jf, cmp(LIR_eqi, byteAt(s, 0), '\n'), attempt);
+                    stv(addi(s, 1), kStartSlot);
+                }
+                lirout->insBranch(LIR_j, NULL, attempt);
+            }
+        }
+        if (!noMatch.empty()) {
+            bind(noMatch);
+            lirout->ins1(LIR_reti, InsConst(PCRE_ERROR_NOMATCH));
+        }
+        bind(bails);
+        lirout->ins1(LIR_reti, InsConst(RegExpCode::kBail));
+        // The attempt loop uses these after the branch back to it, which the
+        // assembler can't see; keep them live to the end.
+        livep(subject);
+        lirout->ins1(LIR_livei, length);
+        lirout->ins1(LIR_livei, start);
+        livep(ovector);
+        frag->lastIns = livep(vars);
+        return true;
+    }
+
+    // Match the sequence 'n', then 'k'; branch to 'fail' if that can't be done.
+    void RegExpCompiler::emitSequence(const RENode* n, const Cont* k, Targets& fail, const Path& path)
+    {
+        // Characters are matched at 'd' bytes after 'pos' until a node needs
+        // the position in kPosSlot.
+        LIns* const start = ldv(kPosSlot);
+        LIns* pos = start;
+        int32_t d = 0;
+        for (; n; n = n->next) {
+            if (++emitted > kMaxEmitted) {
+                tooBig = true;
+                return;
+            }
+            switch (n->kind) {
+            case RENode::kLiteral:
+            case RENode::kSet:
+                emitItem(n, pos, d, fail);
+                d += n->kind == RENode::kSet ? 1 : n->length;
+                break;
+            case RENode::kAssert:
+                if (d != 0) {
+                    pos = addi(pos, d);
+                    d = 0;
+                }
+                emitAssert(n, pos, fail);
+                break;
+            case RENode::kRepeat:
+            case RENode::kGroup:
+                if (d != 0)
+                    pos = addi(pos, d);
+                if (n->kind == RENode::kRepeat)
+                    emitRepeat(n, pos, k, fail, path);
+                else
+                    emitGroup(n, pos, k, fail, path);
+                return;
+            }
+        }
+        if (d != 0)
+            stv(addi(pos, d), kPosSlot);
+        else if (pos != start)
+            stv(pos, kPosSlot);
+        emitContinuation(k, fail, path);
+    }
+
+    void RegExpCompiler::emitContinuation(const Cont* k, Targets& fail, const Path& path)
+    {
+        if (!k) {
+            emitSuccess(path);
+            return;
+        }
+        const RENode* group = k->group;
+        if (group->capture) {
+            stv(ldv(kPosSlot), group->slot + 1);
+            Path closed = path;
+            closed.closed[group->capture] = group;
+            emitSequence(group->next, k->next, fail, closed);
+        } else {
+            emitSequence(group->next, k->next, fail, path);
+        }
+    }
+
+    // Match the repeat 'n' at 'pos', then the rest of its sequence and 'k'.
+    void RegExpCompiler::emitRepeat(const RENode* n, LIns* pos, const Cont* k, Targets& fail, const Path& path)
+    {
+        const int32_t unit = n->set ? 1 : n->length;
+        const int32_t startSlot = n->slot;
+        const int32_t posSlot = n->slot + 1;
+        stv(pos, startSlot);
+
+        if (n->mode == RENode::kLazy) {
+            // The fewest first...
+            stv(pos, posSlot);
+            if (n->min > 0) {
+                Targets enough;
+                LIns* loop = label();
+                LIns* p = ldv(posSlot);
+                if (n->min > 1)
+                    branchTo(enough, LIR_jf, binaryIns(LIR_lti, binaryIns(LIR_subi, p, ldv(startSlot)), InsConst(n->min * unit)));
+                emitItem(n, p, 0, fail);
+                stv(addi(p, unit), posSlot);
+                if (n->min > 1) {
+                    lirout->insBranch(LIR_j, NULL, loop);
+                    bind(enough);
+                }
+            }
+            // ...then one more each time the rest fails.
+            LIns* retry = label();
+            stv(ldv(posSlot), kPosSlot);
+            Targets more;
+            emitSequence(n->next, k, more, path);
+            if (more.empty())
+                return;
+            bind(more);
+            emitBacktrack();
+            LIns* p = ldv(posSlot);
+            if (n->max != RENode::kUnbounded)
+                branchTo(fail, LIR_jf, binaryIns(LIR_lti, binaryIns(LIR_subi, p, ldv(startSlot)), InsConst(n->max * unit)));
+            emitItem(n, p, 0, fail);
+            stv(addi(p, unit), posSlot);
+            lirout->insBranch(LIR_j, NULL, retry);
+            return;
+        }
+
+        // As many as we can...
+        Targets done;
+        stv(pos, kPosSlot);
+        LIns* loop = label();
+        LIns* p = ldv(kPosSlot);
+        if (n->max != RENode::kUnbounded)
+            branchTo(done, LIR_jf, binaryIns(LIR_lti, binaryIns(LIR_subi, p, ldv(startSlot)), InsConst(n->max * unit)));
+        emitItem(n, p, 0, done);
+        stv(addi(p, unit), kPosSlot);
+        lirout->insBranch(LIR_j, NULL, loop);
+        bind(done);
+        p = ldv(kPosSlot);
+        if (n->min > 0)
+            branchTo(fail, LIR_jt, binaryIns(LIR_lti, binaryIns(LIR_subi, p, ldv(startSlot)), InsConst(n->min * unit)));
+        if (n->mode == RENode::kPossessive) {
+            emitSequence(n->next, k, fail, path);
+            return;
+        }
+
+        // ...then one fewer each time the rest fails.
+        stv(p, posSlot);
+        LIns* retry = label();
+        Targets fewer;
+        emitSequence(n->next, k, fewer, path);
+        if (fewer.empty())
+            return;
+        bind(fewer);
+        emitBacktrack();
+        p = ldv(posSlot);
+        branchTo(fail, LIR_jt, binaryIns(LIR_lei, binaryIns(LIR_subi, p, ldv(startSlot)), InsConst(n->min * unit)));
+        p = addi(p, -unit);
+        stv(p, posSlot);
+        stv(p, kPosSlot);
+        lirout->insBranch(LIR_j, NULL, retry);
+    }
+
+    // Match the group 'n' at 'pos', then the rest of its sequence and 'k'.
+    void RegExpCompiler::emitGroup(const RENode* n, LIns* pos, const Cont* k, Targets& fail, const Path& path)
+    {
+        if (n->slot >= 0)
+            stv(pos, n->slot);
+        stv(pos, kPosSlot);
+
+        // Like pcre_exec in ES3 mode, entering a capture unsets the ones after it.
+        Path inner = path;
+        if (n->capture) {
+            for (int32_t i = n->capture + 1; i <= kMaxCaptures; i++)
+                inner.closed[i] = NULL;
+        }
+
+        if (n->optional == RENode::kLazyOptional) {
+            Targets enter;
+            emitSequence(n->next, k, enter, path);
+            if (enter.empty() || tooBig)
+                return;
+            bind(enter);
+            emitBacktrack();
+            stv(ldv(n->slot), kPosSlot);
+        }
+
+        const Cont body = { n, k };
+        for (int32_t i = 0; i < n->altCount; i++) {
+            if (i == n->altCount - 1 && n->optional != RENode::kGreedyOptional) {
+                emitSequence(n->alts[i], &body, fail, inner);
+                return;
+            }
+            Targets next;
+            emitSequence(n->alts[i], &body, next, inner);
+            if (next.empty() || tooBig)
+                return;
+            bind(next);
+            emitBacktrack();
+            stv(ldv(n->slot), kPosSlot);
+        }
+
+        // A greedy optional group that could not match is skipped.
+        emitSequence(n->next, k, fail, path);
+    }
+
+    void RegExpCompiler::emitAssert(const RENode* n, LIns* pos, Targets& fail)
+    {
+        switch (n->assertion) {
+        case RENode::kStart:
+            branchTo(fail, LIR_jf, eqi0(pos));
+            break;
+        case RENode::kEnd:
+            branchTo(fail, LIR_jf, binaryIns(LIR_eqi, pos, length));
+            break;
+        case RENode::kEndOrNewline:
+        case RENode::kLineEnd:
+        case RENode::kLineStart: {
+            // The common case inline, newlines in a helper.
+            Targets ok;
+            if (n->assertion == RENode::kLineStart)
+                branchTo(ok, LIR_jt, eqi0(pos));
+            else
+                branchTo(ok, LIR_jt, binaryIns(LIR_eqi, pos, length));
+            const CallInfo* ci = n->assertion == RENode::kLineStart ? FUNCTIONID(regexAtLineStart) :
+                                 n->assertion == RENode::kLineEnd ? FUNCTIONID(regexAtLineEnd) :
+                                 FUNCTIONID(regexAtEnd);
+            branchTo(fail, LIR_jt, eqi0(callIns(ci, 3, subject, pos, length)));
+            bind(ok);
+            break;
+        }
+        case RENode::kWordBoundary:
+        case RENode::kNotWordBoundary: {
+            // Bytes above 127 are never word characters; see parse().
+            LIns* atStart = eqi0(pos);
+            LIns* here = lookup(wordTable, byteAt(pos, 0));
+            LIns* before = lookup(wordTable, byteAt(lirout->insChoose(atStart, pos, addi(pos, -1), use_cmov), 0));
+            before = lirout->insChoose(atStart, InsConst(0), before, use_cmov);
+            branchTo(fail, n->assertion == RENode::kWordBoundary ? LIR_jt : LIR_jf,
+                     binaryIns(LIR_eqi, before, here));
+            break;
+        }
+        }
+    }
+
+    // Branch to 'fail' unless the character or literal of 'n' is at 'pos' + 'd'.
+    void RegExpCompiler::emitItem(const RENode* n, LIns* pos, int32_t d, Targets& fail)
+    {
+        if (n->set) {
+            emitSetTest(n->set, pos, d, fail);
+            return;
+        }
+        // The subject's terminating NUL stops a literal without one.
+        if (VMPI_memchr(n->bytes, 0, n->length))
+            branchTo(fail, LIR_jt, binaryIns(LIR_gti, addi(pos, d + n->length), length));
+        for (int32_t i = 0; i < n->length; i++)
+            branchTo(fail, LIR_jf, cmp(LIR_eqi, byteAt(pos, d + i), n->bytes[i]));
+    }
+
+    void RegExpCompiler::emitSetTest(const RECharSet* set, LIns* pos, int32_t d, Targets& fail)
+    {
+        if (set->nul)
+            branchTo(fail, LIR_jf, binaryIns(LIR_lti, addi(pos, d), length));
+        LIns* b = byteAt(pos, d);
+        if (set->wide)
+            branchTo(bails, LIR_jf, cmp(LIR_ltui, b, 0x80));
+
+        if (set->count == 1) {
+            branchTo(fail, LIR_jf, cmp(LIR_eqi, b, set->lo));
+        } else if (set->count == 2 && (set->lo ^ set->hi) == 0x20) {
+            // A letter in either case.
+            branchTo(fail, LIR_jf, cmp(LIR_eqi, ori(b, 0x20), set->hi | 0x20));
+        } else if (set->count > 0 && set->hi - set->lo + 1 == set->count) {
+            branchTo(fail, LIR_jf, cmp(LIR_ltui, addi(b, -set->lo), set->count));
+        } else {
+            RECharSet* s = const_cast<RECharSet*>(set);
+            if (!s->table)
+                s->table = copyTable(s->member, 128);
+            branchTo(fail, LIR_jt, eqi0(lookup(s->table, b)));
+        }
+    }
+
+    // Count a backtrack; past the budget pcre_exec would give up, so let it.
+    void RegExpCompiler::emitBacktrack()
+    {
+        LIns* budget = addi(ldv(kBudgetSlot), -1);
+        stv(budget, kBudgetSlot);
+        branchTo(bails, LIR_jt, eqi0(budget));
+    }
+
+    void RegExpCompiler::emitSuccess(const Path& path)
+    {
+        sti(ldv(kStartSlot), ovector, 0, ACCSET_OTHER);
+        sti(ldv(kPosSlot), ovector, sizeof(int32_t), ACCSET_OTHER);
+        const int32_t captures = re->top_bracket;
+        for (int32_t i = 1; i <= captures; i++) {
+            const RENode* group = path.closed[i];
+            LIns* start = group ? ldv(group->slot) : InsConst(-1);
+            LIns* end = group ? ldv(group->slot + 1) : InsConst(-1);
+            sti(start, ovector, 2 * i * sizeof(int32_t), ACCSET_OTHER);
+            sti(end, ovector, (2 * i + 1) * sizeof(int32_t), ACCSET_OTHER);
+        }
+        lirout->ins1(LIR_reti, InsConst(captures + 1));
+    }
+
+    void* RegExpCompiler::assemble(CodeAlloc& codeAlloc, Allocator& dataAlloc)
+    {
+        nanojit::Config cfg = core->config.njconfig;
+        cfg.harden_function_alignment = false;
+        cfg.harden_nop_insertion = false;
+
+        SinkLogControl sink;
+        LogControl* log = &sink;
+        verbose_only(
+            if (verbose())
+                log = &this->log;
+        )
+        Assembler* assm = new (*lir_alloc) Assembler(codeAlloc, dataAlloc, *lir_alloc, log, cfg);
+        LirReader bufreader(frag->lastIns);
+        assm->beginAssembly(frag);
+        assm->assemble(frag, &bufreader);
+        assm->endAssembly(frag);
+        return assm->error() ? NULL : frag->code();
+    }
+
+    RegExpCode::RegExpCode(CodeAlloc* codeAlloc, Allocator* dataAlloc, Matcher matcher)
+        : codeAlloc(codeAlloc)
+        , dataAlloc(dataAlloc)
+        , matcher(matcher)
+    {}
+
+    RegExpCode::~RegExpCode()
+    {
+        mmfx_delete(codeAlloc);
+        mmfx_delete(dataAlloc);
+    }
+
+    RegExpCode* RegExpCode::compile(AvmCore* core, const void* regex)
+    {
+        if (!regex)
+            return NULL;
+        RegExpCompiler compiler(core, (const real_pcre*)regex);
+        if (!compiler.parse())
+            return NULL;
+
+        CodeAlloc* codeAlloc = mmfx_new(CodeAlloc(&core->config.njconfig, 1));
+        Allocator* dataAlloc = mmfx_new(Allocator());
+        void* code = NULL;
+        if (compiler.generate(*dataAlloc))
+            code = compiler.assemble(*codeAlloc, *dataAlloc);
+        if (!code) {
+            mmfx_delete(codeAlloc);
+            mmfx_delete(dataAlloc);
+            return NULL;
+        }
+        return mmfx_new(RegExpCode(codeAlloc, dataAlloc, (Matcher)code));
+    }
+}
+
+#endif // VMCFG_NANOJIT
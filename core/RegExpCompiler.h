@@ -0,0 +1,60 @@
+/* -*- Mode: C++; c-basic-offset: 4; indent-tabs-mode: nil; tab-width: 4 -*- */
+/* vi: set ts=4 sw=4 expandtab: (add to ~/.vimrc: set modeline modelines=5) */
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef __avmplus_RegExpCompiler__
+#define __avmplus_RegExpCompiler__
+
+namespace avmplus
+{
+    /**
+     * Native code for one pcre-compiled regular expression, generated by
+     * RegExpCompiler from the pattern's pcre bytecode.
+     *
+     * match() has the contract of pcre_exec(regex, NULL, subject, length,
+     * start, PCRE_NO_UTF8_CHECK, ovector, ovecsize) for an ovector of at
+     * least 3 * (1 + capture count) ints, except that 'subject' must be
+     * NUL-terminated (as StUTF8String is), and that it may return kBail
+     * instead of a result.  It does that when it meets something it leaves
+     * to pcre: a non-ASCII character where a character class or '.' can
+     * match one, or more backtracking in one attempt than pcre_exec's match
+     * limit could allow.  The caller then runs pcre_exec, which gives the
+     * answer the native code would have had to.
+     *
+     * Patterns using features the compiler does not handle (back references,
+     * lookaround, repeated groups, and a few more, see RegExpCompiler.cpp)
+     * get no RegExpCode at all and always run in pcre_exec.
+     */
+    class RegExpCode
+    {
+    public:
+        static const int32_t kBail = -2;
+
+        /**
+         * Compile 'regex', a pcre* from pcre_compile with PCRE_UTF8.
+         * Returns NULL if the pattern can't be compiled.
+         */
+        static RegExpCode* compile(AvmCore* core, const void* regex);
+
+        ~RegExpCode();
+
+        int32_t match(const char* subject, int32_t length, int32_t start, int32_t* ovector) const
+        {
+            AvmAssert(subject[length] == 0);
+            return matcher((const uint8_t*)subject, length, start, ovector);
+        }
+
+    private:
+        typedef int32_t (*Matcher)(const uint8_t* subject, int32_t length, int32_t start, int32_t* ovector);
+
+        RegExpCode(nanojit::CodeAlloc* codeAlloc, nanojit::Allocator* dataAlloc, Matcher matcher);
+
+        nanojit::CodeAlloc* codeAlloc;  // owns the code
+        nanojit::Allocator* dataAlloc;  // owns the tables the code reads
+        Matcher matcher;
+    };
+}
+
+#endif /* __avmplus_RegExpCompiler__ */
@@ -8,6 +8,10 @@
 #include "avmplus.h"
 
 #include "pcre.h"
+#ifdef VMCFG_NANOJIT
+#include "LirHelper.h"
+#include "RegExpCompiler.h"
+#endif
 
 // todo figure out what to do about all the new/delete in here
 // todo general clean-up
@@ -27,6 +31,17 @@ namespace avmplus
 
 #define OVECTOR_SIZE 99 // 32 matches = (32+1)*3
 
+    CompiledRegExp::CompiledRegExp(void* regex)
+        : regex(regex)
+#ifdef VMCFG_NANOJIT
+        , native(NULL)
+        , execs(0)
+        , bails(0)
+        , noNative(false)
+#endif
+    {
+    }
+
     CompiledRegExp::~CompiledRegExp()
     {
         // NOTE: we do not set the PCRE_STATE here, because we don't have a toplevel
@@ -35,6 +50,51 @@ namespace avmplus
 
         (pcre_free)((void*)(pcre*)regex);
         regex = NULL;
+#ifdef VMCFG_NANOJIT
+        mmfx_delete(native);
+        native = NULL;
+        execs = 0;
+        bails = 0;
+        noNative = false;
+#endif
+    }
+
+    int CompiledRegExp::exec(AvmCore* core, const char* subject, int length, int start, int* ovector, int ovecsize)
+    {
+        RegexCache::Stats& stats = core->m_regexCache.stats();
+#ifdef VMCFG_NANOJIT
+        if (!native && !noNative && ++execs >= core->config.regex_jit_threshold) {
+            if (core->config.regex_jit_threshold == 0 || core->config.runmode == RM_interp_all || !regex) {
+                noNative = true;
+            } else {
+                native = RegExpCode::compile(core, regex);
+                noNative = native == NULL;
+                if (native)
+                    stats.compiled++;
+                else
+                    stats.rejected++;
+                execs = 0;
+            }
+        }
+        if (native) {
+            AvmAssert(ovecsize >= OVECTOR_SIZE);    // room for every capture RegExpCode allows
+            int result = native->match(subject, length, start, ovector);
+            execs++;
+            if (result != RegExpCode::kBail) {
+                stats.nativeExecs++;
+                return result;
+            }
+            stats.nativeBails++;
+            // Mostly non-ASCII subjects, or heavy backtracking: not worth it.
+            if (++bails * 4 > execs && execs >= 64) {
+                mmfx_delete(native);
+                native = NULL;
+                noNative = true;
+            }
+        }
+#endif
+        stats.pcreExecs++;
+        return pcre_exec((pcre*)regex, NULL, subject, length, start, PCRE_NO_UTF8_CHECK, ovector, ovecsize);
     }
 
     RegExpObject::RegExpObject(VTable* ivtable, ScriptObject *objectPrototype)
@@ -362,12 +422,10 @@ namespace avmplus
         PCRE_STATE(toplevel());
         if( startIndex < 0 ||
             startIndex > subjectLength ||
-            (results = pcre_exec((pcre*)(m_pcreInst->regex),
-                                NULL,
+            (results = m_pcreInst->exec(core(),
                                 utf8Subject.c_str(),
                                 subjectLength,
                                 startIndex,
-                                PCRE_NO_UTF8_CHECK,
                                 ovector,
                                 OVECTOR_SIZE)) < 0)
         {
@@ -500,8 +558,8 @@ namespace avmplus
         // get start/end index of all matches
         int matchCount;
         while (lastIndex <= subjectLength &&
-               (matchCount = pcre_exec((pcre*)(m_pcreInst->regex), NULL, (const char*)src,
-               subjectLength, lastIndex, PCRE_NO_UTF8_CHECK, ovector, OVECTOR_SIZE)) > 0)
+               (matchCount = m_pcreInst->exec(core(), src,
+               subjectLength, lastIndex, ovector, OVECTOR_SIZE)) > 0)
         {
             int captureCount = matchCount-1;
 
@@ -617,8 +675,8 @@ namespace avmplus
         // get start/end index of all matches
         int matchCount;
         while (lastIndex < subjectLength &&
-               (matchCount = pcre_exec((pcre*)(m_pcreInst->regex), NULL, (const char*)src,
-                         subjectLength, lastIndex, PCRE_NO_UTF8_CHECK, ovector, OVECTOR_SIZE)) > 0)
+               (matchCount = m_pcreInst->exec(core(), src,
+                         subjectLength, lastIndex, ovector, OVECTOR_SIZE)) > 0)
         {
             int captureCount = matchCount-1;
 
@@ -9,13 +9,31 @@
 
 namespace avmplus
 {
+    class RegExpCode;
+
     class CompiledRegExp : public MMgc::RCObject
     {
     public:
-        CompiledRegExp(void* regex) : regex(regex) {}
+        CompiledRegExp(void* regex);
         ~CompiledRegExp();
 
+        /**
+         * pcre_exec(regex, NULL, subject, length, start, PCRE_NO_UTF8_CHECK,
+         * ovector, ovecsize), run by native code once the regex has been
+         * used config.regex_jit_threshold times and if RegExpCode can
+         * compile it.  'subject' must be NUL-terminated.
+         */
+        int exec(AvmCore* core, const char* subject, int length, int start, int* ovector, int ovecsize);
+
         void * regex; // The compiled regular expression
+
+    private:
+#ifdef VMCFG_NANOJIT
+        RegExpCode* native;     // NULL until compiled
+        uint32_t execs;         // before compiling: all runs; after: native runs
+        uint32_t bails;         // native runs handed over to pcre_exec
+        bool noNative;          // can't compile, or bails too often
+#endif
     };
 
     /**
@@ -7,6 +7,7 @@
 #ifndef __avmplus_ScriptBuffer__
 #define __avmplus_ScriptBuffer__
 
+#include "FixedHeapUtils.h"
 
 namespace avmplus
 {
@@ -73,6 +74,39 @@ namespace avmplus
         }
     };
 
+    /**
+     * SharedScriptBufferImpl is a read-only ScriptBuffer implementation
+     * over bytes that live outside any GC heap and may be used by several
+     * isolates at once, such as a memory-mapped abc or swf file.  Each
+     * buffer holds a reference to its Bytes, so they stay around as long
+     * as any PoolObject parsed from them.  Like every script buffer, the
+     * bytes must be followed by kBufferPadding readable bytes.
+     */
+    class SharedScriptBufferImpl : public ScriptBufferImpl
+    {
+    public:
+        class Bytes : public FixedHeapRCObject
+        {
+        public:
+            const uint8_t* getBuffer() const { return buffer; }
+            size_t getSize() const { return size; }
+        protected:
+            const uint8_t* buffer;
+            size_t size;
+        };
+
+        SharedScriptBufferImpl(Bytes* bytes)
+        : ScriptBufferImpl(),
+          m_bytes(bytes)
+        {
+            this->size = bytes->getSize();
+            this->buffer = (uint8_t*) bytes->getBuffer();
+        }
+
+    private:
+        FixedHeapRef<Bytes> m_bytes;
+    };
+
     /**
      * ScriptBuffer is a "handle" for ScriptBufferImpl which is more convenient
      * to pass around and use than a ScriptBufferImpl pointer.  It defines
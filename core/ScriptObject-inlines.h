@@ -76,6 +76,23 @@ REALLY_INLINE InlineHashtable* ScriptObject::getTableNoInit() const
     }
 }
 
+REALLY_INLINE InlineHashtable* ScriptObject::shapedTable() const
+{
+    // Only objects whose native part is a bare ScriptObject are shaped;
+    // subclasses such as ArrayObject work on their table directly.
+    Traits* t = vtable->traits;
+    if (!t->needsHashtable() || t->isDictionary() || t->getSizeOfInstance() != sizeof(ScriptObject))
+        return NULL;
+    InlineHashtable* iht = (InlineHashtable*)((uint8_t*)this + t->getHashtableOffset());
+    return iht->needsInitialize() ? iht : NULL;
+}
+
+REALLY_INLINE DynamicSlots* ScriptObject::getDynamicSlots() const
+{
+    InlineHashtable* iht = shapedTable();
+    return iht != NULL ? iht->getDynamicSlots() : NULL;
+}
+
 REALLY_INLINE Atom ScriptObject::getStringProperty(Stringp name) const
 {
     AvmAssert(name != NULL && name->isInterned());
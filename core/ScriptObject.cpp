@@ -118,7 +118,11 @@ namespace avmplus
         if(!vtable->traits->isDictionary())
         {
             if (iht->needsInitialize())
-                const_cast<ScriptObject*>(this)->initHashtable();
+            {
+                // callers of getTable() expect a real hashtable, so a shaped
+                // object has to give up its shape here
+                const_cast<ScriptObject*>(this)->unshape(iht);
+            }
             return iht;
         }
         else
@@ -131,9 +135,126 @@ namespace avmplus
         }
     }
 
+    void ScriptObject::putShaped(InlineHashtable* iht, Atom name, Atom value)
+    {
+        AvmCore* core = this->core();
+        DynamicSlots* slots = iht->getDynamicSlots();
+        DynamicShape* shape;
+        if (slots != NULL)
+        {
+            shape = slots->shape();
+            int32_t i = shape->find(name);
+            if (i >= 0)
+            {
+                // also revives a deleted property, in its old position
+                slots->setValueAt(uint32_t(i), value);
+                return;
+            }
+        }
+        else
+        {
+            shape = core->emptyShape();
+        }
+
+        DynamicShape* next = shape->withKey(core, name);
+        if (next == NULL)
+        {
+            // too many properties to share a shape, or no shape ids left
+            unshape(iht);
+            MMGC_MEM_TYPE(this);
+            iht->add(name, value);
+            MMGC_MEM_TYPE(NULL);
+            return;
+        }
+        uint32_t const count = next->count();
+        if (slots == NULL || slots->capacity() < count)
+        {
+            uint32_t capacity = slots != NULL ? slots->capacity() * 2 : uint32_t(DynamicSlots::kInitialCapacity);
+            if (capacity < count)
+                capacity = count;
+            MMGC_MEM_TYPE(this);
+            DynamicSlots* grown = DynamicSlots::create(gc(), next, capacity, slots);
+            if (slots != NULL)
+            {
+                // the values moved to grown without their references, cf. InlineHashtable::grow()
+                iht->setDynamicSlots(NULL);
+                delete slots;
+            }
+            iht->setDynamicSlots(grown);
+            slots = grown;
+        }
+        else
+        {
+            slots->setShape(next);
+        }
+        slots->setValueAt(count - 1, value);
+    }
+
+    void ScriptObject::unshape(InlineHashtable* iht)
+    {
+        DynamicSlots* slots = iht->getDynamicSlots();
+        if (slots == NULL)
+        {
+            initHashtable();
+            return;
+        }
+
+        DynamicShape* shape = slots->shape();
+        if (slots->isEnumerating())
+            core()->rememberUnshaped(this, shape);
+        iht->setDynamicSlots(NULL);
+        initHashtable(int(shape->count()));
+        for (uint32_t i = 0, n = shape->count(); i < n; i++)
+        {
+            Atom const value = slots->valueAt(i);
+            if (value != 0)
+                iht->add(shape->keyAt(i), value);
+        }
+        slots->destroy();
+        delete slots;
+    }
+
+    void ScriptObject::setShapedEnumerable(InlineHashtable* iht, Atom name, bool enumerable)
+    {
+        // shaped properties are all enumerable; nothing to do for a missing
+        // property, as in InlineHashtable
+        DynamicSlots* slots = iht->getDynamicSlots();
+        int32_t i = slots != NULL ? slots->shape()->find(name) : -1;
+        if (enumerable || i < 0 || slots->valueAt(uint32_t(i)) == 0)
+            return;
+
+        // DontEnum is per object, so the object leaves its shape
+        unshape(iht);
+        iht->setAtomPropertyIsEnumerable(name, false);
+    }
+
+    void ScriptObject::deleteShaped(InlineHashtable* iht, Atom name)
+    {
+        // leaves a hole, so the object keeps its shape
+        DynamicSlots* slots = iht->getDynamicSlots();
+        if (slots != NULL)
+        {
+            int32_t i = slots->shape()->find(name);
+            if (i >= 0 && slots->valueAt(uint32_t(i)) != 0)
+                slots->deleteAt(uint32_t(i));
+        }
+    }
+
     bool ScriptObject::isOwnAtomPropertyHere(Atom name, Atom *recv) const
     {
         AvmAssert(this->vtable->traits->getHashtableOffset() != 0);
+        if (InlineHashtable* iht = shapedTable())
+        {
+            // an object with no dynamic properties yet needn't get a table to say so
+            DynamicSlots* slots = iht->getDynamicSlots();
+            Atom const value = slots != NULL ? slots->get(name) : 0;
+            if (value != 0)
+            {
+                *recv = value;
+                return true;
+            }
+            return false;
+        }
         Atom const value = this->getTable()->getNonEmpty(name);
         if (!InlineHashtable::isEmpty(value))
         {
@@ -244,6 +365,11 @@ namespace avmplus
                 name = ival;
             }
 
+            if (InlineHashtable* iht = shapedTable())
+            {
+                DynamicSlots* slots = iht->getDynamicSlots();
+                return slots != NULL && slots->get(name) != 0;
+            }
             return getTable()->contains(name);
         }
         else
@@ -282,6 +408,11 @@ namespace avmplus
                 name = ival;
             }
 
+            if (InlineHashtable* iht = shapedTable())
+            {
+                putShaped(iht, name, value);
+                return;
+            }
             MMGC_MEM_TYPE(this);
             getTable()->add (name, value);
             MMGC_MEM_TYPE(NULL);
@@ -316,6 +447,12 @@ namespace avmplus
                 name = ival;
             }
 
+            if (InlineHashtable* iht = shapedTable())
+            {
+                DynamicSlots* slots = iht->getDynamicSlots();
+                int32_t i = slots != NULL ? slots->shape()->find(name) : -1;
+                return i >= 0 && slots->valueAt(uint32_t(i)) != 0;
+            }
             return getTable()->getAtomPropertyIsEnumerable(name);
         }
         else
@@ -337,6 +474,11 @@ namespace avmplus
                 name = ival;
             }
 
+            if (InlineHashtable* iht = shapedTable())
+            {
+                setShapedEnumerable(iht, name, enumerable);
+                return;
+            }
             getTable()->setAtomPropertyIsEnumerable(name, enumerable);
         }
         else
@@ -357,6 +499,11 @@ namespace avmplus
                 name = ival;
             }
 
+            if (InlineHashtable* iht = shapedTable())
+            {
+                deleteShaped(iht, name);
+                return true;
+            }
             getTable()->remove(name);
             return true;
         }
@@ -445,6 +592,11 @@ namespace avmplus
             Atom name = core->uintToAtom (i);
             if (traits()->needsHashtable())
             {
+                if (InlineHashtable* iht = shapedTable())
+                {
+                    putShaped(iht, name, value);
+                    return;
+                }
                 MMGC_MEM_TYPE(this);
                 getTable()->add(name, value);
                 MMGC_MEM_TYPE(NULL);
@@ -468,6 +620,11 @@ namespace avmplus
             Atom name = core->uintToAtom (i);
             if (traits()->needsHashtable())
             {
+                if (InlineHashtable* iht = shapedTable())
+                {
+                    deleteShaped(iht, name);
+                    return true;
+                }
                 getTable()->remove(name);
                 return true;
             }
@@ -490,6 +647,11 @@ namespace avmplus
             Atom name = core->uintToAtom (i);
             if (traits()->needsHashtable())
             {
+                if (InlineHashtable* iht = shapedTable())
+                {
+                    DynamicSlots* slots = iht->getDynamicSlots();
+                    return slots != NULL && slots->get(name) != 0;
+                }
                 return getTable()->contains(name);
             }
             else
@@ -820,7 +982,17 @@ namespace avmplus
         
         AvmAssert(index > 0);
 
+        if (InlineHashtable* iht = shapedTable())
+        {
+            DynamicSlots* slots = iht->getDynamicSlots();
+            return slots != NULL ? slots->keyAtIndex(index) : nullStringAtom;
+        }
         InlineHashtable* ht = getTable();
+        if (DynamicSlots::isShapeIndex(index))
+        {
+            DynamicShape* shape = core()->unshapedShape(this);
+            return shape != NULL ? DynamicSlots::keyAtIndex(shape, ht, index) : nullStringAtom;
+        }
         Atom m = ht->keyAt(index);
         return AvmCore::isNullOrUndefined(m) ? nullStringAtom : m;
     }
@@ -832,7 +1004,18 @@ namespace avmplus
 
         AvmAssert(index > 0);
 
+        if (InlineHashtable* iht = shapedTable())
+        {
+            DynamicSlots* slots = iht->getDynamicSlots();
+            return slots != NULL ? slots->valueAtIndex(index) : nullStringAtom;
+        }
         InlineHashtable* ht = getTable();
+        if (DynamicSlots::isShapeIndex(index))
+        {
+            DynamicShape* shape = core()->unshapedShape(this);
+            Atom name = shape != NULL ? DynamicSlots::keyAtIndex(shape, ht, index) : nullStringAtom;
+            return name != nullStringAtom ? ht->get(name) : nullStringAtom;
+        }
         Atom m = ht->keyAt(index);
         if (AvmCore::isNullOrUndefined(m))
             return nullStringAtom;
@@ -846,7 +1029,22 @@ namespace avmplus
         if (!traits()->needsHashtable())
             return 0;
 
-        return getTable()->next(index);
+        if (InlineHashtable* iht = shapedTable())
+        {
+            DynamicSlots* slots = iht->getDynamicSlots();
+            return slots != NULL ? slots->next(index) : 0;
+        }
+        InlineHashtable* ht = getTable();
+        if (DynamicSlots::isShapeIndex(index))
+        {
+            // the object left its shape during the loop; finish in the shape's
+            // order if it is remembered, else go on from the same position in
+            // the hashtable, as after InlineHashtable::grow()
+            if (DynamicShape* shape = core()->unshapedShape(this))
+                return DynamicSlots::nextUnshaped(shape, ht, index);
+            index = DynamicSlots::positionOf(index);
+        }
+        return ht->next(index);
     }
 
 #ifdef DEBUGGER
@@ -864,6 +1062,12 @@ namespace avmplus
                 p = (uint8_t*)this + traits()->getHashtableOffset();
                 bytesUsed += (*hht)->bytesUsed();
             }
+            else if (InlineHashtable* iht = shapedTable())
+            {
+                DynamicSlots* slots = iht->getDynamicSlots();
+                if (slots != NULL)
+                    bytesUsed += slots->bytesUsed();
+            }
             else
             {
                 bytesUsed += getTable()->bytesUsed();
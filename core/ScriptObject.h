@@ -56,6 +56,14 @@ namespace avmplus
          * Dictionary.
          */
         InlineHashtable* getTableNoInit() const;
+        /**
+         * An object of plain Object (or of an AS3 dynamic class) keeps its
+         * dynamic properties by shape, see DynamicShape, and switches to an
+         * InlineHashtable when it gets more than DynamicShape::kMaxShared of
+         * them or a DontEnum one, or if getTable() is called.  Returns the
+         * values vector of a shaped object, or NULL.
+         */
+        DynamicSlots* getDynamicSlots() const;
 
         Atom getSlotAtom(uint32_t slot, AvmCore *core);
 
@@ -218,6 +226,15 @@ namespace avmplus
     private:
         void initHashtable(int capacity = InlineHashtable::kDefaultCapacity);
 
+        // The inline table if it is unused or holds a DynamicSlots vector,
+        // i.e. if dynamic properties are (still) kept by shape; else NULL.
+        InlineHashtable* shapedTable() const;
+        void putShaped(InlineHashtable* iht, Atom name, Atom value);
+        void setShapedEnumerable(InlineHashtable* iht, Atom name, bool enumerable);
+        void deleteShaped(InlineHashtable* iht, Atom name);
+        // moves the properties into a real hashtable in iht, for good
+        void unshape(InlineHashtable* iht);
+
     // ------------------------ DATA SECTION BEGIN
     public:     VTable* const           vtable;
     private:    GCMember<ScriptObject>  delegate;     // __proto__ in AS2, archetype in semantics
@@ -8,6 +8,15 @@
 
 #include "avmplus.h"
 
+//GCC only allows intrinsics if sse2 is enabled
+#if (defined(_MSC_VER) || (defined(__GNUC__) && defined(__SSE2__))) && (defined(AVMPLUS_IA32) || defined(AVMPLUS_AMD64))
+    #include <emmintrin.h>
+    #ifdef _MSC_VER
+        #include <intrin.h>
+    #endif
+    #define AVMPLUS_STRING_SSE2
+#endif
+
 // This is the maximum value for the characters Left field in the
 // m_bitsAndFlags field of the String instance. Strings grow by
 // by doubling the available buffer size until the characters left
@@ -28,6 +37,17 @@
 // Never allocate dynamic strings smaller than this (in bytes)
 #define TSTR_MIN_DYNAMIC_ALLOCATION 32
 
+// Concatenations shorter than this (in characters) are always copied rather than
+// made into ropes; copying them costs about as much as creating and later
+// flattening a rope.
+#define TSTR_MIN_ROPE_LENGTH 256
+
+// The maximum number of rope levels below a string. A concatenation that would
+// go deeper is copied into a new buffer instead, so the nodes of a long chain of
+// concatenations are dropped every so often, and the copy has padding to
+// append to in place again.
+#define TSTR_MAX_ROPE_DEPTH 1024
+
 // in fixDependentString, don't bother going dependent->dynamic if the memory
 // we would save is < this (in bytes)
 #define TSTR_DEPENDENT_STRING_NUISANCE_SAVINGS int32_t(sizeof(String))
@@ -256,6 +276,265 @@ namespace avmplus
         return -1;
     }
 
+#ifdef AVMPLUS_STRING_SSE2
+
+    // SSE2 versions of the helpers above for the cases where both strings have
+    // the same width, which are the common ones.  They are plain overloads, so
+    // they are picked over the templates without changes to the callers; mixed
+    // widths still go to the templates.  Sixteen bytes are compared at a time,
+    // and every load stays within the characters the scalar loop would read.
+
+    template <typename STR> struct SSE2Chars;
+
+    template <> struct SSE2Chars<uint8_t>
+    {
+        enum { kPerVector = 16 };
+        static REALLY_INLINE __m128i splat(wchar c) { return _mm_set1_epi8(char(c)); }
+        static REALLY_INLINE __m128i equal(__m128i a, __m128i b) { return _mm_cmpeq_epi8(a, b); }
+        // one bit per character, set where the result of equal() was true
+        static REALLY_INLINE uint32_t bits(__m128i eq) { return uint32_t(_mm_movemask_epi8(eq)); }
+    };
+
+    template <> struct SSE2Chars<wchar>
+    {
+        enum { kPerVector = 8 };
+        static REALLY_INLINE __m128i splat(wchar c) { return _mm_set1_epi16(short(c)); }
+        static REALLY_INLINE __m128i equal(__m128i a, __m128i b) { return _mm_cmpeq_epi16(a, b); }
+        // one bit per character, set where the result of equal() was true
+        static REALLY_INLINE uint32_t bits(__m128i eq) { return uint32_t(_mm_movemask_epi8(_mm_packs_epi16(eq, _mm_setzero_si128()))); }
+    };
+
+    template <typename STR>
+    /*static*/ REALLY_INLINE __m128i loadChars(const STR* p)
+    {
+        return _mm_loadu_si128((const __m128i*)p);
+    }
+
+    /*static*/ REALLY_INLINE int32_t lowestBit(uint32_t bits)
+    {
+        AvmAssert(bits != 0);
+    #ifdef _MSC_VER
+        unsigned long i;
+        _BitScanForward(&i, bits);
+        return int32_t(i);
+    #else
+        return __builtin_ctz(bits);
+    #endif
+    }
+
+    /*static*/ REALLY_INLINE int32_t highestBit(uint32_t bits)
+    {
+        AvmAssert(bits != 0);
+    #ifdef _MSC_VER
+        unsigned long i;
+        _BitScanReverse(&i, bits);
+        return int32_t(i);
+    #else
+        return 31 - __builtin_clz(bits);
+    #endif
+    }
+
+    // Index of the first character at which str1 and str2 differ, or len.
+    template <typename STR>
+    /*static*/ REALLY_INLINE int32_t mismatchSSE2(const STR* str1, const STR* str2, int32_t len)
+    {
+        typedef SSE2Chars<STR> V;
+        uint32_t const all = (1 << V::kPerVector) - 1;
+        int32_t i = 0;
+        for (; i <= len - V::kPerVector; i += V::kPerVector)
+        {
+            uint32_t const diff = V::bits(V::equal(loadChars(str1 + i), loadChars(str2 + i))) ^ all;
+            if (diff)
+                return i + lowestBit(diff);
+        }
+        for (; i < len; i++)
+        {
+            if (str1[i] != str2[i])
+                return i;
+        }
+        return len;
+    }
+
+    template <typename STR>
+    /*static*/ REALLY_INLINE int32_t indexOfCharCodeSSE2(const STR* str, int32_t start, int32_t right, wchar c)
+    {
+        typedef SSE2Chars<STR> V;
+        __m128i const vc = V::splat(c);
+        int32_t i = start;
+        for (; i <= right - (V::kPerVector - 1); i += V::kPerVector)
+        {
+            uint32_t const found = V::bits(V::equal(loadChars(str + i), vc));
+            if (found)
+                return i + lowestBit(found);
+        }
+        for (; i <= right; i++)
+        {
+            if (str[i] == c)
+                return i;
+        }
+        return -1;
+    }
+
+    // Candidates are the positions where both the first and the last character
+    // of the pattern match; only those are compared in full.
+    template <typename STR>
+    /*static*/ REALLY_INLINE int32_t indexOfSSE2(const STR* str, int32_t start, int32_t right, const STR* pat, int32_t patlen)
+    {
+        typedef SSE2Chars<STR> V;
+        AvmAssert(patlen > 0);
+        int32_t const last = patlen - 1;
+        __m128i const vfirst = V::splat(pat[0]);
+        __m128i const vlast = V::splat(pat[last]);
+        int32_t i = start;
+        for (; i <= right - (V::kPerVector - 1); i += V::kPerVector)
+        {
+            uint32_t found = V::bits(_mm_and_si128(V::equal(loadChars(str + i), vfirst),
+                                                   V::equal(loadChars(str + i + last), vlast)));
+            while (found)
+            {
+                int32_t const j = i + lowestBit(found);
+                if (patlen <= 2 || mismatchSSE2(str + j + 1, pat + 1, patlen - 2) == patlen - 2)
+                    return j;
+                found &= found - 1;
+            }
+        }
+        for (; i <= right; i++)
+        {
+            if (str[i] == pat[0] && mismatchSSE2(str + i + 1, pat + 1, last) == last)
+                return i;
+        }
+        return -1;
+    }
+
+    template <typename STR>
+    /*static*/ REALLY_INLINE int32_t lastIndexOfSSE2(const STR* str, int32_t start, const STR* pat, int32_t patlen)
+    {
+        typedef SSE2Chars<STR> V;
+        AvmAssert(patlen > 0);
+        AvmAssert(start >= 0);
+        int32_t const last = patlen - 1;
+        __m128i const vfirst = V::splat(pat[0]);
+        __m128i const vlast = V::splat(pat[last]);
+        // i is the highest position not yet looked at
+        int32_t i = start;
+        for (; i >= V::kPerVector - 1; i -= V::kPerVector)
+        {
+            int32_t const base = i - (V::kPerVector - 1);
+            uint32_t found = V::bits(_mm_and_si128(V::equal(loadChars(str + base), vfirst),
+                                                   V::equal(loadChars(str + base + last), vlast)));
+            while (found)
+            {
+                int32_t const bit = highestBit(found);
+                int32_t const j = base + bit;
+                if (patlen <= 2 || mismatchSSE2(str + j + 1, pat + 1, patlen - 2) == patlen - 2)
+                    return j;
+                found &= ~(1U << bit);
+            }
+        }
+        for (; i >= 0; i--)
+        {
+            if (str[i] == pat[0] && mismatchSSE2(str + i + 1, pat + 1, last) == last)
+                return i;
+        }
+        return -1;
+    }
+
+    /*static*/ REALLY_INLINE bool equalsImpl(const uint8_t* str1, const uint8_t* str2, int32_t len)
+    {
+        return mismatchSSE2(str1, str2, len) == len;
+    }
+
+    /*static*/ REALLY_INLINE bool equalsImpl(const wchar* str1, const wchar* str2, int32_t len)
+    {
+        return mismatchSSE2(str1, str2, len) == len;
+    }
+
+    /*static*/ REALLY_INLINE int32_t compareImpl(const uint8_t* str1, const uint8_t* str2, int32_t len)
+    {
+        int32_t const i = mismatchSSE2(str1, str2, len);
+        return i < len ? int32_t(str2[i] - str1[i]) : 0;
+    }
+
+    /*static*/ REALLY_INLINE int32_t compareImpl(const wchar* str1, const wchar* str2, int32_t len)
+    {
+        int32_t const i = mismatchSSE2(str1, str2, len);
+        return i < len ? int32_t(str2[i] - str1[i]) : 0;
+    }
+
+    /*static*/ REALLY_INLINE int32_t indexOfImpl(const uint8_t* str, int32_t start, int32_t right, const uint8_t* pat, int32_t patlen)
+    {
+        return indexOfSSE2(str, start, right, pat, patlen);
+    }
+
+    /*static*/ REALLY_INLINE int32_t indexOfImpl(const wchar* str, int32_t start, int32_t right, const wchar* pat, int32_t patlen)
+    {
+        return indexOfSSE2(str, start, right, pat, patlen);
+    }
+
+    /*static*/ REALLY_INLINE int32_t indexOfCharCodeImpl(const uint8_t* str, int32_t start, int32_t right, wchar c)
+    {
+        // no 8-bit character can match
+        if (c > 0xFF)
+            return -1;
+        return indexOfCharCodeSSE2(str, start, right, c);
+    }
+
+    /*static*/ REALLY_INLINE int32_t indexOfCharCodeImpl(const wchar* str, int32_t start, int32_t right, wchar c)
+    {
+        return indexOfCharCodeSSE2(str, start, right, c);
+    }
+
+    /*static*/ REALLY_INLINE int32_t lastIndexOfImpl(const uint8_t* str, int32_t start, const uint8_t* pat, int32_t patlen)
+    {
+        return lastIndexOfSSE2(str, start, pat, patlen);
+    }
+
+    /*static*/ REALLY_INLINE int32_t lastIndexOfImpl(const wchar* str, int32_t start, const wchar* pat, int32_t patlen)
+    {
+        return lastIndexOfSSE2(str, start, pat, patlen);
+    }
+
+    // Compares the ASCII characters of str and pat without regard to case and
+    // returns the number of leading characters known to match that way; it stops
+    // early at the first 16 characters that have a mismatch or a non-ASCII
+    // character, which are left for wCharToUpper().
+    /*static*/ REALLY_INLINE int32_t matchesASCIICaselessSSE2(const uint8_t* str, const uint8_t* pat, int32_t len)
+    {
+        __m128i const before_a = _mm_set1_epi8('a' - 1);
+        __m128i const after_z = _mm_set1_epi8('z' + 1);
+        __m128i const caseBit = _mm_set1_epi8(0x20);
+        int32_t i = 0;
+        for (; i <= len - 16; i += 16)
+        {
+            __m128i a = loadChars(str + i);
+            __m128i b = loadChars(pat + i);
+            // A byte >= 0x80 is negative as a signed byte and sets a bit here.
+            if (_mm_movemask_epi8(_mm_or_si128(a, b)) != 0)
+                break;
+            // Clear bit 5 of the lower case letters (the bytes are all < 0x80,
+            // so the signed compares are good).
+            a = _mm_sub_epi8(a, _mm_and_si128(_mm_and_si128(_mm_cmpgt_epi8(a, before_a), _mm_cmpgt_epi8(after_z, a)), caseBit));
+            b = _mm_sub_epi8(b, _mm_and_si128(_mm_and_si128(_mm_cmpgt_epi8(b, before_a), _mm_cmpgt_epi8(after_z, b)), caseBit));
+            if (_mm_movemask_epi8(_mm_cmpeq_epi8(a, b)) != 0xFFFF)
+                break;
+        }
+        return i;
+    }
+
+#endif // AVMPLUS_STRING_SSE2
+
+    // Eight steps of the hash function with no characters mixed in, i.e. eight
+    // applications of h = (h >> 28) ^ (h << 4).  The rotations cancel out, and
+    // what is left of the sign extensions inverts nibble n of h when the top bits
+    // of nibbles n and n+1 differ, and all of h when bit 3 is set.
+    /*static*/ REALLY_INLINE int32_t hashStep8(int32_t hashCode)
+    {
+        uint32_t const h = uint32_t(hashCode);
+        uint32_t const tops = h & 0x88888888;
+        uint32_t const flips = ((tops ^ (tops >> 4)) >> 3) & 0x11111111;
+        return int32_t(h ^ (flips * 15) ^ (0 - ((h >> 3) & 1)));
+    }
+
     // apparently SunPro compiler doesn't like combining REALLY_INLINE with static functions.
     template <typename STR>
     /*static*/ REALLY_INLINE int32_t hashCodeImpl(const STR* str, int32_t len)
@@ -265,6 +544,26 @@ namespace avmplus
         // must be same signed-ness as other hashcode functions.
         // experimentation shows better results from signed (vs unsigned).
         int32_t hashCode = 0;
+
+        // Each step is linear (over GF(2)) in both hashCode and the character, so
+        // eight steps come to hashStep8(hashCode) ^ g, where g is the hash of the
+        // eight characters alone.  g does not depend on hashCode, which breaks the
+        // loop-carried dependency that otherwise limits this loop to one step
+        // at a time.
+        while (len >= 8)
+        {
+            int32_t g = str[0];
+            g = (g >> 28) ^ (g << 4) ^ str[1];
+            g = (g >> 28) ^ (g << 4) ^ str[2];
+            g = (g >> 28) ^ (g << 4) ^ str[3];
+            g = (g >> 28) ^ (g << 4) ^ str[4];
+            g = (g >> 28) ^ (g << 4) ^ str[5];
+            g = (g >> 28) ^ (g << 4) ^ str[6];
+            g = (g >> 28) ^ (g << 4) ^ str[7];
+            hashCode = hashStep8(hashCode) ^ g;
+            str += 8;
+            len -= 8;
+        }
         while (len--)
             hashCode = (hashCode >> 28) ^ (hashCode << 4) ^ *str++;
         return hashCode;
@@ -370,6 +669,34 @@ namespace avmplus
 #endif
     }
 
+    // ctor for a rope.
+
+    REALLY_INLINE String::String(MMgc::GC* gc, Stringp left, Stringp right, int32_t depth) :
+#ifdef DEBUGGER
+        AvmPlusScriptableObject(sotString()),
+        m_buffer((void*)NULL),
+        m_extra(NULL),
+#else
+        m_buffer((void*)right),
+        m_extra(left),
+#endif
+        m_length(left->m_length + right->m_length),
+        m_bitsAndFlags((left->getWidth() | right->getWidth()) | (kRope << TSTR_TYPE_SHIFT) | (depth << TSTR_CHARSLEFT_SHIFT))
+    {
+        AvmAssert(m_length >= 0);
+        AvmAssert((uint64_t(m_length) << getWidth()) <= 0x7FFFFFFFU);
+        AvmAssert(depth > 0 && depth <= TSTR_MAX_ROPE_DEPTH);
+#ifdef DEBUGGER
+        // see the ctor for a dependent string
+        WBRC(gc, this, &this->m_extra.left, left);
+        WBRC(gc, this, &this->m_buffer.right, right);
+#else
+        left->IncrementRef();
+        right->IncrementRef();
+        (void)gc;
+#endif
+    }
+
     // add a and b and check for overflow
 
     static int32_t int32AddChecked(int32_t a, int32_t b)
@@ -426,6 +753,15 @@ namespace avmplus
         return s;
     }
 
+    // Private static method to create a rope. The caller has checked the length
+    // for overflow.
+
+    /*static*/ Stringp String::createRope(GC* gc, Stringp left, Stringp right, int32_t depth)
+    {
+        MMGC_MEM_TAG( "Strings" );
+        return new(gc, MMgc::kExact) String(gc, left, right, depth);
+    }
+
     // Private static method to create a dynamic string, given a buffer and its size in characters
 
     /*static*/ Stringp String::createDynamic(GC* gc, const void* data, int32_t len, Width w, bool is7bit, int32_t extra)
@@ -552,14 +888,56 @@ namespace avmplus
         const bool is7bit = false;
         Stringp newStr = createDynamic(_gc(this), NULL, m_length, w, is7bit);
 
-        Pointers ptrs(this);
-        Pointers new_ptrs(newStr);
-        _copyBuffers(ptrs.pv, new_ptrs.pv, m_length, getWidth(), w);
+        // a rope is copied straight into the new string rather than flattened first
+        copyChars(this, Pointers(newStr).pv, w);
 
         VERIFY_7BIT(newStr);
         return newStr;
     }
 
+    /*static*/ void* String::copyChars(const String* s, void* dst, Width dstWidth)
+    {
+        uint8_t* const end = (uint8_t*)dst + (s->m_length << dstWidth);
+        while (s->isRope())
+        {
+            const String* const left = s->m_extra.left;
+            const String* const right = s->m_buffer.right;
+            // Recurse into the shorter half and loop on the longer one, so the
+            // recursion is never more than log2(length) deep, whatever the shape
+            // of the rope.
+            if (left->m_length >= right->m_length)
+            {
+                copyChars(right, (uint8_t*)dst + (left->m_length << dstWidth), dstWidth);
+                s = left;
+            }
+            else
+            {
+                dst = copyChars(left, dst, dstWidth);
+                s = right;
+            }
+        }
+        _copyBuffers(Pointers(s).pv, dst, s->m_length, s->getWidth(), dstWidth);
+        return end;
+    }
+
+    void* String::flatten()
+    {
+        AvmAssert(isRope());
+        Width const w = getWidth();
+        int32_t const bytes = m_length << w;       // No overflow by definition
+        GC* gc = _gc(this);
+        MMGC_MEM_TYPE( this );
+        void* buf = gc->Alloc(bytes, 0);
+        copyChars(this, buf, w);
+        WBRC_NULL(&m_extra.left);
+        WBRC_NULL(&m_buffer.right);
+        WB(gc, this, &this->m_buffer.pv, buf);
+        setType(kDynamic);
+        // the allocation may have been rounded up; the rest can be appended to in place
+        setCharsLeft(int32_t(GC::Size(buf) >> w) - m_length);
+        return buf;
+    }
+
 /////////////////////////////// Destructors & tracers ////////////////////////////////
 
     String::~String()
@@ -577,6 +955,10 @@ namespace avmplus
                 // WBRC() is however necessary when we store NULL over an RC pointer
                 WBRC_NULL(&m_extra.master);
                 break;
+            case kRope:
+                WBRC_NULL(&m_extra.left);
+                WBRC_NULL(&m_buffer.right);
+                break;
             default: ; // kStatic
         }
         m_extra.master = NULL;  // might have already been cleared above, but that's ok
@@ -597,6 +979,10 @@ namespace avmplus
             case kDependent:
                 gc->TraceLocation(&m_extra.master);
                 break;
+            case kRope:
+                gc->TraceLocation(&m_extra.left);
+                gc->TraceLocation(&m_buffer.right);
+                break;
         }
         return false;
     }
@@ -1124,6 +1510,19 @@ namespace avmplus
             pos = 0;
         if (len < 0)
             len = Length(p);
+        if (len > m_length - pos)
+            return false;
+
+#ifdef AVMPLUS_STRING_SSE2
+        if (getWidth() == k8)
+        {
+            Pointers ptrs(this);
+            int32_t const n = matchesASCIICaselessSSE2(ptrs.p8 + pos, (const uint8_t*)p, len);
+            pos += n;
+            p += n;
+            len -= n;
+        }
+#endif
 
         StringIndexer self(this);
         while (len--)
@@ -1143,7 +1542,7 @@ namespace avmplus
         if (leftStr == NULL || leftStr->m_length == 0)
             return rightStr;
 
-        return leftStr->_append(rightStr, Pointers(rightStr), rightStr->length(), rightStr->getWidth());
+        return leftStr->_appendString(rightStr);
     }
 
     Stringp String::append(Stringp rightStr)
@@ -1151,6 +1550,15 @@ namespace avmplus
         if (rightStr == NULL || rightStr->m_length == 0)
             return this;
 
+        return _appendString(rightStr);
+    }
+
+    Stringp String::_appendString(Stringp rightStr)
+    {
+        // _append() copies the characters of a rope through rightStrPtr, so there
+        // is no need to flatten it for a Pointers
+        if (rightStr->isRope())
+            return _append(rightStr, Pointers((const uint8_t*)NULL), rightStr->length(), rightStr->getWidth());
         return _append(rightStr, Pointers(rightStr), rightStr->length(), rightStr->getWidth());
     }
 
@@ -1169,6 +1577,7 @@ namespace avmplus
         // ASCII character, return the cached character
         if (m_length == 0 && numChars == 1)
         {
+            AvmAssert(rightStr.pv != NULL);     // a rope is never that short
             // Sun studio generated wrong code for the following Conditional operator.
             // Add type conversion to wchar as a workaround.
             wchar ch = (charWidth == k8) ? (wchar)rightStr.p8[0] : (wchar)rightStr.p16[0];
@@ -1186,7 +1595,7 @@ namespace avmplus
         // string types other than kDynamic have charsLeft == 0
         int32_t charsLeft = 0;
         int32_t charsUsed = 0;
-        if (thisWidth >= charWidth)
+        if (thisWidth >= charWidth && !isRope())
         {
             // in-place append only if rightStr's width fits into leftStr
             charsLeft = master->getCharsLeft();
@@ -1196,6 +1605,9 @@ namespace avmplus
                 charsUsed = int32_t((GC::Size(master->m_buffer.pv) >> thisWidth) - master->m_length - charsLeft);
         }
         int32_t start = 0;  // string start for dependent strings
+        // false if this string could never be appended to in place, however
+        // large its buffer; see the rope case below
+        bool atEnd = true;
 
         // it is possible to append in-place if
         // 1) this is a kDynamic string and charsUsed == 0
@@ -1204,24 +1616,34 @@ namespace avmplus
         {
             case kDynamic:
                 if (charsUsed != 0)
+                {
                     // someone else has already appended in-place
                     charsLeft = 0;
+                    atEnd = false;
+                }
                 break;
             case kDependent:
                 start = (int32_t) m_buffer.offset_bytes >> thisWidth;
                 if ((start + m_length) != master->m_length + charsUsed)
+                {
                     charsLeft = 0;
+                    atEnd = false;
+                }
+                break;
+            default:    // kStatic, kRope
+                atEnd = false;
                 break;
-            default:;   // kStatic
         }
 
         // the big check: are there enough chars left?
         if (numChars <= charsLeft)
         {
             // the right-hand string fits into the buffer end
-            _copyBuffers(rightStr.pv,
-                         Pointers(this).p8 + (m_length << thisWidth),   // m_length << thiswidth is safe by definition
-                         numChars, charWidth, newWidth);
+            uint8_t* end = Pointers(this).p8 + (m_length << thisWidth);  // m_length << thiswidth is safe by definition
+            if (rightStr.pv != NULL)
+                _copyBuffers(rightStr.pv, end, numChars, charWidth, newWidth);
+            else
+                copyChars(rightStrPtr, end, newWidth);  // a rope, see _appendString()
 
             charsUsed += numChars;
             charsLeft -= numChars;
@@ -1246,6 +1668,20 @@ namespace avmplus
         }
 
         // fall thru - string does not fit
+        // If this string is at the end of its buffer, the copy below has padding
+        // for the appends that follow, as usual. Otherwise, every append to it
+        // would copy it again, which makes building a long string quadratic, so
+        // make a rope unless the result is short or the rope would be too deep
+        // (see the definitions of TSTR_MIN_ROPE_LENGTH and TSTR_MAX_ROPE_DEPTH above).
+        if (!atEnd && rightStrPtr != NULL && newLen >= TSTR_MIN_ROPE_LENGTH)
+        {
+            int32_t const leftDepth = getRopeDepth();
+            int32_t const rightDepth = rightStrPtr->getRopeDepth();
+            int32_t const depth = 1 + (leftDepth > rightDepth ? leftDepth : rightDepth);
+            if (depth <= TSTR_MAX_ROPE_DEPTH)
+                return createRope(gc, this, rightStrPtr, depth);
+        }
+
         // create a new kDynamic string containing the concatenated string
         // See the definition of TSTR_MAX_CHARSLEFT above for an explanation
         // of this algorithm
@@ -1258,20 +1694,14 @@ namespace avmplus
         Stringp newStr = createDynamic(gc, NULL, newLen, newWidth, is7bit, extra);
 
         // note that createDynamic has invalidated any existing Pointers structs...
-        const void* srcLeft = Pointers(this).pv;
-        const void* srcRight = rightStrPtr ? Pointers(rightStrPtr).pv : rightStr.pv;
-
         // copy leftStr
-        void* ptr = _copyBuffers(srcLeft,
-                      newStr->m_buffer.pv,
-                      m_length,
-                      thisWidth, newWidth);
+        void* ptr = copyChars(this, newStr->m_buffer.pv, newWidth);
 
         // append src
-        _copyBuffers(srcRight,
-                      ptr,
-                      numChars,
-                      charWidth, newWidth);
+        if (rightStrPtr != NULL)
+            copyChars(rightStrPtr, ptr, newWidth);
+        else
+            _copyBuffers(rightStr.pv, ptr, numChars, charWidth, newWidth);
 
 #ifdef _DEBUG
         // Terminate string with 0 for better debugging display
@@ -1320,6 +1750,8 @@ namespace avmplus
         }
 
         // otherwise, create a dependent string
+        if (isRope())
+            flatten();
         Stringp master = this;
         if (isDependent())
         {
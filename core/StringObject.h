@@ -21,6 +21,8 @@ namespace avmplus
     This buffer must exist as long as the string exists; character constants are
     ideal candidates for this type. The kDependent type is a string that points
     into another string; this type is created in a substring or concatenation operation.
+    The kRope type is the concatenation of two other strings that has not been copied
+    into a buffer yet; see below.
     Strings cannot be deleted directly, because they may be referenced be dependent strings.
     <p>
     String concatenation attempts first to use additional memory that the memory
@@ -33,6 +35,14 @@ namespace avmplus
     the new length, up to a platform-dependent maximum(usually 64K). This value can be
     tweaked for platforms with memory constraints in favor of more copying operations.
     <p>
+    If a long string cannot be appended in place (the left-hand string is short and the
+    right-hand string is long, the buffer's padding has been used by another append, or
+    the left-hand string is a substring), the concatenation is a kRope string that just
+    refers to both halves. A rope is flattened, i.e. turned into a kDynamic string, when
+    its characters are first needed; that includes hashing and interning it. Ropes are
+    only made for results of at least TSTR_MIN_ROPE_LENGTH characters, and are at most
+    TSTR_MAX_ROPE_DEPTH deep: a concatenation that would go deeper is copied instead.
+    <p>
     Strings exist in 8, 16, and 32-bit flavors. The 8-bit flavor only holds the first
     256 Unicode characters. All widths ignore Unicode surrogate pairs, treating them
     as ordinary characters. Use the createUTFxx() methods to deal with surrogate pairs and
@@ -49,12 +59,13 @@ namespace avmplus
 
     public:
 
-        /// String type constants. Note that isDependent() and isStatic() rely on using these values as bitflags.
+        /// String type constants. Note that Pointers relies on kDependent and kRope sharing a bit.
         enum Type
         {
             kDynamic            = 0,    // buffer is on the heap
             kStatic             = 1,    // buffer is static
-            kDependent          = 2     // string points into master string
+            kDependent          = 2,    // string points into master string
+            kRope               = 3     // string is the concatenation of two strings, see above
         };
         /// String width constants.
         enum Width
@@ -179,9 +190,11 @@ namespace avmplus
         /// Return the string type.
         REALLY_INLINE   int32_t     getType() const { return ((m_bitsAndFlags & TSTR_TYPE_MASK) >> TSTR_TYPE_SHIFT); }
         /// Return true iff getType() == kDependent.
-        REALLY_INLINE   bool        isDependent() const { return (m_bitsAndFlags & (kDependent << TSTR_TYPE_SHIFT)) != 0; }
+        REALLY_INLINE   bool        isDependent() const { return (m_bitsAndFlags & TSTR_TYPE_MASK) == (kDependent << TSTR_TYPE_SHIFT); }
         /// Return true iff getType() == kStatic.
-        REALLY_INLINE   bool        isStatic() const { return (m_bitsAndFlags & (kStatic << TSTR_TYPE_SHIFT)) != 0; }
+        REALLY_INLINE   bool        isStatic() const { return (m_bitsAndFlags & TSTR_TYPE_MASK) == (kStatic << TSTR_TYPE_SHIFT); }
+        /// Return true iff getType() == kRope.
+        REALLY_INLINE   bool        isRope() const { return (m_bitsAndFlags & TSTR_TYPE_MASK) == (kRope << TSTR_TYPE_SHIFT); }
         /// Is this an interned string?
         REALLY_INLINE   bool        isInterned() const { return (m_bitsAndFlags & TSTR_INTERNED_FLAG) != 0; }
         /// Mark this string as interned.
@@ -446,12 +459,14 @@ namespace avmplus
         friend class StUTF8String;
         friend class StUTF16String;
         friend class CodegenLIR;
+        friend class JSONParser;
+        friend class JSONSerializer;
 
     private:
         /**
-            This is a union of three different pointers, or an offset value -- you
-            must know what type of String this is (static, dynamic, dependent) to know
-            how to interpret the field.
+            This is a union of three different pointers, or an offset value, or the right-hand
+            half of a rope -- you must know what type of String this is (static, dynamic,
+            dependent, rope) to know how to interpret the field.
 
             Note that the offset value is always in bytes, regardless of string width!
 
@@ -468,20 +483,22 @@ namespace avmplus
                 uint8_t*        p8;
                 wchar*          p16;
                 uintptr_t       offset_bytes;
+                Stringp         right;  // used for ropes
             };
             REALLY_INLINE explicit Buffer(const void* _pv) { pv = const_cast<void*>(_pv); }
             REALLY_INLINE explicit Buffer(uintptr_t _offset_bytes) { offset_bytes = _offset_bytes; }
         };
 
         /**
-            Extra storage, for the Master pointer (for dependent strings)
-            or index value (lazily calculated for other strings)
+            Extra storage, for the Master pointer (for dependent strings), the left-hand
+            half (for ropes), or index value (lazily calculated for other strings)
         */
         struct Extra
         {
             union
             {
                 Stringp         master; // used for dependent strings
+                Stringp         left;   // used for ropes
         mutable uint32_t        index;  // if not dependent, this is the index value for getIntAtom/parseIndex
             };
             REALLY_INLINE explicit Extra(Stringp _master) { master = _master; }
@@ -510,7 +527,7 @@ namespace avmplus
                     TSTR_NOUINT_FLAG        = 0x00000040,   // set in parseIndex() if the string is not an unsigned integer
                     TSTR_UINT28_FLAG        = 0x00000080,   // set if m_index contains value for getIntAtom()
                     TSTR_UINT32_FLAG        = 0x00000100,   // set if m_index contains value for parseIndex()
-                    TSTR_CHARSLEFT_MASK     = 0xFFFFFE00,   // characters left in buffer field (for inplace concat)
+                    TSTR_CHARSLEFT_MASK     = 0xFFFFFE00,   // characters left in buffer field (for inplace concat), or depth of a rope
                     TSTR_CHARSLEFT_SHIFT    = 9
                 };
 
@@ -533,10 +550,13 @@ namespace avmplus
             REALLY_INLINE explicit Pointers(const String* const self)
             {
                 AvmAssert(self != NULL);
-                if (!self->isDependent())
+                // a single test for kDynamic and kStatic, the common cases
+                if (!(self->m_bitsAndFlags & (kDependent << TSTR_TYPE_SHIFT)))
                     p8 = self->m_buffer.p8;
-                else
+                else if (self->isDependent())
                     p8 = self->m_extra.master->m_buffer.p8 + self->m_buffer.offset_bytes;
+                else
+                    p8 = const_cast<String*>(self)->flatten();
             }
             REALLY_INLINE explicit Pointers(const uint8_t* _p8) { p8 = const_cast<uint8_t*>(_p8); }
             REALLY_INLINE explicit Pointers(const uint16_t* _p16) { p16 = const_cast<uint16_t*>(_p16); }
@@ -545,6 +565,8 @@ namespace avmplus
         REALLY_INLINE   void        setType(char index)         { m_bitsAndFlags = (m_bitsAndFlags & ~TSTR_TYPE_MASK) |(index << TSTR_TYPE_SHIFT); }
         REALLY_INLINE   int32_t     getCharsLeft() const        { return (m_bitsAndFlags & TSTR_CHARSLEFT_MASK) >> TSTR_CHARSLEFT_SHIFT; }
         REALLY_INLINE   void        setCharsLeft(int32_t n)     { m_bitsAndFlags = (m_bitsAndFlags & ~TSTR_CHARSLEFT_MASK) |(n << TSTR_CHARSLEFT_SHIFT); }
+        // The number of rope levels below this string, i.e. zero if it is not a rope.
+        REALLY_INLINE   int32_t     getRopeDepth() const        { return isRope() ? getCharsLeft() : 0; }
 
         // Create a string with no buffer.
         static  Stringp             createDependent(MMgc::GC* gc, Stringp master, int32_t start, int32_t len);
@@ -552,6 +574,14 @@ namespace avmplus
         static  Stringp             createDynamic(MMgc::GC* gc, const void* data, int32_t len, Width w, bool is7bit, int32_t extra=0);
         // Create a string with a static buffer.
         static  Stringp             createStatic(MMgc::GC* gc, const void* data, int32_t len, Width w, bool is7bit);
+        // Create a rope for the concatenation of left and right.
+        static  Stringp             createRope(MMgc::GC* gc, Stringp left, Stringp right, int32_t depth);
+
+        // Copy the characters of a string of any type to dst, converting them to dstWidth,
+        // and return the end of the copy. Ropes are not flattened.
+        static  void*               copyChars(const String* s, void* dst, Width dstWidth);
+        // Convert a rope to a kDynamic string and return its buffer.
+                void*               flatten();
 
         // Convert the string data to a dynamic buffer.
                 void                convertToDynamic();
@@ -560,6 +590,10 @@ namespace avmplus
         Low-level append worker.
         */
                 Stringp             _append(Stringp rightStrPtr, const Pointers& rightStr, int32_t numChars, Width width);
+        /**
+        Append a whole string. If it is a rope, it is read without being flattened.
+        */
+                Stringp             _appendString(Stringp rightStr);
 
         #ifdef _DEBUG
             void verify7bit() const;
@@ -585,6 +619,8 @@ namespace avmplus
         REALLY_INLINE               String(MMgc::GC* gc, void* buffer, Width w, int32_t length, int32_t charsLeft, bool is7bit);
         // ctor for a dependent string.
         REALLY_INLINE               String(MMgc::GC* gc, Stringp master, int32_t start, int32_t length);
+        // ctor for a rope.
+        REALLY_INLINE               String(MMgc::GC* gc, Stringp left, Stringp right, int32_t depth);
     };
 
     // Compare helpers
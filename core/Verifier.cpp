@@ -1502,8 +1502,11 @@ namespace avmplus
                     FrameValue& obj = state->peek(n);
                     if (multiname.isRtname())
                     {
-                        // restarg assumes the property name is an atom, so we must coerce it to an atom on input
-                        emitCoerce(NULL, state->sp());
+                        // restarg takes the property name as an int, a uint or an atom, so
+                        // anything else must be coerced to an atom on input
+                        Traits* nameType = state->value(state->sp()).traits;
+                        if (nameType != INT_TYPE && nameType != UINT_TYPE)
+                            emitCoerce(NULL, state->sp());
                         coder->writeOp1(state, pc, OP_restarg, imm30, NULL);
                         state->pop_push(n, NULL);
                     }
@@ -110,6 +110,8 @@ namespace avmplus
     class Domain;
     class DomainEnv;
     class DomainMgr;
+    class DynamicShape;
+    class DynamicSlots;
     class E4XNode;
     class EnterSafepointManager;
     class ErrorClass;
@@ -132,6 +134,7 @@ namespace avmplus
     class DoubleVectorObject;
     class UIntVectorObject;
     class ObjectVectorObject;
+    class JitProfile;
     class JSONClass;
     class LinkObject;
     class MathClass;
@@ -280,6 +283,7 @@ namespace avmplus
 #include "Isolate.h"
 #include "AvmCore.h"
 #include "avmplusHashtable.h"
+#include "DynamicShape.h"
 #include "Traits.h"
 #include "VTable.h"
 #include "ScriptObject.h"
@@ -373,6 +377,7 @@ namespace avmplus
 #include "avmplusList-inlines.h"
 #include "ClassClosure-inlines.h"
 #include "Coder-inlines.h"
+#include "DynamicShape-inlines.h"
 #include "E4XNode-inlines.h"
 #include "exec-inlines.h"
 #include "FrameState-inlines.h"
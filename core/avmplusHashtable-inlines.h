@@ -38,6 +38,25 @@ namespace avmplus
         return m_logCapacity == 0;
     }
 
+    REALLY_INLINE DynamicSlots* InlineHashtable::getDynamicSlots() const
+    {
+        return m_logCapacity == 0 ? (DynamicSlots*)m_atomsAndFlags : NULL;
+    }
+
+    REALLY_INLINE void InlineHashtable::setDynamicSlots(DynamicSlots* slots)
+    {
+        AvmAssert(needsInitialize() && m_size == 0);
+        if (slots != NULL)
+        {
+            MMgc::GC* gc = MMgc::GC::GetGC(slots);
+            WB(gc, gc->FindBeginningFast(this), &m_atomsAndFlags, (void*)slots);
+        }
+        else
+        {
+            m_atomsAndFlags = 0;
+        }
+    }
+
     REALLY_INLINE uint32_t InlineHashtable::getCapacity() const
     {
         return m_logCapacity ? 1UL<<(m_logCapacity-1) : 0;
@@ -38,6 +38,14 @@ namespace avmplus
 
     void InlineHashtable::destroy()
     {
+        DynamicSlots* slots = getDynamicSlots();
+        if (slots) {
+            slots->destroy();
+            m_atomsAndFlags = 0;
+            delete slots;
+            return;
+        }
+
         Atom* atoms = getAtoms();
         if(atoms) {
             // deliberately ignore the final two entries if hasIterIndex(), since they aren't Atoms
@@ -51,6 +51,20 @@ namespace avmplus
         uint32_t getSize() const;
         bool needsInitialize() const;
 
+        /**
+         * A ScriptObject that keeps its dynamic properties by shape (see
+         * DynamicShape) leaves its InlineHashtable uninitialized and parks
+         * the DynamicSlots vector in the pointer field instead.  Returns
+         * NULL if the table is in use or nothing has been parked.
+         */
+        DynamicSlots* getDynamicSlots() const;
+
+        /**
+         * Park slots (which may be NULL) in an uninitialized table.  Does not
+         * destroy the previous vector, if any.
+         */
+        void setDynamicSlots(DynamicSlots* slots);
+
         bool getAtomPropertyIsEnumerable(Atom name) const;
         void setAtomPropertyIsEnumerable(Atom name, bool enumerable);
 
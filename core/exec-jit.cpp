@@ -9,6 +9,8 @@
 
 #ifdef VMCFG_NANOJIT
 #include "CodegenLIR.h"
+#include "exec-jitpool.h"
+#include "exec-jitprofile.h"
 
 #ifdef VMCFG_SHARK
 #include <dlfcn.h> // dl apis for JITLoggingObserver
@@ -113,6 +115,7 @@ bool BaseExecMgr::shouldJitFirst(const AbcEnv* abc_env, const MethodInfo* m, Met
     Runmode runmode = config.runmode;
     bool jitWouldFail = CodegenLIR::jitWillFail(ms);
     bool willJit = false;
+    JitProfile::Outcome outcome = JitProfile::kUnknown;
 
     if (runmode == RM_jit_all)
     {
@@ -133,6 +136,20 @@ bool BaseExecMgr::shouldJitFirst(const AbcEnv* abc_env, const MethodInfo* m, Met
         {
             willJit = false;
         }
+#ifdef VMCFG_HALFMOON
+        else if (m->_jitTier != kTierNone)
+        {
+            // Compiled before; tierUp() or a bailout wants it compiled again.
+            willJit = true;
+        }
+#endif
+        else if (config.jitProfile &&
+                 (outcome = config.jitProfile->lookup(m)) != JitProfile::kUnknown)
+        {
+            // An earlier run already found out how the JIT does with this
+            // method; skip the interpreted warm-up or the doomed compile.
+            willJit = outcome == JitProfile::kCompiled;
+        }
         else if (OSR::isSupported(abc_env, m, ms))
         {
             willJit = false;
@@ -176,12 +193,20 @@ void BaseExecMgr::setJit(MethodInfo* m, GprMethodProc p)
     m->_invoker = InvokerCompiler::canCompileInvoker(m)
         ? jitInvokerNext
         : invokeGeneric;
+    recordJitOutcome(m, true);
 #ifdef AVMPLUS_VERBOSE
     if (m->pool()->isVerbose(VB_execpolicy))
         core->console << "execpolicy jit (" << m->unique_method_id() << ") " << m << "\n";
 #endif
 }
 
+void BaseExecMgr::recordJitOutcome(const MethodInfo* m, bool compiled)
+{
+    // What happens under -Ojit or -Dinterp says nothing about RM_mixed.
+    if (config.jitProfile && config.runmode == RM_mixed)
+        config.jitProfile->record(m, compiled ? JitProfile::kCompiled : JitProfile::kFailed);
+}
+
 Atom BaseExecMgr::jitInvokerNext(MethodEnv* env, int argc, Atom* args)
 {
     // Install stub to compile on next call.
@@ -217,12 +242,43 @@ void BaseExecMgr::verifyJit(MethodInfo* m, MethodSignaturep ms,
         Toplevel *toplevel, AbcEnv* abc_env, OSR *osr)
 {
 #ifdef VMCFG_HALFMOON
+    if (isTiering()) {
+        verifyTieredJit(m, ms, toplevel, abc_env, osr);
+        return;
+    }
     if (verifyOptimizeJit(m, ms, toplevel, abc_env, osr))
         return; // halfmoon jit worked.
     // hack: force exception table to be re-parsed.
     m->set_abc_exceptions(core->gc, NULL);
     // fall through to CodegenLIR JIT logic.
 #endif
+    verifyBaselineJit(m, ms, toplevel, abc_env, osr);
+}
+
+void BaseExecMgr::verifyBaselineJit(MethodInfo* m, MethodSignaturep ms,
+        Toplevel *toplevel, AbcEnv* abc_env, OSR *osr)
+{
+    if (shouldDeferJit(m, ms, osr)) {
+        // Verify and generate LIR now, assemble in the background.
+        CodegenLIR* volatile jit = mmfx_new(CodegenLIR(m, ms, toplevel, NULL)); // Volatile for setjmp safety.
+        PERFM_NTPROF_BEGIN("verify & IR gen");
+        TRY(core, kCatchAction_Rethrow) {
+            verifyCommon(m, ms, toplevel, abc_env, jit);
+        }
+        CATCH (Exception *exception) {
+            mmfx_delete((CodegenLIR*) jit);
+            core->throwException(exception);
+        }
+        END_CATCH
+        END_TRY
+        PERFM_NTPROF_END("verify & IR gen");
+        jit->prepareMD();
+        setJitPending(m, ms);
+        if (!jit_pool)
+            jit_pool = mmfx_new(JitPool(this, config.jit_threads));
+        jit_pool->enqueue(m, jit);
+        return;
+    }
     CodegenLIR jit(m, ms, toplevel, osr);
     PERFM_NTPROF_BEGIN("verify & IR gen");
     verifyCommon(m, ms, toplevel, abc_env, &jit);
@@ -249,9 +305,114 @@ void BaseExecMgr::verifyJit(MethodInfo* m, MethodSignaturep ms,
         setInterp(m, ms, false);
         // Blacklist method so we don't attempt to compile it again.
         m->setHasFailedJit();
+        recordJitOutcome(m, false);
     }
 }
 
+bool BaseExecMgr::shouldDeferJit(const MethodInfo* m, MethodSignaturep ms, const OSR* osr) const
+{
+#ifdef VMCFG_VTUNE
+    // vtune registration needs the method name, which needs the GC.
+    (void)m; (void)ms; (void)osr;
+    return false;
+#else
+    if (config.jit_threads == 0 ||
+        osr != NULL ||                          // OSR must continue in compiled code right away
+        config.runmode == RM_jit_all ||         // -Ojit means never interpret
+        config.jitordie ||                      // failures must be reported synchronously
+        config.verifyall)
+        return false;
+#ifdef VMCFG_FLOAT
+    if (ms->returnTraitsBT() == BUILTIN_float4) // no pending trampoline for the VECR convention
+        return false;
+#else
+    (void)ms;
+#endif
+#ifdef AVMPLUS_VERBOSE
+    // Keep verbose assembler output in order with everything else.
+    if (m->pool()->isVerbose(VB_jit, const_cast<MethodInfo*>(m)))
+        return false;
+#else
+    (void)m;
+#endif
+    return true;
+#endif
+}
+
+void BaseExecMgr::setJitPending(MethodInfo* m, MethodSignaturep ms)
+{
+    // Start from the plain interpreter stubs so flags and the OSR
+    // countdown match an interpreted method, then interpose.
+    setInterp(m, ms, false);
+    m->_isJitPending = 1;
+    m->_invoker = jitPendingInvoke;
+    BuiltinType rt = ms->returnTraitsBT();
+    m->_implGPR = (rt == BUILTIN_number FLOAT_ONLY(|| rt == BUILTIN_float))
+        ? (GprMethodProc) jitPendingFPR
+        : jitPendingGPR;
+#ifdef AVMPLUS_VERBOSE
+    if (m->pool()->isVerbose(VB_execpolicy))
+        core->console << "execpolicy jit-pending (" << m->unique_method_id() << ") " << m << "\n";
+#endif
+}
+
+bool BaseExecMgr::installJit(MethodInfo* m, CodegenLIR* jit, GprMethodProc code)
+{
+    AvmAssert(m->isJitPending());
+    m->_isJitPending = 0;
+    jit->notifyMD(code);
+    if (code) {
+        setJit(m, code);
+        return true;
+    }
+#ifdef AVMPLUS_VERBOSE
+    if (m->pool()->isVerbose(VB_execpolicy))
+        core->console << "execpolicy interp " << m << " method-jit-failed\n";
+#endif
+    setInterp(m, m->getMethodSignature(), false);
+    m->setHasFailedJit();
+    recordJitOutcome(m, false);
+    return false;
+}
+
+uintptr_t BaseExecMgr::jitPendingGPR(MethodEnv* env, int32_t argc, uint32_t* ap)
+{
+    MethodInfo* m = env->method;
+    exec(env)->jit_pool->installCompleted();
+    if (!m->isJitPending()) {
+        // Finished, one way or the other; stop coming here.
+        env->_implGPR = m->_implGPR;
+        STACKADJUST(); // align stack for 32-bit Windows and MSVC compiler
+        uintptr_t ret = (*env->_implGPR)(env, argc, ap);
+        STACKRESTORE();
+        return ret;
+    }
+    return m->isConstructor() ? initInterpGPR(env, argc, ap) : interpGPR(env, argc, ap);
+}
+
+double BaseExecMgr::jitPendingFPR(MethodEnv* env, int32_t argc, uint32_t* ap)
+{
+    MethodInfo* m = env->method;
+    exec(env)->jit_pool->installCompleted();
+    if (!m->isJitPending()) {
+        env->_implGPR = m->_implGPR;
+        STACKADJUST(); // align stack for 32-bit Windows and MSVC compiler
+        double d = (*env->_implFPR)(env, argc, ap);
+        STACKRESTORE();
+        return d;
+    }
+    return m->isConstructor() ? initInterpFPR(env, argc, ap) : interpFPR(env, argc, ap);
+}
+
+Atom BaseExecMgr::jitPendingInvoke(MethodEnv* env, int32_t argc, Atom* args)
+{
+    MethodInfo* m = env->method;
+    exec(env)->jit_pool->installCompleted();
+    if (!m->isJitPending())
+        return (*m->_invoker)(env, argc, args);
+    return m->isConstructor() ? initInvokeInterp(env, argc, args) : invokeInterp(env, argc, args);
+}
+
 uintptr_t BaseExecMgr::initInterpGPR(MethodEnv* env, int argc, uint32_t* ap)
 {
     initObj(env, (ScriptObject*) atomPtr(((uintptr_t*)ap)[0]));
@@ -0,0 +1,190 @@
+/* -*- Mode: C++; c-basic-offset: 4; indent-tabs-mode: nil; tab-width: 4 -*- */
+/* vi: set ts=4 sw=4 expandtab: (add to ~/.vimrc: set modeline modelines=5) */
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "avmplus.h"
+
+#ifdef VMCFG_NANOJIT
+#include "CodegenLIR.h"
+#include "exec-jitpool.h"
+
+namespace avmplus
+{
+    /**
+     * One method's trip through the pool.  Created and destroyed on the main
+     * thread; a worker only calls assemble(), which writes code, codeAlloc,
+     * dataAlloc contents and nothing else.  Conservatively scanned so that
+     * 'method' keeps the MethodInfo alive.
+     */
+    class JitPool::Job : public MMgc::GCRoot
+    {
+    public:
+        Job(AvmCore* core, MethodInfo* method, CodegenLIR* jit)
+            : MMgc::GCRoot(core->GetGC())
+            , method(method)
+            , jit(jit)
+            , codeAlloc(mmfx_new(CodeAlloc(&core->config.njconfig, 1)))
+            , dataAlloc(mmfx_new(Allocator()))
+            , code(NULL)
+            , next(NULL)
+        {}
+
+        ~Job()
+        {
+            mmfx_delete(jit);
+            mmfx_delete(codeAlloc);
+            mmfx_delete(dataAlloc);
+        }
+
+        void assemble()
+        {
+            SinkLogControl sink;
+            code = jit->assembleMD(*codeAlloc, *dataAlloc, &sink);
+        }
+
+        MethodInfo* const method;
+        CodegenLIR* const jit;
+        CodeAlloc* codeAlloc;   // NULL once adopted by the pool's CodeMgr
+        Allocator* dataAlloc;   // ditto
+        GprMethodProc code;     // result of assemble(), NULL on failure
+        Job* next;
+    };
+
+    JitPool::JitPool(BaseExecMgr* exec, uint32_t threadCount)
+        : exec(exec)
+        , threadCount(threadCount)
+        , threads(NULL)
+        , pendingHead(NULL)
+        , pendingTail(NULL)
+        , completedHead(NULL)
+        , completedTail(NULL)
+        , completedCount(0)
+        , stopping(false)
+    {
+        AvmAssert(threadCount > 0);
+    }
+
+    JitPool::~JitPool()
+    {
+        SCOPE_LOCK_NO_SP_NAMED(locker, monitor) {
+            stopping = true;
+            locker.notifyAll();
+        }
+        if (threads) {
+            for (uint32_t i = 0; i < threadCount; i++) {
+                if (threads[i]) {
+                    threads[i]->join();
+                    mmfx_delete(threads[i]);
+                }
+            }
+            mmfx_delete_array(threads);
+        }
+        // Workers are gone; nobody else can see the lists.
+        Job* lists[2] = { pendingHead, completedHead };
+        for (int i = 0; i < 2; i++) {
+            for (Job* job = lists[i]; job != NULL; ) {
+                Job* next = job->next;
+                delete job;
+                job = next;
+            }
+        }
+    }
+
+    void JitPool::startThreads()
+    {
+        threads = mmfx_new_array(vmbase::VMThread*, threadCount);
+        for (uint32_t i = 0; i < threadCount; i++) {
+            threads[i] = mmfx_new(vmbase::VMThread("jit", this));
+            if (!threads[i]->start(vmbase::VMThread::LOW_PRIORITY)) {
+                mmfx_delete(threads[i]);
+                threads[i] = NULL;
+            }
+        }
+    }
+
+    void JitPool::enqueue(MethodInfo* m, CodegenLIR* jit)
+    {
+        if (!threads)
+            startThreads();
+        Job* job = new Job(exec->core, m, jit);
+        SCOPE_LOCK_NO_SP_NAMED(locker, monitor) {
+            if (pendingTail)
+                pendingTail->next = job;
+            else
+                pendingHead = job;
+            pendingTail = job;
+            locker.notify();
+        }
+        // If no worker could be started, assemble here rather than leave
+        // the method pending forever.
+        bool anyThreads = false;
+        for (uint32_t i = 0; i < threadCount; i++)
+            anyThreads |= threads[i] != NULL;
+        if (!anyThreads) {
+            stopping = true;
+            work();
+            installCompletedSlow();
+        }
+    }
+
+    void JitPool::run()
+    {
+        // Assembler memory comes from FixedMalloc and the GCHeap, which
+        // require an enter frame on every thread that allocates.
+        MMGC_ENTER_VOID;
+        work();
+    }
+
+    void JitPool::work()
+    {
+        for (;;) {
+            Job* job = NULL;
+            SCOPE_LOCK_NO_SP_NAMED(locker, monitor) {
+                while (pendingHead == NULL && !stopping)
+                    locker.wait();
+                if (pendingHead == NULL)
+                    return;
+                job = pendingHead;
+                pendingHead = job->next;
+                if (pendingHead == NULL)
+                    pendingTail = NULL;
+                job->next = NULL;
+            }
+
+            job->assemble();
+
+            SCOPE_LOCK_NO_SP(monitor) {
+                if (completedTail)
+                    completedTail->next = job;
+                else
+                    completedHead = job;
+                completedTail = job;
+                completedCount++;
+            }
+        }
+    }
+
+    void JitPool::installCompletedSlow()
+    {
+        Job* done = NULL;
+        SCOPE_LOCK_NO_SP(monitor) {
+            done = completedHead;
+            completedHead = completedTail = NULL;
+            completedCount = 0;
+        }
+        while (done != NULL) {
+            Job* next = done->next;
+            if (exec->installJit(done->method, done->jit, done->code)) {
+                done->method->pool()->codeMgr->adopt(done->codeAlloc, done->dataAlloc);
+                done->codeAlloc = NULL;
+                done->dataAlloc = NULL;
+            }
+            delete done;
+            done = next;
+        }
+    }
+}
+
+#endif // VMCFG_NANOJIT
@@ -0,0 +1,87 @@
+/* -*- Mode: C++; c-basic-offset: 4; indent-tabs-mode: nil; tab-width: 4 -*- */
+/* vi: set ts=4 sw=4 expandtab: (add to ~/.vimrc: set modeline modelines=5) */
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef __avmplus_exec_jitpool__
+#define __avmplus_exec_jitpool__
+
+#include "VMThread.h"
+
+namespace avmplus
+{
+#ifdef VMCFG_NANOJIT
+
+/**
+ * JitPool moves the back half of JIT compilation -- register allocation and
+ * instruction selection in nanojit::Assembler -- onto background threads.
+ *
+ * The front half cannot move: the Verifier and CodegenLIR allocate from the
+ * GC, resolve names and types, and report errors by throwing, all of which
+ * require the main thread.  So BaseExecMgr::verifyJit() still verifies the
+ * method and generates LIR synchronously, then hands the finished LIR to the
+ * pool and installs interpreter trampolines that know the method is pending
+ * (see BaseExecMgr::setJitPending()).  The method runs interpreted until a
+ * worker has assembled it.
+ *
+ * Workers never touch GC memory or shared JIT state.  Each job assembles into
+ * its own CodeAlloc and data Allocator, reading only the job's LIR buffer and
+ * the (read-only) nanojit::Config.  Finished jobs wait on a completed list;
+ * the main thread picks them up at safe points -- the pending trampolines and
+ * verifyOnCall() -- and installs the code, handing the job's allocators to
+ * the pool's CodeMgr so the code lives exactly as long as synchronously
+ * compiled code would.
+ *
+ * Jobs are GC roots so the MethodInfo, and through it the PoolObject whose
+ * constants the LIR refers to, cannot be collected while a job is in flight.
+ */
+class JitPool : public vmbase::Runnable
+{
+public:
+    JitPool(BaseExecMgr* exec, uint32_t threadCount);
+
+    /** Stop and join the workers, then discard unfinished jobs. */
+    ~JitPool();
+
+    /**
+     * Queue a method for assembly.  jit must have generated all its LIR
+     * (see CodegenLIR::prepareMD()); the pool takes ownership of it.
+     */
+    void enqueue(MethodInfo* m, CodegenLIR* jit);
+
+    /** Install any finished jobs; cheap if there are none. */
+    void installCompleted();
+
+    /** Worker thread body. */
+    void run();
+
+private:
+    class Job;
+
+    void installCompletedSlow();
+    void work();                    // assemble jobs until stopping and none are left
+    void startThreads();
+
+    BaseExecMgr* const exec;
+    const uint32_t threadCount;
+    vmbase::VMThread** threads;     // started lazily on the first enqueue()
+    vmbase::WaitNotifyMonitor monitor; // protects everything below
+    Job* pendingHead;               // jobs waiting for a worker, oldest first
+    Job* pendingTail;
+    Job* completedHead;             // jobs waiting to be installed, oldest first
+    Job* completedTail;
+    volatile int32_t completedCount; // polled without the lock by installCompleted()
+    bool stopping;
+};
+
+REALLY_INLINE void JitPool::installCompleted()
+{
+    if (completedCount != 0)
+        installCompletedSlow();
+}
+
+#endif // VMCFG_NANOJIT
+}
+
+#endif /* __avmplus_exec_jitpool__ */
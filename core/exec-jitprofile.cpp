@@ -0,0 +1,217 @@
+/* -*- Mode: C++; c-basic-offset: 4; indent-tabs-mode: nil; tab-width: 4 -*- */
+/* vi: set ts=4 sw=4 expandtab: (add to ~/.vimrc: set modeline modelines=5) */
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "avmplus.h"
+
+#ifdef VMCFG_NANOJIT
+#include "exec-jitprofile.h"
+
+namespace avmplus
+{
+    // The serialized form is a header followed by the entries sorted by
+    // (pool, method), all in the byte order of the machine that wrote it.
+    // A machine with the other byte order is a different build anyway.
+    struct JitProfileHeader
+    {
+        uint32_t magic;
+        uint32_t count;
+        uint64_t build;
+    };
+
+    JitProfile::JitProfile(uint64_t build)
+        : build(build)
+        , loaded(NULL)
+        , loadedLength(0)
+        , recorded(NULL)
+        , recordedLength(0)
+        , recordedCapacity(0)
+    {
+    }
+
+    JitProfile::~JitProfile()
+    {
+        mmfx_delete_array(loaded);
+        mmfx_delete_array(recorded);
+    }
+
+    uint64_t JitProfile::hashBytes(const uint8_t* data, size_t size, uint64_t hash)
+    {
+        for (size_t i = 0; i < size; i++) {
+            hash ^= data[i];
+            hash *= 0x100000001b3ULL;
+        }
+        return hash;
+    }
+
+    int JitProfile::compareEntries(const void* a, const void* b)
+    {
+        const Entry* x = (const Entry*)a;
+        const Entry* y = (const Entry*)b;
+        if (x->pool != y->pool)
+            return x->pool < y->pool ? -1 : 1;
+        if (x->method != y->method)
+            return x->method < y->method ? -1 : 1;
+        return 0;
+    }
+
+    int JitProfile::compareRecorded(const void* a, const void* b)
+    {
+        const Recorded* x = (const Recorded*)a;
+        const Recorded* y = (const Recorded*)b;
+        int c = compareEntries(&x->entry, &y->entry);
+        if (c != 0)
+            return c;
+        return x->index < y->index ? -1 : x->index > y->index ? 1 : 0;
+    }
+
+    bool JitProfile::isExpired(const Entry& e)
+    {
+        return e.outcome == kFailed && e.runs + 1 >= kFailedRuns;
+    }
+
+    bool JitProfile::load(const uint8_t* data, size_t size)
+    {
+        JitProfileHeader header;
+        if (size < sizeof(header))
+            return false;
+        VMPI_memcpy(&header, data, sizeof(header));
+        if (header.magic != kMagic ||
+            header.build != build ||
+            header.count > kMaxEntries ||
+            size != sizeof(header) + size_t(header.count) * sizeof(Entry))
+            return false;
+
+        Entry* entries = mmfx_new_array(Entry, header.count);
+        VMPI_memcpy(entries, data + sizeof(header), header.count * sizeof(Entry));
+        for (uint32_t i = 0; i < header.count; i++) {
+            if ((entries[i].outcome != kCompiled && entries[i].outcome != kFailed) ||
+                (i > 0 && compareEntries(&entries[i-1], &entries[i]) >= 0)) {
+                mmfx_delete_array(entries);
+                return false;
+            }
+        }
+        mmfx_delete_array(loaded);
+        loaded = entries;
+        loadedLength = header.count;
+        return true;
+    }
+
+    JitProfile::Outcome JitProfile::lookup(const MethodInfo* m) const
+    {
+        if (loadedLength == 0)
+            return kUnknown;
+        Entry key;
+        key.pool = m->pool()->contentHash();
+        key.method = uint32_t(m->method_id());
+        uint32_t lo = 0;
+        uint32_t hi = loadedLength;
+        while (lo < hi) {
+            uint32_t mid = lo + (hi - lo) / 2;
+            int c = compareEntries(&loaded[mid], &key);
+            if (c == 0)
+                return Outcome(loaded[mid].outcome);
+            if (c < 0)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        return kUnknown;
+    }
+
+    void JitProfile::record(const MethodInfo* m, Outcome outcome)
+    {
+        AvmAssert(outcome == kCompiled || outcome == kFailed);
+        Entry e;
+        e.pool = m->pool()->contentHash();
+        e.method = uint32_t(m->method_id());
+        e.outcome = uint16_t(outcome);
+        e.runs = 0;
+
+        SCOPE_LOCK_NO_SP(lock) {
+            // Past kMaxEntries save() could not keep them all anyway.
+            if (recordedLength == kMaxEntries)
+                return;
+            if (recordedLength == recordedCapacity) {
+                uint32_t capacity = recordedCapacity ? recordedCapacity * 2 : 64;
+                Entry* grown = mmfx_new_array(Entry, capacity);
+                if (recordedLength > 0)
+                    VMPI_memcpy(grown, recorded, recordedLength * sizeof(Entry));
+                mmfx_delete_array(recorded);
+                recorded = grown;
+                recordedCapacity = capacity;
+            }
+            recorded[recordedLength++] = e;
+        }
+    }
+
+    uint8_t* JitProfile::save(size_t* size)
+    {
+        SCOPE_LOCK_NO_SP(lock) {
+            // Sort this run's outcomes by method and then by when they were
+            // recorded, keeping only the last one recorded for each method.
+            uint32_t n = recordedLength;
+            Recorded* sorted = mmfx_new_array(Recorded, n > 0 ? n : 1);
+            for (uint32_t i = 0; i < n; i++) {
+                sorted[i].entry = recorded[i];
+                sorted[i].index = i;
+            }
+            qsort(sorted, n, sizeof(Recorded), compareRecorded);
+            uint32_t unique = 0;
+            for (uint32_t i = 0; i < n; i++) {
+                if (i + 1 < n && compareEntries(&sorted[i].entry, &sorted[i+1].entry) == 0)
+                    continue;
+                sorted[unique++] = sorted[i];
+            }
+
+            // Merge with the loaded outcomes; this run's win, and expired
+            // failures go.  If the result would be too long, outcomes only
+            // known from earlier runs go too.
+            uint32_t total = 0;
+            for (uint32_t i = 0, j = 0; i < loadedLength || j < unique; ) {
+                int c = i == loadedLength ? 1 : j == unique ? -1 : compareEntries(&loaded[i], &sorted[j].entry);
+                if (c >= 0 || !isExpired(loaded[i]))
+                    total++;
+                if (c <= 0) i++;
+                if (c >= 0) j++;
+            }
+            uint32_t excess = total > kMaxEntries ? total - kMaxEntries : 0;
+
+            JitProfileHeader header;
+            header.magic = kMagic;
+            header.count = total - excess;
+            header.build = build;
+            *size = sizeof(header) + size_t(header.count) * sizeof(Entry);
+            uint8_t* data = mmfx_new_array(uint8_t, *size);
+            VMPI_memcpy(data, &header, sizeof(header));
+            Entry* out = (Entry*)(data + sizeof(header));
+            for (uint32_t i = 0, j = 0; i < loadedLength || j < unique; ) {
+                int c = i == loadedLength ? 1 : j == unique ? -1 : compareEntries(&loaded[i], &sorted[j].entry);
+                if (c < 0) {
+                    if (isExpired(loaded[i])) {
+                        // dropped, and not counted in total
+                    } else if (excess > 0) {
+                        excess--;
+                    } else {
+                        Entry e = loaded[i];
+                        if (e.outcome == kFailed)
+                            e.runs++;
+                        VMPI_memcpy(out++, &e, sizeof(Entry));
+                    }
+                    i++;
+                } else {
+                    VMPI_memcpy(out++, &sorted[j].entry, sizeof(Entry));
+                    if (c == 0) i++;
+                    j++;
+                }
+            }
+            AvmAssert((uint8_t*)out == data + *size);
+            mmfx_delete_array(sorted);
+            return data;
+        }
+        return NULL;
+    }
+}
+#endif // VMCFG_NANOJIT
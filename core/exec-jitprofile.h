@@ -0,0 +1,142 @@
+/* -*- Mode: C++; c-basic-offset: 4; indent-tabs-mode: nil; tab-width: 4 -*- */
+/* vi: set ts=4 sw=4 expandtab: (add to ~/.vimrc: set modeline modelines=5) */
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef __avmplus_exec_jitprofile__
+#define __avmplus_exec_jitprofile__
+
+#include "VMThread.h"
+
+namespace avmplus
+{
+#ifdef VMCFG_NANOJIT
+
+/**
+ * JitProfile remembers, across runs, how the JIT fared with each method so
+ * that a later run can make the right choice on the method's first call.
+ *
+ * It deliberately does not keep the generated code.  Code produced by
+ * CodegenLIR is full of absolute addresses -- of the MethodInfo and its
+ * PoolObject, of Traits, BindingCaches and interned strings, of helper
+ * functions -- and nanojit records no relocations for them, so it cannot be
+ * reused by another process.  What carries over is the compilation policy:
+ *
+ *  - A method that was compiled last time is compiled on its first call,
+ *    even where the default policy would interpret it first (static
+ *    initializers, or methods waiting for the OSR threshold).  The
+ *    interpreted warm-up and the OSR transition are skipped.
+ *  - A method the JIT failed on last time goes straight to the interpreter
+ *    instead of being verified and compiled once more only to fail again.
+ *    A failure is only trusted for kFailedRuns runs; then the JIT gets
+ *    another go, in case it failed for want of code memory or some other
+ *    reason that had to do with that run rather than with the method.
+ *
+ * Every method that runs is still verified and compiled anew in each run.
+ * Compiling on the first call moves that work earlier, so a static
+ * initializer that runs once may now cost more at startup than it would
+ * have interpreted; the profile pays off for the methods that run often.
+ *
+ * A method is identified by a hash of its ABC (PoolObject::contentHash())
+ * and its method index, and a profile is only accepted by a JitProfile
+ * constructed with the build id the profile was saved with.  Outcomes are
+ * recorded only in RM_mixed, the one runmode where they influence anything.
+ *
+ * The host owns the profile and handles the storage (see the shell's
+ * -jitprofile option): it passes the bytes of a previous run to load(),
+ * points Config::jitProfile at it for every core, and writes what save()
+ * returns when it is done.  lookup() reads only what load() set up and may
+ * be called from any thread; record() and save() take a lock, so one
+ * profile may be shared by all workers.
+ */
+class JitProfile
+{
+public:
+    enum Outcome
+    {
+        kUnknown = 0,   // no record
+        kCompiled = 1,  // the JIT produced code
+        kFailed = 2     // the JIT gave up; the method was interpreted
+    };
+
+    /**
+     * 'build' identifies the VM binary: the host derives it from something
+     * that changes whenever the VM is rebuilt, such as the size and the time
+     * of the last write of the executable (see the shell).
+     */
+    explicit JitProfile(uint64_t build);
+    ~JitProfile();
+
+    /**
+     * Install the outcomes saved by a previous run.  Returns false, and
+     * ignores the data, if it is malformed or was written by another build.
+     */
+    bool load(const uint8_t* data, size_t size);
+
+    /**
+     * Serialize the outcomes loaded earlier merged with the ones recorded
+     * since; where both have an entry for a method, the newer one wins.
+     * Returns a buffer to be freed with mmfx_delete_array() and stores its
+     * length in *size.
+     */
+    uint8_t* save(size_t* size);
+
+    /** The outcome recorded for m by a previous run, or kUnknown. */
+    Outcome lookup(const MethodInfo* m) const;
+
+    /** Note how the JIT fared with m in this run. */
+    void record(const MethodInfo* m, Outcome outcome);
+
+    /** Number of outcomes installed by load(). */
+    uint32_t loadedCount() const;
+
+    /** 64-bit FNV-1a hash of size bytes, used for ABC content hashes. */
+    static uint64_t hashBytes(const uint8_t* data, size_t size, uint64_t hash = kHashSeed);
+
+    static const uint64_t kHashSeed = 0xcbf29ce484222325ULL;
+
+    /** Number of runs a failure is trusted for. */
+    static const uint16_t kFailedRuns = 8;
+
+private:
+    struct Entry
+    {
+        uint64_t pool;      // PoolObject::contentHash()
+        uint32_t method;    // MethodInfo::method_id()
+        uint16_t outcome;   // Outcome
+        uint16_t runs;      // later runs that have carried this entry over
+    };
+
+    // an entry of this run, for sorting by (pool, method, index)
+    struct Recorded
+    {
+        Entry entry;
+        uint32_t index;     // position in recorded
+    };
+
+    static const uint32_t kMagic = 0x504a5641;  // "AVJP"
+    static const uint32_t kMaxEntries = 1 << 16;
+
+    static int compareEntries(const void* a, const void* b);
+    static int compareRecorded(const void* a, const void* b);
+    static bool isExpired(const Entry& e);
+
+    const uint64_t build;
+    Entry* loaded;                  // sorted by (pool, method); immutable after load()
+    uint32_t loadedLength;
+    vmbase::RecursiveMutex lock;    // protects everything below
+    Entry* recorded;                // this run's outcomes, in the order they happened
+    uint32_t recordedLength;
+    uint32_t recordedCapacity;
+};
+
+REALLY_INLINE uint32_t JitProfile::loadedCount() const
+{
+    return loadedLength;
+}
+
+#endif // VMCFG_NANOJIT
+}
+
+#endif /* __avmplus_exec_jitprofile__ */
@@ -130,6 +130,7 @@ namespace avmplus
         return (m->osrEnabled() &&                    // OSR allowed by policy (global or ExecPolicy attribute)
                 !m->hasExceptions() &&                // method does not have a try block
                 !m->hasFailedJit() &&                 // no previous attempt to compile the method has failed
+                !m->isJitPending() &&                 // no background compile is in progress
                 !CodegenLIR::jitWillFail(ms) &&       // fast-fail predictor says JIT success is possible
                 !m->pool()->isBuiltin &&              // the method is not a builtin (ABC baked into application)
                 abc_env->codeContext()->bugCompatibility()->bugzilla539094);  // bug compatibility permits OSR
@@ -7,6 +7,7 @@
 #include "avmplus.h"
 #include "../vprof/vprof.h"
 #include "Interpreter.h"
+#include "exec-jitpool.h"
 
 namespace avmplus {
 
@@ -46,6 +47,7 @@ BaseExecMgr::BaseExecMgr(AvmCore* core)
 #ifdef VMCFG_NANOJIT
     , current_osr(NULL)
     , jit_observer(NULL)
+    , jit_pool(NULL)
 #endif
 {
 #ifdef SUPERWORD_PROFILING
@@ -57,6 +59,9 @@ BaseExecMgr::BaseExecMgr(AvmCore* core)
 #ifdef VMCFG_NANOJIT
     setupJit(core);
 #endif
+#ifdef VMCFG_HALFMOON
+    VMPI_memset(&tierStats, 0, sizeof(tierStats));
+#endif
 }
 
 BaseExecMgr::~BaseExecMgr()
@@ -65,6 +70,8 @@ BaseExecMgr::~BaseExecMgr()
     WordcodeTranslator::swprofStop();
 #endif
 #ifdef VMCFG_NANOJIT
+    mmfx_delete(jit_pool);
+    jit_pool = NULL;
     delete jit_observer;
     jit_observer = NULL;
 #endif
@@ -351,6 +358,12 @@ void BaseExecMgr::verifyOnCall(MethodEnv* env)
     CallStackNode callStackNode(env->method);
     #endif
 
+    #ifdef VMCFG_NANOJIT
+    // A good moment to pick up methods finished by background compilation.
+    if (exec->jit_pool)
+        exec->jit_pool->installCompleted();
+    #endif
+
     exec->verifyMethod(env->method, env->toplevel(), env->abcEnv());
 
     // We got here by calling env->_implGPR, which was pointing to verifyEnterGPR/FPR,
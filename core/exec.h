@@ -15,6 +15,9 @@ namespace nanojit {
 
 namespace avmplus {
 
+class JitPool;
+class CodegenLIR;
+
 /**
  *  Execution manager pure virtual interface.  An execution manager implementation
  *  is responsible for all aspects of AS3 execution, including invocation,
@@ -369,9 +372,16 @@ private:
     void verifyJit(MethodInfo*, MethodSignaturep, Toplevel*, AbcEnv*,
                    OSR *osr_state);
 
+    /** Run the verifier with the CodegenLIR JIT attached. */
+    void verifyBaselineJit(MethodInfo*, MethodSignaturep, Toplevel*, AbcEnv*,
+                           OSR *osr_state);
+
     /** Install JIT code pointers and set MethodInfo::_isJitImpl. */
     void setJit(MethodInfo*, GprMethodProc p);
 
+    /** Note in config.jitProfile, if any, whether the JIT compiled m. */
+    void recordJitOutcome(const MethodInfo*, bool compiled);
+
     /**
      * Invoker called on the first invocation then calls invoke_generic,
      * installs jitInvokerNow yielding a 1-call delay before we try to
@@ -382,6 +392,33 @@ private:
     /* Compile now then invoke the compiled invoker. */
     static Atom jitInvokerNow(MethodEnv*, int argc, Atom* args);
 
+    //
+    // Support for background compilation (config.jit_threads > 0).  See JitPool.
+    //
+
+    /** True if the assembly of m may be handed to the JitPool. */
+    bool shouldDeferJit(const MethodInfo*, MethodSignaturep, const OSR*) const;
+
+    /**
+     * Install trampolines for a method whose code is being assembled in the
+     * background.  They behave like the interpreter stubs chosen by
+     * setInterp(), but first install any finished code and switch to it
+     * once the method itself is ready.
+     */
+    void setJitPending(MethodInfo*, MethodSignaturep);
+
+    /**
+     * Finish a background compile on the main thread.  Installs code (or
+     * reverts to the interpreter if code is NULL) and returns true if the
+     * code was installed.
+     */
+    bool installJit(MethodInfo*, CodegenLIR*, GprMethodProc code);
+
+    // Trampolines installed by setJitPending():
+    static uintptr_t jitPendingGPR(MethodEnv*, int32_t argc, uint32_t* ap);
+    static double jitPendingFPR(MethodEnv*, int32_t argc, uint32_t* ap);
+    static Atom jitPendingInvoke(MethodEnv*, int32_t argc, Atom* args);
+
     // Support for interface method tables (IMTs).  These enable fast
     // dispatching of an interface method when invoked via an interface-
     // typed reference, when we know the method signature but not the
@@ -452,16 +489,45 @@ private:
 
 #ifdef VMCFG_HALFMOON
 public:
+    /**
+     * Tiers of tiered compilation (see Config::tierup_threshold), kept in
+     * MethodInfo::_jitTier.  A method moves down this list one compile at a
+     * time and never moves back up.
+     */
+    enum JitTier {
+        kTierNone = 0,      // not compiled under tiering yet
+        kTierBaseline,      // CodegenLIR code that counts calls to tier up
+        kTierProfiling,     // CodegenLIR code with profiling instrumentation, if halfmoon uses a profile
+        kTierOptimized,     // halfmoon code
+        kTierFinal,         // CodegenLIR code, no further tiering
+        kTierCount
+    };
+
     static void resetMethodInvokers(MethodEnv*);
-    static void setRecompileWithProfileData(MethodEnv* env);
-    static void setRecompileHotMethod(MethodEnv* env);
-    static Atom jitInvokerProfiler(MethodEnv* env, int argc, Atom* args);
-    static Atom jitInvokerWithProfileData(MethodEnv* env, int argc, Atom* args);
-    static Atom executeMethod(MethodEnv*, int argc, Atom* args);
-    static void freeJitCompiledCode(MethodInfo*);
+
+    /** Recompile env's method at the next tier on its next call. */
+    static void tierUp(MethodEnv* env);
+
     bool verifyOptimizeJit(MethodInfo* m, MethodSignaturep ms,
                            Toplevel*, AbcEnv*, OSR*);
-    void verifyProfilingJit(MethodInfo*, MethodSignaturep, Toplevel*, AbcEnv*);
+    void dumpTierStats();
+
+private:
+    // Arrange for the method to be verified and compiled again on its next call.
+    static void reverifyOnCall(MethodEnv*);
+    bool isTiering() const;
+    void verifyTieredJit(MethodInfo*, MethodSignaturep, Toplevel*, AbcEnv*, OSR*);
+    bool verifyProfilingJit(MethodInfo*, MethodSignaturep, Toplevel*, AbcEnv*);
+
+    // Counters reported by dumpTierStats().  Time spent running the code
+    // of each tier is not measured.
+    struct TierStats {
+        uint32_t compiles[kTierCount];
+        uint64_t compileTicks[kTierCount];  // time verifying and compiling for each tier
+        uint32_t tierUps;                   // tierUp() requests
+        uint32_t bailouts;                  // returns from halfmoon code to baseline
+    };
+    TierStats tierStats;
 #endif
 
 private:
@@ -479,8 +545,10 @@ private:
     friend class CodegenLIR;
     friend class halfmoon::JitFriend;
     friend class LirHelper;
+    friend class JitPool;
     OSR *current_osr;
     JITObserver *jit_observer; // Current JITObserver or NULL if not profiling.
+    JitPool *jit_pool;         // Background compiler threads, or NULL if not started.
 #endif
 };
 
@@ -37,10 +37,66 @@ namespace avmplus
 
     // if the cached obj was a ScriptObject, we have a hit when
     // the new object's tag is kObjectType and the cached vtable matches exactly
-    #define OBJ_HIT(obj, c)  (atomKind(obj) == kObjectType && atomObj(obj)->vtable == (c).vtable)
+    #define OBJ_MATCH(obj, c)  (atomKind(obj) == kObjectType && atomObj(obj)->vtable == (c).vtable)
 
-    // if the cached obj was a primitive, we only need a matching atom tag for a hit
-    #define PRIM_HIT(val, c) (atomKind(val) == c.tag)
+    // if the cached obj was a primitive, we only need a matching atom tag for a hit.
+    // a vtable pointer is never a valid tag, so this can't match an object entry.
+    #define PRIM_MATCH(val, c) (atomKind(val) == (c).tag)
+
+    // primary entry hits are counted for AvmCore::dumpBindingCacheStats()
+    // only in profiling builds; otherwise a hit is just the compare
+    #ifdef DOPROF
+    REALLY_INLINE bool count_hit(BindingCache& c, bool hit)
+    {
+        if (hit)
+            c.hits++;
+        return hit;
+    }
+
+    # define OBJ_HIT(obj, c)  count_hit(c, OBJ_MATCH(obj, c))
+    # define PRIM_HIT(val, c) count_hit(c, PRIM_MATCH(val, c))
+    # define ANY_HIT(val, c)  count_hit(c, OBJ_MATCH(val, c) || PRIM_MATCH(val, c))
+    #else
+    # define OBJ_HIT(obj, c)  OBJ_MATCH(obj, c)
+    # define PRIM_HIT(val, c) PRIM_MATCH(val, c)
+    # define ANY_HIT(val, c)  (OBJ_MATCH(val, c) || PRIM_MATCH(val, c))
+    #endif
+
+    // Polymorphic step shared by the miss handlers.  If c is bound to some
+    // other receiver type, search the secondary entries for obj's type and
+    // swap a match into the primary entry; otherwise save the primary entry
+    // so the caller's lookup doesn't lose it.  When the secondary entries are
+    // full the site becomes megamorphic.  Returns true if the caller should
+    // just dispatch through the (restored, or megamorphic) handler, false if
+    // it must look up the binding and fill the primary entry.
+    template <class C>
+    bool pic_miss(C& c, Atom obj, MethodEnv* env)
+    {
+        c.misses++;
+        if (!c.isBound())
+            return false;
+        typename C::Entry* poly = c.poly;
+        for (uint32_t i = 0, n = c.npoly; i < n; i++) {
+            if (OBJ_MATCH(obj, poly[i]) || PRIM_MATCH(obj, poly[i])) {
+                typename C::Entry e = poly[i];
+                c.save(poly[i]);
+                c.restore(e);
+                c.polyhits++;
+                return true;
+            }
+        }
+        if (c.npoly == C::kPolyEntries) {
+            c.megamorphic = true;
+            return true;
+        }
+        if (!poly) {
+            // same lifetime as the cache itself
+            poly = c.poly = new (env->method->pool()->codeMgr->allocator) typename C::Entry[C::kPolyEntries];
+        }
+        c.save(poly[c.npoly++]);
+        c.transitions++;
+        return false;
+    }
 
     REALLY_INLINE Atom invoke_cached_method(CallCache& c, Atom obj, int argc, Atom* args)
     {
@@ -102,12 +158,9 @@ namespace avmplus
         return callprop_miss(c, prim, argc, args, env);
     }
 
-    // generic call handler for uncommon cases
-    Atom callprop_generic(CallCache& c, Atom obj, int argc, Atom* args, MethodEnv* env)
+    // full lookup, without consulting or updating the cache
+    Atom callprop_slow(CallCache& c, Atom obj, int argc, Atom* args, MethodEnv* env)
     {
-        // go back to callprop_miss() after this call in case atom type changes
-        // to something allowing a smarter handler
-        c.call_handler = callprop_miss;
         Toplevel* toplevel = env->toplevel();
         VTable* vtable = toplevel->toVTable(obj);
         tagprof("callprop_generic obj", obj);
@@ -115,6 +168,22 @@ namespace avmplus
         return toplevel->callproperty(obj, c.name, argc, args, vtable);
     }
 
+    // generic call handler for uncommon cases.  Still keyed on the receiver
+    // type so a type allowing a smarter handler goes back to callprop_miss().
+    Atom callprop_generic(CallCache& c, Atom obj, int argc, Atom* args, MethodEnv* env)
+    {
+        PROF_IF ("callprop_generic hit", ANY_HIT(obj, c))
+            return callprop_slow(c, obj, argc, args, env);
+        return callprop_miss(c, obj, argc, args, env);
+    }
+
+    // too many receiver types seen at this site; stop caching
+    Atom callprop_megamorphic(CallCache& c, Atom obj, int argc, Atom* args, MethodEnv* env)
+    {
+        c.misses++;
+        return callprop_slow(c, obj, argc, args, env);
+    }
+
     static const CallCache::Handler callprop_obj_handlers[8] = {
         &callprop_obj_none,     // BKIND_NONE
         &callprop_obj_method,   // BKIND_METHOD
@@ -163,6 +232,11 @@ namespace avmplus
     Atom callprop_miss(CallCache& c, Atom obj, int argc, Atom* args, MethodEnv* env)
     {
         AssertNotNull(obj);
+        if (pic_miss(c, obj, env)) {
+            if (c.megamorphic)
+                c.call_handler = callprop_megamorphic;
+            return c.call_handler(c, obj, argc, args, env);
+        }
         Toplevel* toplevel = env->toplevel();
         VTable* vtable = toplevel->toVTable(obj);
         Traits* obj_type = vtable->traits;
@@ -200,19 +274,17 @@ namespace avmplus
     // AND the multiname has runtime parts, so we couldn't use a CallCache.
     Atom callprop_late(MethodEnv* caller_env, Atom base, const Multiname* name, int argc, Atom* args)
     {
-        CallCache c(name, NULL);  // temporary cache, just so we can call the generic handler.
-        return callprop_generic(c, base, argc, args, caller_env);
+        CallCache c(name, NULL);  // temporary cache, just so we can call the slow handler.
+        return callprop_slow(c, base, argc, args, caller_env);
     }
     FUNCTION(FUNCADDR(callprop_late), SIG5(A,P,A,P,I,P), callprop_late)
 
     // forward decl
     Atom getprop_miss(GetCache&, MethodEnv*, Atom obj);
 
-    // getting any property (catch-all)
-    Atom getprop_generic(GetCache& c, MethodEnv* env, Atom obj)
+    // full lookup, without consulting or updating the cache
+    Atom getprop_slow(GetCache& c, MethodEnv* env, Atom obj)
     {
-        // reinstall miss handler so we don't end up dead-ended here in this handler.
-        c.get_handler = getprop_miss;
         Toplevel* toplevel = env->toplevel();
         VTable* vtable = toplevel->toVTable(obj);
         tagprof("getprop_generic obj", obj);
@@ -220,6 +292,22 @@ namespace avmplus
         return toplevel->getproperty(obj, c.name, vtable);
     }
 
+    // getting any property (catch-all).  Keyed on the receiver type so we
+    // don't end up dead-ended here when a smarter handler becomes possible.
+    Atom getprop_generic(GetCache& c, MethodEnv* env, Atom obj)
+    {
+        PROF_IF ("getprop_generic hit", ANY_HIT(obj, c))
+            return getprop_slow(c, env, obj);
+        return getprop_miss(c, env, obj);
+    }
+
+    // too many receiver types seen at this site; stop caching
+    Atom getprop_megamorphic(GetCache& c, MethodEnv* env, Atom obj)
+    {
+        c.misses++;
+        return getprop_slow(c, env, obj);
+    }
+
     // overloaded helpers that convert a raw value to Atom.  helper will be
     // chosen based on the <T> parameter to getprop_obj_slot, below.
     enum Bool32 {};                    // can't use bool when sizeof(bool) != sizeof(int32_t)
@@ -273,11 +361,36 @@ namespace avmplus
         return getprop_miss(c, env, obj);
     }
 
+    // Index of c.name among the dynamic properties of a shaped object, or -1.
+    // The key is canonicalized the way ScriptObject::setAtomProperty() does.
+    REALLY_INLINE int32_t shaped_index(BindingCache& c, DynamicSlots* slots)
+    {
+        if (!c.name->isValidDynamicName())
+            return -1;
+        Stringp s = c.name->getName();
+        Atom ival = s->getIntAtom();
+        return slots->shape()->find(ival ? ival : s->atom());
+    }
+
     // getting a dynamic property on an object
     Atom getprop_obj_none(GetCache& c, MethodEnv* env, Atom obj)
     {
         PROF_IF ("getprop_obj_none hit", OBJ_HIT(obj, c)) {
-            return atomObj(obj)->getMultinameProperty(c.name);
+            ScriptObject* o = atomObj(obj);
+            if (DynamicSlots* slots = o->getDynamicSlots()) {
+                if (slots->shape()->id() != c.shape_id) {
+                    int32_t i = shaped_index(c, slots);
+                    if (i < 0)
+                        return o->getMultinameProperty(c.name);
+                    c.shape_id = slots->shape()->id();
+                    c.slot_offset = i;
+                }
+                // a deleted property reads through to the prototype chain
+                Atom value = slots->valueAt(uint32_t(c.slot_offset));
+                if (value != 0)
+                    return value;
+            }
+            return o->getMultinameProperty(c.name);
         }
         return getprop_miss(c, env, obj);
     }
@@ -344,6 +457,11 @@ namespace avmplus
     {
         // cache handler when cache miss occurs
         AvmAssert(!AvmCore::isNullOrUndefined(obj));
+        if (pic_miss(c, obj, env)) {
+            if (c.megamorphic)
+                c.get_handler = getprop_megamorphic;
+            return c.get_handler(c, env, obj);
+        }
         Toplevel* toplevel = env->toplevel();
         VTable* vtable = toplevel->toVTable(obj);
         Traits* actual_type = vtable->traits;
@@ -395,7 +513,7 @@ namespace avmplus
     Atom getprop_late(MethodEnv* env, Atom obj, const Multiname* name)
     {
         GetCache c(name, NULL);
-        return getprop_generic(c, env, obj);
+        return getprop_slow(c, env, obj);
     }
     FUNCTION(FUNCADDR(getprop_late), SIG3(A,P,A,P), getprop_late)
 
@@ -638,10 +756,9 @@ namespace avmplus
 
     void setprop_miss(SetCache& c, Atom obj, Atom val, MethodEnv* env);
 
-    void setprop_generic(SetCache& c, Atom obj, Atom val, MethodEnv* env)
+    // full lookup, without consulting or updating the cache
+    void setprop_slow(SetCache& c, Atom obj, Atom val, MethodEnv* env)
     {
-        // reinstall miss handler so we don't end up dead-ended here in this handler.
-        c.set_handler = setprop_miss;
         Toplevel* toplevel = env->toplevel();
         VTable* vtable = toplevel->toVTable(obj);
         tagprof("setprop_generic obj", obj);
@@ -650,6 +767,24 @@ namespace avmplus
         toplevel->setproperty(obj, c.name, val, vtable);
     }
 
+    // setting any property (catch-all).  Keyed on the receiver type so we
+    // don't end up dead-ended here when a smarter handler becomes possible.
+    void setprop_generic(SetCache& c, Atom obj, Atom val, MethodEnv* env)
+    {
+        PROF_IF ("setprop_generic hit", ANY_HIT(obj, c)) {
+            setprop_slow(c, obj, val, env);
+        } else {
+            setprop_miss(c, obj, val, env);
+        }
+    }
+
+    // too many receiver types seen at this site; stop caching
+    void setprop_megamorphic(SetCache& c, Atom obj, Atom val, MethodEnv* env)
+    {
+        c.misses++;
+        setprop_slow(c, obj, val, env);
+    }
+
     // sst_atom (*), for slot types not requiring any coercion
     void setprop_slot_any(SetCache& c, Atom obj, Atom val, MethodEnv* env)
     {
@@ -755,7 +890,22 @@ namespace avmplus
     void setprop_none(SetCache& c, Atom obj, Atom val, MethodEnv* env)
     {
         PROF_IF ("setprop_none hit", OBJ_HIT(obj, c)) {
-            atomObj(obj)->setMultinameProperty(c.name, val);
+            ScriptObject* o = atomObj(obj);
+            DynamicSlots* slots = o->getDynamicSlots();
+            if (slots != NULL && slots->shape()->id() == c.shape_id &&
+                slots->valueAt(uint32_t(c.slot_offset)) != 0) {
+                slots->setValueAt(uint32_t(c.slot_offset), val);
+                return;
+            }
+            o->setMultinameProperty(c.name, val);
+            // remember where the property ended up, for the next object built the same way
+            if ((slots = o->getDynamicSlots()) != NULL) {
+                int32_t i = shaped_index(c, slots);
+                if (i >= 0) {
+                    c.shape_id = slots->shape()->id();
+                    c.slot_offset = i;
+                }
+            }
         } else {
             setprop_miss(c, obj, val, env);
         }
@@ -806,6 +956,12 @@ namespace avmplus
     {
         // cache handler when cache miss occurs
         AvmAssert(!AvmCore::isNullOrUndefined(obj));
+        if (pic_miss(c, obj, env)) {
+            if (c.megamorphic)
+                c.set_handler = setprop_megamorphic;
+            c.set_handler(c, obj, val, env);
+            return;
+        }
         Toplevel* toplevel = env->toplevel();
         VTable* vtable = toplevel->toVTable(obj);
         Traits* actual_type = vtable->traits;
@@ -844,6 +1000,8 @@ namespace avmplus
             // must be a primitive: int, bool, string, namespace, or number.
             // all paths lead to an error, so just use the generic handler.
             c.set_handler = &setprop_generic;
+            c.tag = atomKind(obj);
+            AvmAssert(c.tag != 0);
         }
         c.set_handler(c, obj, val, env);
     }
@@ -852,8 +1010,8 @@ namespace avmplus
     // fully dynamic generic handler for OP_setproperty
     void setprop_late(MethodEnv* env, Atom obj, const Multiname* name, Atom val)
     {
-        SetCache c(name, NULL);  // temporary cache, just so we can call the generic handler.
-        setprop_generic(c, obj, val, env);
+        SetCache c(name, NULL);  // temporary cache, just so we can call the slow handler.
+        setprop_slow(c, obj, val, env);
     }
     FUNCTION(FUNCADDR(setprop_late), SIG4(V,P,A,P,A), setprop_late)
 
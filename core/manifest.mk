@@ -43,12 +43,15 @@ avmplus_CXXSRCS := $(avmplus_CXXSRCS) \
   $(curdir)/Domain.cpp \
   $(curdir)/DomainEnv.cpp \
   $(curdir)/DomainMgr.cpp \
+  $(curdir)/DynamicShape.cpp \
   $(curdir)/E4XNode.cpp \
   $(curdir)/ErrorClass.cpp \
   $(curdir)/ErrorConstants.cpp \
   $(curdir)/Exception.cpp \
   $(curdir)/exec.cpp \
   $(curdir)/exec-jit.cpp \
+  $(curdir)/exec-jitpool.cpp \
+  $(curdir)/exec-jitprofile.cpp \
   $(curdir)/exec-osr.cpp \
   $(curdir)/exec-verifyall.cpp \
   $(curdir)/FloatClass.cpp \
@@ -80,6 +83,7 @@ avmplus_CXXSRCS := $(avmplus_CXXSRCS) \
   $(curdir)/ProxyGlue.cpp \
   $(curdir)/QCache.cpp \
   $(curdir)/RegExpClass.cpp \
+  $(curdir)/RegExpCompiler.cpp \
   $(curdir)/RegExpObject.cpp \
   $(curdir)/Sampler.cpp \
   $(curdir)/ScopeChain.cpp \
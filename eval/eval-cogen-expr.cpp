@@ -180,7 +180,6 @@ namespace avmplus
                 cogen->I_pushnull();
             else
                 tparam->cogen(cogen, ctx);
-            tparam->cogen(cogen, ctx);
             cogen->I_applytype(1);
         }
 
@@ -1,4 +1,4 @@
-// Generated from ST_avmplus_basics.st, ST_avmplus_builtins.st, ST_avmplus_peephole.st, ST_avmplus_vector_accessors.st, ST_mmgc_543560.st, ST_mmgc_575631.st, ST_mmgc_580603.st, ST_mmgc_603411.st, ST_mmgc_637993.st, ST_mmgc_basics.st, ST_mmgc_dependent.st, ST_mmgc_exact.st, ST_mmgc_externalalloc.st, ST_mmgc_finalize_uninit.st, ST_mmgc_fixedmalloc_findbeginning.st, ST_mmgc_gcheap.st, ST_mmgc_gcoption.st, ST_mmgc_mmfx_array.st, ST_mmgc_threads.st, ST_mmgc_weakref.st, ST_nanojit_codealloc.st, ST_vmbase_concurrency.st, ST_vmbase_safepoints.st, ST_vmpi_threads.st, ST_workers_Buffer.st, ST_workers_NoSyncSingleItemBuffer.st, ST_workers_Promise.st
+// Generated from ST_avmplus_basics.st, ST_avmplus_builtins.st, ST_avmplus_jitprofile.st, ST_avmplus_json.st, ST_avmplus_peephole.st, ST_avmplus_vector_accessors.st, ST_mmgc_543560.st, ST_mmgc_575631.st, ST_mmgc_580603.st, ST_mmgc_603411.st, ST_mmgc_637993.st, ST_mmgc_basics.st, ST_mmgc_dependent.st, ST_mmgc_exact.st, ST_mmgc_externalalloc.st, ST_mmgc_finalize_uninit.st, ST_mmgc_fixedmalloc_findbeginning.st, ST_mmgc_gcheap.st, ST_mmgc_gcoption.st, ST_mmgc_mmfx_array.st, ST_mmgc_threads.st, ST_mmgc_weakref.st, ST_nanojit_codealloc.st, ST_vmbase_concurrency.st, ST_vmbase_safepoints.st, ST_vmpi_threads.st, ST_workers_Buffer.st, ST_workers_NoSyncSingleItemBuffer.st, ST_workers_Promise.st
 // Generated from ST_avmplus_basics.st
 // -*- mode: c; c-basic-offset: 4; indent-tabs-mode: nil; tab-width: 4 -*-
 // vi: set ts=4 sw=4 expandtab: (add to ~/.vimrc: set modeline modelines=5) */
@@ -26,12 +26,15 @@ void test4();
 void test5();
 void test6();
 void test7();
+void test8();
+void test9();
+void test10();
 };
 ST_avmplus_basics::ST_avmplus_basics(AvmCore* core)
     : Selftest(core, "avmplus", "basics", ST_avmplus_basics::ST_names,ST_avmplus_basics::ST_explicits)
 {}
-const char* ST_avmplus_basics::ST_names[] = {"unsigned_int","signed_int","equalsLatin1","containsLatin1","indexOfLatin1","matchesLatin1","matchesLatin1_caseless","bug562101", NULL };
-const bool ST_avmplus_basics::ST_explicits[] = {false,false,false,false,false,false,false,false, false };
+const char* ST_avmplus_basics::ST_names[] = {"unsigned_int","signed_int","equalsLatin1","containsLatin1","indexOfLatin1","matchesLatin1","matchesLatin1_caseless","string_kernels","matchesLatin1_caseless_long","string_kernels_timing","bug562101", NULL };
+const bool ST_avmplus_basics::ST_explicits[] = {false,false,false,false,false,false,false,false,false,true,false, false };
 void ST_avmplus_basics::run(int n) {
 switch(n) {
 case 0: test0(); return;
@@ -42,19 +45,97 @@ case 4: test4(); return;
 case 5: test5(); return;
 case 6: test6(); return;
 case 7: test7(); return;
+case 8: test8(); return;
+case 9: test9(); return;
+case 10: test10(); return;
 }
 }
+
+// Plain loops to check String's search, compare and hash code against; the
+// String versions use SSE2 where it is available.
+
+static int32_t refIndexOf(const wchar* s, int32_t n, const wchar* p, int32_t m, int32_t start)
+{
+    for (int32_t i = start; i + m <= n; i++)
+        if (VMPI_memcmp(s + i, p, m * sizeof(wchar)) == 0)
+            return i;
+    return -1;
+}
+
+static int32_t refLastIndexOf(const wchar* s, int32_t n, const wchar* p, int32_t m, int32_t start)
+{
+    for (int32_t i = (start < n - m ? start : n - m); i >= 0; i--)
+        if (VMPI_memcmp(s + i, p, m * sizeof(wchar)) == 0)
+            return i;
+    return -1;
+}
+
+static int32_t refHashCode(const wchar* s, int32_t n)
+{
+    int32_t h = 0;
+    while (n--)
+        h = (h >> 28) ^ (h << 4) ^ *s++;
+    return h;
+}
+
+// Fills buf with n characters from a four letter alphabet, so that there are
+// many partial matches.  The wide alphabet has a character that differs from
+// another one in its high byte only.
+static void fillChars(wchar* buf, int32_t n, uint32_t& seed, bool wide)
+{
+    static const wchar narrow_chars[] = { 'a', 'b', 'c', 0xE9 };
+    static const wchar wide_chars[] = { 'a', 'b', 0x161, 0x3B1 };
+    for (int32_t i = 0; i < n; i++)
+    {
+        seed = seed * 1103515245 + 12345;
+        buf[i] = (wide ? wide_chars : narrow_chars)[(seed >> 16) & 3];
+    }
+    if (wide)
+        buf[0] = 0x3B1;
+}
+
+// Runs the searches and comparisons of the string_kernels test over s, and
+// returns false if any of them disagreed with the loops above.
+static bool checkStringKernels(AvmCore* core, Stringp s, const wchar* buf, int32_t n)
+{
+    bool ok = s->hashCode() == refHashCode(buf, n);
+    for (int32_t start = 0; start < n; start++)
+    {
+        for (int32_t m = 1; start + m <= n && m <= 20; m++)
+        {
+            Stringp p = s->substring(start, start + m);
+            int32_t from = (start * 7) % n;
+            ok = ok && s->indexOf(p, from) == refIndexOf(buf, n, buf + start, m, from);
+            ok = ok && s->lastIndexOf(p, from) == refLastIndexOf(buf, n, buf + start, m, from);
+            ok = ok && s->indexOf(p) == refIndexOf(buf, n, buf + start, m, 0);
+            ok = ok && s->lastIndexOf(p) == refLastIndexOf(buf, n, buf + start, m, n);
+        }
+        ok = ok && s->indexOfCharCode(buf[start], start) == start;
+    }
+    wchar changed[80];
+    for (int32_t k = 0; k < n; k++)
+    {
+        VMPI_memcpy(changed, buf, n * sizeof(wchar));
+        changed[k] = wchar(changed[k] + 1);
+        Stringp t = core->newStringUTF16(changed, n);
+        ok = ok && !s->equals(t) && !t->equals(s);
+        ok = ok && s->Compare(*t) == 1 && t->Compare(*s) == -1;
+        ok = ok && s->hashCode() != t->hashCode();
+    }
+    return ok;
+}
+
 void ST_avmplus_basics::test0() {
 
 // Does right shift of unsigned quantities work?
-// line 14 "ST_avmplus_basics.st"
+// line 90 "ST_avmplus_basics.st"
 verifyPass((int)(~0U >> 1) > 0, "(int)(~0U >> 1) > 0", __FILE__, __LINE__);
 
 }
 void ST_avmplus_basics::test1() {
 
 // Does right shift of signed quantities work?
-// line 19 "ST_avmplus_basics.st"
+// line 95 "ST_avmplus_basics.st"
 verifyPass((-1 >> 1) == -1, "(-1 >> 1) == -1", __FILE__, __LINE__);
 
 // verify that the "latin1" literal string calls work properly for hi-bit latin1 chars
@@ -62,40 +143,137 @@ verifyPass((-1 >> 1) == -1, "(-1 >> 1) == -1", __FILE__, __LINE__);
 void ST_avmplus_basics::test2() {
     Stringp s = core->newConstantStringLatin1("ev\xADident");
     bool equals = s->equalsLatin1("ev\xADident");
-// line 25 "ST_avmplus_basics.st"
+// line 101 "ST_avmplus_basics.st"
 verifyPass(equals == true, "equals == true", __FILE__, __LINE__);
 
 }
 void ST_avmplus_basics::test3() {
     Stringp s = core->newConstantStringLatin1("ev\xADident");
     bool found = s->containsLatin1("\xAD");
-// line 30 "ST_avmplus_basics.st"
+// line 106 "ST_avmplus_basics.st"
 verifyPass(found == true, "found == true", __FILE__, __LINE__);
 
 }
 void ST_avmplus_basics::test4() {
     Stringp s = core->newConstantStringLatin1("ev\xADident");
     int index = s->indexOfLatin1("\xAD");
-// line 35 "ST_avmplus_basics.st"
+// line 111 "ST_avmplus_basics.st"
 verifyPass(index == 2, "index == 2", __FILE__, __LINE__);
 
 }
 void ST_avmplus_basics::test5() {
     Stringp s = core->newConstantStringLatin1("ev\xADident");
     bool matches1 = s->matchesLatin1("\xADi", 2, 2);
-// line 40 "ST_avmplus_basics.st"
+// line 116 "ST_avmplus_basics.st"
 verifyPass(matches1 == true, "matches1 == true", __FILE__, __LINE__);
 
 }
 void ST_avmplus_basics::test6() {
     Stringp s = core->newConstantStringLatin1("ev\xADident");
     bool matches2 = s->matchesLatin1_caseless("\xADIDENT", 2, 2);
-// line 45 "ST_avmplus_basics.st"
+// line 121 "ST_avmplus_basics.st"
 verifyPass(matches2 == true, "matches2 == true", __FILE__, __LINE__);
 
 
+// Search, compare and hash both widths of strings at lengths around and between
+// the vector sizes, against the plain loops.
 }
 void ST_avmplus_basics::test7() {
+    bool ok = true;
+    uint32_t seed = 1;
+    wchar buf[80];
+    for (int32_t n = 1; n < 80; n++)
+    {
+        fillChars(buf, n, seed, false);
+        Stringp s8 = core->newStringUTF16(buf, n);
+        ok = ok && s8->getWidth() == String::k8 && checkStringKernels(core, s8, buf, n);
+        fillChars(buf, n, seed, true);
+        Stringp s16 = core->newStringUTF16(buf, n);
+        ok = ok && s16->getWidth() == String::k16 && checkStringKernels(core, s16, buf, n);
+    }
+// line 139 "ST_avmplus_basics.st"
+verifyPass(ok, "ok", __FILE__, __LINE__);
+
+// Case-insensitive matches, with the characters around 'a'..'z' and 'A'..'Z' and
+// a non-ASCII one somewhere in or after the first 16.
+}
+void ST_avmplus_basics::test8() {
+    const char* lower = "@`[{az-the quick brown fox, \xE9t\xE9, jumps over the lazy dog";
+    const char* upper = "@`[{AZ-THE QUICK BROWN FOX, \xC9T\xC9, JUMPS OVER THE LAZY DOG";
+    int32_t len = int32_t(VMPI_strlen(lower));
+    Stringp s = core->newStringLatin1(lower);
+    bool ok = true;
+    for (int32_t pos = 0; pos < len; pos++)
+    {
+        ok = ok && s->matchesLatin1_caseless(upper + pos, len - pos, pos);
+        ok = ok && s->matchesLatin1_caseless(lower + pos, len - pos, pos);
+        ok = ok && !s->matchesLatin1_caseless(upper + pos, len - pos + 1, pos);
+    }
+    char changed[80];
+    for (int32_t k = 0; k < len; k++)
+    {
+        VMPI_strcpy(changed, upper);
+        changed[k] = changed[k] == '@' ? '`' : char(changed[k] ^ 1);
+        ok = ok && !s->matchesLatin1_caseless(changed, len, 0);
+    }
+// line 162 "ST_avmplus_basics.st"
+verifyPass(ok, "ok", __FILE__, __LINE__);
+
+// Not a test: times String's search, compare and hash code on long strings of
+// both widths, to spot changes in their speed.  Run it explicitly, with
+// -Dselftest=avmplus,basics,string_kernels_timing in a release build.
+}
+void ST_avmplus_basics::test9() {
+    const int32_t kLength = 64 * 1024;
+    const int32_t kRounds = 2000;
+    int32_t sink = 0;
+    wchar* buf = mmfx_new_array(wchar, kLength);
+    for (int wide = 0; wide < 2; wide++)
+    {
+        // Only the first and the last characters are unique, so the searches
+        // go through the whole string.
+        for (int32_t i = 0; i < kLength; i++)
+            buf[i] = wchar('a' + i % 23);
+        buf[0] = 'y';
+        buf[kLength - 1] = wide ? 0x3B1 : 'z';
+        Stringp s = core->newStringUTF16(buf, kLength);
+        Stringp t = core->newStringUTF16(buf, kLength);
+        Stringp tail = s->substring(kLength - 8, kLength);
+        Stringp last = s->substring(kLength - 1, kLength);
+        Stringp head = s->substring(0, 8);
+        Stringp caseless = s->substring(1, kLength - 1)->toUpperCase();
+        StUTF8String caselessChars(caseless);
+        for (int op = 0; op < 6; op++)
+        {
+            if (wide && op == 5)
+                break;
+            uint64_t start = VMPI_getPerformanceCounter();
+            for (int32_t r = 0; r < kRounds; r++)
+            {
+                switch (op)
+                {
+                    case 0: sink += s->indexOf(tail); break;
+                    case 1: sink += s->indexOf(last); break;
+                    case 2: sink += s->lastIndexOf(head); break;
+                    case 3: sink += s->Compare(*t) + s->equals(t); break;
+                    case 4: sink += s->hashCode(); break;
+                    case 5: sink += s->matchesLatin1_caseless(caselessChars.c_str(), kLength - 2, 1); break;
+                }
+            }
+            uint64_t ticks = VMPI_getPerformanceCounter() - start;
+            static const char* const names[] = { "indexOf", "indexOf(char)", "lastIndexOf", "Compare+equals", "hashCode", "matchesLatin1_caseless" };
+            double mb = double(kLength) * kRounds * (wide ? 2 : 1) / (1024 * 1024);
+            printf("%s %s: %.0f MB/s\n", wide ? "k16" : "k8", names[op],
+                   mb * double(VMPI_getPerformanceFrequency()) / double(ticks ? ticks : 1));
+        }
+    }
+    mmfx_delete_array(buf);
+    printf("Ignore this: %d\n", sink);
+// line 213 "ST_avmplus_basics.st"
+verifyPass(true, "true", __FILE__, __LINE__);
+
+}
+void ST_avmplus_basics::test10() {
 // XMLParser omits the last char of a DOCTYPE node
 Stringp str = core->newConstantStringLatin1("<?xml version=\"1.0\"?><!DOCTYPE greeting SYSTEM><greeting>Hello, world!</greeting>");
 XMLParser parser(core, str);
@@ -115,7 +293,7 @@ while ((m_status = parser.getNext(tag)) == XMLParser::kNoError)
     break;
     }
 }
-// line 68 "ST_avmplus_basics.st"
+// line 235 "ST_avmplus_basics.st"
 verifyPass(pass == true, "pass == true", __FILE__, __LINE__);
 
     // FIXME: this needs a "register this object with the GC" mechanism; this abuse of the GCRoot mechanism
@@ -202,6 +380,456 @@ void create_avmplus_builtins(AvmCore* core) { new ST_avmplus_builtins(core); }
 }
 #endif
 
+// Generated from ST_avmplus_jitprofile.st
+// -*- mode: c; c-basic-offset: 4; indent-tabs-mode: nil; tab-width: 4 -*-
+// vi: set ts=4 sw=4 expandtab: (add to ~/.vimrc: set modeline modelines=5) */
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+// JitProfile's save() and load(), as the shell's -jitprofile uses them.  The
+// methods recorded are the first few of the builtin pool.
+
+#include "avmshell.h"
+#ifdef VMCFG_SELFTEST
+#if defined VMCFG_NANOJIT
+namespace avmplus {
+namespace ST_avmplus_jitprofile {
+class ST_avmplus_jitprofile : public Selftest {
+public:
+ST_avmplus_jitprofile(AvmCore* core);
+virtual void run(int n);
+private:
+static const char* ST_names[];
+static const bool ST_explicits[];
+void test0();
+void test1();
+void test2();
+void test3();
+};
+ST_avmplus_jitprofile::ST_avmplus_jitprofile(AvmCore* core)
+    : Selftest(core, "avmplus", "jitprofile", ST_avmplus_jitprofile::ST_names,ST_avmplus_jitprofile::ST_explicits)
+{}
+const char* ST_avmplus_jitprofile::ST_names[] = {"round_trip","failures_expire","other_build","damaged", NULL };
+const bool ST_avmplus_jitprofile::ST_explicits[] = {false,false,false,false, false };
+void ST_avmplus_jitprofile::run(int n) {
+switch(n) {
+case 0: test0(); return;
+case 1: test1(); return;
+case 2: test2(); return;
+case 3: test3(); return;
+}
+}
+
+// What a later run of the same build, or of the build 'build', would load
+// from what 'p' saves.  NULL if load() rejected it.
+static JitProfile* reload(JitProfile* p, uint64_t build)
+{
+    size_t size;
+    uint8_t* data = p->save(&size);
+    JitProfile* q = mmfx_new(JitProfile(build));
+    bool loaded = q->load(data, size);
+    mmfx_delete_array(data);
+    if (!loaded) {
+        mmfx_delete(q);
+        return NULL;
+    }
+    return q;
+}
+
+// Saves 'p' and checks that every way of damaging the result is rejected,
+// and leaves what 'q' had loaded alone.
+static bool rejectsDamage(JitProfile* p, JitProfile* q)
+{
+    size_t size;
+    uint8_t* data = p->save(&size);
+    uint32_t count = q->loadedCount();
+    bool ok = size > 1;
+    ok = ok && !q->load(data, 0);
+    ok = ok && !q->load(data, 3);               // shorter than the header
+    ok = ok && !q->load(data, size - 1);        // truncated entry
+    uint8_t* longer = mmfx_new_array(uint8_t, size + 1);
+    VMPI_memcpy(longer, data, size);
+    longer[size] = 0;
+    ok = ok && !q->load(longer, size + 1);      // trailing garbage
+    mmfx_delete_array(longer);
+    data[0] ^= 0xFF;                            // magic
+    ok = ok && !q->load(data, size);
+    data[0] ^= 0xFF;
+    for (size_t i = size / 2; i < size; i++)    // entries out of order or with a bad outcome
+        data[i] = uint8_t(0xA5 ^ i);
+    ok = ok && !q->load(data, size);
+    mmfx_delete_array(data);
+    return ok && q->loadedCount() == count;
+}
+
+void ST_avmplus_jitprofile::test0() {
+    MethodInfo* m0 = core->builtinPool->getMethodInfo(0);
+    MethodInfo* m1 = core->builtinPool->getMethodInfo(1);
+    MethodInfo* m2 = core->builtinPool->getMethodInfo(2);
+    MethodInfo* m3 = core->builtinPool->getMethodInfo(3);
+    JitProfile* p = mmfx_new(JitProfile(1));
+    p->record(m0, JitProfile::kCompiled);
+    p->record(m1, JitProfile::kFailed);
+    p->record(m1, JitProfile::kCompiled);
+    p->record(m2, JitProfile::kFailed);
+    JitProfile* q = reload(p, 1);
+// line 70 "ST_avmplus_jitprofile.st"
+verifyPass(p->lookup(m0) == JitProfile::kUnknown, "p->lookup(m0) == JitProfile::kUnknown", __FILE__, __LINE__);
+// line 71 "ST_avmplus_jitprofile.st"
+verifyPass(q != NULL && q->loadedCount() == 3, "q != NULL && q->loadedCount() == 3", __FILE__, __LINE__);
+// line 72 "ST_avmplus_jitprofile.st"
+verifyPass(q->lookup(m0) == JitProfile::kCompiled, "q->lookup(m0) == JitProfile::kCompiled", __FILE__, __LINE__);
+// line 73 "ST_avmplus_jitprofile.st"
+verifyPass(q->lookup(m1) == JitProfile::kCompiled, "q->lookup(m1) == JitProfile::kCompiled", __FILE__, __LINE__);
+// line 74 "ST_avmplus_jitprofile.st"
+verifyPass(q->lookup(m2) == JitProfile::kFailed, "q->lookup(m2) == JitProfile::kFailed", __FILE__, __LINE__);
+// line 75 "ST_avmplus_jitprofile.st"
+verifyPass(q->lookup(m3) == JitProfile::kUnknown, "q->lookup(m3) == JitProfile::kUnknown", __FILE__, __LINE__);
+    // A later run's outcomes replace the loaded ones and are merged with the rest.
+    q->record(m2, JitProfile::kCompiled);
+    q->record(m3, JitProfile::kFailed);
+    JitProfile* r = reload(q, 1);
+// line 80 "ST_avmplus_jitprofile.st"
+verifyPass(r != NULL && r->loadedCount() == 4, "r != NULL && r->loadedCount() == 4", __FILE__, __LINE__);
+// line 81 "ST_avmplus_jitprofile.st"
+verifyPass(r->lookup(m0) == JitProfile::kCompiled, "r->lookup(m0) == JitProfile::kCompiled", __FILE__, __LINE__);
+// line 82 "ST_avmplus_jitprofile.st"
+verifyPass(r->lookup(m2) == JitProfile::kCompiled, "r->lookup(m2) == JitProfile::kCompiled", __FILE__, __LINE__);
+// line 83 "ST_avmplus_jitprofile.st"
+verifyPass(r->lookup(m3) == JitProfile::kFailed, "r->lookup(m3) == JitProfile::kFailed", __FILE__, __LINE__);
+    mmfx_delete(r);
+    mmfx_delete(q);
+    mmfx_delete(p);
+
+}
+void ST_avmplus_jitprofile::test1() {
+    MethodInfo* m0 = core->builtinPool->getMethodInfo(0);
+    MethodInfo* m1 = core->builtinPool->getMethodInfo(1);
+    JitProfile* p = mmfx_new(JitProfile(1));
+    p->record(m0, JitProfile::kFailed);
+    p->record(m1, JitProfile::kCompiled);
+    // Runs that record nothing carry the failure over kFailedRuns times.
+    int failedRuns = 0;
+    bool compiledKept = true;
+    for (int run = 0; run < 2 * JitProfile::kFailedRuns && p != NULL; run++) {
+        JitProfile* next = reload(p, 1);
+        mmfx_delete(p);
+        p = next;
+        if (p != NULL && p->lookup(m0) == JitProfile::kFailed)
+            failedRuns++;
+        compiledKept = compiledKept && p != NULL && p->lookup(m1) == JitProfile::kCompiled;
+    }
+// line 105 "ST_avmplus_jitprofile.st"
+verifyPass(p != NULL, "p != NULL", __FILE__, __LINE__);
+// line 106 "ST_avmplus_jitprofile.st"
+verifyPass(failedRuns == JitProfile::kFailedRuns, "failedRuns == JitProfile::kFailedRuns", __FILE__, __LINE__);
+// line 107 "ST_avmplus_jitprofile.st"
+verifyPass(compiledKept, "compiledKept", __FILE__, __LINE__);
+    mmfx_delete(p);
+
+}
+void ST_avmplus_jitprofile::test2() {
+    JitProfile* p = mmfx_new(JitProfile(1));
+    p->record(core->builtinPool->getMethodInfo(0), JitProfile::kCompiled);
+    JitProfile* q = reload(p, 2);
+// line 114 "ST_avmplus_jitprofile.st"
+verifyPass(q == NULL, "q == NULL", __FILE__, __LINE__);
+    mmfx_delete(p);
+
+}
+void ST_avmplus_jitprofile::test3() {
+    JitProfile* p = mmfx_new(JitProfile(1));
+    for (uint32_t i = 0; i < 8; i++)
+        p->record(core->builtinPool->getMethodInfo(i), i % 3 ? JitProfile::kCompiled : JitProfile::kFailed);
+    JitProfile* q = mmfx_new(JitProfile(1));
+// line 122 "ST_avmplus_jitprofile.st"
+verifyPass(rejectsDamage(p, q), "rejectsDamage(p, q)", __FILE__, __LINE__);
+// line 123 "ST_avmplus_jitprofile.st"
+verifyPass(q->loadedCount() == 0, "q->loadedCount() == 0", __FILE__, __LINE__);
+    JitProfile* r = reload(p, 1);
+// line 125 "ST_avmplus_jitprofile.st"
+verifyPass(r != NULL && r->loadedCount() == 8, "r != NULL && r->loadedCount() == 8", __FILE__, __LINE__);
+// line 126 "ST_avmplus_jitprofile.st"
+verifyPass(rejectsDamage(p, r), "rejectsDamage(p, r)", __FILE__, __LINE__);
+// line 127 "ST_avmplus_jitprofile.st"
+verifyPass(r->lookup(core->builtinPool->getMethodInfo(0)) == JitProfile::kFailed, "r->lookup(core->builtinPool->getMethodInfo(0)) == JitProfile::kFailed", __FILE__, __LINE__);
+    mmfx_delete(r);
+    mmfx_delete(q);
+    mmfx_delete(p);
+
+}
+void create_avmplus_jitprofile(AvmCore* core) { new ST_avmplus_jitprofile(core); }
+}
+}
+#endif
+#endif
+
+// Generated from ST_avmplus_json.st
+// -*- mode: c; c-basic-offset: 4; indent-tabs-mode: nil; tab-width: 4 -*-
+// vi: set ts=4 sw=4 expandtab: (add to ~/.vimrc: set modeline modelines=5) */
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+// JSONClass::parseTyped has no AS3 entry point, so it is tested here.  The
+// classes to parse into are compiled from source by the shell's eval, which
+// does not record the types of vars; typed targets are tested with Vectors.
+
+#include "avmshell.h"
+#ifdef VMCFG_SELFTEST
+namespace avmplus {
+namespace ST_avmplus_json {
+
+#if defined AVMSHELL_BUILD && defined VMCFG_EVAL
+
+static const char* const kJSONTypes =
+    "class JSONPoint {"
+    "    public var x;"
+    "    public var label;"
+    "    public var next;"
+    "}"
+    "dynamic class JSONBag {"
+    "    public var n;"
+    "}";
+
+// The core kJSONTypes has been compiled for.
+static AvmCore* jsonTypesCore = NULL;
+
+// The class 'name', compiling kJSONTypes into 'codeContext' first if need be.
+static ClassClosure* jsonClass(Toplevel* toplevel, CodeContext* codeContext, const char* name)
+{
+    AvmCore* core = toplevel->core();
+    // The newline stops eval from reading a lone name as an attribute.
+    String* code = core->newStringLatin1(name)->appendLatin1("\n\0", 2);
+    if (jsonTypesCore != core) {
+        code = core->newStringLatin1(kJSONTypes)->append(code);
+        jsonTypesCore = core;
+    }
+    Atom a = core->handleActionSource(code, NULL, toplevel, NULL, codeContext, core->getApiVersionFromCallStack());
+    return (ClassClosure*)AvmCore::atomToScriptObject(a);
+}
+
+// Parses as if called from code in 'codeContext', where JSONPoint is found.
+static Atom parseTyped(Toplevel* toplevel, CodeContext* codeContext, const char* text, ClassClosure* type)
+{
+    EnterCodeContext ecc(toplevel->core(), codeContext);
+    return toplevel->builtinClasses()->get_JSONClass()->parseTyped(toplevel->core()->newStringUTF8(text), type);
+}
+
+static Atom getJSONProperty(Toplevel* toplevel, Atom obj, const char* name)
+{
+    AvmCore* core = toplevel->core();
+    Multiname mn(core->findPublicNamespace(), core->internStringLatin1(name));
+    return toplevel->getproperty(obj, &mn, toplevel->toVTable(obj));
+}
+
+static bool isJSONInstance(Atom a, ClassClosure* type)
+{
+    return AvmCore::isObject(a) && AvmCore::atomToScriptObject(a)->traits() == type->ivtable()->traits;
+}
+
+#endif // AVMSHELL_BUILD && VMCFG_EVAL
+
+class ST_avmplus_json : public Selftest {
+public:
+ST_avmplus_json(AvmCore* core);
+virtual void run(int n);
+private:
+static const char* ST_names[];
+static const bool ST_explicits[];
+void test0();
+void test1();
+void test2();
+void test3();
+void test4();
+};
+ST_avmplus_json::ST_avmplus_json(AvmCore* core)
+    : Selftest(core, "avmplus", "json", ST_avmplus_json::ST_names,ST_avmplus_json::ST_explicits)
+{}
+const char* ST_avmplus_json::ST_names[] = {"slots","vectors","top_level_array","dynamic_and_sealed","string_values", NULL };
+const bool ST_avmplus_json::ST_explicits[] = {false,false,false,false,false, false };
+void ST_avmplus_json::run(int n) {
+switch(n) {
+case 0: test0(); return;
+case 1: test1(); return;
+case 2: test2(); return;
+case 3: test3(); return;
+case 4: test4(); return;
+}
+}
+void ST_avmplus_json::test0() {
+
+#if defined AVMSHELL_BUILD && defined VMCFG_EVAL
+
+avmshell::ShellCore* c = (avmshell::ShellCore*)core;
+avmshell::ShellToplevel* top = c->shell_toplevel;
+ClassClosure* point = jsonClass(top, c->user_codeContext, "JSONPoint");
+Atom p = parseTyped(top, c->user_codeContext, "{\"x\": 7, \"label\": \"caf\xc3\xa9\", \"next\": {\"x\": 1}}", point);
+Atom next = getJSONProperty(top, p, "next");
+
+// line 77 "ST_avmplus_json.st"
+verifyPass(isJSONInstance(p, point), "isJSONInstance(p, point)", __FILE__, __LINE__);
+// line 78 "ST_avmplus_json.st"
+verifyPass(getJSONProperty(top, p, "x") == core->intToAtom(7), "getJSONProperty(top, p, \"x\") == core->intToAtom(7)", __FILE__, __LINE__);
+// line 79 "ST_avmplus_json.st"
+verifyPass(core->string(getJSONProperty(top, p, "label"))->equals(core->newStringUTF8("caf\xc3\xa9")), "core->string(getJSONProperty(top, p, \"label\"))->equals(core->newStringUTF8(\"caf\xc3\xa9\"))", __FILE__, __LINE__);
+// line 80 "ST_avmplus_json.st"
+verifyPass(AvmCore::atomToScriptObject(next)->traits() == core->traits.object_itraits, "AvmCore::atomToScriptObject(next)->traits() == core->traits.object_itraits", __FILE__, __LINE__);
+// line 81 "ST_avmplus_json.st"
+verifyPass(getJSONProperty(top, next, "x") == core->intToAtom(1), "getJSONProperty(top, next, \"x\") == core->intToAtom(1)", __FILE__, __LINE__);
+
+#else
+
+// line 85 "ST_avmplus_json.st"
+verifyPass(true, "true", __FILE__, __LINE__);
+
+#endif
+
+}
+void ST_avmplus_json::test1() {
+
+#if defined AVMSHELL_BUILD && defined VMCFG_EVAL
+
+avmshell::ShellCore* c = (avmshell::ShellCore*)core;
+avmshell::ShellToplevel* top = c->shell_toplevel;
+ClassClosure* point = jsonClass(top, c->user_codeContext, "JSONPoint");
+ClassClosure* points = top->vectorClass()->getTypedVectorClass(point);
+ScriptObject* pv = AvmCore::atomToScriptObject(parseTyped(top, c->user_codeContext, "[{\"x\": 3}, null, {\"x\": 4, \"next\": null}]", points));
+ScriptObject* iv = AvmCore::atomToScriptObject(parseTyped(top, c->user_codeContext, "[1, 2.5, -3]", top->intVectorClass()));
+
+// line 100 "ST_avmplus_json.st"
+verifyPass(pv->traits() == points->ivtable()->traits, "pv->traits() == points->ivtable()->traits", __FILE__, __LINE__);
+// line 101 "ST_avmplus_json.st"
+verifyPass(isJSONInstance(pv->getUintProperty(0), point), "isJSONInstance(pv->getUintProperty(0), point)", __FILE__, __LINE__);
+// line 102 "ST_avmplus_json.st"
+verifyPass(pv->getUintProperty(1) == nullObjectAtom, "pv->getUintProperty(1) == nullObjectAtom", __FILE__, __LINE__);
+// line 103 "ST_avmplus_json.st"
+verifyPass(getJSONProperty(top, pv->getUintProperty(2), "x") == core->intToAtom(4), "getJSONProperty(top, pv->getUintProperty(2), \"x\") == core->intToAtom(4)", __FILE__, __LINE__);
+// line 104 "ST_avmplus_json.st"
+verifyPass(iv->traits() == top->intVectorClass()->ivtable()->traits, "iv->traits() == top->intVectorClass()->ivtable()->traits", __FILE__, __LINE__);
+// line 105 "ST_avmplus_json.st"
+verifyPass(core->string(iv->atom())->equalsLatin1("1,2,-3"), "core->string(iv->atom())->equalsLatin1(\"1,2,-3\")", __FILE__, __LINE__);
+
+#else
+
+// line 109 "ST_avmplus_json.st"
+verifyPass(true, "true", __FILE__, __LINE__);
+
+#endif
+
+}
+void ST_avmplus_json::test2() {
+
+#if defined AVMSHELL_BUILD && defined VMCFG_EVAL
+
+avmshell::ShellCore* c = (avmshell::ShellCore*)core;
+avmshell::ShellToplevel* top = c->shell_toplevel;
+ClassClosure* point = jsonClass(top, c->user_codeContext, "JSONPoint");
+Atom a = parseTyped(top, c->user_codeContext, "[{\"x\": 1}, {\"x\": 2}, null]", point);
+ScriptObject* arr = AvmCore::atomToScriptObject(a);
+
+// line 123 "ST_avmplus_json.st"
+verifyPass(AvmCore::istype(a, core->traits.array_itraits), "AvmCore::istype(a, core->traits.array_itraits)", __FILE__, __LINE__);
+// line 124 "ST_avmplus_json.st"
+verifyPass(isJSONInstance(arr->getUintProperty(0), point), "isJSONInstance(arr->getUintProperty(0), point)", __FILE__, __LINE__);
+// line 125 "ST_avmplus_json.st"
+verifyPass(getJSONProperty(top, arr->getUintProperty(1), "x") == core->intToAtom(2), "getJSONProperty(top, arr->getUintProperty(1), \"x\") == core->intToAtom(2)", __FILE__, __LINE__);
+// line 126 "ST_avmplus_json.st"
+verifyPass(arr->getUintProperty(2) == nullObjectAtom, "arr->getUintProperty(2) == nullObjectAtom", __FILE__, __LINE__);
+
+#else
+
+// line 130 "ST_avmplus_json.st"
+verifyPass(true, "true", __FILE__, __LINE__);
+
+#endif
+
+}
+void ST_avmplus_json::test3() {
+
+#if defined AVMSHELL_BUILD && defined VMCFG_EVAL
+
+avmshell::ShellCore* c = (avmshell::ShellCore*)core;
+avmshell::ShellToplevel* top = c->shell_toplevel;
+ClassClosure* bag = jsonClass(top, c->user_codeContext, "JSONBag");
+Atom b = parseTyped(top, c->user_codeContext, "{\"n\": 5, \"extra\": \"e\", \"0\": true}", bag);
+
+// line 143 "ST_avmplus_json.st"
+verifyPass(isJSONInstance(b, bag), "isJSONInstance(b, bag)", __FILE__, __LINE__);
+// line 144 "ST_avmplus_json.st"
+verifyPass(getJSONProperty(top, b, "n") == core->uintToAtom(5), "getJSONProperty(top, b, \"n\") == core->uintToAtom(5)", __FILE__, __LINE__);
+// line 145 "ST_avmplus_json.st"
+verifyPass(core->string(getJSONProperty(top, b, "extra"))->equalsLatin1("e"), "core->string(getJSONProperty(top, b, \"extra\"))->equalsLatin1(\"e\")", __FILE__, __LINE__);
+// line 146 "ST_avmplus_json.st"
+verifyPass(getJSONProperty(top, b, "0") == trueAtom, "getJSONProperty(top, b, \"0\") == trueAtom", __FILE__, __LINE__);
+
+ClassClosure* point = jsonClass(top, c->user_codeContext, "JSONPoint");
+bool threw = false;
+TRY(core, kCatchAction_Ignore)
+{
+    parseTyped(top, c->user_codeContext, "{\"x\": 1, \"nosuchvar\": 2}", point);
+}
+CATCH(Exception* exception)
+{
+    threw = AvmCore::istype(exception->atom, top->referenceErrorClass()->ivtable()->traits);
+}
+END_CATCH
+END_TRY
+
+// line 161 "ST_avmplus_json.st"
+verifyPass(threw, "threw", __FILE__, __LINE__);
+
+#else
+
+// line 165 "ST_avmplus_json.st"
+verifyPass(true, "true", __FILE__, __LINE__);
+
+#endif
+
+}
+void ST_avmplus_json::test4() {
+
+#if defined AVMSHELL_BUILD && defined VMCFG_EVAL
+
+// A value without escapes shares the input's characters only if it is a
+// large share of the input; a short one is copied so that it does not keep
+// the whole input alive.
+avmshell::ShellCore* c = (avmshell::ShellCore*)core;
+avmshell::ShellToplevel* top = c->shell_toplevel;
+ClassClosure* bag = jsonClass(top, c->user_codeContext, "JSONBag");
+Atom b = parseTyped(top, c->user_codeContext,
+                    "{\"n\": 1, \"short\": \"abcde\", \"long\": \""
+                    "0123456789012345678901234567890123456789012345678901234567890123456789"
+                    "0123456789012345678901234567890123456789012345678901234567890123456789"
+                    "\"}", bag);
+String* shortValue = core->string(getJSONProperty(top, b, "short"));
+String* longValue = core->string(getJSONProperty(top, b, "long"));
+
+// line 187 "ST_avmplus_json.st"
+verifyPass(shortValue->equalsLatin1("abcde"), "shortValue->equalsLatin1(\"abcde\")", __FILE__, __LINE__);
+// line 188 "ST_avmplus_json.st"
+verifyPass(!shortValue->isDependent(), "!shortValue->isDependent()", __FILE__, __LINE__);
+// line 189 "ST_avmplus_json.st"
+verifyPass(longValue->length() == 140, "longValue->length() == 140", __FILE__, __LINE__);
+// line 190 "ST_avmplus_json.st"
+verifyPass(longValue->isDependent(), "longValue->isDependent()", __FILE__, __LINE__);
+
+#else
+
+// line 194 "ST_avmplus_json.st"
+verifyPass(true, "true", __FILE__, __LINE__);
+
+#endif
+
+}
+void create_avmplus_json(AvmCore* core) { new ST_avmplus_json(core); }
+}
+}
+#endif
+
 // Generated from ST_avmplus_peephole.st
 // -*- mode: c; c-basic-offset: 4; indent-tabs-mode: nil; tab-width: 4 -*-
 // vi: set ts=4 sw=4 expandtab: (add to ~/.vimrc: set modeline modelines=5) */
@@ -3332,6 +3960,7 @@ private:
 static const char* ST_names[];
 static const bool ST_explicits[];
 void test0();
+void test1();
 
 private:
     MMgc::GC *gc;
@@ -3408,11 +4037,12 @@ private:
 ST_mmgc_threads::ST_mmgc_threads(AvmCore* core)
     : Selftest(core, "mmgc", "threads", ST_mmgc_threads::ST_names,ST_mmgc_threads::ST_explicits)
 {}
-const char* ST_mmgc_threads::ST_names[] = {"mmgc_gc_root_thread", NULL };
-const bool ST_mmgc_threads::ST_explicits[] = {false, false };
+const char* ST_mmgc_threads::ST_names[] = {"mmgc_gc_root_thread","mmgc_gc_alloc_threads", NULL };
+const bool ST_mmgc_threads::ST_explicits[] = {false,false, false };
 void ST_mmgc_threads::run(int n) {
 switch(n) {
 case 0: test0(); return;
+case 1: test1(); return;
 }
 }
 void ST_mmgc_threads::prologue() {
@@ -3445,6 +4075,54 @@ public:
         bool *isDead;
 };
 
+// Allocate like a worker: with a GC of its own, on a thread of its own, from
+// the heap shared with the other threads.  Keep every fourth object, collect,
+// and count a failure in *arg if the kept objects did not survive intact.
+
+class AllocNode : public GCObject
+{
+public:
+        AllocNode(int key) : key(key) {}
+        GCMember<AllocNode> next;
+        int key;
+};
+
+static const int kAllocThreads = 4;
+static const int kAllocObjects = 50000;
+
+static void* allocRunner(void *arg)
+{
+    volatile int32_t* failures = (volatile int32_t*)arg;
+    MMGC_ENTER_RETURN(NULL);
+    MMgc::GCConfig config;
+    MMgc::GC *threadgc = new MMgc::GC(MMgc::GCHeap::GetGCHeap(), config);
+    {
+        MMGC_GCENTER(threadgc);
+        AllocNode *head = NULL;
+        for ( int i=0 ; i < kAllocObjects ; i++ ) {
+            // Spread the objects over several size classes.
+            AllocNode *node = new (threadgc, size_t((i % 8) * 24)) AllocNode(i);
+            if (i % 4 == 0) {
+                node->next = head;
+                head = node;
+            }
+        }
+        threadgc->Collect();
+        int key = ((kAllocObjects - 1) / 4) * 4;
+        int count = 0;
+        for ( AllocNode *node = head ; node != NULL ; node = node->next ) {
+            if (node->key != key)
+                break;
+            key -= 4;
+            count++;
+        }
+        if (count != (kAllocObjects + 3) / 4)
+            VMPI_atomicIncAndGet32(failures);
+    }
+    delete threadgc;
+    return NULL;
+}
+
 void ST_mmgc_threads::test0() {
        startSlave();
        MMGC_GCENTER(gc);
@@ -3453,22 +4131,33 @@ void ST_mmgc_threads::test0() {
           gc->CreateRootFromCurrentStack(kickAndWait, this);
        }
 
-// line 122 "ST_mmgc_threads.st"
+// line 170 "ST_mmgc_threads.st"
 verifyPass(result, "result", __FILE__, __LINE__);
 
-// line 124 "ST_mmgc_threads.st"
+// line 172 "ST_mmgc_threads.st"
 verifyPass(!isDead, "!isDead", __FILE__, __LINE__);
        gc->ReapZCT();
-// line 126 "ST_mmgc_threads.st"
+// line 174 "ST_mmgc_threads.st"
 verifyPass(!isDead, "!isDead", __FILE__, __LINE__);
        gc->Collect();
-// line 128 "ST_mmgc_threads.st"
+// line 176 "ST_mmgc_threads.st"
 verifyPass(!isDead, "!isDead", __FILE__, __LINE__);
 
        pthread_join(pthread, NULL);
 
        printf("Ignore this: %d\n", *obj->isDead);
 
+}
+void ST_mmgc_threads::test1() {
+       volatile int32_t failures = 0;
+       pthread_t threads[kAllocThreads];
+       for ( int i=0 ; i < kAllocThreads ; i++ )
+           pthread_create(&threads[i], NULL, allocRunner, (void*)&failures);
+       for ( int i=0 ; i < kAllocThreads ; i++ )
+           pthread_join(threads[i], NULL);
+// line 189 "ST_mmgc_threads.st"
+verifyPass(failures == 0, "failures == 0", __FILE__, __LINE__);
+
 }
 void create_mmgc_threads(AvmCore* core) { new ST_mmgc_threads(core); }
 }
@@ -1,39 +1,6 @@
-/* ***** BEGIN LICENSE BLOCK *****
- * Version: MPL 1.1/GPL 2.0/LGPL 2.1
- *
- * The contents of this file are subject to the Mozilla Public License Version
- * 1.1 (the "License"); you may not use this file except in compliance with
- * the License. You may obtain a copy of the License at
- * http://www.mozilla.org/MPL/
- *
- * Software distributed under the License is distributed on an "AS IS" basis,
- * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
- * for the specific language governing rights and limitations under the
- * License.
- *
- * The Original Code is [Open Source Virtual Machine.].
- *
- * The Initial Developer of the Original Code is
- * Adobe System Incorporated.
- * Portions created by the Initial Developer are Copyright (C) 2008
- * the Initial Developer. All Rights Reserved.
- *
- * Contributor(s):
- *   Adobe AS3 Team
- *
- * Alternatively, the contents of this file may be used under the terms of
- * either the GNU General Public License Version 2 or later (the "GPL"), or
- * the GNU Lesser General Public License Version 2.1 or later (the "LGPL"),
- * in which case the provisions of the GPL or the LGPL are applicable instead
- * of those above. If you wish to allow use of your version of this file only
- * under the terms of either the GPL or the LGPL, and not to allow others to
- * use your version of this file under the terms of the MPL, indicate your
- * decision by deleting the provisions above and replace them with the notice
- * and other provisions required by the GPL or the LGPL. If you do not delete
- * the provisions above, a recipient may use your version of this file under
- * the terms of any one of the MPL, the GPL or the LGPL.
- *
- * ***** END LICENSE BLOCK ***** */
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
 // Initialization code for generated selftest code
 #include "avmshell.h"
 namespace avmplus {
@@ -44,6 +11,14 @@ extern void create_avmplus_basics(AvmCore* core);
 namespace ST_avmplus_builtins {
 extern void create_avmplus_builtins(AvmCore* core);
 }
+#if defined VMCFG_NANOJIT
+namespace ST_avmplus_jitprofile {
+extern void create_avmplus_jitprofile(AvmCore* core);
+}
+#endif
+namespace ST_avmplus_json {
+extern void create_avmplus_json(AvmCore* core);
+}
 #if defined AVMPLUS_PEEPHOLE_OPTIMIZER
 namespace ST_avmplus_peephole {
 extern void create_avmplus_peephole(AvmCore* core);
@@ -140,6 +115,10 @@ extern void create_workers_Promise(AvmCore* core);
 void SelftestRunner::createGeneratedSelftestClasses() {
 ST_avmplus_basics::create_avmplus_basics(core);
 ST_avmplus_builtins::create_avmplus_builtins(core);
+#if defined VMCFG_NANOJIT
+ST_avmplus_jitprofile::create_avmplus_jitprofile(core);
+#endif
+ST_avmplus_json::create_avmplus_json(core);
 #if defined AVMPLUS_PEEPHOLE_OPTIMIZER
 ST_avmplus_peephole::create_avmplus_peephole(core);
 #endif
@@ -36,6 +36,8 @@
 #define avmplus_DoubleVectorObject_isExactInterlock 1
 #define avmplus_DynamicPropertyOutputClass_isExactInterlock 1
 #define avmplus_DynamicPropertyOutputObject_isExactInterlock 1
+#define avmplus_DynamicShape_isExactInterlock 1
+#define avmplus_DynamicSlots_isExactInterlock 1
 #define avmplus_E4XNode_isExactInterlock 1
 #define avmplus_E4XNodeAux_isExactInterlock 1
 #define avmplus_ElementE4XNode_isExactInterlock 1
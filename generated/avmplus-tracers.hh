@@ -2603,6 +2603,80 @@ bool DomainEnv::gcTrace(MMgc::GC* gc, size_t _xact_cursor)
 
 
 
+#ifdef DEBUG
+const uint32_t DynamicShape::gcTracePointerOffsets[] = {
+    offsetof(DynamicShape, m_parent),
+    offsetof(DynamicShape, m_transitions),
+    0};
+
+MMgc::GCTracerCheckResult DynamicShape::gcTraceOffsetIsTraced(uint32_t off) const
+{
+    MMgc::GCTracerCheckResult result;
+    (void)off;
+    (void)result;
+    return MMgc::GC::CheckOffsetIsInList(off,gcTracePointerOffsets,2);
+}
+#endif // DEBUG
+
+bool DynamicShape::gcTrace(MMgc::GC* gc, size_t _xact_cursor)
+{
+    if (_xact_cursor == 0) {
+        gc->TraceLocation(&m_parent);
+        gc->TraceLocation(&m_transitions);
+    }
+    const size_t _xact_work_increment = 2000/sizeof(void*);
+    const size_t _xact_work_count = m_count;
+    if (_xact_cursor * _xact_work_increment >= _xact_work_count)
+        return false;
+    size_t _xact_work = _xact_work_increment;
+    bool _xact_more = true;
+    if ((_xact_cursor + 1) * _xact_work_increment >= _xact_work_count)
+    {
+        _xact_work = _xact_work_count - (_xact_cursor * _xact_work_increment);
+        _xact_more = false;
+    }
+    gc->TraceAtoms((m_keys+(_xact_cursor * _xact_work_increment)), _xact_work);
+    return _xact_more;
+}
+
+
+
+#ifdef DEBUG
+const uint32_t DynamicSlots::gcTracePointerOffsets[] = {
+    offsetof(DynamicSlots, m_shape),
+    0};
+
+MMgc::GCTracerCheckResult DynamicSlots::gcTraceOffsetIsTraced(uint32_t off) const
+{
+    MMgc::GCTracerCheckResult result;
+    (void)off;
+    (void)result;
+    return MMgc::GC::CheckOffsetIsInList(off,gcTracePointerOffsets,1);
+}
+#endif // DEBUG
+
+bool DynamicSlots::gcTrace(MMgc::GC* gc, size_t _xact_cursor)
+{
+    if (_xact_cursor == 0) {
+        gc->TraceLocation(&m_shape);
+    }
+    const size_t _xact_work_increment = 2000/sizeof(void*);
+    const size_t _xact_work_count = m_capacity;
+    if (_xact_cursor * _xact_work_increment >= _xact_work_count)
+        return false;
+    size_t _xact_work = _xact_work_increment;
+    bool _xact_more = true;
+    if ((_xact_cursor + 1) * _xact_work_increment >= _xact_work_count)
+    {
+        _xact_work = _xact_work_count - (_xact_cursor * _xact_work_increment);
+        _xact_more = false;
+    }
+    gc->TraceAtoms((m_values+(_xact_cursor * _xact_work_increment)), _xact_work);
+    return _xact_more;
+}
+
+
+
 #ifdef DEBUG
 const uint32_t E4XNode::gcTracePointerOffsets[] = {
     offsetof(E4XNode, m_nameOrAux),
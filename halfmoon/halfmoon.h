@@ -22,6 +22,17 @@ using nanojit::HashMap;
 /// Return true if halfmoon wants to try to compile this method.
 ///
 bool canCompile(MethodInfo*);
+
+/// Return true if a method may go on from baseline code to halfmoon (and
+/// to the profiling tier first, if the profiler is on) under tiered
+/// compilation.
+///
+bool canTierUp(MethodInfo*);
+
+/// Return true if halfmoon compiles from a profile (PROFILER=1), which is
+/// only used to speculate (SPECULATE=1, unfinished); tiered compilation
+/// then goes through the profiling tier to gather it.
+///
 bool isProfilerEnabled();
 
 class JitManager;
@@ -214,8 +214,12 @@ void AbcBuilder::visitBlock(AbcBlock* abc_block) {
   pc_ = NULL;
 }
 
+/// Type speculation needs a way out of the speculative code when a guess
+/// turns out wrong, and that is unfinished: saveState() and
+/// LirEmitter::patchBailouts() are stubs.  So unless SPECULATE is set, for
+/// development, the profile only decides when a method is compiled.
 bool AbcBuilder::shouldSpeculate() {
-  bool speculate = enable_profiler > 0;
+  bool speculate = enable_profiler > 0 && enable_speculate > 0;
   profiler::PROFILING_STATE state =
     JitManager::getProfile(method_)->current_profiler_state_;
 
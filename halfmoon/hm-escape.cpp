@@ -0,0 +1,216 @@
+/* -*- Mode: C++; c-basic-offset: 2; indent-tabs-mode: nil; tab-width: 2 -*- */
+/* vi: set ts=2 sw=2 expandtab: (add to ~/.vimrc: set modeline modelines=5) */
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "hm-main.h"
+#ifdef VMCFG_HALFMOON
+
+namespace halfmoon {
+
+/*
+ * Scalar replacement notes.
+ *
+ * An object from newinstance or newactivation does not escape if the only
+ * things done with it are getslot and setslot with a constant slot number,
+ * all in the block that allocates it.  Then every getslot just reads the
+ * value of the last setslot of the same slot, so we forward that value and
+ * drop the slot accesses from the effect chain; dead code elimination takes
+ * care of the allocation.  Inlining a constructor is what usually exposes
+ * such objects: the constructor's own activation, and the new instance when
+ * the caller only keeps it in locals.
+ *
+ * Two other uses of a new instance are harmless:  loadinitenv only reads the
+ * vtable, and the call to Object's constructor at the end of an inlined
+ * constructor chain does nothing.
+ *
+ * Any other use counts as an escape, including the uses in deopt safepoints
+ * and setlocal.  Rebuilding replaced objects on deopt needs metadata that
+ * hm-deoptimizer.cpp does not have yet.
+ *
+ * todo: follow the values across blocks with phis, so objects used in
+ * loops and on both arms of an if can be replaced too.
+ */
+class ScalarReplacer {
+public:
+  ScalarReplacer(InstrGraph* ir)
+  : ir_(ir)
+  , object_init_(ir->lattice.object_traits->init) {
+  }
+
+  bool pass();
+
+private:
+  Def* allocation(Instr* instr);
+  bool isSlotAccess(const Use& u, BlockStartInstr* block, int* slot_count);
+  bool isObjectInit(const Use& u);
+  bool escapes(Instr* alloc, Def* obj, BlockStartInstr* block, int* slot_count);
+  bool forward(Def* obj, BlockStartInstr* block, Def** slots, bool rewrite);
+  void replace(Instr* alloc, Def* obj);
+
+private:
+  InstrGraph* ir_;
+  MethodInfo* object_init_;
+};
+
+/** Return the new object defined by instr, or 0 if it isn't an allocation */
+Def* ScalarReplacer::allocation(Instr* instr) {
+  switch (kind(instr)) {
+    case HR_newinstance:
+      return cast<UnaryExpr>(instr)->value_out();
+    case HR_newactivation:
+      return cast<UnaryStmt>(instr)->value_out();
+    default:
+      return 0;
+  }
+}
+
+/**
+ * Return true if u is the object operand of a getslot or setslot in block,
+ * with a constant slot number.  Raise *slot_count to cover that slot.
+ */
+bool ScalarReplacer::isSlotAccess(const Use& u, BlockStartInstr* block,
+                                  int* slot_count) {
+  Instr* instr = user(u);
+  if (kind(instr) != HR_getslot && kind(instr) != HR_setslot)
+    return false;
+  CallStmt2* stmt = cast<CallStmt2>(instr);
+  if (&u != &stmt->object_in() || !isConst(type(stmt->param_in())))
+    return false;
+  if (!InstrGraph::isLinked(instr) ||
+      InstrGraph::blockRange(instr).front() != block)
+    return false;
+  int slot = ordinalVal(type(stmt->param_in()));
+  if (slot >= *slot_count)
+    *slot_count = slot + 1;
+  return true;
+}
+
+/**
+ * Return true if u is the receiver of a call to Object's constructor whose
+ * result is unused.  That constructor is empty, so the call can go.
+ */
+bool ScalarReplacer::isObjectInit(const Use& u) {
+  Instr* instr = user(u);
+  if (kind(instr) != HR_callmethod)
+    return false;
+  CallStmt2* call = cast<CallStmt2>(instr);
+  const Type* env_type = type(call->param_in());
+  return &u == &call->object_in() && call->arg_count() == 1 &&
+         isEnv(env_type) && getMethod(env_type) == object_init_ &&
+         UseRange(*call->value_out()).empty();
+}
+
+/**
+ * Return true if anything other than the slot accesses in block and the
+ * harmless uses described above can see obj.
+ */
+bool ScalarReplacer::escapes(Instr* alloc, Def* obj, BlockStartInstr* block,
+                             int* slot_count) {
+  for (UseRange u(*obj); !u.empty(); u.popFront()) {
+    const Use& use = u.front();
+    if (isSlotAccess(use, block, slot_count))
+      continue;
+    if (kind(alloc) != HR_newinstance)
+      return true;
+    Instr* instr = user(use);
+    if (kind(instr) == HR_loadinitenv)
+      continue;
+    if (kind(instr) != HR_scriptobject2atom)
+      return true;
+    Def* atom = cast<UnaryExpr>(instr)->value_out();
+    for (UseRange a(*atom); !a.empty(); a.popFront())
+      if (!isObjectInit(a.front()))
+        return true;
+  }
+  return false;
+}
+
+/**
+ * Walk block in order, tracking the value last stored in each slot of obj.
+ * Return false if some getslot comes before any setslot of its slot, or
+ * would narrow the type of the value stored.  If rewrite is true, forward
+ * the stored values to each getslot and unlink the slot accesses from the
+ * effect chain.
+ */
+bool ScalarReplacer::forward(Def* obj, BlockStartInstr* block, Def** slots,
+                             bool rewrite) {
+  for (InstrRange r(block); !r.empty();) {
+    Instr* instr = r.popFront();
+    if (kind(instr) != HR_getslot && kind(instr) != HR_setslot)
+      continue;
+    CallStmt2* stmt = cast<CallStmt2>(instr);
+    if (def(stmt->object_in()) != obj)
+      continue;
+    int slot = ordinalVal(type(stmt->param_in()));
+    if (kind(instr) == HR_setslot) {
+      slots[slot] = def(stmt->arg(1));
+    } else {
+      Def* value = slots[slot];
+      if (!value || !subtypeof(type(value), type(stmt->value_out())))
+        return false;
+      if (rewrite)
+        copyUses(stmt->value_out(), value);
+    }
+    if (rewrite)
+      copyUses(stmt->effect_out(), def(stmt->effect_in()));
+  }
+  return true;
+}
+
+/**
+ * Remove the remaining effects of the replaced allocation: the activation
+ * itself, or the calls to Object's constructor on the new instance.
+ */
+void ScalarReplacer::replace(Instr* alloc, Def* obj) {
+  if (kind(alloc) == HR_newactivation) {
+    UnaryStmt* stmt = cast<UnaryStmt>(alloc);
+    copyUses(stmt->effect_out(), def(stmt->effect_in()));
+    return;
+  }
+  for (UseRange u(*obj); !u.empty(); u.popFront()) {
+    Instr* instr = user(u.front());
+    if (kind(instr) != HR_scriptobject2atom)
+      continue;
+    Def* atom = cast<UnaryExpr>(instr)->value_out();
+    for (UseRange a(*atom); !a.empty(); a.popFront()) {
+      CallStmt2* call = cast<CallStmt2>(user(a.front()));
+      copyUses(call->effect_out(), def(call->effect_in()));
+    }
+  }
+}
+
+bool ScalarReplacer::pass() {
+  Allocator scratch;
+  bool changed = false;
+  for (EachBlock b(ir_); !b.empty();) {
+    BlockStartInstr* block = b.popFront();
+    for (InstrRange i(block); !i.empty();) {
+      Instr* alloc = i.popFront();
+      Def* obj = allocation(alloc);
+      int slot_count = 0;
+      if (!obj || escapes(alloc, obj, block, &slot_count))
+        continue;
+      Allocator0 scratch0(scratch);
+      Def** slots = new (scratch0) Def*[slot_count + 1];
+      if (!forward(obj, block, slots, false))
+        continue;
+      if (enable_verbose)
+        printf("escape: replace %s d%d\n", name(alloc), defId(obj));
+      VMPI_memset(slots, 0, (slot_count + 1) * sizeof(Def*));
+      forward(obj, block, slots, true);
+      replace(alloc, obj);
+      changed = true;
+    }
+  }
+  return changed;
+}
+
+bool scalarReplace(Context*, InstrGraph* ir) {
+  ScalarReplacer replacer(ir);
+  return replacer.pass();
+}
+
+} // namespace halfmoon
+#endif // VMCFG_HALFMOON
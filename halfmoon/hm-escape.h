@@ -0,0 +1,18 @@
+/* -*- Mode: C++; c-basic-offset: 2; indent-tabs-mode: nil; tab-width: 2 -*- */
+/* vi: set ts=2 sw=2 expandtab: (add to ~/.vimrc: set modeline modelines=5) */
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef HM_ESCAPE_H_
+#define HM_ESCAPE_H_
+
+namespace halfmoon {
+
+/// Replace the slots of objects that never escape the block that allocates
+/// them with the values stored into them.  Returns true if anything changed.
+///
+bool scalarReplace(Context*, InstrGraph*);
+
+} // namespace halfmoon
+#endif // HM_ESCAPE_H_
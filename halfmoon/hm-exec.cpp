@@ -41,117 +41,132 @@ bool BaseExecMgr::verifyOptimizeJit(MethodInfo* m, MethodSignaturep ms,
   return false;
 }
 
+/// The halfmoon code of env's method bailed out to the interpreter: discard
+/// the profile and verify again on the next call.  Under tiered compilation
+/// that yields baseline code, otherwise halfmoon code that does not speculate.
 void BaseExecMgr::resetMethodInvokers(MethodEnv* env) {
-    MethodInfo* method_info = env->method;
-    method_info->_implGPR = verifyEnterGPR;
-    method_info->_invoker = verifyInvoke;
-    env->_implGPR = method_info->_implGPR;
-
-    finish(JitManager::getProfile(method_info));
+  exec(env)->tierStats.bailouts++;
+  reverifyOnCall(env);
+  finish(JitManager::getProfile(env->method));
 }
 
-void BaseExecMgr::verifyProfilingJit(MethodInfo* methodInfo,
-                                     MethodSignaturep methodSignature,
-                                     Toplevel* toplevel, AbcEnv* abc_env) {
-    profiler::ProfileLirEmitter jit(methodInfo, methodSignature, toplevel);
-    verifyCommon(methodInfo, methodSignature, toplevel, abc_env, &jit);
-    GprMethodProc code = jit.emitMD();
-
-    if (code) {
-        setJit(methodInfo, code);
-    } else if (config.jitordie) {
-        AvmAssert(false); // Not sure how to clean up yet
-        jit.~ProfileLirEmitter(); // Explicit cleanup since destructor won't run otherwise.
-    }
+/// Put back the trampolines installed by notifyMethodResolved(), so the
+/// next call verifies and compiles the method again.  MethodEnvs that
+/// have already copied the current code pointer keep running it; that
+/// is safe because code is never freed, just not as fast.
+void BaseExecMgr::reverifyOnCall(MethodEnv* env) {
+  MethodInfo* m = env->method;
+  exec(env)->notifyMethodResolved(m, m->getMethodSignature());
+  env->_implGPR = m->_implGPR;
 }
 
-/// We finished profiling the method, at the next invocation recompile with halfmoon
-/// Still pretty sure we don't have to set all 3 fields to redirect control flow.
-/// What's the diff between env->_implGPR and env->method->implGPR and invoker?
-/// I can't find a clear distinction
-/* static */ void BaseExecMgr::setRecompileWithProfileData(MethodEnv* env)
-{
-    env->_implGPR = (GprMethodProc) jitInvokerWithProfileData;
-    env->method->_implGPR = (GprMethodProc) jitInvokerWithProfileData;
-    env->method->_invoker = jitInvokerWithProfileData;
+bool BaseExecMgr::isTiering() const {
+  return config.tierup_threshold > 0 &&
+         config.runmode == RM_mixed &&  // -Ojit and -Dinterp pick one engine
+         !config.jitordie &&
+         !config.verifyall;
 }
 
-/// We found out a method is hot. At the next invocation, recompile with instrumentation
-/// I'm pretty sure we don't have to set all 3 fields... but I can't find another way
-/* static */ void BaseExecMgr::setRecompileHotMethod(MethodEnv* env)
-{
-    env->_implGPR = (GprMethodProc)jitInvokerProfiler;
-    env->method->_implGPR = (GprMethodProc)jitInvokerProfiler;
-    env->method->_invoker = jitInvokerProfiler;
+/// Called by the baseline code once it has run tierup_threshold times, and
+/// by the profiling code once it has gathered tierprofile_threshold calls
+/// worth of profile (see profiler::incrementMethodInvokeCounter()).
+/* static */ void BaseExecMgr::tierUp(MethodEnv* env) {
+  BaseExecMgr* exec = BaseExecMgr::exec(env);
+  exec->tierStats.tierUps++;
+#ifdef AVMPLUS_VERBOSE
+  if (env->method->pool()->isVerbose(VB_execpolicy))
+    env->core()->console << "execpolicy tier-up " << env->method << "\n";
+#endif
+  reverifyOnCall(env);
 }
 
-/// All the env, env->method, implGPR, invoker stuff is very confusing.
-/// JIT compiled code that calls other JIT compiled code looks up the
-/// method address at runtime based on the env->implGPR.
-/// So we have to overwrite env->implGPR so the correct method is called.
-///
-/// env->method->implGPR is written with the address of the JIT compiled code during
-/// actual compilation. I'm not sure when env->method->implGPR is ever directly loaded
-/// but its the same address as env->implGPR. The "this" object must already be unboxed
-/// into the appropriate script object
-///
-/// env->method->invoker is used when the method is not resolved (late bound).
-/// This also means that the args are a boxed atom array.
-///
-/// The profiler never changes whether or not arguments are boxed/unboxed,
-/// so never overwrite the invoker.
-///
-/// Any sound way to test if the this object is already unboxed?
-///
-/// I think this is the correct order, still slightly unsure / bug testing - Mason
-Atom BaseExecMgr::executeMethod(MethodEnv* env, int argc, Atom* args) {
-    GprMethodProc address = (GprMethodProc) env->method->_implGPR;
-    env->_implGPR = address ;
-
-    MethodInfo* method_info = env->method;
-    Atom this_object = atomKind(args[0]);
-    if (atomKind(this_object) == kUnusedAtomTag) {
-      return env->_implGPR(env, argc, (uint32_t*) args);
+static const char* const tierNames[] = {
+  "none", "baseline", "profiling", "optimized", "final"
+};
+
+/// Compile m for the tier after the one it is in:
+///   none      -> baseline, counting calls, or final if m cannot tier up
+///   baseline  -> profiling, or optimized if halfmoon uses no profile
+///   profiling -> optimized (halfmoon), or final if halfmoon gives up
+///   optimized -> final, after a bailout or deoptimization
+/// Every step but the first verifies the method again.  Halfmoon only reads
+/// the profile to speculate, which is unfinished (see
+/// AbcBuilder::shouldSpeculate()), so unless PROFILER is set the profiling
+/// tier is skipped rather than paid for.
+void BaseExecMgr::verifyTieredJit(MethodInfo* m, MethodSignaturep ms,
+                                  Toplevel* toplevel, AbcEnv* abc_env,
+                                  OSR* osr) {
+  uint64_t start = VMPI_getPerformanceCounter();
+  JitTier tier = JitTier(m->_jitTier);
+  bool compiled = false;
+  switch (tier) {
+  case kTierNone:
+    if (halfmoon::canTierUp(m)) {
+      m->_jitTier = kTierBaseline;
+      m->_abc.countdown = config.tierup_threshold;
     } else {
-      return (method_info->_invoker(env, argc, args));
+      m->_jitTier = kTierFinal;
     }
+    break;
+  case kTierBaseline:
+    if (halfmoon::isProfilerEnabled()) {
+      m->set_abc_exceptions(core->gc, NULL);
+      m->_jitTier = kTierProfiling;
+      compiled = verifyProfilingJit(m, ms, toplevel, abc_env);
+      break;
+    }
+    // fall through
+  case kTierProfiling:
+    m->set_abc_exceptions(core->gc, NULL);
+    m->_jitTier = kTierOptimized;
+    compiled = verifyOptimizeJit(m, ms, toplevel, abc_env, osr);
+    break;
+  default:
+    break;
+  }
+  if (!compiled) {
+    if (tier != kTierNone) {
+      // hack: force exception table to be re-parsed.
+      m->set_abc_exceptions(core->gc, NULL);
+      m->_jitTier = kTierFinal;
+    }
+    verifyBaselineJit(m, ms, toplevel, abc_env, osr);
+  }
+  tierStats.compiles[m->_jitTier]++;
+  tierStats.compileTicks[m->_jitTier] += VMPI_getPerformanceCounter() - start;
+#ifdef AVMPLUS_VERBOSE
+  if (m->pool()->isVerbose(VB_execpolicy))
+    core->console << "execpolicy tier " << tierNames[m->_jitTier] << " " << m << "\n";
+#endif
 }
 
-
-/// We detected a hot method. Recompile the method with profiling instrumentation
-/* static */
-Atom BaseExecMgr::jitInvokerProfiler(MethodEnv* env, int argc, Atom* args)
-{
-    freeJitCompiledCode(env->method);
-    BaseExecMgr *exec = BaseExecMgr::exec(env);
-    exec->verifyProfilingJit(env->method, env->method->getMethodSignature(),
-                             env->toplevel(), env->abcEnv());
-    return executeMethod(env, argc, args);
-}
-
-
-/// We have gathered all the profiling data. Now recompile it with halfmoon
-/// and execute the resulting code.
-/* static */
-Atom BaseExecMgr::jitInvokerWithProfileData(MethodEnv* env, int argc,
-                                            Atom* args)
-{
-    freeJitCompiledCode(env->method);
-    BaseExecMgr *exec = BaseExecMgr::exec(env);
-    OSR* osr = NULL;
-    exec->verifyJit(env->method, env->method->getMethodSignature(),
-                    env->toplevel(), env->abcEnv(), osr);
-    return executeMethod(env, argc, args);
+bool BaseExecMgr::verifyProfilingJit(MethodInfo* methodInfo,
+                                     MethodSignaturep methodSignature,
+                                     Toplevel* toplevel, AbcEnv* abc_env) {
+  // The profile lives in the pool's JitManager; make sure there is one.
+  JitManager::init(methodInfo->pool());
+  JitManager::getProfile(methodInfo)->current_profiler_state_ = profiler::PROFILING;
+  profiler::ProfileLirEmitter jit(methodInfo, methodSignature, toplevel);
+  verifyCommon(methodInfo, methodSignature, toplevel, abc_env, &jit);
+  GprMethodProc code = jit.emitMD();
+  if (code) {
+    setJit(methodInfo, code);
+    return true;
+  }
+  return false;
 }
 
-// Free the memory allocated to the jit compiled code. Means we have to
-// recompile the method.
-// TODO: recursive calls, cannot free memory until we unwind stack.
-void BaseExecMgr::freeJitCompiledCode(MethodInfo* method_info) {
-    PoolObject* pool = method_info->pool();
-    CodeMgr* alloc = pool->codeMgr;
-    //alloc->freeCodeMemory(method_info);
-    (void) alloc;
+void BaseExecMgr::dumpTierStats() {
+  PrintWriter& out = core->console;
+  uint64_t frequency = VMPI_getPerformanceFrequency();
+  for (int tier = kTierBaseline; tier < kTierCount; tier++) {
+    out << "tier " << tierNames[tier]
+        << " compiles=" << tierStats.compiles[tier]
+        << " compile_us=" << uint32_t(tierStats.compileTicks[tier] * 1000000 / frequency)
+        << "\n";
+  }
+  out << "tier-ups=" << tierStats.tierUps
+      << " bailouts=" << tierStats.bailouts << "\n";
 }
 
 // Ideally, we would like to provide a MethodInfo* here,
@@ -179,6 +194,12 @@ void BaseExecMgr::deoptimize(MethodEnv* env)
 
     // release space for code here
 
+    if (isTiering()) {
+        // Back to baseline code, via verifyTieredJit().
+        tierStats.bailouts++;
+        reverifyOnCall(env);
+        return;
+    }
     setInterp(m, ms, OSR::isSupported(env->abcEnv(), m, ms));
 }
 
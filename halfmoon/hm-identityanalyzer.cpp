@@ -64,16 +64,19 @@ Def* IdentityAnalyzer::do_toprimitive(UnaryStmt* instr) {
   return def_;
 }
 
+/// The value may only stand in for the result if it has the same model;
+/// a boxed Number[A] is a Number, but can't feed a double operand.
+///
 Def* IdentityAnalyzer::coerceIdentity(UnaryExpr* instr, const Type* to_type) {
   Def* value_in = def(instr->value_in());
-  if (subtypeof(type(value_in), to_type))
+  if (subtypeof(type(value_in), to_type) && submodelof(type(value_in), to_type))
     return value_in;
   return def_;
 }
 
 Def* IdentityAnalyzer::coerceIdentity(UnaryStmt* instr, const Type* to_type) {
   Def* value_in = def(instr->value_in());
-  if (subtypeof(type(value_in), to_type))
+  if (subtypeof(type(value_in), to_type) && submodelof(type(value_in), to_type))
     return identity(instr, value_in);
   return def_;
 }
@@ -95,6 +98,16 @@ Def* IdentityAnalyzer::do_cknull(UnaryStmt* instr) {
   return def_;
 }
 
+/// tonumber(double2atom(x)) => x, which scalar replacement leaves behind
+/// when a double goes through an untyped slot.
+///
+Def* IdentityAnalyzer::do_tonumber(UnaryStmt* instr) {
+  Def* d2;
+  if (match(instr->value_in(), HR_double2atom, &d2))
+    return identity(instr, d2);
+  return coerceIdentity(instr, lattice_->double_type);
+}
+
 Def* IdentityAnalyzer::do_u2i(UnaryExpr* instr) {
   Def* d2;
   if (match(instr->value_in(), HR_i2u, &d2))
@@ -34,7 +34,7 @@ public: // dispatch() adapter methods.
   Def* do_coerce(BinaryStmt*);
   Def* do_castobject(UnaryExpr* i) { return coerceIdentity(i, lattice_->object_type[kTypeNullable]); }
   Def* do_caststring(UnaryStmt* i) { return coerceIdentity(i, lattice_->string_type[kTypeNullable]); }
-  Def* do_tonumber(UnaryStmt* i) { return coerceIdentity(i, lattice_->double_type); }
+  Def* do_tonumber(UnaryStmt*);
   Def* do_toint(UnaryStmt* i) { return coerceIdentity(i, lattice_->int_type); }
   Def* do_touint(UnaryStmt* i) { return coerceIdentity(i, lattice_->uint_type); }
   Def* do_toboolean(UnaryExpr* i) { return coerceIdentity(i, lattice_->boolean_type); }
@@ -18,6 +18,7 @@ using profiler::MethodProfile;
 int enable_builtins = 1;
 int enable_dvn = 1;
 int enable_deopt = 0;
+int enable_escape = 1;
 int enable_gml = 0;
 int enable_inline = 0;
 int enable_mode = 0;			// disabled by default, use -Dhalfmoon or env var
@@ -25,6 +26,7 @@ int enable_optional = 1;
 int enable_peephole = 0;
 int enable_printir = 0;
 int enable_profiler = 0;
+int enable_speculate = 0;		// see AbcBuilder::shouldSpeculate()
 int enable_selftest = 0;
 int enable_trace = 0;
 int enable_try = 1;
@@ -44,6 +46,7 @@ void init() {
   enable_builtins = parseEnv("BUILTINS", enable_builtins);
   enable_dvn = parseEnv("DVN", enable_dvn);
   enable_deopt = parseEnv("DEOPT", enable_deopt);
+  enable_escape = parseEnv("ESCAPE", enable_escape);
   enable_gml = parseEnv("GML", enable_gml);
   enable_inline = parseEnv("INLINE", enable_inline);
   enable_mode = parseEnv("MODE", enable_mode);
@@ -51,6 +54,7 @@ void init() {
   enable_peephole = parseEnv("PEEPHOLE", enable_peephole);
   enable_printir = parseEnv("PRINTIR", enable_printir);
   enable_profiler = parseEnv("PROFILER", enable_profiler);
+  enable_speculate = parseEnv("SPECULATE", enable_speculate);
   enable_selftest = parseEnv("SELFTEST", enable_selftest);
   enable_trace = parseEnv("TRACE", enable_trace);
   enable_try = parseEnv("TRY", enable_try);
@@ -68,6 +72,7 @@ void init() {
     printf("  BUILTINS  %d  Also look at the builtins\n", enable_builtins);
     printf("  DEOPT     %d  Enable deoptimization support (incomplete)\n", enable_deopt);
     printf("  DVN       %d  Dominator Value Numbering\n", enable_dvn);
+    printf("  ESCAPE    %d  Scalar-replace objects that don't escape\n", enable_escape);
     printf("  GML       %d  Generate GML graph output for yEd\n", enable_gml);
     printf("  INLINE    %d  Enable inlining\n", enable_inline);
     printf("  MODE      %d  Halfmoon mode. 0=none, 1=analyze, 2=interpret,"
@@ -76,6 +81,7 @@ void init() {
     printf("  PEEPHOLE  %d  Enable ABC peephole optimizer\n", enable_peephole);
     printf("  PRINTIR   %d  Print final IR\n", enable_printir);
     printf("  PROFILER  %d  Enable runtime profiling\n", enable_profiler);
+    printf("  SPECULATE %d  Speculate on profiled types (incomplete)\n", enable_speculate);
     printf("  SCHEDULE  %d  Scheduler 0=none, 1=early, 2=late, 3=middle\n", enable_schedule);
     printf("  SELFTEST  %d  Enable self-test\n", enable_selftest);
     printf("  TRACE     %d  Print execution trace\n", enable_trace);
@@ -146,7 +152,8 @@ void AbcRange::read() {
     next += 3 * (imm30b + 1);
 }
 
-bool canCompile(MethodInfo* m) {
+/// The checks of canCompile() that do not depend on the method's profile.
+static bool canAnalyze(MethodInfo* m) {
   init();
 
   if (enable_mode == kModeNone)
@@ -172,6 +179,12 @@ bool canCompile(MethodInfo* m) {
   if (!enable_optional && m->hasOptional()) {
     return false;
   }
+  return true;
+}
+
+bool canCompile(MethodInfo* m) {
+  if (!canAnalyze(m))
+    return false;
 
   if (enable_profiler) {
     MethodProfile* profile = JitManager::getProfile(m);
@@ -182,6 +195,14 @@ bool canCompile(MethodInfo* m) {
   return true;
 }
 
+bool canTierUp(MethodInfo* m) {
+  if (!canAnalyze(m))
+    return false;
+  // The profiling tier handles neither builtins nor exception handlers
+  // (see ProfileLirEmitter::shouldEmitMethodCounters).
+  return !enable_profiler || (!m->pool()->isBuiltin && !m->hasExceptions());
+}
+
 bool isProfilerEnabled() {
   return enable_profiler != 0;
 }
@@ -464,6 +485,10 @@ void optimizePass(Context* cxt, InstrGraph* ir, const char* title) {
       printGraph(cxt, ir, "after-inlining-deadcode");
     }
   }
+  if (enable_escape && scalarReplace(cxt, ir)) {
+    removeDeadCode(cxt, ir);
+    printGraph(cxt, ir, "after-escape");
+  }
   printGraph(cxt, ir, title);
   assert(checkSSA(ir));
 }
@@ -117,6 +117,7 @@ enum BoolKind {
 #include "hm-typeinference.h"
 #include "hm-jitmanager.h"
 #include "hm-valnum.h"
+#include "hm-escape.h"
 
 namespace halfmoon {
 
@@ -212,6 +213,7 @@ extern int enable_mode;       // Which execution mode.
 extern int enable_trace;      // Enable execution trace.
 extern int enable_inline;     // Enable inline optimization.
 extern int enable_profiler;   // Enable runtime profiling
+extern int enable_speculate;  // Speculate on profiled types (needs bailouts)
 extern int enable_typecheck;  // Enable type-check verbosity.
 extern int enable_optional;   // Enable optional argument support.
 
@@ -44,6 +44,7 @@ avmplus_CXXSRCS := $(avmplus_CXXSRCS) \
   $(curdir)/hm-deoptimizer.cpp \
   $(curdir)/hm-bailouts.cpp \
   $(curdir)/hm-dominatortree.cpp \
+  $(curdir)/hm-escape.cpp \
   $(curdir)/hm-exec.cpp \
   $(curdir)/hm-identityanalyzer.cpp \
   $(curdir)/hm-inline.cpp \
@@ -17,6 +17,8 @@ using namespace nanojit;
 
 void recordArgumentTypes(MethodEnv* method_env, int argc, Atom* args) {
   MethodProfile* method_profile = JitManager::getProfile(method_env);
+  if (method_profile->hasBailedOut())
+    return; // The profile was discarded; see BaseExecMgr::resetMethodInvokers().
   int abc_pc = 0; // Because we're at the top of the method
   int output_count = 0;
   ProfiledState* profile_data = method_profile->getProfileState(abc_pc, argc, output_count);
@@ -75,6 +77,8 @@ void recordUnaryInputTypes(MethodEnv* method_env, Atom input) {
 
 void recordBinaryInputTypes(MethodEnv* method_env, Atom left_operand, Atom right_operand, int abc_pc) {
   MethodProfile* method_profile = JitManager::getProfile(method_env);
+  if (method_profile->hasBailedOut())
+    return;
   int input_count = 2;
   int output_count = 1;
   ProfiledState* profiled_state = method_profile->getProfileState(abc_pc, input_count, output_count);
@@ -97,6 +101,8 @@ void recordTernaryInputTypes(MethodEnv* method_env, Atom first_operand, Atom sec
 
 void recordCallInputTypes(MethodEnv* method_env, Atom receiver_object, int argc, Atom* atom_args, Atom result_atom, MethodInfo* loaded_method, int abc_pc) {
   MethodProfile* method_profile = JitManager::getProfile(method_env);
+  if (method_profile->hasBailedOut())
+    return;
   int output_count = 1;
   int input_count = 1 + argc; // + 1 for the receiver object
   ProfiledState* profiled_state = method_profile->getProfileState(abc_pc, input_count, output_count);
@@ -118,44 +124,19 @@ FUNCTION(uintptr_t(profiler::recordCallInputTypes), SIG7(V,P,A,I,P,A,A,I), recor
 FUNCTION(uintptr_t(profiler::recordArgumentTypes), SIG3(V,P,I,P), recordArgumentTypes);
 
 /***
- * CallInfos ONLY for the first JIT compiler phase with light weight
- * profiling instrumentation. Heavy weight profiling CallInfos
- * should be seperate in profiler_jit_calls.h
+ * Called on entry to profiling code under tiered compilation (only used
+ * when PROFILER=1).  Once Config::tierprofile_threshold calls have been
+ * profiled, the method is recompiled with halfmoon.
  */
-bool isHotMethod(int invocation_count) {
-  return invocation_count == 10;
-}
-
-// Only run profiling code for 10 iterations
-bool isRunningProfilingCode(int invocation_count) {
-  return (invocation_count > 10) && (invocation_count < 15);
-}
-
-bool gatheredAllProfilingData(int invocation_count) {
-  return invocation_count > 15;
-}
-
 void incrementMethodInvokeCounter(MethodEnv* method_env) {
   MethodProfile* method_profile = JitManager::getProfile(method_env);
-  int invocation_count = method_profile->method_invocation_count_;
-  method_profile->method_invocation_count_++;
+  if (method_profile->current_profiler_state_ != PROFILING)
+    return; // A MethodEnv still running the profiling code after tier up.
 
-  if (isRunningProfilingCode(invocation_count)) {
-    return;
-  }
-
-  if (gatheredAllProfilingData(invocation_count)) {
-    //AvmAssert(method_profile->current_profiler_state_ == PROFILING);
+  uint32_t threshold = method_env->core()->config.tierprofile_threshold;
+  if (uint32_t(++method_profile->method_invocation_count_) >= threshold) {
     method_profile->current_profiler_state_ = GATHERED;
-    BaseExecMgr::setRecompileWithProfileData(method_env);
-    return;
-  }
-
-  if (isHotMethod(invocation_count) && !method_env->method->isNative()) {
-    AvmAssert(method_profile->current_profiler_state_ == NONE);
-    method_profile->current_profiler_state_ = PROFILING;
-    BaseExecMgr::setRecompileHotMethod(method_env);
-    return;
+    BaseExecMgr::tierUp(method_env);
   }
 }
 FUNCTION(uintptr_t(incrementMethodInvokeCounter), SIG1(V, P), incrementMethodInvokeCounter)
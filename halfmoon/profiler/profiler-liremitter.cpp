@@ -268,10 +268,9 @@ void ProfileLirEmitter::boxArguments(LIns* args) {
 
 void ProfileLirEmitter::writePrologue(const FrameState* state, const uint8_t *pc, CodegenDriver* driver) {
   CodegenLIR::writePrologue(state, pc, driver);
+  // By now CodegenLIR::writePrologue has stored the default values of
+  // missing optional arguments in their locals, so all of them can be boxed.
   const int param_count = ms->param_count();
-  const int optional_count = ms->optional_count();
-  (void) optional_count;
-  assert ((optional_count == 0) && "Don't support optional arguments yet");
 
   if (shouldEmitMethodCounters())
     callIns(FUNCTIONID(incrementMethodInvokeCounter), 1, env_param);
@@ -316,8 +315,7 @@ bool ProfileLirEmitter::shouldEmitMethodCounters() {
     // Means the halfmoon jit failed
     // So just stick with LIR
     !hasBailedOut(methodProfile) &&
-    ms->optional_count() == 0 && // Don't profile methods with optional args
-    !info->hasExceptions();      // or exceptions.
+    !info->hasExceptions();      // Don't profile methods with exceptions.
 }
 
 }
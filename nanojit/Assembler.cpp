@@ -167,6 +167,9 @@ typedef void* (*decode_instructions_ftype) (void* start, void* end,
         , codeList(NULL)
         , _epilogue(NULL)
         , _err(None)
+        , _intervals(NULL)
+        , _nSpills(0)
+        , _nRestores(0)
     #if PEDANTIC
         , pedanticTop(NULL)
     #endif
@@ -689,6 +692,7 @@ typedef void* (*decode_instructions_ftype) (void* start, void* end,
                           if (_logc->lcbits & LC_Native) {
                              setOutputForEOL("  <= spill %s",
                              _thisfrag->lirbuf->printer->formatRef(&b, ins)); } )
+            _nSpills++;
             int8_t nWords = ins->isF4() ? 4 : 
                         ( ins->isQorD() ? 2 : 1 );
 #ifdef NANOJIT_IA32
@@ -761,6 +765,8 @@ typedef void* (*decode_instructions_ftype) (void* start, void* end,
                         setOutputForEOL("  <= restore %s",
                         _thisfrag->lirbuf->printer->formatRef(&b, vic)); } )
         asm_restore(vic, r);
+        if (!RegAlloc::canRemat(vic))
+            _nRestores++;
 
         _allocator.retire(r);
         vic->clearReg();
@@ -1088,8 +1094,24 @@ typedef void* (*decode_instructions_ftype) (void* start, void* end,
                           NanoAssert(frag->profFragID == 0); )
 
         _inExit = false;
-
-        gen(reader);
+        _nSpills = _nRestores = 0;
+
+        if (_config.regalloc_intervals) {
+            Allocator intervalAlloc;
+            LiveIntervals intervals(intervalAlloc);
+            intervals.build(reader->finalIns());
+            _intervals = &intervals;
+            gen(reader);
+            _intervals = NULL;
+        } else {
+            gen(reader);
+        }
+        verbose_only( if (_logc->lcbits & (LC_Native | LC_RegAlloc))
+                          outputf("## %s: %u spills, %u restores",
+                                  _config.regalloc_intervals ? "interval allocator" : "default allocator",
+                                  _nSpills, _nRestores); )
+        PERFM_NVPROF("spills", _nSpills);
+        PERFM_NVPROF("restores", _nRestores);
 
         if (!error()) {
             // patch all branches
@@ -1388,8 +1410,12 @@ typedef void* (*decode_instructions_ftype) (void* start, void* end,
             // Back edge.
             handleLoopCarriedExprs(pending_lives, 0);
             if (!label) {
-                // Evict all registers, most conservative approach.
-                evictAllActiveRegs();
+                // Evict all registers, most conservative approach; with live
+                // intervals we can keep those holding values from before the loop.
+                if (_intervals)
+                    evictLoopVariantRegs(to);
+                else
+                    evictAllActiveRegs();
                 _labels.add(to, 0, _allocator);
             }
             else {
@@ -1440,8 +1466,12 @@ typedef void* (*decode_instructions_ftype) (void* start, void* end,
             // back edge.
             handleLoopCarriedExprs(pending_lives, 0);
             if (!label) {
-                // evict all registers, most conservative approach.
-                evictAllActiveRegs();
+                // evict all registers, most conservative approach; with live
+                // intervals we can keep those holding values from before the loop.
+                if (_intervals)
+                    evictLoopVariantRegs(to);
+                else
+                    evictAllActiveRegs();
                 _labels.add(to, 0, _allocator);
             }
             else {
@@ -1546,6 +1576,11 @@ typedef void* (*decode_instructions_ftype) (void* start, void* end,
         {
             LIns* ins = currIns;        // give it a shorter name for local use
 
+            if (_intervals) {
+                _intervals->reached(ins);
+                _allocator.startIns();
+            }
+
             if (!ins->isLive()) {
                 NanoAssert(!ins->isExtant());
                 continue;
@@ -1903,6 +1938,10 @@ typedef void* (*decode_instructions_ftype) (void* start, void* end,
                 case LIR_subf4:
                 case LIR_mulf4:
                 case LIR_divf4:
+                case LIR_addd2:
+                case LIR_subd2:
+                case LIR_muld2:
+                case LIR_divd2:
                 case LIR_addd:
                 case LIR_subd:
                 case LIR_muld:
@@ -1977,6 +2016,7 @@ typedef void* (*decode_instructions_ftype) (void* start, void* end,
                     break;
 
                 case LIR_f2f4:
+                case LIR_d2d2:
                     countlir_fpu();
                     ins->oprnd1()->setResultLive();
                     if (ins->isExtant()) {
@@ -2000,6 +2040,8 @@ typedef void* (*decode_instructions_ftype) (void* start, void* end,
                 case LIR_f4z:
                 case LIR_f4w:
                 case LIR_swzf4:
+                case LIR_d2x:
+                case LIR_d2y:
                     countlir_fpu();
                     ins->oprnd1()->setResultLive();
                     if (ins->isExtant()) {
@@ -2789,6 +2831,34 @@ typedef void* (*decode_instructions_ftype) (void* start, void* end,
         }
     }
 
+    // Used by the interval allocator in place of evictAllActiveRegs() at a
+    // conditional branch back to 'label', not yet seen.  Loop invariants stay
+    // in their registers, so that the loop header doesn't have to reload them
+    // on every iteration; like loop-carried values they must have a stack
+    // slot for the whole loop, in case they are evicted somewhere inside it.
+    // Everything else, including values only used after the loop, is evicted.
+    void Assembler::evictLoopVariantRegs(LIns* label)
+    {
+        NanoAssert(_intervals);
+        RegisterMask active = _allocator.activeMask();
+        for (Register r = lsReg(active); active; r = nextLsReg(active, r)) {
+            LIns* ins = _allocator.getActive(r);
+            Register r1 = ins->getReg();
+            NanoAssert( (rmask(r) & rmask(r1)) == rmask(r) );
+            r = r1;
+#ifdef NANOJIT_IA32
+            if (r != FST0 && _intervals->isLoopInvariant(ins, label)) {
+#else
+            if (_intervals->isLoopInvariant(ins, label)) {
+#endif
+                if (!RegAlloc::canRemat(ins))
+                    findMemFor(ins);
+            } else {
+                evict(ins);
+            }
+        }
+    }
+
     /**
      * Merge the current regstate with a previously stored version.
      *
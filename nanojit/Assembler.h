@@ -358,6 +358,7 @@ namespace nanojit
                 evictSomeActiveRegs(~RegisterMask(0));
             }
             void        evictSomeActiveRegs(RegisterMask regs);
+            void        evictLoopVariantRegs(LIns* label);
             void        evictScratchRegsExcept(RegisterMask ignore);
             void        intersectRegisterState(RegAlloc& saved);
             void        unionRegisterState(RegAlloc& saved);
@@ -450,6 +451,9 @@ namespace nanojit
 
             AR          _activation;
             RegAlloc    _allocator;
+            LiveIntervals* _intervals;      // set during assemble() if config.regalloc_intervals
+            uint32_t    _nSpills;           // spills and restores generated by assemble()
+            uint32_t    _nRestores;
 
             MetaDataWriter* _mdWriter;
 
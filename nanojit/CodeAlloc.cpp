@@ -29,12 +29,12 @@ namespace nanojit
     // Sanity checks that should remain enabled in release builds.
     #define ABORT_UNLESS(cond) do { NanoAssert(cond); if (!(cond)) VMPI_abort(); } while(0)
 
-    CodeAlloc::CodeAlloc(const Config* config)
+    CodeAlloc::CodeAlloc(const Config* config, int pagesPerChunk)
         : heapblocks(0)
         , availblocks(0)
         , totalAllocated(0)
         , bytesPerPage(VMPI_getVMPageSize())
-        , bytesPerAlloc(pagesPerAlloc * bytesPerPage)
+        , bytesPerAlloc((pagesPerChunk > 0 ? pagesPerChunk : pagesPerAlloc) * bytesPerPage)
         , _config(config)
     {
     }
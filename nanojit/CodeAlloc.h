@@ -159,7 +159,8 @@ namespace nanojit
         bool checkChunkMark(void* addr, size_t nbytes, bool isExec);
 
     public:
-        CodeAlloc(const Config* config);
+        /** pagesPerChunk overrides the platform default chunk size when nonzero */
+        CodeAlloc(const Config* config, int pagesPerChunk = 0);
         ~CodeAlloc();
 
         /** return all the memory allocated through this allocator to the gcheap. */
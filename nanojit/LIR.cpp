@@ -1804,6 +1804,2582 @@ namespace nanojit
         }
     }
 
+    // GlobalOpt.  The fragment is read into an array; a position is an
+    // instruction's index in it.  Positions of the rewritten fragment are
+    // doubled so that instructions moved in front of position p can be
+    // ordered before it: they are at 2p, the instruction itself at 2p+1.
+
+    struct GlobalOpt::Block
+    {
+        int32_t first, last;        // positions of the first and last instructions
+        int32_t* succ;
+        int32_t nsucc;
+        int32_t* pred;
+        int32_t npred;
+        int32_t rpo;                // reverse postorder number, -1 if unreachable
+        int32_t idom;               // immediate dominator
+        int32_t pre, post;          // dominator tree numbering
+        int32_t loop;               // innermost loop containing the block, -1 if none
+        AccSet stores;              // what stores may write, except...
+        AccSet allocStores;         // ... stores straight into an alloc, which write this
+        int32_t nallocStores;       // number of stores straight into an alloc
+        AccSet calls;               // what impure calls may write
+        bool fence;                 // the block has a LIR_memfence
+    };
+
+    struct GlobalOpt::Loop
+    {
+        int32_t header;
+        int32_t parent;             // innermost enclosing loop, -1 if none
+        int32_t size;               // number of blocks in the body
+        int32_t first;              // lowest position in the body
+        int32_t point;              // invariants are emitted before this position, -1 if none
+        int32_t entry;              // the block 'point' is in
+        AccSet stores;
+        AccSet allocStores;
+        int32_t* allocStore;        // positions of the stores straight into an alloc
+        int32_t nallocStores;
+        AccSet calls;
+        bool fence;
+        BitSet* body;
+    };
+
+    // Big fragments are mostly straight-line initialization code that has
+    // little to gain, so don't spend time on them.
+    static const int32_t GLOBALOPT_MAX_INS = 100000;
+
+    // Limits on the search for facts that make a bounds check redundant: how
+    // many blocks to walk back, how deep to recurse into operands, and how
+    // many steps to take for the whole fragment.
+    static const int32_t GLOBALOPT_MAX_PATH = 16;
+    static const int32_t GLOBALOPT_MAX_DEPTH = 6;
+    static const int32_t GLOBALOPT_CHECK_BUDGET = 20000;
+
+    // A chain of blocks, each entered only from the next one, so there is a
+    // single way through it to block[0].
+    struct GlobalOpt::Path
+    {
+        int32_t block[GLOBALOPT_MAX_PATH];
+        int32_t n;
+    };
+
+    GlobalOpt::GlobalOpt(Allocator& alloc, const Config& config)
+        : alloc(alloc), config(config), index(NULL), n(0), ins(NULL), deadBlock(NULL),
+          assumedSlot(NULL), nassumed(0), slotStores(NULL), nslotStores(0), budget(0),
+          out(NULL), blocks(NULL), nblocks(0), loops(NULL), nloops(0), changed(false)
+    {}
+
+    int32_t GlobalOpt::posOf(LIns* i)
+    {
+        return i ? int32_t(index->get(i)) - 1 : -1;
+    }
+
+    LIns* GlobalOpt::remap(LIns* i)
+    {
+        int32_t p = out ? posOf(i) : -1;
+        return p >= 0 ? out[rep[p]] : i;
+    }
+
+    uint32_t valueOperands(LIns* i, LIns** opnds)
+    {
+        switch (repKinds[i->opcode()]) {
+        case LRK_Op1:
+            if (i->isop(LIR_comment))
+                return 0;
+            // fall through
+        case LRK_Op1b:
+        case LRK_Ld:
+        case LRK_Jtbl:
+            opnds[0] = i->oprnd1();
+            return 1;
+        case LRK_Op2:
+            if (i->isop(LIR_j))
+                return 0;
+            opnds[0] = i->oprnd1();
+            if (i->isBranch())
+                return 1;
+            opnds[1] = i->oprnd2();
+            return 2;
+        case LRK_Op3:
+            opnds[0] = i->oprnd1();
+            opnds[1] = i->oprnd2();
+            if (i->isJov())
+                return 2;
+            opnds[2] = i->oprnd3();
+            return 3;
+        case LRK_Op4:
+            opnds[0] = i->oprnd1();
+            opnds[1] = i->oprnd2();
+            opnds[2] = i->oprnd3();
+            opnds[3] = i->oprnd4();
+            return 4;
+        case LRK_St:
+            opnds[0] = i->oprnd1();
+            opnds[1] = i->oprnd2();
+            return 2;
+        case LRK_C: {
+            uint32_t argc = i->argc();
+            for (uint32_t k = 0; k < argc; k++)
+                opnds[k] = i->arg(k);
+            return argc;
+        }
+        default:
+            return 0;
+        }
+    }
+
+    // Does 'i' end a basic block?  A LIR_brsavpc doesn't: its target runs
+    // the interrupt handler between a LIR_pushstate and a LIR_popstate and
+    // returns right after the branch with LIR_restorepc.  The handler itself
+    // is left out of the flow graph.  It only returns after polling for a
+    // safepoint, and what other threads change at a safepoint is read with
+    // volatile loads, so like CseFilter we take the branch to write nothing.
+    static bool endsBlock(LIns* i)
+    {
+        return (i->isBranch() && !i->isop(LIR_brsavpc)) || i->isRet() || i->isop(LIR_restorepc);
+    }
+
+    // The number of bytes a load or store accesses.
+    static int32_t accessSize(LOpcode op)
+    {
+        switch (op) {
+        case LIR_ldc2i:
+        case LIR_lduc2ui:
+        case LIR_sti2c:
+            return 1;
+        case LIR_lds2i:
+        case LIR_ldus2ui:
+        case LIR_sti2s:
+            return 2;
+        case LIR_ldi:
+        case LIR_ldf:
+        case LIR_ldf2d:
+        case LIR_sti:
+        case LIR_stf:
+        case LIR_std2f:
+            return 4;
+        case LIR_ldf4:
+        case LIR_stf4:
+            return 16;
+        default:
+            return 8;
+        }
+    }
+
+    // Can 'i' be replaced by an equal instruction computed earlier?
+    static bool isNumbered(LIns* i)
+    {
+        if (i->isImmAny())
+            return true;
+        if (i->isLoad())
+            return i->loadQual() == LOAD_CONST;
+        if (i->isCall())
+            return i->callInfo()->_isPure;
+        switch (i->opcode()) {
+        CASE86(LIR_divi:)
+        CASE86(LIR_modi:)
+        CASESF(LIR_hcalli:)
+            // divi and modi come in pairs; hcalli must follow its call.
+            return false;
+        default:
+            return isCseOpcode(i->opcode()) && !i->isJov();
+        }
+    }
+
+    // Can 'i' be computed before the loop containing it, provided its
+    // operands are available there?
+    static bool isMovable(LIns* i)
+    {
+        return i->isLoad() || (isNumbered(i) && !i->isCall());
+    }
+
+    bool GlobalOpt::run(Fragment* frag, Allocator& lirAlloc)
+    {
+#if NJ_SOFTFLOAT_SUPPORTED
+        if (config.soft_float)
+            return false;
+#endif
+        // Count the instructions, rejecting fragments with ones we don't handle.
+        LirReader counter(frag->lastIns);
+        for (LIns* i = counter.read(); ; i = counter.read()) {
+            switch (i->opcode()) {
+            case LIR_x:
+            case LIR_xt:
+            case LIR_xf:
+            case LIR_xbarrier:
+            case LIR_addxovi:
+            case LIR_subxovi:
+            case LIR_mulxovi:
+            case LIR_safe:
+            case LIR_endsafe:
+                return false;
+            default:
+                break;
+            }
+            if (++n > GLOBALOPT_MAX_INS)
+                return false;
+            if (i->isop(LIR_start))
+                break;
+        }
+
+        ins = new (alloc) LIns*[n];
+        index = new (alloc) HashMap<LIns*, int32_t>(alloc, n);
+        LirReader reader(frag->lastIns);
+        for (int32_t p = n - 1; p >= 0; p--) {
+            ins[p] = reader.read();
+            index->put(ins[p], p + 1);
+        }
+
+        if (!plan() || !changed)
+            return false;
+
+        LirBuffer* oldbuf = frag->lirbuf;
+        LirBuffer* buf = new (lirAlloc) LirBuffer(lirAlloc);
+        buf->abi = oldbuf->abi;
+        verbose_only( buf->printer = oldbuf->printer; )
+        LirBufWriter w(buf, config);
+
+        // Forward branches are patched when their label is emitted.
+        int32_t* patchHead = new (alloc) int32_t[n];
+        int32_t* patchNext = new (alloc) int32_t[n];
+        int32_t* patchSlot = new (alloc) int32_t[n];
+        LIns** patchIns = new (alloc) LIns*[n];
+        int32_t npatches = 0;
+        int32_t capPatches = n;
+        for (int32_t p = 0; p < n; p++)
+            patchHead[p] = -1;
+
+        out = new (alloc) LIns*[n];
+        VMPI_memset(out, 0, n * sizeof(LIns*));
+        LIns* last = NULL;
+        for (int32_t p = 0; p < n; p++) {
+            for (int32_t h = hoistHead[p]; h >= 0; h = hoistNext[h])
+                out[h] = last = emit(w, h);
+            if (rep[p] != p || hoistTo[p] >= 0)
+                continue;
+
+            LIns* i = ins[p];
+            out[p] = last = emit(w, p);
+            if (i->isop(LIR_label)) {
+                for (int32_t f = patchHead[p]; f >= 0; f = patchNext[f]) {
+                    if (patchSlot[f] < 0)
+                        patchIns[f]->setTarget(last);
+                    else
+                        patchIns[f]->setTarget(uint32_t(patchSlot[f]), last);
+                }
+            } else if (i->isBranch()) {
+                uint32_t size = i->isop(LIR_jtbl) ? i->getTableSize() : 1;
+                for (uint32_t k = 0; k < size; k++) {
+                    int32_t t = i->isop(LIR_jtbl) ? posOf(i->getTarget(k)) : target[p];
+                    int32_t slot = i->isop(LIR_jtbl) ? int32_t(k) : -1;
+                    if (t < p) {
+                        if (slot < 0)
+                            last->setTarget(out[t]);
+                        else
+                            last->setTarget(k, out[t]);
+                        continue;
+                    }
+                    if (npatches == capPatches) {
+                        int32_t cap = capPatches * 2;
+                        int32_t* nextGrown = new (alloc) int32_t[cap];
+                        int32_t* slotGrown = new (alloc) int32_t[cap];
+                        LIns** insGrown = new (alloc) LIns*[cap];
+                        VMPI_memcpy(nextGrown, patchNext, npatches * sizeof(int32_t));
+                        VMPI_memcpy(slotGrown, patchSlot, npatches * sizeof(int32_t));
+                        VMPI_memcpy(insGrown, patchIns, npatches * sizeof(LIns*));
+                        patchNext = nextGrown;
+                        patchSlot = slotGrown;
+                        patchIns = insGrown;
+                        capPatches = cap;
+                    }
+                    patchIns[npatches] = last;
+                    patchSlot[npatches] = slot;
+                    patchNext[npatches] = patchHead[t];
+                    patchHead[t] = npatches++;
+                }
+            }
+            for (int32_t v = liveHead[p]; v >= 0; v = liveNext[v]) {
+                LOpcode op;
+                switch (ins[v]->retType()) {
+                case LTy_I:  op = LIR_livei;  break;
+#ifdef NANOJIT_64BIT
+                case LTy_Q:  op = LIR_liveq;  break;
+#endif
+                case LTy_D:  op = LIR_lived;  break;
+                case LTy_F:  op = LIR_livef;  break;
+                case LTy_F4: op = LIR_livef4; break;
+                default:     NanoAssert(!"bad live type"); op = LIR_livei; break;
+                }
+                last = w.ins1(op, out[v]);
+            }
+        }
+
+        buf->state = remap(oldbuf->state);
+        buf->param1 = remap(oldbuf->param1);
+        buf->sp = remap(oldbuf->sp);
+        buf->rp = remap(oldbuf->rp);
+        frag->lirbuf = buf;
+        frag->lastIns = last;
+        return true;
+    }
+
+    // The alloc a load or store addresses directly, or -1.
+    int32_t GlobalOpt::allocBase(int32_t p)
+    {
+        int32_t base = ops[opStart[p] + (ins[p]->isStore() ? 1 : 0)];
+        return ins[base]->isop(LIR_allocp) ? base : -1;
+    }
+
+    LIns* GlobalOpt::opnd(int32_t p, int32_t k)
+    {
+        return out[rep[ops[opStart[p] + k]]];
+    }
+
+    // Writes a copy of 'i' whose value operands, in the order
+    // valueOperands() gives them, are 'a'.  Branch targets are left unset.
+    static LIns* copyIns(LirWriter& w, LIns* i, LIns** a)
+    {
+        LOpcode op = i->opcode();
+        switch (repKinds[op]) {
+        case LRK_Op0:
+            return w.ins0(op);
+        case LRK_Op1:
+            // A comment's operand is its text.
+            return w.ins1(op, op == LIR_comment ? i->oprnd1() : a[0]);
+        case LRK_Op1b:
+            return w.insSwz(a[0], i->mask());
+        case LRK_Op2:
+            if (i->isBranch())
+                return w.insBranch(op, op == LIR_j ? NULL : a[0], NULL);
+            return w.ins2(op, a[0], a[1]);
+        case LRK_Op3:
+            if (i->isJov())
+                return w.insBranchJov(op, a[0], a[1], NULL);
+            return w.ins3(op, a[0], a[1], a[2]);
+        case LRK_Op4:
+            return w.ins4(op, a[0], a[1], a[2], a[3]);
+        case LRK_Ld:
+            return w.insLoad(op, a[0], i->disp(), i->accSet(), i->loadQual());
+        case LRK_St:
+            return w.insStore(op, a[0], a[1], i->disp(), i->accSet());
+        case LRK_C:
+            return w.insCall(i->callInfo(), a);
+        case LRK_P:
+            return w.insParam(i->paramArg(), i->paramKind());
+        case LRK_IorF:
+            if (op == LIR_allocp)
+                return w.insAlloc(i->size());
+            if (op == LIR_immf)
+                return w.insImmF(i->immF());
+            return w.insImmI(i->immI());
+        case LRK_QorD:
+#ifdef NANOJIT_64BIT
+            if (op == LIR_immq)
+                return w.insImmQ(i->immQ());
+#endif
+            return w.insImmD(i->immD());
+        case LRK_F4:
+            return w.insImmF4(i->immF4());
+        case LRK_Jtbl:
+            return w.insJtbl(a[0], i->getTableSize());
+        default:
+            NanoAssert(!"GlobalOpt: unexpected instruction");
+            return NULL;
+        }
+    }
+
+    LIns* GlobalOpt::emit(LirBufWriter& w, int32_t p)
+    {
+        LIns* a[MAXARGS];
+        for (int32_t k = opStart[p]; k < opStart[p+1]; k++)
+            a[k - opStart[p]] = opnd(p, k - opStart[p]);
+        return copyIns(w, ins[p], a);
+    }
+
+    bool GlobalOpt::plan()
+    {
+        if (!readOperands())
+            return false;
+        buildBlocks();
+        computeDominators();
+#if NJ_F2I_SUPPORTED
+        if (config.narrow_counters) {
+            findLoops();
+            if (nloops > 0 && narrowLoops()) {
+                readOperands();
+                buildBlocks();
+                computeDominators();
+            }
+        }
+#endif
+        if (eliminateChecks()) {
+            // Start over on what is left; it can only be simpler.
+            readOperands();
+            buildBlocks();
+            computeDominators();
+        }
+        findLoops();
+#if NJ_PACKED_DOUBLE_SUPPORTED
+        if (config.vectorize && nloops > 0 && vectorizeLoops()) {
+            readOperands();
+            buildBlocks();
+            computeDominators();
+            findLoops();
+        }
+#endif
+        numberValues();
+        if (changed)
+            extendLiveRanges();
+        return true;
+    }
+
+    // Operands and branch targets, as positions.
+    bool GlobalOpt::readOperands()
+    {
+        opStart = new (alloc) int32_t[n + 1];
+        target = new (alloc) int32_t[n];
+        escaped = new (alloc) BitSet(alloc, n);
+        LIns* opnds[MAXARGS];
+        int32_t nops = 0;
+        for (int32_t p = 0; p < n; p++) {
+            opStart[p] = nops;
+            nops += valueOperands(ins[p], opnds);
+        }
+        opStart[n] = nops;
+        ops = new (alloc) int32_t[nops > 0 ? nops : 1];
+        for (int32_t p = 0; p < n; p++) {
+            LIns* i = ins[p];
+            uint32_t count = valueOperands(i, opnds);
+            for (uint32_t k = 0; k < count; k++) {
+                int32_t o = posOf(opnds[k]);
+                if (o < 0 || o >= p)
+                    return false;
+                ops[opStart[p] + k] = o;
+            }
+            for (uint32_t k = 0; k < count; k++) {
+                // Other than as the base of a load or store, any use of an
+                // alloc may pass its address on.
+                int32_t o = ops[opStart[p] + k];
+                if (ins[o]->isop(LIR_allocp) && !i->isLive() &&
+                    !(i->isLoad() && k == 0) && !(i->isStore() && k == 1))
+                    escaped->set(o);
+            }
+            target[p] = -1;
+            if (i->isBranch()) {
+                if (i->isop(LIR_jtbl)) {
+                    for (uint32_t k = 0, size = i->getTableSize(); k < size; k++) {
+                        if (posOf(i->getTarget(k)) < 0)
+                            return false;
+                    }
+                } else {
+                    target[p] = posOf(i->getTarget());
+                    if (target[p] < 0)
+                        return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    void GlobalOpt::buildBlocks()
+    {
+        blockOf = new (alloc) int32_t[n];
+        nblocks = 0;
+        for (int32_t p = 0; p < n; p++) {
+            if (p == 0 || ins[p]->isop(LIR_label) || endsBlock(ins[p-1]))
+                nblocks++;
+            blockOf[p] = nblocks - 1;
+        }
+        blocks = new (alloc) Block[nblocks];
+        for (int32_t b = 0; b < nblocks; b++) {
+            Block& bb = blocks[b];
+            bb.first = -1;
+            bb.nsucc = bb.npred = 0;
+            bb.rpo = bb.idom = bb.pre = bb.post = bb.loop = -1;
+            bb.stores = bb.allocStores = bb.calls = ACCSET_NONE;
+            bb.nallocStores = 0;
+            bb.fence = false;
+        }
+        for (int32_t p = 0; p < n; p++) {
+            LIns* i = ins[p];
+            Block& bb = blocks[blockOf[p]];
+            if (bb.first < 0)
+                bb.first = p;
+            bb.last = p;
+            if (i->isStore() && allocBase(p) >= 0) {
+                bb.allocStores |= i->accSet();
+                bb.nallocStores++;
+            } else if (i->isStore())
+                bb.stores |= i->accSet();
+            else if (i->isCall() && !i->callInfo()->_isPure)
+                bb.calls |= i->callInfo()->_storeAccSet;
+            else if (i->isop(LIR_memfence))
+                bb.fence = true;
+        }
+
+        // Successors, then predecessors.
+        for (int32_t b = 0; b < nblocks; b++) {
+            Block& bb = blocks[b];
+            LIns* i = ins[bb.last];
+            bool hasNext = b + 1 < nblocks;
+            if (i->isop(LIR_jtbl)) {
+                bb.nsucc = int32_t(i->getTableSize());
+                bb.succ = new (alloc) int32_t[bb.nsucc > 0 ? bb.nsucc : 1];
+                for (int32_t k = 0; k < bb.nsucc; k++)
+                    bb.succ[k] = blockOf[posOf(i->getTarget(uint32_t(k)))];
+            } else {
+                bb.succ = new (alloc) int32_t[2];
+                if (i->isBranch() && !i->isop(LIR_brsavpc))
+                    bb.succ[bb.nsucc++] = blockOf[target[bb.last]];
+                if (hasNext && !i->isRet() && !i->isop(LIR_restorepc) && !i->isUnConditionalBranch())
+                    bb.succ[bb.nsucc++] = b + 1;
+            }
+            for (int32_t k = 0; k < bb.nsucc; k++)
+                blocks[bb.succ[k]].npred++;
+        }
+        for (int32_t b = 0; b < nblocks; b++) {
+            blocks[b].pred = new (alloc) int32_t[blocks[b].npred > 0 ? blocks[b].npred : 1];
+            blocks[b].npred = 0;
+        }
+        for (int32_t b = 0; b < nblocks; b++) {
+            for (int32_t k = 0; k < blocks[b].nsucc; k++) {
+                Block& s = blocks[blocks[b].succ[k]];
+                s.pred[s.npred++] = b;
+            }
+        }
+    }
+
+    bool GlobalOpt::dominates(int32_t a, int32_t b)
+    {
+        return blocks[a].rpo >= 0 && blocks[b].rpo >= 0 &&
+               blocks[a].pre <= blocks[b].pre && blocks[b].post <= blocks[a].post;
+    }
+
+    // Dominators are computed with the algorithm of Cooper, Harvey and
+    // Kennedy, "A Simple, Fast Dominance Algorithm".
+    void GlobalOpt::computeDominators()
+    {
+        int32_t* stack = new (alloc) int32_t[nblocks];
+        int32_t* edge = new (alloc) int32_t[nblocks];
+        int32_t* postorder = new (alloc) int32_t[nblocks];
+        int32_t npost = 0;
+        int32_t sp = 0;
+
+        // Depth-first search from the entry.  Unreachable blocks keep rpo -1.
+        stack[sp] = 0;
+        edge[sp++] = 0;
+        blocks[0].rpo = 0;
+        while (sp > 0) {
+            Block& bb = blocks[stack[sp-1]];
+            if (edge[sp-1] < bb.nsucc) {
+                int32_t s = bb.succ[edge[sp-1]++];
+                if (blocks[s].rpo < 0) {
+                    blocks[s].rpo = 0;
+                    stack[sp] = s;
+                    edge[sp++] = 0;
+                }
+            } else {
+                postorder[npost++] = stack[--sp];
+            }
+        }
+        rpo = new (alloc) int32_t[npost];
+        nrpo = npost;
+        for (int32_t k = 0; k < npost; k++) {
+            rpo[k] = postorder[npost - 1 - k];
+            blocks[rpo[k]].rpo = k;
+        }
+
+        blocks[0].idom = 0;
+        for (bool again = true; again; ) {
+            again = false;
+            for (int32_t k = 1; k < nrpo; k++) {
+                Block& bb = blocks[rpo[k]];
+                int32_t idom = -1;
+                for (int32_t j = 0; j < bb.npred; j++) {
+                    int32_t p = bb.pred[j];
+                    if (blocks[p].rpo < 0 || blocks[p].idom < 0)
+                        continue;
+                    if (idom < 0) {
+                        idom = p;
+                        continue;
+                    }
+                    int32_t a = p;
+                    while (a != idom) {
+                        while (blocks[a].rpo > blocks[idom].rpo)
+                            a = blocks[a].idom;
+                        while (blocks[idom].rpo > blocks[a].rpo)
+                            idom = blocks[idom].idom;
+                    }
+                }
+                if (bb.idom != idom) {
+                    bb.idom = idom;
+                    again = true;
+                }
+            }
+        }
+
+        // Number the dominator tree so that dominance is two comparisons.
+        // Children are chained through 'edge' (first child) and 'postorder'
+        // (next sibling).
+        for (int32_t b = 0; b < nblocks; b++)
+            edge[b] = postorder[b] = -1;
+        for (int32_t k = nrpo - 1; k > 0; k--) {
+            int32_t b = rpo[k];
+            postorder[b] = edge[blocks[b].idom];
+            edge[blocks[b].idom] = b;
+        }
+        int32_t counter = 0;
+        sp = 0;
+        stack[sp++] = 0;
+        blocks[0].pre = counter++;
+        while (sp > 0) {
+            int32_t b = stack[sp-1];
+            int32_t c = edge[b];
+            if (c >= 0) {
+                edge[b] = postorder[c];
+                blocks[c].pre = counter++;
+                stack[sp++] = c;
+            } else {
+                blocks[b].post = counter++;
+                sp--;
+            }
+        }
+    }
+
+    // Bounds checks.  CodegenLIR checks a Vector index like this:
+    //
+    //      jf geui(index, length) -> ok
+    //      call a helper that throws
+    //      ok:
+    //
+    // The check is redundant if a branch on the only way in has already
+    // found index < length, and index can't be negative; the branch and the
+    // helper call are then dropped.  The facts come from the conditional
+    // branches ending a Path that leads to the check.  Loads on it give the
+    // same value if nothing that runs between them can write what they read.
+    // A value is known to be non-negative if it is a non-negative constant,
+    // an int loaded from an alloc that is only ever given non-negative
+    // values, or one more than a non-negative value that was found to be
+    // less than some int (so the add can't overflow).  That covers loops
+    // such as
+    //
+    //      for (var i:int = 0; i < v.length; i++) ... v[i] ...
+    //
+    // where CodegenLIR compares against the length as a signed int.
+    //
+    // All checks are first assumed to pass, with their helper calls left
+    // out of the flow graph, and those that can't be proved are put back
+    // until the rest prove each other.  That is sound by induction on the
+    // execution: what holds at a point is only concluded from what ran
+    // before it, when none of the remaining checks had failed yet.
+    bool GlobalOpt::eliminateChecks()
+    {
+        // A value used after the helper call's block would need it.
+        int32_t* lastUser = new (alloc) int32_t[n];
+        int32_t* uses = new (alloc) int32_t[n];
+        for (int32_t p = 0; p < n; p++) {
+            lastUser[p] = -1;
+            uses[p] = 0;
+        }
+        nslotStores = 0;
+        for (int32_t p = 0; p < n; p++) {
+            for (int32_t k = opStart[p]; k < opStart[p+1]; k++) {
+                lastUser[ops[k]] = p;
+                uses[ops[k]]++;
+            }
+            if (ins[p]->isStore() && allocBase(p) >= 0)
+                nslotStores++;
+        }
+        slotStores = new (alloc) int32_t[nslotStores > 0 ? nslotStores : 1];
+        nslotStores = 0;
+        for (int32_t p = 0; p < n; p++) {
+            if (ins[p]->isStore() && allocBase(p) >= 0)
+                slotStores[nslotStores++] = p;
+        }
+
+        int32_t* check = new (alloc) int32_t[nblocks];
+        int32_t nchecks = 0;
+        deadBlock = new (alloc) BitSet(alloc, nblocks);
+        for (int32_t c = 0; c + 1 < n; c++) {
+            if (!ins[c]->isop(LIR_jf) || !ins[ops[opStart[c]]]->isop(LIR_geui) ||
+                blocks[blockOf[c]].rpo < 0)
+                continue;
+            // The helper call must be alone in a block that only the check
+            // enters, and that goes on to the check's target or jumps.
+            Block& fail = blocks[blockOf[c+1]];
+            LIns* last = ins[fail.last];
+            if (fail.first != c + 1 || fail.last + 1 != target[c] || fail.npred != 1 ||
+                (endsBlock(last) && !last->isop(LIR_j)))
+                continue;
+            bool used = false;
+            for (int32_t p = fail.first; p <= fail.last && !used; p++)
+                used = lastUser[p] > fail.last;
+            if (used)
+                continue;
+            check[nchecks++] = c;
+            deadBlock->set(blockOf[c+1]);
+        }
+        if (nchecks == 0)
+            return false;
+
+        assumedSlot = new (alloc) int32_t[2 * (GLOBALOPT_MAX_DEPTH + 1)];
+        budget = GLOBALOPT_CHECK_BUDGET;
+        for (bool again = true; again; ) {
+            again = false;
+            for (int32_t k = 0; k < nchecks; k++) {
+                int32_t c = check[k];
+                if (!deadBlock->get(blockOf[c+1]))
+                    continue;
+                int32_t cmp = ops[opStart[c]];
+                nassumed = 0;
+                if (!isProvenBelow(ops[opStart[cmp]], ops[opStart[cmp] + 1], c, 0)) {
+                    deadBlock->clear(blockOf[c+1]);
+                    again = true;
+                }
+            }
+        }
+
+        // Drop the checks and their helper calls, and then whatever only
+        // they used: the compare, and often the length load.
+        BitSet* dropped = new (alloc) BitSet(alloc, n);
+        int32_t* work = new (alloc) int32_t[n];
+        int32_t nwork = 0;
+        for (int32_t k = 0; k < nchecks; k++) {
+            int32_t c = check[k];
+            Block& fail = blocks[blockOf[c+1]];
+            if (!deadBlock->get(blockOf[c+1]))
+                continue;
+            for (int32_t p = c; p <= fail.last; p++) {
+                dropped->set(p);
+                work[nwork++] = p;
+            }
+        }
+        deadBlock = NULL;
+        if (nwork == 0)
+            return false;
+        while (nwork > 0) {
+            int32_t p = work[--nwork];
+            for (int32_t k = opStart[p]; k < opStart[p+1]; k++) {
+                int32_t o = ops[k];
+                LIns* i = ins[o];
+                if (--uses[o] == 0 && !dropped->get(o) && !i->isImmAny() &&
+                    ((i->isLoad() && i->loadQual() != LOAD_VOLATILE) || (isNumbered(i) && !i->isCall()))) {
+                    dropped->set(o);
+                    work[nwork++] = o;
+                }
+            }
+        }
+
+        LIns** kept = new (alloc) LIns*[n];
+        int32_t m = 0;
+        index = new (alloc) HashMap<LIns*, int32_t>(alloc, n);
+        for (int32_t p = 0; p < n; p++) {
+            if (dropped->get(p))
+                continue;
+            kept[m++] = ins[p];
+            index->put(ins[p], m);
+        }
+        ins = kept;
+        n = m;
+        changed = true;
+        return true;
+    }
+
+    // The only predecessor of block 'b' that can run, or -1.
+    int32_t GlobalOpt::livePred(int32_t b)
+    {
+        int32_t pred = -1;
+        for (int32_t j = 0; j < blocks[b].npred; j++) {
+            int32_t p = blocks[b].pred[j];
+            if (blocks[p].rpo < 0 || (deadBlock && deadBlock->get(p)))
+                continue;
+            if (pred >= 0 && pred != p)
+                return -1;
+            pred = p;
+        }
+        return pred;
+    }
+
+    // The opcode of a strict comparison known to hold when 'op' is 'holds',
+    // or LIR_skip if there is none.
+    static LOpcode strictLess(LOpcode op, bool holds)
+    {
+        switch (op) {
+        case LIR_lti:  return holds ? LIR_lti : LIR_skip;
+        case LIR_gti:  return holds ? LIR_gti : LIR_skip;
+        case LIR_gei:  return holds ? LIR_skip : LIR_lti;
+        case LIR_lei:  return holds ? LIR_skip : LIR_gti;
+        case LIR_ltui: return holds ? LIR_ltui : LIR_skip;
+        case LIR_gtui: return holds ? LIR_gtui : LIR_skip;
+        case LIR_geui: return holds ? LIR_skip : LIR_ltui;
+        case LIR_leui: return holds ? LIR_skip : LIR_gtui;
+        default:       return LIR_skip;
+        }
+    }
+
+    // Is 'x' known to be below 'bound' (as unsigned ints) at position 'pos'?
+    // If 'bound' is -1, is it known to be below some int, as signed ints?
+    bool GlobalOpt::isProvenBelow(int32_t x, int32_t bound, int32_t pos, int32_t depth)
+    {
+        // The operands of a branch may come from blocks above it, so the
+        // whole path is found first.
+        Path path;
+        path.n = 0;
+        path.block[path.n++] = blockOf[pos];
+        while (path.n < GLOBALOPT_MAX_PATH) {
+            int32_t p = livePred(path.block[path.n - 1]);
+            if (p < 0)
+                break;
+            path.block[path.n++] = p;
+        }
+        for (int32_t k = 1; k < path.n && --budget > 0; k++) {
+            int32_t b = path.block[k - 1];
+            int32_t last = blocks[path.block[k]].last;
+            LIns* br = ins[last];
+            bool taken = target[last] >= 0 && blockOf[target[last]] == b;
+            if (!(br->isop(LIR_jt) || br->isop(LIR_jf)) || taken == (last + 1 == blocks[b].first))
+                continue;
+            int32_t c = ops[opStart[last]];
+            LOpcode op = strictLess(ins[c]->opcode(), br->isop(LIR_jt) == taken);
+            if (op == LIR_skip)
+                continue;
+            bool gt = op == LIR_gti || op == LIR_gtui;
+            bool isSigned = op == LIR_lti || op == LIR_gti;
+            int32_t lo = ops[opStart[c] + (gt ? 1 : 0)];
+            int32_t hi = ops[opStart[c] + (gt ? 0 : 1)];
+            if (bound < 0 ? isSigned && isEqualAt(x, lo, path, depth)
+                          : isEqualAt(x, lo, path, depth) && isEqualAt(bound, hi, path, depth) &&
+                            (!isSigned || isNonNegative(x, depth + 1)))
+                return true;
+        }
+        return false;
+    }
+
+    bool GlobalOpt::isNonNegative(int32_t v, int32_t depth)
+    {
+        LIns* i = ins[v];
+        if (depth > GLOBALOPT_MAX_DEPTH || --budget <= 0)
+            return false;
+        if (i->isop(LIR_immi))
+            return i->immI() >= 0;
+        if (i->isop(LIR_addi)) {
+            int32_t a = ops[opStart[v]];
+            int32_t b = ops[opStart[v] + 1];
+            if (ins[a]->isop(LIR_immi)) {
+                int32_t t = a; a = b; b = t;
+            }
+            return ins[b]->isop(LIR_immi) && ins[b]->immI() == 1 &&
+                   isNonNegative(a, depth + 1) && isProvenBelow(a, -1, v, depth + 1);
+        }
+        if (!i->isop(LIR_ldi) || i->loadQual() == LOAD_VOLATILE)
+            return false;
+
+        // A slot of an alloc that nothing else can write, given only
+        // non-negative values, and written before it is read.  While its
+        // stores are looked at, the slot itself is assumed to be fine.
+        int32_t a = allocBase(v);
+        if (a < 0 || escaped->get(a))
+            return false;
+        int32_t d = i->disp();
+        for (int32_t k = 0; k < nassumed; k++) {
+            if (assumedSlot[2*k] == a && assumedSlot[2*k+1] == d)
+                return true;
+        }
+        assumedSlot[2*nassumed] = a;
+        assumedSlot[2*nassumed+1] = d;
+        nassumed++;
+        bool ok = true;
+        bool written = false;
+        for (int32_t k = 0; k < nslotStores && ok; k++) {
+            int32_t s = slotStores[k];
+            LIns* st = ins[s];
+            int32_t sb = blockOf[s];
+            if (allocBase(s) != a || d + 4 <= st->disp() || st->disp() + accessSize(st->opcode()) <= d ||
+                blocks[sb].rpo < 0 || deadBlock->get(sb))
+                continue;
+            ok = st->isop(LIR_sti) && st->disp() == d && isNonNegative(ops[opStart[s]], depth + 1);
+            if (sb == blockOf[v] ? s < v : dominates(sb, blockOf[v]))
+                written = true;
+        }
+        nassumed--;
+        return ok && written;
+    }
+
+    // Are 'x' and 'y', as last computed before the end of 'path', equal?
+    bool GlobalOpt::isEqualAt(int32_t x, int32_t y, const Path& path, int32_t depth)
+    {
+        if (x == y)
+            return true;
+        LIns* i = ins[x];
+        LIns* j = ins[y];
+        if (i->opcode() != j->opcode() || depth > GLOBALOPT_MAX_DEPTH || --budget <= 0)
+            return false;
+        if (i->isop(LIR_immi))
+            return i->immI() == j->immI();
+        if (i->isLoad()) {
+            return i->disp() == j->disp() && i->accSet() == j->accSet() &&
+                   i->loadQual() == j->loadQual() && i->loadQual() != LOAD_VOLATILE &&
+                   isEqualAt(ops[opStart[x]], ops[opStart[y]], path, depth + 1) &&
+                   (i->loadQual() == LOAD_CONST || isUnclobbered(x, y, path));
+        }
+        if (i->isImmAny() || i->isCall() || !isNumbered(i))
+            return false;
+        for (int32_t k = 0; k < opStart[x+1] - opStart[x]; k++) {
+            if (!isEqualAt(ops[opStart[x] + k], ops[opStart[y] + k], path, depth + 1))
+                return false;
+        }
+        return true;
+    }
+
+    // Can nothing that runs between loads 'p' and 'q' write what they read?
+    // They must be in the same block, or both on 'path'.
+    bool GlobalOpt::isUnclobbered(int32_t p, int32_t q, const Path& path)
+    {
+        int32_t bp = blockOf[p];
+        int32_t bq = blockOf[q];
+        if (bp == bq) {
+            for (int32_t s = (p < q ? p : q) + 1, e = p < q ? q : p; s < e; s++) {
+                if (clobbers(s, p))
+                    return false;
+            }
+            return true;
+        }
+        int32_t ip = -1, iq = -1;
+        for (int32_t k = 0; k < path.n; k++) {
+            if (path.block[k] == bp)
+                ip = k;
+            if (path.block[k] == bq)
+                iq = k;
+        }
+        if (ip < 0 || iq < 0)
+            return false;
+        if (ip < iq) {
+            int32_t t = p; p = q; q = t;
+            t = ip; ip = iq; iq = t;
+        }
+        // 'p' runs first.
+        for (int32_t k = ip; k >= iq; k--) {
+            Block& bb = blocks[path.block[k]];
+            int32_t end = k == iq ? q : bb.last + 1;
+            for (int32_t s = k == ip ? p + 1 : bb.first; s < end; s++) {
+                if (clobbers(s, p))
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    // May instruction 's' write what load 'ld' reads?
+    bool GlobalOpt::clobbers(int32_t s, int32_t ld)
+    {
+        LIns* i = ins[s];
+        AccSet acc = ins[ld]->accSet();
+        int32_t a = allocBase(ld);
+        if (i->isop(LIR_memfence))
+            return true;
+        if (i->isCall())
+            return !i->callInfo()->_isPure && (i->callInfo()->_storeAccSet & acc) != 0 &&
+                   (a < 0 || escaped->get(a));
+        if (!i->isStore() || (i->accSet() & acc) == 0)
+            return false;
+        int32_t sa = allocBase(s);
+        if (a < 0 || sa < 0)
+            return true;
+        return sa == a && i->disp() < ins[ld]->disp() + accessSize(ins[ld]->opcode()) &&
+               ins[ld]->disp() < i->disp() + accessSize(i->opcode());
+    }
+
+    void GlobalOpt::findLoops()
+    {
+        // Natural loops: an edge to a block that dominates its source is a
+        // back edge, and all back edges to a header make up one loop.
+        int32_t* loopOfHeader = new (alloc) int32_t[nblocks];
+        int32_t* work = new (alloc) int32_t[nblocks];
+        for (int32_t b = 0; b < nblocks; b++)
+            loopOfHeader[b] = -1;
+        nloops = 0;
+        for (int32_t k = 0; k < nrpo; k++) {
+            Block& bb = blocks[rpo[k]];
+            for (int32_t j = 0; j < bb.nsucc; j++) {
+                if (dominates(bb.succ[j], rpo[k]) && loopOfHeader[bb.succ[j]] < 0)
+                    loopOfHeader[bb.succ[j]] = nloops++;
+            }
+        }
+        if (nloops == 0)
+            return;
+
+        loops = new (alloc) Loop[nloops];
+        for (int32_t h = 0; h < nblocks; h++) {
+            int32_t l = loopOfHeader[h];
+            if (l < 0)
+                continue;
+            Loop& loop = loops[l];
+            loop.header = h;
+            loop.parent = -1;
+            loop.body = new (alloc) BitSet(alloc, nblocks);
+            loop.body->set(h);
+            loop.size = 1;
+            int32_t nwork = 0;
+            for (int32_t j = 0; j < blocks[h].npred; j++) {
+                int32_t p = blocks[h].pred[j];
+                if (dominates(h, p) && !loop.body->get(p)) {
+                    loop.body->set(p);
+                    loop.size++;
+                    work[nwork++] = p;
+                }
+            }
+            while (nwork > 0) {
+                Block& bb = blocks[work[--nwork]];
+                for (int32_t j = 0; j < bb.npred; j++) {
+                    int32_t p = bb.pred[j];
+                    if (blocks[p].rpo >= 0 && !loop.body->get(p)) {
+                        loop.body->set(p);
+                        loop.size++;
+                        work[nwork++] = p;
+                    }
+                }
+            }
+        }
+
+        for (int32_t l = 0; l < nloops; l++) {
+            Loop& loop = loops[l];
+            loop.first = n;
+            loop.stores = loop.allocStores = loop.calls = ACCSET_NONE;
+            loop.nallocStores = 0;
+            loop.fence = false;
+            for (int32_t b = 0; b < nblocks; b++) {
+                if (!loop.body->get(b))
+                    continue;
+                Block& bb = blocks[b];
+                if (bb.first < loop.first)
+                    loop.first = bb.first;
+                loop.stores |= bb.stores;
+                loop.allocStores |= bb.allocStores;
+                loop.calls |= bb.calls;
+                loop.nallocStores += bb.nallocStores;
+                loop.fence = loop.fence || bb.fence;
+                if (bb.loop < 0 || loops[bb.loop].size > loop.size)
+                    bb.loop = l;
+            }
+            loop.allocStore = new (alloc) int32_t[loop.nallocStores > 0 ? loop.nallocStores : 1];
+            loop.nallocStores = 0;
+            for (int32_t b = 0; b < nblocks; b++) {
+                if (!loop.body->get(b) || blocks[b].nallocStores == 0)
+                    continue;
+                for (int32_t p = blocks[b].first; p <= blocks[b].last; p++) {
+                    if (ins[p]->isStore() && allocBase(p) >= 0)
+                        loop.allocStore[loop.nallocStores++] = p;
+                }
+            }
+            for (int32_t m = 0; m < nloops; m++) {
+                if (m != l && loops[m].body->get(loop.header) && loops[m].size > loop.size &&
+                    (loop.parent < 0 || loops[loop.parent].size > loops[m].size))
+                    loop.parent = m;
+            }
+        }
+
+        // Where to put a loop's invariants: if exactly one reachable block
+        // enters the loop, at the end of that block.  It must either jump to
+        // the header, or fall through into it without also branching to it.
+        for (int32_t l = 0; l < nloops; l++) {
+            Loop& loop = loops[l];
+            Block& header = blocks[loop.header];
+            loop.point = loop.entry = -1;
+            int32_t entry = -1;
+            int32_t entries = 0;
+            for (int32_t j = 0; j < header.npred; j++) {
+                int32_t p = header.pred[j];
+                if (blocks[p].rpo >= 0 && !loop.body->get(p)) {
+                    entry = p;
+                    entries++;
+                }
+            }
+            if (entries != 1)
+                continue;
+            int32_t last = blocks[entry].last;
+            LIns* i = ins[last];
+            int32_t point = -1;
+            if (i->isop(LIR_j)) {
+                point = last;
+            } else if (last + 1 == header.first) {
+                bool branches = false;
+                if (i->isop(LIR_jtbl)) {
+                    for (uint32_t k = 0, size = i->getTableSize(); k < size; k++)
+                        branches = branches || posOf(i->getTarget(k)) == header.first;
+                } else if (i->isBranch()) {
+                    branches = target[last] == header.first;
+                }
+                if (!branches)
+                    point = header.first;
+            }
+            // The invariants are emitted in program order, so they must come
+            // before every instruction in the loop.
+            if (point >= 0 && point <= loop.first) {
+                loop.point = point;
+                loop.entry = entry;
+            }
+        }
+    }
+
+    // If loop 'l' is an innermost loop with somewhere to put code in front
+    // of it, and its body is a run of blocks entered only at the header,
+    // sets 'first' and 'last' to the positions of that run.
+    bool GlobalOpt::isSimpleLoop(int32_t l, int32_t& first, int32_t& last)
+    {
+        Loop& loop = loops[l];
+        if (loop.point < 0 || loop.fence)
+            return false;
+        for (int32_t m = 0; m < nloops; m++) {
+            if (loops[m].parent == l)
+                return false;
+        }
+        first = loop.first;
+        last = -1;
+        for (int32_t b = 0; b < nblocks; b++) {
+            if (loop.body->get(b) && blocks[b].last > last)
+                last = blocks[b].last;
+        }
+        if (blockOf[last] - blockOf[first] + 1 != loop.size)
+            return false;
+        for (int32_t b = blockOf[first]; b <= blockOf[last]; b++) {
+            if (!loop.body->get(b))
+                return false;
+            for (int32_t j = 0; j < blocks[b].npred; j++) {
+                int32_t pb = blocks[b].pred[j];
+                if (blocks[pb].rpo >= 0 && !loop.body->get(pb) && b != loop.header)
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    // Runs of new instructions, each to go in front of a position.
+    struct GlobalOpt::Insertions
+    {
+        Insertions(Allocator& alloc, int32_t cap)
+            : at(new (alloc) int32_t[cap])
+            , code(new (alloc) LIns**[cap])
+            , ncode(new (alloc) int32_t[cap])
+            , count(0)
+            , total(0)
+        {}
+
+        // Keeps them sorted by where they go; runs for the same position
+        // stay in the order they were added.
+        void add(int32_t p, LIns** c, int32_t nc)
+        {
+            int32_t k = count++;
+            for (; k > 0 && at[k-1] > p; k--) {
+                at[k] = at[k-1];
+                code[k] = code[k-1];
+                ncode[k] = ncode[k-1];
+            }
+            at[k] = p;
+            code[k] = c;
+            ncode[k] = nc;
+            total += nc;
+        }
+
+        int32_t* at;
+        LIns*** code;
+        int32_t* ncode;
+        int32_t count;
+        int32_t total;
+    };
+
+    // Puts the instructions in 'c' into 'ins'.  The caller must read the
+    // fragment again.  Returns false if there were none.
+    bool GlobalOpt::insertCode(Insertions& c)
+    {
+        if (c.count == 0)
+            return false;
+        LIns** grown = new (alloc) LIns*[n + c.total];
+        index = new (alloc) HashMap<LIns*, int32_t>(alloc, n + c.total);
+        int32_t m = 0;
+        for (int32_t p = 0, f = 0; p < n; p++) {
+            for (; f < c.count && c.at[f] == p; f++) {
+                for (int32_t k = 0; k < c.ncode[f]; k++) {
+                    grown[m++] = c.code[f][k];
+                    index->put(c.code[f][k], m);
+                }
+            }
+            grown[m++] = ins[p];
+            index->put(ins[p], m);
+        }
+        ins = grown;
+        n = m;
+        changed = true;
+        return true;
+    }
+
+#if NJ_F2I_SUPPORTED
+    // Narrowing.  A double local that a loop only ever changes by adding a
+    // small integer constant -- the counter of 'for (var i:Number = 0; i <
+    // n; i++)' -- holds an int for as long as it starts out as one and
+    // doesn't overflow.  If such a loop L is simple enough, a copy NL of it
+    // that keeps the local as an int in a new slot T is put in front of it:
+    //
+    //         t = d2i(i)
+    //         if i2d(t) != i, or i is -0                   -> SL
+    //         T = t
+    //         j NH
+    //     NL: L's blocks, in order, with:
+    //     NH:   at the top of the header,
+    //           if T + c would overflow                    -> SL
+    //           loads of i replaced by i2d(T), and
+    //           i = i + c replaced by T = T + c; i = i2d(T)
+    //     SL: L, unchanged
+    //
+    // NL keeps storing i as well, so whoever reads the local after the loop,
+    // or from a handler, sees what L would have left in it.  Branches out of
+    // NL go where L's do, or to SL if the code they lead to uses values
+    // from the loop; if T is about to overflow, L takes over at the top of
+    // the next iteration and goes on with a double.  In NL, comparisons
+    // and d2i conversions of values that are ints anyway are done on the
+    // ints, so the loop condition becomes an int compare, CodegenLIR's
+    // check that a double index is an int folds away, and the bounds checks
+    // the index needs can be eliminated as for an int counter.
+
+    // The largest loop considered for narrowing, in instructions.
+    static const int32_t GLOBALOPT_MAX_NARROW_INS = 400;
+
+    // Bound on the constant a narrowed local is stepped by.
+    static const int32_t GLOBALOPT_MAX_NARROW_STEP = 1 << 20;
+
+    struct GlobalOpt::NarrowLoop
+    {
+        int32_t first, last;        // the loop's positions ...
+        int32_t header;             // ... and where its header block starts
+        int32_t point;              // where the narrowed loop goes
+        int32_t base;               // the local: the alloc ...
+        int32_t disp;               // ... and the displacement of the double
+        int32_t store;              // its one store in the loop ...
+        int32_t inc;                // ... of this addd or subd ...
+        int32_t step;               // ... which adds this
+        bool nonNegative;           // enter only if the local is >= 0
+        bool fallsOut;              // the last instruction may fall out of the loop
+        BitSet* slowExit;           // blocks to leave for through the original loop
+        LIns* exit;                 // where falling out goes ...
+        bool newExit;               // ... a label to put after the loop
+        LIns** val;                 // copies, by position - first
+        LIns** ival;                // int values of copies known to hold ints
+        LIns* slot;                 // T
+        LIns** code;                // the narrowed loop, in order
+        int32_t ncode;
+        int32_t capCode;
+        bool failed;
+        LirWriter* w;
+    };
+
+    bool GlobalOpt::narrowLoops()
+    {
+        NarrowLoop* nls = new (alloc) NarrowLoop[nloops];
+        int32_t found = 0;
+        for (int32_t l = 0; l < nloops; l++) {
+            if (planNarrow(l, nls[found]) && emitNarrow(nls[found]))
+                found++;
+        }
+        // A new label after a loop goes in front of whatever else is put
+        // there, which may be the narrowed copy of the next loop.
+        Insertions code(alloc, 2 * found + 1);
+        for (int32_t k = 0; k < found; k++) {
+            if (nls[k].newExit) {
+                LIns** label = new (alloc) LIns*[1];
+                label[0] = nls[k].exit;
+                code.add(nls[k].last + 1, label, 1);
+            }
+        }
+        for (int32_t k = 0; k < found; k++)
+            code.add(nls[k].point, nls[k].code, nls[k].ncode);
+        return insertCode(code);
+    }
+
+    // Is 'p' a load or store of the double local 'nl' narrows?
+    bool GlobalOpt::isNarrowLocal(NarrowLoop& nl, int32_t p)
+    {
+        return (ins[p]->isop(LIR_ldd) || ins[p]->isop(LIR_std)) &&
+               allocBase(p) == nl.base && ins[p]->disp() == nl.disp;
+    }
+
+    // Is the stored value of 'st', a store of a double local in the loop,
+    // that local plus or minus a small integer?  Fills in 'nl' if so.
+    bool GlobalOpt::isNarrowStep(NarrowLoop& nl, int32_t st)
+    {
+        int32_t val = ops[opStart[st]];
+        LIns* i = ins[val];
+        if (val < nl.first || !(i->isop(LIR_addd) || i->isop(LIR_subd)))
+            return false;
+        nl.base = allocBase(st);
+        nl.disp = ins[st]->disp();
+        for (int32_t k = 0; k < (i->isop(LIR_addd) ? 2 : 1); k++) {
+            int32_t ld = ops[opStart[val] + k];
+            LIns* c = ins[ops[opStart[val] + 1 - k]];
+            if (ld < nl.first || !ins[ld]->isop(LIR_ldd) || !isNarrowLocal(nl, ld) || !c->isImmD())
+                continue;
+            double d = c->immD();
+            if (d == 0 || d != double(int32_t(d)) ||
+                d <= -GLOBALOPT_MAX_NARROW_STEP || d >= GLOBALOPT_MAX_NARROW_STEP)
+                continue;
+            nl.store = st;
+            nl.inc = val;
+            nl.step = i->isop(LIR_addd) ? int32_t(d) : -int32_t(d);
+            return true;
+        }
+        return false;
+    }
+
+    // Can loop 'l' be narrowed?  Fills in 'nl' if so.
+    bool GlobalOpt::planNarrow(int32_t l, NarrowLoop& nl)
+    {
+        Loop& loop = loops[l];
+        int32_t first, last;
+        if (!isSimpleLoop(l, first, last) || last - first + 1 > GLOBALOPT_MAX_NARROW_INS)
+            return false;
+        nl.first = first;
+        nl.last = last;
+        nl.header = blocks[loop.header].first;
+        nl.point = loop.point;
+        if (!ins[nl.header]->isop(LIR_label))
+            return false;
+
+        // The local: the first double local stepped by a constant and
+        // touched in no other way.
+        nl.store = -1;
+        for (int32_t p = first; p <= last && nl.store < 0; p++) {
+            int32_t a;
+            if (!ins[p]->isop(LIR_std) || (a = allocBase(p)) < 0 || escaped->get(a) ||
+                !isNarrowStep(nl, p))
+                continue;
+            for (int32_t q = first; q <= last; q++) {
+                LIns* i = ins[q];
+                if (q == nl.store || !(i->isLoad() || i->isStore()) || allocBase(q) != nl.base ||
+                    i->disp() >= nl.disp + 8 || nl.disp >= i->disp() + accessSize(i->opcode()))
+                    continue;
+                if (!i->isop(LIR_ldd) || i->disp() != nl.disp) {
+                    nl.store = -1;
+                    break;
+                }
+            }
+        }
+        if (nl.store < 0)
+            return false;
+
+        // The copy goes at 'point', so the loop may only use values from
+        // before there.
+        nl.nonNegative = false;
+        for (int32_t p = first; p <= last; p++) {
+            LIns* i = ins[p];
+            if (i->isop(LIR_jtbl))
+                return false;
+            for (int32_t k = opStart[p]; k < opStart[p+1]; k++) {
+                if (ops[k] < first && ops[k] >= nl.point)
+                    return false;
+            }
+            // A compare with a uint can only be done on ints if the local
+            // is never negative, which it isn't if it starts out so and
+            // goes up.
+            if (nl.step > 0 && isCmpDOpcode(i->opcode())) {
+                for (int32_t k = 0; k < 2; k++) {
+                    if (ins[ops[opStart[p] + k]]->isop(LIR_ui2d))
+                        nl.nonNegative = true;
+                }
+            }
+        }
+        LIns* back = ins[last];
+        nl.fallsOut = !back->isop(LIR_j) && !back->isRet();
+        if (nl.fallsOut && last + 1 == n)
+            return false;
+
+        // Code after the loop may use values from it, as it may when the
+        // last block falls out of the loop.  An exit from which such code
+        // can be reached leaves the copy through the original loop instead.
+        // That runs the header again, so the copy may only take such exits
+        // from the header, and the header may not store.
+        BitSet* uses = new (alloc) BitSet(alloc, nblocks);
+        bool any = false;
+        for (int32_t p = last + 1; p < n; p++) {
+            for (int32_t k = opStart[p]; k < opStart[p+1]; k++) {
+                if (ops[k] >= first && ops[k] <= last) {
+                    uses->set(blockOf[p]);
+                    any = true;
+                }
+            }
+        }
+        nl.slowExit = new (alloc) BitSet(alloc, nblocks);
+        if (!any)
+            return true;
+        for (bool more = true; more; ) {
+            more = false;
+            for (int32_t b = 0; b < nblocks; b++) {
+                if (uses->get(b) || loop.body->get(b))
+                    continue;
+                for (int32_t j = 0; j < blocks[b].nsucc; j++) {
+                    if (uses->get(blocks[b].succ[j])) {
+                        uses->set(b);
+                        more = true;
+                        break;
+                    }
+                }
+            }
+        }
+        bool slow = false;
+        for (int32_t p = first; p <= last; p++) {
+            LIns* i = ins[p];
+            int32_t to[2] = { -1, -1 };
+            if (i->isBranch() && !i->isop(LIR_brsavpc))
+                to[0] = target[p];
+            if (p == last && nl.fallsOut)
+                to[1] = last + 1;
+            for (int32_t k = 0; k < 2; k++) {
+                int32_t tp = to[k];
+                if (tp < 0 || (tp >= first && tp <= last) || !uses->get(blockOf[tp]))
+                    continue;
+                if (p < nl.header)
+                    return false;
+                nl.slowExit->set(blockOf[tp]);
+                slow = true;
+            }
+        }
+        for (int32_t p = nl.header; p <= last && slow; p++) {
+            LIns* i = ins[p];
+            if (i->isStore() || (i->isCall() && !i->callInfo()->_isPure))
+                return false;
+        }
+        return true;
+    }
+
+    LIns* GlobalOpt::narrowPut(NarrowLoop& nl, LIns* i)
+    {
+        if (nl.ncode == nl.capCode)
+            nl.failed = true;
+        else
+            nl.code[nl.ncode++] = i;
+        return i;
+    }
+
+    // The copy of 'p' in the narrowed loop.
+    LIns* GlobalOpt::narrowVal(NarrowLoop& nl, int32_t p)
+    {
+        if (p < nl.first)
+            return ins[p];
+        LIns* v = nl.val[p - nl.first];
+        if (!v) {
+            nl.failed = true;
+            return ins[p];
+        }
+        return v;
+    }
+
+    // The int that 'p' converts to a double in the narrowed loop, or NULL
+    // if it isn't known to be one.
+    LIns* GlobalOpt::narrowInt(NarrowLoop& nl, int32_t p)
+    {
+        if (p >= nl.first && nl.ival[p - nl.first])
+            return nl.ival[p - nl.first];
+        LIns* i = ins[p];
+        if (i->isop(LIR_i2d))
+            return narrowVal(nl, ops[opStart[p]]);
+        if (i->isImmD() && i->immD() == double(int32_t(i->immD())) &&
+            !(i->immD() == 0 && 1 / i->immD() < 0))
+            return narrowPut(nl, nl.w->insImmI(int32_t(i->immD())));
+        return NULL;
+    }
+
+    // Is 'p' the local, as loaded or stepped in the loop?
+    bool GlobalOpt::isNarrowCounter(NarrowLoop& nl, int32_t p)
+    {
+        return p >= nl.first && (p == nl.inc || isNarrowLocal(nl, p));
+    }
+
+    // Copies compare 'p', on ints if it can be.
+    LIns* GlobalOpt::narrowCompare(NarrowLoop& nl, int32_t p)
+    {
+        LirWriter& w = *nl.w;
+        LOpcode op = ins[p]->opcode();
+        int32_t a = ops[opStart[p]];
+        int32_t b = ops[opStart[p] + 1];
+        LIns* ia = narrowInt(nl, a);
+        LIns* ib = narrowInt(nl, b);
+        if (ia && ib) {
+            if (ia == ib) {
+                bool eq = op == LIR_eqd || op == LIR_led || op == LIR_ged;
+                return narrowPut(nl, w.insImmI(eq ? 1 : 0));
+            }
+            return narrowPut(nl, w.ins2(cmpOpcodeD2I(op), ia, ib));
+        }
+        // i < u is i <u u if i >= 0.
+        if (nl.nonNegative) {
+            if (ia && isNarrowCounter(nl, a) && ins[b]->isop(LIR_ui2d))
+                return narrowPut(nl, w.ins2(cmpOpcodeD2UI(op), ia, narrowVal(nl, ops[opStart[b]])));
+            if (ib && isNarrowCounter(nl, b) && ins[a]->isop(LIR_ui2d))
+                return narrowPut(nl, w.ins2(cmpOpcodeD2UI(op), narrowVal(nl, ops[opStart[a]]), ib));
+        }
+        LIns* args[2] = { narrowVal(nl, a), narrowVal(nl, b) };
+        return narrowPut(nl, copyIns(w, ins[p], args));
+    }
+
+    // Writes the narrowed loop for 'nl' into nl.code.  Returns false if it
+    // turned out it can't be done.
+    bool GlobalOpt::emitNarrow(NarrowLoop& nl)
+    {
+        int32_t len = nl.last - nl.first + 1;
+        LirBuffer* buf = new (alloc) LirBuffer(alloc);
+        LirBufWriter w(buf, config);
+        nl.w = &w;
+        nl.val = new (alloc) LIns*[len];
+        nl.ival = new (alloc) LIns*[len];
+        VMPI_memset(nl.val, 0, len * sizeof(LIns*));
+        VMPI_memset(nl.ival, 0, len * sizeof(LIns*));
+        nl.capCode = 4 * len + 32;
+        nl.code = new (alloc) LIns*[nl.capCode];
+        nl.ncode = 0;
+        nl.failed = false;
+        for (int32_t p = nl.first; p <= nl.last; p++) {
+            if (ins[p]->isop(LIR_label))
+                nl.val[p - nl.first] = w.ins0(LIR_label);
+        }
+
+        // Enter if the local holds an int other than -0.
+        LIns* slow = w.ins0(LIR_label);
+        nl.newExit = false;
+        if (nl.fallsOut) {
+            nl.exit = ins[nl.last + 1];
+            if (nl.slowExit->get(blockOf[nl.last + 1])) {
+                nl.exit = slow;
+            } else if (!nl.exit->isop(LIR_label)) {
+                nl.exit = w.ins0(LIR_label);
+                nl.newExit = true;
+            }
+        }
+        LIns* nonzero = w.ins0(LIR_label);
+        LIns* base = ins[nl.base];
+        AccSet acc = ins[nl.store]->accSet();
+        LIns* d = narrowPut(nl, w.insLoad(LIR_ldd, base, nl.disp, acc, LOAD_NORMAL));
+        LIns* t = narrowPut(nl, w.ins1(LIR_d2i, d));
+        LIns* back = narrowPut(nl, w.ins1(LIR_i2d, t));
+        narrowPut(nl, w.insBranch(LIR_jf, narrowPut(nl, w.ins2(LIR_eqd, back, d)), slow));
+        LIns* zero = narrowPut(nl, w.insImmI(0));
+        narrowPut(nl, w.insBranch(LIR_jf, narrowPut(nl, w.ins2(LIR_eqi, t, zero)), nonzero));
+        LIns* inv = narrowPut(nl, w.ins2(LIR_divd, narrowPut(nl, w.insImmD(1)), d));
+        LIns* neg = narrowPut(nl, w.ins2(LIR_ltd, inv, narrowPut(nl, w.insImmD(0))));
+        narrowPut(nl, w.insBranch(LIR_jt, neg, slow));
+        narrowPut(nl, nonzero);
+        if (nl.nonNegative)
+            narrowPut(nl, w.insBranch(LIR_jt, narrowPut(nl, w.ins2(LIR_lti, t, zero)), slow));
+        nl.slot = narrowPut(nl, w.insAlloc(sizeof(int32_t)));
+        narrowPut(nl, w.insStore(LIR_sti, t, nl.slot, 0, acc));
+        narrowPut(nl, w.insBranch(LIR_j, NULL, nl.val[nl.header - nl.first]));
+
+        for (int32_t p = nl.first; p <= nl.last && !nl.failed; p++) {
+            LIns* i = ins[p];
+            int32_t x = p - nl.first;
+            if (i->isop(LIR_label)) {
+                narrowPut(nl, nl.val[x]);
+                if (p == nl.header) {
+                    // Leave before the step could overflow.
+                    LIns* cur = narrowPut(nl, w.insLoad(LIR_ldi, nl.slot, 0, acc, LOAD_NORMAL));
+                    LIns* ovf = nl.step > 0
+                        ? w.ins2(LIR_gti, cur, narrowPut(nl, w.insImmI(0x7fffffff - nl.step)))
+                        : w.ins2(LIR_lti, cur, narrowPut(nl, w.insImmI(int32_t(0x80000000) - nl.step)));
+                    narrowPut(nl, w.insBranch(LIR_jt, narrowPut(nl, ovf), slow));
+                }
+            } else if (i->isop(LIR_comment)) {
+                continue;
+            } else if (p == nl.store) {
+                narrowPut(nl, w.insStore(LIR_sti, nl.ival[nl.inc - nl.first], nl.slot, 0, acc));
+                narrowPut(nl, w.insStore(LIR_std, nl.val[nl.inc - nl.first], base, nl.disp, i->accSet()));
+            } else if (isNarrowLocal(nl, p)) {
+                nl.ival[x] = narrowPut(nl, w.insLoad(LIR_ldi, nl.slot, 0, acc, LOAD_NORMAL));
+                nl.val[x] = narrowPut(nl, w.ins1(LIR_i2d, nl.ival[x]));
+            } else if (p == nl.inc) {
+                int32_t ld = ops[opStart[p]];
+                if (!isNarrowLocal(nl, ld))
+                    ld = ops[opStart[p] + 1];
+                LIns* step = narrowPut(nl, w.insImmI(nl.step));
+                nl.ival[x] = narrowPut(nl, w.ins2(LIR_addi, nl.ival[ld - nl.first], step));
+                nl.val[x] = narrowPut(nl, w.ins1(LIR_i2d, nl.ival[x]));
+            } else if (i->isop(LIR_brsavpc)) {
+                narrowPut(nl, w.insBranch(LIR_brsavpc, narrowVal(nl, ops[opStart[p]]), i->getTarget()));
+            } else if (i->isBranch()) {
+                int32_t tp = target[p];
+                LIns* to = tp >= nl.first && tp <= nl.last ? nl.val[tp - nl.first]
+                         : nl.slowExit->get(blockOf[tp]) ? slow : ins[tp];
+                if (i->isop(LIR_j)) {
+                    narrowPut(nl, w.insBranch(LIR_j, NULL, to));
+                    continue;
+                }
+                LIns* cond = narrowVal(nl, ops[opStart[p]]);
+                if (cond->isImmI()) {
+                    // Folded; either always taken or never.
+                    if ((cond->immI() != 0) == i->isop(LIR_jt))
+                        narrowPut(nl, w.insBranch(LIR_j, NULL, to));
+                } else {
+                    narrowPut(nl, w.insBranch(i->opcode(), cond, to));
+                }
+            } else if (i->isop(LIR_d2i) && narrowInt(nl, ops[opStart[p]])) {
+                nl.val[x] = nl.ival[x] = narrowInt(nl, ops[opStart[p]]);
+            } else if (isCmpDOpcode(i->opcode())) {
+                nl.val[x] = narrowCompare(nl, p);
+            } else {
+                LIns* a[MAXARGS];
+                for (int32_t k = opStart[p]; k < opStart[p+1]; k++)
+                    a[k - opStart[p]] = narrowVal(nl, ops[k]);
+                nl.val[x] = narrowPut(nl, copyIns(w, i, a));
+            }
+        }
+        if (nl.fallsOut)
+            narrowPut(nl, w.insBranch(LIR_j, NULL, nl.exit));
+        narrowPut(nl, slow);
+        return !nl.failed;
+    }
+#endif // NJ_F2I_SUPPORTED
+
+#if NJ_PACKED_DOUBLE_SUPPORTED
+    // Vectorization.  CodegenLIR rotates counted loops: the code before the
+    // loop jumps to the condition C at the bottom, which branches back to
+    // the body H at the top while the counter is in range.  If an iteration
+    // of such a loop runs straight through, apart from bounds check failure
+    // paths, a second loop VH that does two iterations at a time is put in
+    // front of it:
+    //
+    //     VH: the guards of both iterations        -> SC
+    //         both iterations' loads, arithmetic and stores
+    //         j VH
+    //     SC: j C                                  (the original loop)
+    //
+    // The guards are the branches out of the loop, the bounds checks and the
+    // loop condition of both iterations, so VH only runs a pair of
+    // iterations that would run straight through; otherwise the original
+    // loop takes over at the same state and finishes one at a time.  Guards
+    // may only depend on the counter and on values the loop doesn't change.
+    //
+    // A value is computed once if it is the same in both iterations, and
+    // otherwise per iteration ("lane"), except for doubles read from
+    // consecutive Vector elements v[i + c], which are loaded, computed with
+    // addd2 and friends, and stored two at a time.  Every element access
+    // must use the same c, so each iteration only touches its own elements
+    // and the two can be interleaved even if two Vectors are the same
+    // object.  Whatever is computed per lane is computed in the original
+    // order, so a sum comes out exactly as it would one element at a time.
+    // Locals (stores straight into an alloc) are kept as values: a load
+    // reads the value stored earlier in the same iteration, or the previous
+    // iteration's last store; only the second iteration's stores are done.
+
+    // The largest loop considered for vectorization, in instructions.
+    static const int32_t GLOBALOPT_MAX_VECTOR_INS = 400;
+
+    // Bounds on the counter offsets tracked for element accesses.
+    static const int32_t GLOBALOPT_MAX_VECTOR_OFF = 1 << 20;
+
+    enum VecKind {
+        VEC_NONE,       // not part of the vector loop
+        VEC_UNIFORM,    // the same in both iterations, computed once
+        VEC_LANES,      // computed for each iteration
+        VEC_PACKED      // a double in each iteration, kept as a double2
+    };
+
+    struct GlobalOpt::VecLoop
+    {
+        int32_t first, last;        // the loop's positions ...
+        int32_t header;             // ... and where its header block starts
+        int32_t point;              // where the vector loop goes
+        int32_t* seq;               // the positions in the order an iteration runs them
+        int32_t nseq;
+        int32_t* order;             // index in 'seq', by position - first
+        BitSet* skip;               // labels, branches and failure paths left out
+        int32_t* guard;             // the branches out, in 'seq' order
+        int32_t nguards;
+        uint8_t* kind;              // VecKind, by position - first
+        int32_t* same;              // the stored value a load reads back, or -1
+        int32_t* carried;           // the previous iteration's store a load reads, or -1
+        int32_t* scale;             // lane l is scale * (counter + off + l); 0 if not known to be
+        int32_t* off;
+        BitSet* varying;            // depends on Vector elements or on a local other than the counter
+        BitSet* dead;               // stores to locals a later one overwrites
+        int32_t counter;            // the counter's load, -1 if not found yet
+        int32_t elemKey;            // 8 * c + disp for the element accesses ...
+        bool haveElem;              // ... if there are any
+        int32_t npacked;            // double2 operations and stores
+        LIns** val;                 // uniform and packed values, by position - first
+        LIns** lane0;
+        LIns** lane1;
+        HashMap<LIns*, LIns*>* splats;
+        LIns** code;                // the vector loop, in order
+        int32_t ncode;
+        int32_t capCode;
+        int32_t cur;                // index in 'seq' being emitted, -1 for the guards
+        bool failed;
+        LirWriter* w;
+    };
+
+    // The load that reads back exactly what 'st' stores.
+    static LOpcode loadOpFor(LOpcode st)
+    {
+        switch (st) {
+        case LIR_sti:  return LIR_ldi;
+        case LIR_stq:  return LIR_ldq;
+        case LIR_std:  return LIR_ldd;
+        case LIR_stf:  return LIR_ldf;
+        case LIR_stf4: return LIR_ldf4;
+        default:       return LIR_skip;
+        }
+    }
+
+    static LOpcode packedOpFor(LOpcode op)
+    {
+        switch (op) {
+        case LIR_addd: return LIR_addd2;
+        case LIR_subd: return LIR_subd2;
+        case LIR_muld: return LIR_muld2;
+        case LIR_divd: return LIR_divd2;
+        default:       return LIR_skip;
+        }
+    }
+
+    bool GlobalOpt::vectorizeLoops()
+    {
+        Insertions code(alloc, nloops);
+        for (int32_t l = 0; l < nloops; l++) {
+            VecLoop v;
+            if (planVector(l, v) && emitVector(v))
+                code.add(v.point, v.code, v.ncode);
+        }
+        return insertCode(code);
+    }
+
+    // Can loop 'l' be vectorized?  Fills in 'v' if so.
+    bool GlobalOpt::planVector(int32_t l, VecLoop& v)
+    {
+        Loop& loop = loops[l];
+        int32_t first, last;
+        if (!isSimpleLoop(l, first, last))
+            return false;
+
+        // The last block must branch back to the first.
+        int32_t len = last - first + 1;
+        if (len > GLOBALOPT_MAX_VECTOR_INS)
+            return false;
+        int32_t header = blocks[loop.header].first;
+        LIns* back = ins[last];
+        if (header == first || !(back->isop(LIR_jt) || back->isop(LIR_jf)) || target[last] != first)
+            return false;
+
+        v.first = first;
+        v.last = last;
+        v.header = header;
+        v.point = loop.point;
+        v.skip = new (alloc) BitSet(alloc, len);
+        BitSet* guards = new (alloc) BitSet(alloc, len);
+        for (int32_t p = first; p <= last; p++) {
+            LIns* i = ins[p];
+            if (i->isop(LIR_label) || i->isop(LIR_comment)) {
+                v.skip->set(p - first);
+                continue;
+            }
+            if (!endsBlock(i))
+                continue;
+            if (!i->isop(LIR_jt) && !i->isop(LIR_jf))
+                return false;
+            int32_t t = target[p];
+            v.skip->set(p - first);
+            guards->set(p - first);
+            if (p == last || t < first || t > last)
+                continue;
+            // A bounds check: a block only it enters calls a helper, which
+            // throws or, for a store, grows the Vector.
+            Block& fail = blocks[blockOf[p+1]];
+            LIns* fl = ins[fail.last];
+            if (!i->isop(LIR_jf) || !ins[ops[opStart[p]]]->isop(LIR_geui) ||
+                fail.first != p + 1 || fail.last + 1 != t || fail.npred != 1 ||
+                (endsBlock(fl) && (!fl->isop(LIR_j) || target[fail.last] > last)))
+                return false;
+            for (int32_t q = fail.first; q <= fail.last; q++)
+                v.skip->set(q - first);
+            p = fail.last;
+        }
+
+        // An iteration runs the header block first.
+        v.seq = new (alloc) int32_t[len];
+        v.order = new (alloc) int32_t[len];
+        v.nseq = 0;
+        for (int32_t p = header; p <= last; p++)
+            v.seq[v.nseq++] = p;
+        for (int32_t p = first; p < header; p++)
+            v.seq[v.nseq++] = p;
+        v.guard = new (alloc) int32_t[len];
+        v.nguards = 0;
+        for (int32_t k = 0; k < v.nseq; k++) {
+            v.order[v.seq[k] - first] = k;
+            if (guards->get(v.seq[k] - first))
+                v.guard[v.nguards++] = v.seq[k];
+        }
+
+        // Stores to locals that a later one in the iteration overwrites are
+        // left out; partly overwritten ones are not handled.
+        v.dead = new (alloc) BitSet(alloc, len);
+        for (int32_t k = 0; k < v.nseq; k++) {
+            int32_t s = v.seq[k];
+            if (!isVecSlot(v, s) || !ins[s]->isStore())
+                continue;
+            for (int32_t kk = k + 1; kk < v.nseq; kk++) {
+                int32_t t = v.seq[kk];
+                if (!isVecSlot(v, t) || !ins[t]->isStore() || !clobbers(t, s))
+                    continue;
+                int32_t sd = ins[s]->disp();
+                int32_t td = ins[t]->disp();
+                if (td > sd || td + accessSize(ins[t]->opcode()) < sd + accessSize(ins[s]->opcode()))
+                    return false;
+                v.dead->set(s - first);
+                break;
+            }
+        }
+
+        v.kind = new (alloc) uint8_t[len];
+        v.same = new (alloc) int32_t[len];
+        v.carried = new (alloc) int32_t[len];
+        v.scale = new (alloc) int32_t[len];
+        v.off = new (alloc) int32_t[len];
+        v.varying = new (alloc) BitSet(alloc, len);
+        for (int32_t x = 0; x < len; x++) {
+            v.kind[x] = VEC_NONE;
+            v.same[x] = v.carried[x] = -1;
+            v.scale[x] = v.off[x] = 0;
+        }
+        v.counter = -1;
+        v.haveElem = false;
+        v.elemKey = 0;
+        v.npacked = 0;
+        for (int32_t k = 0; k < v.nseq; k++) {
+            if (!v.skip->get(v.seq[k] - first) && !classifyVector(v, v.seq[k]))
+                return false;
+        }
+        for (int32_t g = 0; g < v.nguards; g++) {
+            int32_t c = ops[opStart[v.guard[g]]];
+            uint8_t k = vecKind(v, c);
+            if ((k != VEC_UNIFORM && k != VEC_LANES) || (c >= first && v.varying->get(c - first)))
+                return false;
+        }
+        return v.counter >= 0 && v.haveElem && v.npacked > 0;
+    }
+
+    // Is 'p' a load or store of a local: straight into an alloc whose
+    // address nothing else sees?
+    bool GlobalOpt::isVecSlot(VecLoop& v, int32_t p)
+    {
+        if (v.skip->get(p - v.first) || (!ins[p]->isLoad() && !ins[p]->isStore()))
+            return false;
+        int32_t a = allocBase(p);
+        return a >= 0 && !escaped->get(a);
+    }
+
+    uint8_t GlobalOpt::vecKind(VecLoop& v, int32_t p)
+    {
+        return p < v.first ? uint8_t(VEC_UNIFORM) : v.kind[p - v.first];
+    }
+
+    // The last store to what local access 'p' reads or writes among the
+    // first 'k' in 'seq', or -1.
+    int32_t GlobalOpt::vecSlotStore(VecLoop& v, int32_t p, int32_t k)
+    {
+        while (--k >= 0) {
+            int32_t s = v.seq[k];
+            if (isVecSlot(v, s) && ins[s]->isStore() && clobbers(s, p))
+                return s;
+        }
+        return -1;
+    }
+
+    // Is 'addr' + 'disp' the address of a Vector element v[i + c], with 'i'
+    // the counter?  The base must be loaded, as a Vector's data pointer is,
+    // so that bases are equal or point to different Vectors.
+    bool GlobalOpt::isVecElement(VecLoop& v, int32_t addr, int32_t disp)
+    {
+        if (addr < v.first || !ins[addr]->isop(LIR_addq))
+            return false;
+        for (int32_t k = 0; k < 2; k++) {
+            int32_t base = vecSource(v, ops[opStart[addr] + k]);
+            int32_t x = ops[opStart[addr] + 1 - k];
+            if (vecKind(v, base) != VEC_UNIFORM || !ins[base]->isLoad() ||
+                vecKind(v, x) != VEC_LANES || v.scale[x - v.first] != 8)
+                continue;
+            int32_t key = 8 * v.off[x - v.first] + disp;
+            if (v.haveElem && key != v.elemKey)
+                return false;
+            v.haveElem = true;
+            v.elemKey = key;
+            return true;
+        }
+        return false;
+    }
+
+    // Works out how 'p' is computed in the vector loop; returns false if it
+    // can't be.
+    bool GlobalOpt::classifyVector(VecLoop& v, int32_t p)
+    {
+        LIns* i = ins[p];
+        int32_t x = p - v.first;
+        bool lanes = false;
+        bool packed = false;
+        for (int32_t k = opStart[p]; k < opStart[p+1]; k++) {
+            int32_t o = ops[k];
+            if (o < v.first) {
+                if (o >= v.point)
+                    return false;
+                continue;
+            }
+            switch (v.kind[o - v.first]) {
+            case VEC_LANES:  lanes = true;  break;
+            case VEC_PACKED: packed = true; break;
+            case VEC_NONE:   return false;
+            default:         break;
+            }
+            if (v.varying->get(o - v.first))
+                v.varying->set(x);
+        }
+
+        if (i->isop(LIR_brsavpc))
+            return !lanes && !packed && !v.varying->get(x);
+
+        if (isVecSlot(v, p)) {
+            if (i->isStore())
+                return true;
+            int32_t k = v.order[x];
+            int32_t s = vecSlotStore(v, p, k);
+            bool earlier = s >= 0;
+            if (!earlier)
+                s = vecSlotStore(v, p, v.nseq);
+            if (s < 0) {
+                v.kind[x] = VEC_UNIFORM;
+                return true;
+            }
+            if (ins[s]->disp() != i->disp() || loadOpFor(ins[s]->opcode()) != i->opcode())
+                return false;
+            int32_t val = vecSource(v, ops[opStart[s]]);
+            if (earlier) {
+                // The value stored earlier in the iteration.
+                v.same[x] = val;
+                if (val >= v.first) {
+                    int32_t y = val - v.first;
+                    v.kind[x] = v.kind[y];
+                    v.scale[x] = v.scale[y];
+                    v.off[x] = v.off[y];
+                    if (v.varying->get(y))
+                        v.varying->set(x);
+                } else {
+                    v.kind[x] = VEC_UNIFORM;
+                }
+                return true;
+            }
+            // The previous iteration's value.  The counter is the local
+            // each iteration adds one to.
+            v.carried[x] = s;
+            v.kind[x] = VEC_LANES;
+            LIns* inc = ins[val];
+            int32_t one = opStart[val] + 1;
+            bool counter = inc->isop(LIR_addi) && ins[ops[one]]->isImmI() && ins[ops[one]]->immI() == 1;
+            if (counter) {
+                int32_t ld = ops[opStart[val]];
+                counter = ld >= v.first && ins[ld]->isop(LIR_ldi) && isVecSlot(v, ld) &&
+                          clobbers(s, ld) && ins[ld]->disp() == i->disp() &&
+                          vecSlotStore(v, ld, v.order[ld - v.first]) < 0;
+            }
+            if (counter && (v.counter < 0 || (ins[v.counter]->disp() == i->disp() &&
+                                              allocBase(v.counter) == allocBase(p)))) {
+                v.counter = p;
+                v.scale[x] = 1;
+            } else {
+                v.varying->set(x);
+            }
+            return true;
+        }
+
+        if (i->isStore()) {
+            // Only Vector element stores.
+            int32_t addr = ops[opStart[p] + 1];
+            if (!i->isop(LIR_std) || !isVecElement(v, addr, i->disp()))
+                return false;
+            if (vecKind(v, ops[opStart[p]]) != VEC_LANES)
+                v.npacked++;
+            return true;
+        }
+
+        if (i->isLoad()) {
+            int32_t addr = ops[opStart[p]];
+            if (!lanes && !packed) {
+                for (int32_t k = 0; k < v.nseq; k++) {
+                    if (!v.skip->get(v.seq[k] - v.first) && clobbers(v.seq[k], p))
+                        return false;
+                }
+                v.kind[x] = VEC_UNIFORM;
+                return true;
+            }
+            if (!i->isop(LIR_ldd) || !isVecElement(v, addr, i->disp()))
+                return false;
+            v.kind[x] = VEC_PACKED;
+            v.varying->set(x);
+            return true;
+        }
+
+        if (!isNumbered(i) || i->isBranch())
+            return false;
+        if (!lanes && !packed) {
+            v.kind[x] = VEC_UNIFORM;
+            return true;
+        }
+        if (!lanes && packedOpFor(i->opcode()) != LIR_skip) {
+            v.kind[x] = VEC_PACKED;
+            v.npacked++;
+            return true;
+        }
+        v.kind[x] = VEC_LANES;
+
+        // Follow the counter through the index arithmetic.
+        int32_t a = ops[opStart[p]];
+        int32_t b = opStart[p+1] - opStart[p] > 1 ? ops[opStart[p] + 1] : -1;
+        LIns* bi = b >= 0 ? ins[vecSource(v, b)] : NULL;
+        int32_t sa = a >= v.first ? v.scale[a - v.first] : 0;
+        int32_t oa = a >= v.first ? v.off[a - v.first] : 0;
+        switch (i->opcode()) {
+        case LIR_addi:
+        case LIR_subi:
+            if (sa == 1 && bi->isImmI() && bi->immI() > -GLOBALOPT_MAX_VECTOR_OFF &&
+                bi->immI() < GLOBALOPT_MAX_VECTOR_OFF) {
+                v.scale[x] = 1;
+                v.off[x] = i->isop(LIR_addi) ? oa + bi->immI() : oa - bi->immI();
+            }
+            break;
+        case LIR_lshi:
+            if (sa > 0 && bi->isImmI() && bi->immI() >= 0 && bi->immI() <= 3 && sa << bi->immI() <= 8) {
+                v.scale[x] = sa << bi->immI();
+                v.off[x] = oa;
+            }
+            break;
+        case LIR_ui2uq:
+        case LIR_i2q:
+            v.scale[x] = sa;
+            v.off[x] = oa;
+            break;
+        default:
+            break;
+        }
+        return true;
+    }
+
+    // The value 'p' stands for: what it reads back if it's a load of a
+    // local stored earlier in the iteration.
+    int32_t GlobalOpt::vecSource(VecLoop& v, int32_t p)
+    {
+        while (p >= v.first && v.same[p - v.first] >= 0)
+            p = v.same[p - v.first];
+        return p;
+    }
+
+    LIns* GlobalOpt::vecPut(VecLoop& v, LIns* i)
+    {
+        if (v.ncode == v.capCode)
+            v.failed = true;
+        else
+            v.code[v.ncode++] = i;
+        return i;
+    }
+
+    LIns* GlobalOpt::vecUniform(VecLoop& v, int32_t p)
+    {
+        p = vecSource(v, p);
+        if (p < v.first)
+            return ins[p];
+        int32_t x = p - v.first;
+        if (v.kind[x] != VEC_UNIFORM) {
+            v.failed = true;
+            return ins[p];
+        }
+        if (!v.val[x]) {
+            LIns* a[MAXARGS];
+            for (int32_t k = opStart[p]; k < opStart[p+1]; k++)
+                a[k - opStart[p]] = vecUniform(v, ops[k]);
+            v.val[x] = vecPut(v, copyIns(*v.w, ins[p], a));
+        }
+        return v.val[x];
+    }
+
+    LIns* GlobalOpt::vecLane(VecLoop& v, int32_t p, int32_t lane)
+    {
+        p = vecSource(v, p);
+        if (p < v.first)
+            return ins[p];
+        int32_t x = p - v.first;
+        LIns** r = lane == 0 ? &v.lane0[x] : &v.lane1[x];
+        if (*r)
+            return *r;
+        LIns* result;
+        switch (v.kind[x]) {
+        case VEC_UNIFORM:
+            return vecUniform(v, p);
+        case VEC_PACKED:
+            result = vecPut(v, v.w->ins1(lane == 0 ? LIR_d2x : LIR_d2y, vecPacked(v, p)));
+            break;
+        case VEC_LANES:
+            if (v.carried[x] >= 0 && lane == 1) {
+                // What the first iteration stores.  Unless that only depends
+                // on the counter, it must have been computed by now.
+                int32_t val = vecSource(v, ops[opStart[v.carried[x]]]);
+                if (v.varying->get(x) && val >= v.first && v.order[val - v.first] > v.cur) {
+                    v.failed = true;
+                    return ins[p];
+                }
+                result = vecLane(v, val, 0);
+            } else {
+                LIns* a[MAXARGS];
+                for (int32_t k = opStart[p]; k < opStart[p+1]; k++)
+                    a[k - opStart[p]] = vecLane(v, ops[k], lane);
+                result = vecPut(v, copyIns(*v.w, ins[p], a));
+            }
+            break;
+        default:
+            v.failed = true;
+            return ins[p];
+        }
+        *r = result;
+        return result;
+    }
+
+    LIns* GlobalOpt::vecPacked(VecLoop& v, int32_t p)
+    {
+        p = vecSource(v, p);
+        if (p < v.first || v.kind[p - v.first] == VEC_UNIFORM) {
+            LIns* u = vecUniform(v, p);
+            LIns* splat = v.splats->get(u);
+            if (!splat) {
+                splat = vecPut(v, v.w->ins1(LIR_d2d2, u));
+                v.splats->put(u, splat);
+            }
+            return splat;
+        }
+        int32_t x = p - v.first;
+        if (v.kind[x] != VEC_PACKED) {
+            v.failed = true;
+            return ins[p];
+        }
+        if (!v.val[x]) {
+            LIns* i = ins[p];
+            if (i->isLoad()) {
+                LIns* addr = vecLane(v, ops[opStart[p]], 0);
+                v.val[x] = vecPut(v, v.w->insLoad(LIR_ldf4, addr, i->disp(), i->accSet(), i->loadQual()));
+            } else {
+                LIns* a = vecPacked(v, ops[opStart[p]]);
+                LIns* b = vecPacked(v, ops[opStart[p] + 1]);
+                v.val[x] = vecPut(v, v.w->ins2(packedOpFor(i->opcode()), a, b));
+            }
+        }
+        return v.val[x];
+    }
+
+    // Writes the vector loop for 'v' into v.code.  Returns false if it
+    // turned out it can't be done.
+    bool GlobalOpt::emitVector(VecLoop& v)
+    {
+        int32_t len = v.last - v.first + 1;
+        LirBuffer* buf = new (alloc) LirBuffer(alloc);
+        LirBufWriter w(buf, config);
+        v.w = &w;
+        v.val = new (alloc) LIns*[len];
+        v.lane0 = new (alloc) LIns*[len];
+        v.lane1 = new (alloc) LIns*[len];
+        VMPI_memset(v.val, 0, len * sizeof(LIns*));
+        VMPI_memset(v.lane0, 0, len * sizeof(LIns*));
+        VMPI_memset(v.lane1, 0, len * sizeof(LIns*));
+        v.splats = new (alloc) HashMap<LIns*, LIns*>(alloc);
+        v.capCode = 8 * len + 16;
+        v.code = new (alloc) LIns*[v.capCode];
+        v.ncode = 0;
+        v.failed = false;
+
+        LIns* top = vecPut(v, w.ins0(LIR_label));
+        LIns* scalar = w.ins0(LIR_label);
+
+        // The guards.  A bounds check or the loop condition leaves the loop
+        // when its branch is not taken.
+        v.cur = -1;
+        for (int32_t g = 0; g < v.nguards; g++) {
+            int32_t p = v.guard[g];
+            LIns* br = ins[p];
+            int32_t c = ops[opStart[p]];
+            bool exits = p != v.last && (target[p] < v.first || target[p] > v.last);
+            LOpcode op = exits ? br->opcode() : invertCondJmpOpcode(br->opcode());
+            if (vecKind(v, c) == VEC_UNIFORM) {
+                vecPut(v, w.insBranch(op, vecUniform(v, c), scalar));
+            } else {
+                vecPut(v, w.insBranch(op, vecLane(v, c, 0), scalar));
+                vecPut(v, w.insBranch(op, vecLane(v, c, 1), scalar));
+            }
+        }
+
+        // The body.  Loads and stores stay in order; everything else is
+        // computed when first needed.
+        for (int32_t k = 0; k < v.nseq && !v.failed; k++) {
+            int32_t p = v.seq[k];
+            int32_t x = p - v.first;
+            LIns* i = ins[p];
+            v.cur = k;
+            if (v.skip->get(x))
+                continue;
+            if (i->isop(LIR_brsavpc)) {
+                vecPut(v, w.insBranch(LIR_brsavpc, vecUniform(v, ops[opStart[p]]), i->getTarget()));
+            } else if (i->isStore()) {
+                int32_t val = ops[opStart[p]];
+                int32_t addr = ops[opStart[p] + 1];
+                if (isVecSlot(v, p)) {
+                    if (!v.dead->get(x))
+                        vecPut(v, w.insStore(i->opcode(), vecLane(v, val, 1), ins[addr], i->disp(), i->accSet()));
+                } else if (vecKind(v, val) == VEC_LANES) {
+                    LIns* base = vecLane(v, addr, 0);
+                    vecPut(v, w.insStore(LIR_std, vecLane(v, val, 0), base, i->disp(), i->accSet()));
+                    vecPut(v, w.insStore(LIR_std, vecLane(v, val, 1), base, i->disp() + 8, i->accSet()));
+                } else {
+                    LIns* base = vecLane(v, addr, 0);
+                    vecPut(v, w.insStore(LIR_stf4, vecPacked(v, val), base, i->disp(), i->accSet()));
+                }
+            } else if (i->isLoad() && v.same[x] < 0) {
+                if (v.kind[x] == VEC_PACKED)
+                    vecPacked(v, p);
+                else if (v.kind[x] == VEC_LANES)
+                    vecLane(v, p, 0);
+            }
+        }
+        vecPut(v, w.insBranch(LIR_j, NULL, top));
+        vecPut(v, scalar);
+        return !v.failed;
+    }
+#endif // NJ_PACKED_DOUBLE_SUPPORTED
+
+    bool GlobalOpt::isAvailable(int32_t v, int32_t blk, int32_t pos)
+    {
+        // The assembler rematerializes immediates wherever they're needed,
+        // so they only have to come first.
+        return defPos[v] < pos && (ins[v]->isImmAny() || dominates(defBlock[v], blk));
+    }
+
+    uint32_t GlobalOpt::hashValue(int32_t p)
+    {
+        LIns* i = ins[p];
+        uint32_t h = uint32_t(i->opcode());
+        switch (repKinds[i->opcode()]) {
+        case LRK_IorF:
+            h = h * 31 + uint32_t(i->isop(LIR_immf) ? i->immFasI() : i->immI());
+            break;
+        case LRK_QorD: {
+#ifdef NANOJIT_64BIT
+            uint64_t q = i->isop(LIR_immq) ? i->immQ() : i->immDasQ();
+#else
+            uint64_t q = i->immDasQ();
+#endif
+            h = h * 31 + uint32_t(q);
+            h = h * 31 + uint32_t(q >> 32);
+            break;
+        }
+        case LRK_F4: {
+            float4_t f4 = i->immF4();
+            uint32_t w[4];
+            VMPI_memcpy(w, &f4, sizeof(w));
+            for (int k = 0; k < 4; k++)
+                h = h * 31 + w[k];
+            break;
+        }
+        case LRK_Ld:
+            h = h * 31 + uint32_t(i->disp());
+            break;
+        case LRK_C:
+            h = h * 31 + uint32_t(uintptr_t(i->callInfo()) >> 3);
+            break;
+        case LRK_Op1b:
+            h = h * 31 + i->mask();
+            break;
+        default:
+            break;
+        }
+        for (int32_t k = opStart[p]; k < opStart[p+1]; k++)
+            h = h * 31 + uint32_t(rep[ops[k]]);
+        h ^= h >> 16;
+        h *= 0x85ebca6b;
+        h ^= h >> 13;
+        return h;
+    }
+
+    bool GlobalOpt::sameValue(int32_t a, int32_t b)
+    {
+        LIns* x = ins[a];
+        LIns* y = ins[b];
+        if (x->opcode() != y->opcode())
+            return false;
+        switch (repKinds[x->opcode()]) {
+        case LRK_IorF:
+            if (x->isop(LIR_immf) ? x->immFasI() != y->immFasI() : x->immI() != y->immI())
+                return false;
+            break;
+        case LRK_QorD:
+#ifdef NANOJIT_64BIT
+            if (x->isop(LIR_immq) ? x->immQ() != y->immQ() : x->immDasQ() != y->immDasQ())
+                return false;
+#else
+            if (x->immDasQ() != y->immDasQ())
+                return false;
+#endif
+            break;
+        case LRK_F4: {
+            float4_t f = x->immF4();
+            float4_t g = y->immF4();
+            if (VMPI_memcmp(&f, &g, sizeof(f)) != 0)
+                return false;
+            break;
+        }
+        case LRK_Ld:
+            if (x->disp() != y->disp() || x->accSet() != y->accSet() || x->loadQual() != y->loadQual())
+                return false;
+            break;
+        case LRK_C:
+            if (x->callInfo() != y->callInfo())
+                return false;
+            break;
+        case LRK_Op1b:
+            if (x->mask() != y->mask())
+                return false;
+            break;
+        default:
+            break;
+        }
+        NanoAssert(opStart[a+1] - opStart[a] == opStart[b+1] - opStart[b]);
+        for (int32_t k = 0; k < opStart[a+1] - opStart[a]; k++) {
+            if (rep[ops[opStart[a] + k]] != rep[ops[opStart[b] + k]])
+                return false;
+        }
+        return true;
+    }
+
+    bool GlobalOpt::isInvariant(int32_t p, Loop& loop, bool afterImpureCall)
+    {
+        LIns* i = ins[p];
+        if (!i->isLoad())
+            return true;
+        if (i->loadQual() == LOAD_VOLATILE || loop.fence)
+            return false;
+        if (i->loadQual() != LOAD_CONST) {
+            // Stores straight into an alloc are told apart by the range they
+            // write; they can't touch other allocs.  Nor can a call write an
+            // alloc whose address it has no way of knowing.
+            int32_t a = allocBase(p);
+            AccSet clobbered = a < 0 ? loop.stores | loop.allocStores | loop.calls
+                                     : loop.stores | (escaped->get(a) ? loop.calls : ACCSET_NONE);
+            if ((i->accSet() & clobbered) != 0)
+                return false;
+            if (a >= 0 && (i->accSet() & loop.allocStores) != 0) {
+                int32_t lo = i->disp();
+                int32_t hi = lo + accessSize(i->opcode());
+                for (int32_t k = 0; k < loop.nallocStores; k++) {
+                    LIns* st = ins[loop.allocStore[k]];
+                    if (allocBase(loop.allocStore[k]) == a && st->disp() < hi &&
+                        lo < st->disp() + accessSize(st->opcode()))
+                        return false;
+                }
+            }
+        }
+
+        // The load will run even on paths where it didn't before, so the
+        // address has to be good.  That is certain if the load is at the top
+        // of the header, which runs whenever the loop is entered; and it is
+        // assumed for params, allocs and absolute addresses.
+        if (blockOf[p] == loop.header && !afterImpureCall)
+            return true;
+        LIns* base = ins[rep[ops[opStart[p]]]];
+        return (base->isop(LIR_paramp) && base->paramKind() == 0) ||
+               base->isop(LIR_allocp) || base->isImmAny();
+    }
+
+    void GlobalOpt::hoist(int32_t p, bool afterImpureCall)
+    {
+        // The enclosing loops, outermost first.
+        static const int32_t MAX_DEPTH = 32;
+        int32_t chain[MAX_DEPTH];
+        int32_t depth = 0;
+        for (int32_t l = blocks[blockOf[p]].loop; l >= 0 && depth < MAX_DEPTH; l = loops[l].parent)
+            chain[depth++] = l;
+
+        while (depth > 0) {
+            Loop& loop = loops[chain[--depth]];
+            if (loop.point < 0 || !isInvariant(p, loop, afterImpureCall))
+                continue;
+            int32_t pos = 2 * loop.point + 1;
+            bool available = true;
+            for (int32_t k = opStart[p]; k < opStart[p+1] && available; k++)
+                available = isAvailable(rep[ops[k]], loop.entry, pos);
+            if (!available)
+                continue;
+
+            hoistTo[p] = loop.point;
+            defBlock[p] = loop.entry;
+            defPos[p] = 2 * loop.point;
+            hoistNext[p] = -1;
+            if (hoistHead[loop.point] < 0)
+                hoistHead[loop.point] = p;
+            else
+                hoistNext[hoistTail[loop.point]] = p;
+            hoistTail[loop.point] = p;
+            if (!ins[p]->isImmAny())
+                changed = true;
+            return;
+        }
+    }
+
+    void GlobalOpt::numberValues()
+    {
+        rep = new (alloc) int32_t[n];
+        hoistTo = new (alloc) int32_t[n];
+        defBlock = new (alloc) int32_t[n];
+        defPos = new (alloc) int32_t[n];
+        hoistHead = new (alloc) int32_t[n];
+        hoistTail = new (alloc) int32_t[n];
+        hoistNext = new (alloc) int32_t[n];
+
+        uint32_t cap = 64;
+        while (cap < uint32_t(n) * 2)
+            cap <<= 1;
+        int32_t* table = new (alloc) int32_t[cap];
+        for (uint32_t k = 0; k < cap; k++)
+            table[k] = -1;
+
+        bool afterImpureCall = false;
+        for (int32_t p = 0; p < n; p++) {
+            LIns* i = ins[p];
+            int32_t b = blockOf[p];
+            rep[p] = p;
+            hoistTo[p] = -1;
+            hoistHead[p] = -1;
+            defBlock[p] = b;
+            defPos[p] = 2 * p + 1;
+            if (blocks[b].first == p)
+                afterImpureCall = false;
+            if (blocks[b].rpo < 0)
+                continue;
+
+            if (isNumbered(i)) {
+                uint32_t k = hashValue(p) & (cap - 1);
+                for (; table[k] >= 0; k = (k + 1) & (cap - 1)) {
+                    int32_t c = table[k];
+                    if (sameValue(c, p) && isAvailable(c, b, 2 * p + 1)) {
+                        rep[p] = c;
+                        if (!i->isImmAny())
+                            changed = true;
+                        break;
+                    }
+                }
+                if (rep[p] == p)
+                    table[k] = p;
+            }
+            if (rep[p] == p && blocks[b].loop >= 0 && isMovable(i))
+                hoist(p, afterImpureCall);
+            if (i->isCall() && !i->callInfo()->_isPure)
+                afterImpureCall = true;
+        }
+    }
+
+    // The assembler allocates registers in one backwards pass, treating a
+    // value as live from its last use up to its definition, except that it
+    // forgets everything at a LIR_j.  Where a value defined before a loop is
+    // still needed at the loop header, that is wrong twice over: the loop
+    // body may reuse the value's register or spill slot after its last use,
+    // or after the backward branch if the last use is past it.  A LIR_live*
+    // right after the backward branch makes the assembler keep a spill slot
+    // for the value throughout the loop.
+    void GlobalOpt::extendLiveRanges()
+    {
+        lastUse = new (alloc) int32_t[n];
+        liveHead = new (alloc) int32_t[n];
+        liveNext = new (alloc) int32_t[n];
+        for (int32_t p = 0; p < n; p++)
+            lastUse[p] = liveHead[p] = -1;
+
+        int32_t nedges = 0;
+        for (int32_t p = 0; p < n; p++) {
+            if (rep[p] != p)
+                continue;
+            int32_t pos = hoistTo[p] >= 0 ? defPos[p] : 2 * p + 1;
+            for (int32_t k = opStart[p]; k < opStart[p+1]; k++) {
+                int32_t v = rep[ops[k]];
+                if (pos > lastUse[v])
+                    lastUse[v] = pos;
+                // The assembler folds a comparison into the branch or cmov
+                // that uses it, so its operands are read there as well.
+                if (ins[v]->isCmp()) {
+                    for (int32_t j = opStart[v]; j < opStart[v+1]; j++) {
+                        int32_t w = rep[ops[j]];
+                        if (pos > lastUse[w])
+                            lastUse[w] = pos;
+                    }
+                }
+            }
+            if (ins[p]->isop(LIR_jtbl)) {
+                for (uint32_t k = 0, size = ins[p]->getTableSize(); k < size; k++)
+                    nedges += posOf(ins[p]->getTarget(k)) < p;
+            } else if (target[p] >= 0) {
+                nedges += target[p] < p;
+            }
+        }
+        if (nedges == 0)
+            return;
+
+        // Backward branches, in program order.
+        int32_t* from = new (alloc) int32_t[nedges];
+        int32_t* to = new (alloc) int32_t[nedges];
+        int32_t e = 0;
+        for (int32_t p = 0; p < n; p++) {
+            if (ins[p]->isop(LIR_jtbl)) {
+                for (uint32_t k = 0, size = ins[p]->getTableSize(); k < size; k++) {
+                    int32_t t = posOf(ins[p]->getTarget(k));
+                    if (t < p) {
+                        from[e] = p;
+                        to[e++] = t;
+                    }
+                }
+            } else if (target[p] >= 0 && target[p] < p) {
+                from[e] = p;
+                to[e++] = target[p];
+            }
+        }
+
+        for (int32_t v = 0; v < n; v++) {
+            LIns* i = ins[v];
+            if (rep[v] != v || lastUse[v] < 0 || i->isV() || i->isImmAny() ||
+                (i->isop(LIR_paramp) && i->paramKind() != 0))
+                continue;
+            // Values that never leave their block are fine.
+            if (hoistTo[v] < 0 && lastUse[v] <= 2 * blocks[blockOf[v]].last + 1)
+                continue;
+
+            // A branch before the definition can't matter.
+            int32_t lo = 0, hi = nedges;
+            while (lo < hi) {
+                int32_t mid = (lo + hi) / 2;
+                if (2 * from[mid] + 1 > defPos[v])
+                    hi = mid;
+                else
+                    lo = mid + 1;
+            }
+            int32_t liveAt = -1;
+            for (int32_t k = lo; k < nedges; k++) {
+                int32_t jump = 2 * from[k] + 1;
+                int32_t label = 2 * to[k] + 1;
+                if (defPos[v] < label && label <= lastUse[v]) {
+                    if (jump > lastUse[v])
+                        lastUse[v] = jump;
+                    liveAt = from[k];
+                }
+            }
+            if (liveAt >= 0) {
+                liveNext[v] = liveHead[liveAt];
+                liveHead[liveAt] = v;
+            }
+        }
+    }
+
 #ifdef NJ_VERBOSE
     class RetiredEntry
     {
@@ -1983,6 +4559,9 @@ namespace nanojit
                 case LIR_f4z:
                 case LIR_f4w:
                 case LIR_swzf4:
+                case LIR_d2d2:
+                case LIR_d2x:
+                case LIR_d2y:
                 CASE64(LIR_q2i:)
                 case LIR_d2i:
                 CASE64(LIR_dasq:)
@@ -2056,6 +4635,10 @@ namespace nanojit
                 case LIR_subf4:
                 case LIR_mulf4:
                 case LIR_divf4:
+                case LIR_addd2:
+                case LIR_subd2:
+                case LIR_muld2:
+                case LIR_divd2:
                 case LIR_dotf4:
                 case LIR_dotf3:
                 case LIR_dotf2:
@@ -2503,6 +5086,9 @@ namespace nanojit
             case LIR_f4z:
             case LIR_f4w:
             case LIR_f2f4:
+            case LIR_d2d2:
+            case LIR_d2x:
+            case LIR_d2y:
             CASESF(LIR_dlo2i:)
             CASESF(LIR_dhi2i:)
             case LIR_noti:
@@ -2560,6 +5146,10 @@ namespace nanojit
             case LIR_subf4:
             case LIR_mulf4:
             case LIR_divf4:
+            case LIR_addd2:
+            case LIR_subd2:
+            case LIR_muld2:
+            case LIR_divd2:
             case LIR_dotf4:
             case LIR_dotf3:
             case LIR_dotf2:
@@ -4288,6 +6878,7 @@ namespace nanojit
         case LIR_lived:
         case LIR_d2i:
         case LIR_d2f:
+        case LIR_d2d2:
         CASE64(LIR_dasq:)
             formals[0] = LTy_D;
             break;
@@ -4303,6 +6894,8 @@ namespace nanojit
         case LIR_f4y:
         case LIR_f4z:
         case LIR_f4w:
+        case LIR_d2x:
+        case LIR_d2y:
             formals[0] = LTy_F4;
             break;
 
@@ -4429,6 +7022,10 @@ namespace nanojit
         case LIR_subf4:
         case LIR_mulf4:
         case LIR_divf4:
+        case LIR_addd2:
+        case LIR_subd2:
+        case LIR_muld2:
+        case LIR_divd2:
         case LIR_eqf4:
         case LIR_dotf4:
         case LIR_dotf3:
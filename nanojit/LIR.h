@@ -2559,6 +2559,162 @@ NanoStaticAssert(LIR_start == 0 && LIR_sentinel <= 256); // It's ok if LIR_senti
         LIns* read();
     };
 
+    // Stores the value operands of 'i' in 'opnds', which must have room for
+    // MAXARGS entries, in a fixed order; branch targets are not included.
+    // Returns the number of operands.
+    uint32_t valueOperands(LIns* i, LIns** opnds);
+
+    // GlobalOpt rewrites a finished fragment into a new LirBuffer, doing the
+    // optimizations that CseFilter cannot do because it only sees one basic
+    // block at a time:
+    //
+    // - Global CSE: a pure expression, a LOAD_CONST load or a pure call that
+    //   was already computed in a dominating block is reused instead of being
+    //   computed again.  Immediates are shared across the whole fragment.
+    //
+    // - Bounds check elimination: a branch around a Vector bounds check
+    //   failure path is dropped when the index is already known to be in
+    //   range, as it is in 'for (i = 0; i < v.length; i++) v[i]'.
+    //
+    // - LICM: a pure expression whose operands are all defined outside a loop
+    //   is computed once before the loop is entered.  So is a non-volatile
+    //   load if nothing in the loop can store to what it reads -- stores
+    //   straight into an alloc are told apart by displacement, others by
+    //   access region, and calls can't write an alloc whose address is never
+    //   passed on -- and it is safe to do early: either its base is a param,
+    //   an alloc or an immediate, or it sits at the top of the loop header,
+    //   before any impure call.  Instructions that can trap (divi, modi) and
+    //   calls are never moved.
+    //
+    // - Narrowing: a loop whose counter is a double local stepped by a small
+    //   integer, as a Number counter is, gets a copy in front of it that
+    //   keeps the counter as an int, and does its compares as ints, for as
+    //   long as it holds an int and doesn't overflow.  Then the original
+    //   loop takes over.  Only where NJ_F2I_SUPPORTED, and only if
+    //   config.narrow_counters is set.
+    //
+    // - Vectorization: a counted loop over Vector.<Number> elements gets a
+    //   copy in front of it that runs two iterations at a time, loading,
+    //   computing and storing pairs of elements as double2 values, while
+    //   both iterations would run straight through.  The original loop does
+    //   whatever is left.  Only where NJ_PACKED_DOUBLE_SUPPORTED, and only
+    //   if config.vectorize is set.
+    //
+    // Loop invariants go into the single block that enters the loop from
+    // outside, just before its jump or fallthrough into the loop header;
+    // loops without such a block are left alone.  Values whose live range
+    // now spans a backward branch are kept alive across it with a LIR_live*
+    // instruction, as the assembler requires.
+    //
+    // Fragments with guards or deoptimization safepoints are left unchanged,
+    // as are fragments where nothing was found to improve.
+    class GlobalOpt
+    {
+    public:
+        GlobalOpt(Allocator& alloc, const Config& config);
+
+        // Optimize 'frag', replacing frag->lirbuf and frag->lastIns.  The
+        // new buffer is allocated from 'lirAlloc'.  Returns false if the
+        // fragment was left unchanged.
+        bool run(Fragment* frag, Allocator& lirAlloc);
+
+        // The instruction that replaced 'ins' in the rewritten fragment.
+        LIns* remap(LIns* ins);
+
+    private:
+        struct Block;
+        struct Loop;
+        struct Path;
+        struct VecLoop;
+        struct NarrowLoop;
+        struct Insertions;
+
+        int32_t posOf(LIns* ins);
+        int32_t allocBase(int32_t p);
+        bool plan();
+        bool readOperands();
+        void buildBlocks();
+        void computeDominators();
+        bool eliminateChecks();
+        int32_t livePred(int32_t b);
+        bool isProvenBelow(int32_t x, int32_t bound, int32_t pos, int32_t depth);
+        bool isNonNegative(int32_t v, int32_t depth);
+        bool isEqualAt(int32_t x, int32_t y, const Path& path, int32_t depth);
+        bool isUnclobbered(int32_t p, int32_t q, const Path& path);
+        bool clobbers(int32_t s, int32_t ld);
+        void findLoops();
+        void numberValues();
+        void extendLiveRanges();
+        bool dominates(int32_t a, int32_t b);
+        bool isAvailable(int32_t v, int32_t blk, int32_t pos);
+        bool isInvariant(int32_t p, Loop& loop, bool afterImpureCall);
+        void hoist(int32_t p, bool afterImpureCall);
+        uint32_t hashValue(int32_t p);
+        bool sameValue(int32_t a, int32_t b);
+        LIns* opnd(int32_t p, int32_t k);
+        LIns* emit(LirBufWriter& w, int32_t p);
+        bool isSimpleLoop(int32_t l, int32_t& first, int32_t& last);
+        bool insertCode(Insertions& c);
+        bool narrowLoops();
+        bool isNarrowLocal(NarrowLoop& nl, int32_t p);
+        bool isNarrowStep(NarrowLoop& nl, int32_t st);
+        bool planNarrow(int32_t l, NarrowLoop& nl);
+        LIns* narrowPut(NarrowLoop& nl, LIns* i);
+        LIns* narrowVal(NarrowLoop& nl, int32_t p);
+        LIns* narrowInt(NarrowLoop& nl, int32_t p);
+        bool isNarrowCounter(NarrowLoop& nl, int32_t p);
+        LIns* narrowCompare(NarrowLoop& nl, int32_t p);
+        bool emitNarrow(NarrowLoop& nl);
+        bool vectorizeLoops();
+        bool planVector(int32_t l, VecLoop& v);
+        bool isVecSlot(VecLoop& v, int32_t p);
+        uint8_t vecKind(VecLoop& v, int32_t p);
+        int32_t vecSlotStore(VecLoop& v, int32_t p, int32_t k);
+        bool isVecElement(VecLoop& v, int32_t addr, int32_t disp);
+        bool classifyVector(VecLoop& v, int32_t p);
+        int32_t vecSource(VecLoop& v, int32_t p);
+        LIns* vecPut(VecLoop& v, LIns* i);
+        LIns* vecUniform(VecLoop& v, int32_t p);
+        LIns* vecLane(VecLoop& v, int32_t p, int32_t lane);
+        LIns* vecPacked(VecLoop& v, int32_t p);
+        bool emitVector(VecLoop& v);
+
+        Allocator& alloc;
+        const Config& config;
+        HashMap<LIns*, int32_t>* index; // instruction -> position + 1
+        int32_t n;                      // number of instructions
+        LIns** ins;                     // the instructions, by position
+        int32_t* opStart;               // ops[opStart[p] .. opStart[p+1]) are p's operands
+        int32_t* ops;
+        int32_t* target;                // branch target, -1 if none (and for jtbl)
+        BitSet* escaped;                // allocs whose address may be seen by others
+        BitSet* deadBlock;              // blocks of bounds checks assumed to pass
+        int32_t* assumedSlot;           // alloc slots assumed to be non-negative ...
+        int32_t nassumed;               // ... as alloc and displacement pairs
+        int32_t* slotStores;            // stores straight into an alloc, in order
+        int32_t nslotStores;
+        int32_t budget;                 // steps left for proving checks redundant
+        int32_t* blockOf;
+        int32_t* rep;                   // the instruction computing p's value
+        int32_t* hoistTo;               // position p is moved in front of, -1 if none
+        int32_t* defBlock;              // block p ends up in
+        int32_t* defPos;                // doubled position p ends up at
+        int32_t* lastUse;               // doubled position of p's last use
+        int32_t* hoistHead;             // instructions moved in front of p ...
+        int32_t* hoistTail;
+        int32_t* hoistNext;             // ... chained in order
+        int32_t* liveHead;              // values kept live after branch p ...
+        int32_t* liveNext;              // ... chained
+        LIns** out;                     // the rewritten instructions, by position
+        Block* blocks;
+        int32_t nblocks;
+        int32_t* rpo;                   // reachable blocks in reverse postorder
+        int32_t nrpo;
+        Loop* loops;
+        int32_t nloops;
+        bool changed;
+    };
+
     // This type is used to perform a simple interval analysis of 32-bit
     // add/sub/mul.  It lets us avoid overflow checks in some cases.
     struct Interval
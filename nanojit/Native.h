@@ -69,6 +69,11 @@
 #  define NJ_DIVI_SUPPORTED 0
 #endif
 
+// The backend implements the double2 opcodes (LIR_addd2 and friends).
+#ifndef NJ_PACKED_DOUBLE_SUPPORTED
+#  define NJ_PACKED_DOUBLE_SUPPORTED 0
+#endif
+
 #if NJ_SOFTFLOAT_SUPPORTED
     #define CASESF(x)   case x
 #else
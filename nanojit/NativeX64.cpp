@@ -493,6 +493,10 @@ namespace nanojit
     void Assembler::MULPS(   R l, R r)  { emitrr(X64_mulps,   l,r); asm_output("mulps %s, %s",   RQ(l),RQ(r)); }
     void Assembler::ADDPS(   R l, R r)  { emitrr(X64_addps,   l,r); asm_output("addps %s, %s",   RQ(l),RQ(r)); }
     void Assembler::SUBPS(   R l, R r)  { emitrr(X64_subps,   l,r); asm_output("subps %s, %s",   RQ(l),RQ(r)); }
+    void Assembler::DIVPD(   R l, R r)  { emitprr(X64_divpd,  l,r); asm_output("divpd %s, %s",   RQ(l),RQ(r)); }
+    void Assembler::MULPD(   R l, R r)  { emitprr(X64_mulpd,  l,r); asm_output("mulpd %s, %s",   RQ(l),RQ(r)); }
+    void Assembler::ADDPD(   R l, R r)  { emitprr(X64_addpd,  l,r); asm_output("addpd %s, %s",   RQ(l),RQ(r)); }
+    void Assembler::SUBPD(   R l, R r)  { emitprr(X64_subpd,  l,r); asm_output("subpd %s, %s",   RQ(l),RQ(r)); }
     void Assembler::CVTSQ2SD(R l, R r)  { emitprr(X64_cvtsq2sd,l,r); asm_output("cvtsq2sd %s, %s",RQ(l),RQ(r)); }
     void Assembler::CVTSQ2SS(R l, R r)  { emitprr(X64_cvtsq2ss,l,r); asm_output("cvtsq2ss %s, %s",RQ(l),RQ(r)); }
     void Assembler::CVTSI2SD(R l, R r)  { emitprr(X64_cvtsi2sd,l,r); asm_output("cvtsi2sd %s, %s",RQ(l),RL(r)); }
@@ -988,6 +992,10 @@ namespace nanojit
         case LIR_mulf4: MULPS(rr, rb); break;
         case LIR_addf4: ADDPS(rr, rb); break;
         case LIR_subf4: SUBPS(rr, rb); break;
+        case LIR_divd2: DIVPD(rr, rb); break;
+        case LIR_muld2: MULPD(rr, rb); break;
+        case LIR_addd2: ADDPD(rr, rb); break;
+        case LIR_subd2: SUBPD(rr, rb); break;
         }
         if (rr != ra) {
             asm_nongp_copy(rr, ra);
@@ -1301,11 +1309,14 @@ namespace nanojit
 
     void Assembler::asm_f2f4(LIns *ins) {
         LIns *a = ins->oprnd1();
-        NanoAssert(ins->isF4() && a->isF());
+        NanoAssert(ins->isF4() && (ins->isop(LIR_d2d2) ? a->isD() : a->isF()));
 
         Register rr = prepareResultReg(ins, FpRegs);
         Register rb = findRegFor(a, FpRegs);
-        PSHUFD(rr, rb, PSHUFD_MASK(0, 0, 0, 0)); 
+        if (ins->isop(LIR_d2d2))
+            PSHUFD(rr, rb, PSHUFD_MASK(0, 1, 0, 1));
+        else
+            PSHUFD(rr, rb, PSHUFD_MASK(0, 0, 0, 0)); 
         freeResourcesOf(ins);
     }
 
@@ -1334,13 +1345,16 @@ namespace nanojit
     }
     
     void Assembler::asm_f4comp(LIns *ins) {
-        NanoAssert(ins->isop(LIR_swzf4) ? ins->isF4() : ins->isF());
+        NanoAssert(ins->isop(LIR_swzf4) ? ins->isF4() :
+                   ins->isop(LIR_d2x) || ins->isop(LIR_d2y) ? ins->isD() : ins->isF());
         NanoAssert(ins->oprnd1()->isF4());
         LIns *a = ins->oprnd1();
         Register rr = prepareResultReg(ins, FpRegs);
         Register rb = findRegFor(a, FpRegs);
         switch (ins->opcode()) {
         default: NanoAssert(!"bad opcode for asm_f4comp()"); break;
+        case LIR_d2x: PSHUFD(rr, rb, PSHUFD_MASK(0, 1, 0, 1)); break;
+        case LIR_d2y: PSHUFD(rr, rb, PSHUFD_MASK(2, 3, 2, 3)); break;
         case LIR_f4x: PSHUFD(rr, rb, PSHUFD_MASK(0, 0, 0, 0)); break;
         case LIR_f4y: PSHUFD(rr, rb, PSHUFD_MASK(1, 1, 1, 1)); break;
         case LIR_f4z: PSHUFD(rr, rb, PSHUFD_MASK(2, 2, 2, 2)); break;
@@ -38,6 +38,7 @@ namespace nanojit
 #define RA_PREFERS_LSREG                1
 #define NJ_USES_IMMF4_POOL              1   // Note: doesn't use IMMD pool!
 #define NJ_SAFEPOINT_POLLING_SUPPORTED  1
+#define NJ_PACKED_DOUBLE_SUPPORTED      1
 
 // exclude R12 because ESP and R12 cannot be used as an index
 // (index=100 in SIB means "none")
@@ -190,6 +191,9 @@ namespace nanojit
         X64_divps   = 0xC05E0F4000000004LL, // divide float4 vector single-precision r[i] /= b[i]
         X64_mulps   = 0xC0590F4000000004LL, // multiply float4 vector single-precision r[i] *= b[i]
         X64_addps   = 0xC0580F4000000004LL, // add float4 vector single-precision r[i] += b[i]
+        X64_divpd   = 0xC05E0F4066000005LL, // divide packed doubles r[i] /= b[i]
+        X64_mulpd   = 0xC0590F4066000005LL, // multiply packed doubles r[i] *= b[i]
+        X64_addpd   = 0xC0580F4066000005LL, // add packed doubles r[i] += b[i]
         X64_idiv    = 0xF8F7400000000003LL, // 32bit signed div (rax = rdx:rax/r, rdx=rdx:rax%r)
         X64_imul    = 0xC0AF0F4000000004LL, // 32bit signed mul r *= b
         X64_imuli   = 0xC069400000000003LL, // 32bit signed mul r = b * immI
@@ -296,6 +300,7 @@ namespace nanojit
         X64_subsd   = 0xC05C0F40F2000005LL, // subtract scalar double r -= b
         X64_subss   = 0xC05C0F40F3000005LL, // subtract scalar single-precision r -= b
         X64_subps   = 0xC05C0F4000000004LL, // subtract float4 vector single-precision r[i] -= b[i]
+        X64_subpd   = 0xC05C0F4066000005LL, // subtract packed doubles r[i] -= b[i]
         X64_shl     = 0xE0D3400000000003LL, // 32bit left shift r <<= rcx
         X64_shlq    = 0xE0D3480000000003LL, // 64bit left shift r <<= rcx
         X64_shr     = 0xE8D3400000000003LL, // 32bit uint right shift r >>= rcx
@@ -529,6 +534,10 @@ namespace nanojit
         void MULPS(Register l, Register r);\
         void ADDPS(Register l, Register r);\
         void SUBPS(Register l, Register r);\
+        void DIVPD(Register l, Register r);\
+        void MULPD(Register l, Register r);\
+        void ADDPD(Register l, Register r);\
+        void SUBPD(Register l, Register r);\
         void CVTSQ2SD(Register l, Register r);\
         void CVTSI2SD(Register l, Register r);\
         void CVTSS2SD(Register l, Register r);\
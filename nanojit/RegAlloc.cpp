@@ -25,6 +25,7 @@ namespace nanojit
         _assembler = a;
         _managed = nInitManagedRegisters(); // was nRegisterResetAll(_allocator);
         _free = _managed;
+        _insStart = _priority;              // no instruction has started yet
 
         // At start, should have some registers free and none active.
         NanoAssert( _assembler!=NULL );
@@ -103,6 +104,10 @@ namespace nanojit
     LIns* RegAlloc::findVictim( RegisterMask allow, LIns* forIns /*= NULL*/, Register regClass /*= UnspecifiedReg*/ )
     {
         NanoAssert(allow);
+        if (LiveIntervals* intervals = _assembler->_intervals) {
+            if (LIns* vic = findIntervalVictim(intervals, allow, forIns, regClass))
+                return vic;
+        }
         LIns *ins, *vic = 0;
         int allow_pri = 0x7fffffff;
         RegisterMask vic_set = allow & activeMask();
@@ -133,6 +138,170 @@ namespace nanojit
         return vic;
     }
 
+    // Scan table for the instruction that is cheapest to evict according to
+    // 'intervals', leaving alone those the current instruction uses.  Returns
+    // NULL if there are no others.
+    LIns* RegAlloc::findIntervalVictim( LiveIntervals* intervals, RegisterMask allow, LIns* forIns, Register regClass )
+    {
+        LIns *ins, *vic = 0;
+        RegisterMask vic_set = allow & activeMask();
+        for (Register r = lsReg(vic_set); vic_set; r = nextLsReg(vic_set, r))
+        {
+            ins = getActive(r);
+            if (!ins || getPriority(r) >= _insStart)
+                continue;
+#ifdef RA_REGISTERS_OVERLAP
+            Register r1 = ins->getReg(); // may be wider than r
+            if (forIns && firstAvailableReg(forIns, regClass, (_free | rmask(r1)) & allow) == UnspecifiedReg) {
+                // evicting this instruction wouldn't help; find another one
+                continue;
+            }
+#else
+            (void) forIns; (void) regClass;
+#endif
+            if (!vic || intervals->cheaperToEvict(ins, vic))
+                vic = ins;
+        }
+        return vic;
+    }
+
+    LiveIntervals::LiveIntervals(Allocator& alloc)
+        : alloc(alloc), index(NULL), n(0), weight(NULL),
+          useStart(NULL), useEnd(NULL), uses(NULL), current(0)
+    {}
+
+    void LiveIntervals::build(LIns* lastIns)
+    {
+        LirReader counter(lastIns);
+        for (LIns* i = counter.read(); ; i = counter.read()) {
+            n++;
+            if (i->isop(LIR_start))
+                break;
+        }
+
+        LIns** ins = new (alloc) LIns*[n];
+        index = new (alloc) HashMap<LIns*, int32_t>(alloc, n);
+        LirReader reader(lastIns);
+        for (int32_t p = n - 1; p >= 0; p--) {
+            ins[p] = reader.read();
+            index->put(ins[p], p + 1);
+        }
+
+        // A backward branch and its target bound a loop; each position
+        // counts the loops around it.
+        int32_t* depth = new (alloc) int32_t[n + 1];
+        useStart = new (alloc) int32_t[n + 1];
+        useEnd = new (alloc) int32_t[n];
+        VMPI_memset(depth, 0, (n + 1) * sizeof(int32_t));
+        VMPI_memset(useStart, 0, (n + 1) * sizeof(int32_t));
+        LIns* opnds[MAXARGS];
+        for (int32_t p = 0; p < n; p++) {
+            LIns* i = ins[p];
+            if (i->isop(LIR_jtbl)) {
+                for (uint32_t k = 0, size = i->getTableSize(); k < size; k++) {
+                    int32_t t = posOf(i->getTarget(k));
+                    if (t >= 0 && t < p) {
+                        depth[t]++;
+                        depth[p + 1]--;
+                    }
+                }
+            } else if (i->isBranch()) {
+                int32_t t = posOf(i->getTarget());
+                if (t >= 0 && t < p) {
+                    depth[t]++;
+                    depth[p + 1]--;
+                }
+            }
+            uint32_t count = valueOperands(i, opnds);
+            for (uint32_t k = 0; k < count; k++) {
+                int32_t o = posOf(opnds[k]);
+                if (o >= 0)
+                    useStart[o + 1]++;
+            }
+        }
+
+        weight = new (alloc) uint32_t[n];
+        for (int32_t p = 0, d = 0; p < n; p++) {
+            d += depth[p];
+            weight[p] = 1u << (3 * (d < 5 ? d : 5));
+            useStart[p + 1] += useStart[p];
+            useEnd[p] = useStart[p];
+        }
+
+        // Uses are recorded in increasing order, so the last of each value's
+        // uses is the first one the assembler reaches.
+        uses = new (alloc) int32_t[useStart[n] > 0 ? useStart[n] : 1];
+        for (int32_t p = 0; p < n; p++) {
+            uint32_t count = valueOperands(ins[p], opnds);
+            for (uint32_t k = 0; k < count; k++) {
+                int32_t o = posOf(opnds[k]);
+                if (o >= 0)
+                    uses[useEnd[o]++] = p;
+            }
+        }
+        current = n - 1;
+    }
+
+    int32_t LiveIntervals::posOf(LIns* ins)
+    {
+        return ins ? index->get(ins) - 1 : -1;
+    }
+
+    void LiveIntervals::reached(LIns* ins)
+    {
+        int32_t p = posOf(ins);
+        if (p < 0)
+            return;
+        current = p;
+        LIns* opnds[MAXARGS];
+        uint32_t count = valueOperands(ins, opnds);
+        for (uint32_t k = 0; k < count; k++) {
+            int32_t o = posOf(opnds[k]);
+            while (o >= 0 && useEnd[o] > useStart[o] && uses[useEnd[o] - 1] >= p)
+                useEnd[o]--;
+        }
+    }
+
+    // The cost of restoring 'ins' here, and of spilling it where it is
+    // defined unless that is already done.
+    uint32_t LiveIntervals::spillWeight(LIns* ins)
+    {
+        int32_t p = posOf(ins);
+        if (p < 0)
+            return weight[current];
+        return weight[current] + (ins->isInAr() ? 0 : weight[p]);
+    }
+
+    // How many instructions above the current point 'ins' is next needed in
+    // a register, by a use or by its definition.
+    int32_t LiveIntervals::distance(LIns* ins)
+    {
+        int32_t p = posOf(ins);
+        if (p < 0)
+            return 1;
+        int32_t next = useEnd[p] > useStart[p] ? uses[useEnd[p] - 1] : p;
+        return current > next ? current - next : 1;
+    }
+
+    bool LiveIntervals::isLoopInvariant(LIns* ins, LIns* label)
+    {
+        int32_t p = posOf(ins);
+        int32_t l = posOf(label);
+        return p >= 0 && p < l && useEnd[p] > useStart[p] && uses[useEnd[p] - 1] > l;
+    }
+
+    bool LiveIntervals::cheaperToEvict(LIns* a, LIns* b)
+    {
+        // Rematerializable values cost nothing to evict.
+        bool rematA = RegAlloc::canRemat(a);
+        bool rematB = RegAlloc::canRemat(b);
+        if (rematA || rematB)
+            return rematA && !rematB;
+        uint64_t costA = uint64_t(spillWeight(a)) * uint64_t(distance(b));
+        uint64_t costB = uint64_t(spillWeight(b)) * uint64_t(distance(a));
+        return costA < costB;
+    }
+
     // Allocates a SPECIFIC register to the instruction; Asserts that it can
     // be allocated.
     // Always returns r
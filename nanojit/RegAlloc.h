@@ -12,6 +12,7 @@
 namespace nanojit
 {
     class Assembler;
+    class LiveIntervals;
 
 #define IS_REG_IN_MASK(r,m)   (((m) & rmask(r)) != 0)
 #define IS_MASK_IN_MASK(rm,m)  (((m) & rm) == rm)
@@ -113,6 +114,11 @@ inline Register nextMsReg(RegisterMask& mask,Register r)
         bool                isFree(Register r) const      { return IS_REG_IN_MASK(r,_free); }
         int32_t             getPriority(Register r);
 
+        // Called as the assembler starts on each instruction.  Registers used
+        // from here on belong to the instruction's own operands and result,
+        // and the interval allocator must not choose them as victims.
+        void                startIns()                    { _insStart = _priority; }
+
         // Return a mask containing the active registers.  For each register
         // in this set, getActive(register) will be a nonzero LIns pointer.
         RegisterMask        activeMask() const            { return ~_free  & _managed; }
@@ -150,9 +156,12 @@ inline Register nextMsReg(RegisterMask& mask,Register r)
         RegisterMask    _free;                   // Registers currently free.
         RegisterMask    _managed;                // Registers under management (invariant).
         int32_t         _priority;
+        int32_t         _insStart;               // _priority when the current instruction started;
+                                                 // zeroed by the constructor, reset by initialize()
         Assembler*      _assembler;              // the assembler that initialized this RegAlloc
 
         LIns* findVictim( RegisterMask allow, LIns* forIns = NULL, Register regClass = UnspecifiedReg );
+        LIns* findIntervalVictim( LiveIntervals* intervals, RegisterMask allow, LIns* forIns, Register regClass );
 
     public:
         // Platform-specific methods
@@ -170,6 +179,55 @@ inline Register nextMsReg(RegisterMask& mask,Register r)
         DECLARE_PLATFORM_REGALLOC();
     };
 
+    // LiveIntervals gives the register allocator a view of the whole fragment
+    // when Config::regalloc_intervals is set.  Before any code is generated it
+    // numbers the instructions, records the positions at which each value is
+    // used, and finds the loop nesting depth of each position from the
+    // backward branches.  As the assembler walks the fragment backwards it
+    // reports each instruction it reaches, so that for any value in a register
+    // we know the next position above that needs it, i.e. the end of the
+    // register live range that evicting it would cut short.
+    //
+    // RegAlloc uses this instead of recency when it has to evict: the victim
+    // is the value with the lowest spill weight per instruction freed.  The
+    // weight is the cost of the restore at the current point plus that of the
+    // spill at the value's definition if it doesn't already have a stack slot,
+    // each scaled by 8 for every loop level it sits in.  The assembler also
+    // uses it at conditional back edges to keep values computed before the
+    // loop in registers, rather than reloading them on every iteration.
+    class LiveIntervals
+    {
+    public:
+        LiveIntervals(Allocator& alloc);
+
+        // Number the instructions of the fragment ending with 'lastIns'.
+        void build(LIns* lastIns);
+
+        // The assembler has reached 'ins', whose operands are used here.
+        void reached(LIns* ins);
+
+        // Is evicting 'a' at the current point cheaper than evicting 'b'?
+        bool cheaperToEvict(LIns* a, LIns* b);
+
+        // Is 'ins' computed before 'label' and used between it and the
+        // current point, i.e. an invariant of the loop they bound?
+        bool isLoopInvariant(LIns* ins, LIns* label);
+
+    private:
+        int32_t posOf(LIns* ins);
+        uint32_t spillWeight(LIns* ins);
+        int32_t distance(LIns* ins);
+
+        Allocator& alloc;
+        HashMap<LIns*, int32_t>* index; // instruction -> position + 1
+        int32_t n;                      // number of instructions
+        uint32_t* weight;               // execution weight of each position
+        int32_t* useStart;              // uses[useStart[p] .. useEnd[p]) are the positions
+        int32_t* useEnd;                // ... above the current point that use p
+        int32_t* uses;
+        int32_t current;                // position the assembler has reached
+    };
+
     /************** Inline method implementations for class RegAlloc  ********************/
 
     inline void RegAlloc::useActive(Register r)
@@ -60,6 +60,9 @@ namespace nanojit
         VMPI_memset(this, 0, sizeof(*this));
 
         cseopt = true;
+        globalopt = true;
+        vectorize = true;
+        narrow_counters = true;
         harden_function_alignment = false;
         harden_nop_insertion = false;
         check_page_flags = false;
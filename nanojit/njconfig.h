@@ -43,6 +43,24 @@ namespace nanojit
         // If true, use CSE.
         uint32_t cseopt:1;
 
+        // If true, use global CSE and loop-invariant code motion (GlobalOpt).
+        uint32_t globalopt:1;
+
+        // If true, choose registers to spill using live intervals and loop
+        // depths computed over the whole fragment (LiveIntervals) instead of
+        // by how recently they were used.
+        uint32_t regalloc_intervals:1;
+
+        // If true, GlobalOpt also rewrites counted loops over arrays of
+        // doubles to handle two elements at a time, where the backend has
+        // the double2 opcodes (NJ_PACKED_DOUBLE_SUPPORTED).
+        uint32_t vectorize:1;
+
+        // If true, GlobalOpt also gives loops with a double counter that
+        // holds an int a copy that keeps it as an int, where the backend
+        // has LIR_d2i (NJ_F2I_SUPPORTED).
+        uint32_t narrow_counters:1;
+
         // Can we use SSE2 instructions? (x86-only)
         uint32_t i386_sse2:1;
 
@@ -8,6 +8,76 @@
 
 namespace avmshell
 {
+    vmbase::RecursiveMutex MappedFile::m_lock;
+    MappedFile* MappedFile::m_files = NULL;
+
+    MappedFile::MappedFile(const char* filename, const uint8_t* buffer, size_t size, size_t mappedSize, const FileStamp& stamp)
+        : m_mappedSize(mappedSize)
+        , m_stamp(stamp)
+        , m_next(NULL)
+    {
+        this->buffer = buffer;
+        this->size = size;
+        m_filename = mmfx_new_array(char, VMPI_strlen(filename) + 1);
+        VMPI_strcpy(m_filename, filename);
+    }
+
+    MappedFile::~MappedFile()
+    {
+        Platform::GetInstance()->unmapFile(buffer, m_mappedSize);
+        mmfx_delete_array(m_filename);
+    }
+
+    /* virtual */ void MappedFile::destroy()
+    {
+        mmfx_delete(this);
+    }
+
+    /* static */ MappedFile* MappedFile::open(const char* filename)
+    {
+        SCOPE_LOCK_NO_SP(m_lock) {
+            FileStamp stamp;
+            if (!Platform::GetInstance()->stampFile(filename, &stamp))
+                return NULL;
+            for (MappedFile** p = &m_files; *p != NULL; p = &(*p)->m_next) {
+                MappedFile* f = *p;
+                if (VMPI_strcmp(f->m_filename, filename) == 0) {
+                    if (f->m_stamp == stamp)
+                        return f;
+                    // the file has changed; buffers still using the old
+                    // mapping keep it alive
+                    *p = f->m_next;
+                    f->DecrementRef();
+                    break;
+                }
+            }
+
+            size_t size, mappedSize;
+            const uint8_t* buffer = Platform::GetInstance()->mapFile(filename, avmplus::kBufferPadding, &size, &mappedSize, &stamp);
+            if (buffer == NULL)
+                return NULL;
+
+            // The cache holds one reference, dropped by closeAll().
+            MappedFile* f = mmfx_new(MappedFile(filename, buffer, size, mappedSize, stamp));
+            f->IncrementRef();
+            f->m_next = m_files;
+            m_files = f;
+            return f;
+        }
+        return NULL;
+    }
+
+    /* static */ void MappedFile::closeAll()
+    {
+        SCOPE_LOCK_NO_SP(m_lock) {
+            while (m_files != NULL) {
+                MappedFile* f = m_files;
+                m_files = f->m_next;
+                f->DecrementRef();
+            }
+        }
+    }
+
     FileInputStream::FileInputStream(const char *filename)
     {
         file = Platform::GetInstance()->createFile();
@@ -45,6 +45,48 @@ namespace avmshell
         File *file;
         int64_t len;
     };
+
+    /**
+     * MappedFile is a read-only memory mapping of an abc or swf file,
+     * used as the bytes of a SharedScriptBufferImpl so that loading the
+     * file neither copies it nor reads it all up front.  Mappings are
+     * cached by file name and FileStamp for the life of the process, so
+     * every worker that loads the same file shares one copy of its pages,
+     * and one that loads it after it has been rewritten gets a new mapping.
+     * Truncating a file that is still mapped and in use makes reading the
+     * lost pages fault, as it would for any mapped file.
+     */
+    class MappedFile : public avmplus::SharedScriptBufferImpl::Bytes
+    {
+    public:
+        /**
+         * Return the mapping of 'filename' as it is now, creating it on
+         * first use or when the file has changed since it was mapped, or
+         * NULL if the platform cannot map it, in which case the caller
+         * should read it with a FileInputStream instead.
+         */
+        static MappedFile* open(const char* filename);
+
+        /**
+         * Drop the cache's references to all mappings.  Mappings still
+         * used by a ScriptBuffer are released with their last buffer.
+         */
+        static void closeAll();
+
+        virtual void destroy();
+        virtual ~MappedFile();
+
+    private:
+        MappedFile(const char* filename, const uint8_t* buffer, size_t size, size_t mappedSize, const FileStamp& stamp);
+
+        char* m_filename;
+        size_t m_mappedSize;
+        FileStamp m_stamp;
+        MappedFile* m_next;
+
+        static vmbase::RecursiveMutex m_lock;
+        static MappedFile* m_files;     // protected by m_lock
+    };
 }
 
 #endif /* __avmshell_FileInputStream__ */
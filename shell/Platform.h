@@ -19,6 +19,25 @@ namespace avmshell
 
     class File;
 
+    /**
+    * Tells one version of a file from another: which file it is, when it was
+    * last written and how big it is.  Stamps of the same file differ once it
+    * has been rewritten, replaced or truncated.
+    */
+    struct FileStamp
+    {
+        uint64_t volume;        // st_dev, or the volume serial number
+        uint64_t file;          // st_ino, or the file index
+        uint64_t modified;      // time of the last write, in the platform's units
+        uint64_t size;
+
+        bool operator==(const FileStamp& other) const
+        {
+            return volume == other.volume && file == other.file &&
+                   modified == other.modified && size == other.size;
+        }
+    };
+
     /**
     * Abstract base class representing the platform on which avm is ported to.
     * The class defines APIs that need to be implemented by the platform
@@ -62,6 +81,59 @@ namespace avmshell
         */
         virtual void destroyFile(File* file) = 0;
 
+        /**
+        * Method to map a file read-only into memory
+        * The mapping is followed by at least 'padding' readable bytes, which is what
+        * the abc parser expects of a ScriptBuffer.
+        * @param filename name of the file to map.  File name is UTF-8 encoded
+        * @param padding number of readable bytes required past the end of the file
+        * @param fileSize receives the size of the file
+        * @param mappedSize receives the size of the mapping, to be passed to unmapFile
+        * @param stamp receives the stamp of the file that was mapped
+        * @return start of the mapping, NULL if the platform cannot map the file; callers
+        *         should then read it through createFile
+        * @see unmapFile()
+        */
+        virtual const uint8_t* mapFile(const char* filename, size_t padding, size_t* fileSize, size_t* mappedSize, FileStamp* stamp) = 0;
+
+        /**
+        * Method to get the stamp of a file as it is now
+        * @param filename name of the file.  File name is UTF-8 encoded
+        * @param stamp receives the stamp
+        * @return false if the file cannot be found
+        * @see mapFile()
+        */
+        virtual bool stampFile(const char* filename, FileStamp* stamp) = 0;
+
+        /**
+        * Method to get the stamp of the running executable
+        * @param stamp receives the stamp
+        * @return false if the platform cannot locate the executable
+        * @see stampFile()
+        */
+        virtual bool stampExecutable(FileStamp* stamp) = 0;
+
+        /**
+        * Method to replace the contents of a file as one operation
+        * The data is written to a new file next to 'filename', which is then
+        * renamed over it, so that readers see either the old or the new
+        * contents and concurrent writers do not interleave.
+        * @param filename name of the file.  File name is UTF-8 encoded
+        * @param data the new contents
+        * @param size length of data in bytes
+        * @return false if the file could not be written; it is then unchanged
+        */
+        virtual bool replaceFile(const char* filename, const uint8_t* data, size_t size) = 0;
+
+        /**
+        * Method to release a mapping created via mapFile
+        * @param addr start of the mapping
+        * @param mappedSize size of the mapping as returned by mapFile
+        * @return none
+        * @see mapFile()
+        */
+        virtual void unmapFile(const uint8_t* addr, size_t mappedSize) = 0;
+
         /**
         * Method for setting up logging functionality
         * A platform can implement this method to open a file for logging messages
@@ -7,6 +7,16 @@
 #include "PosixPartialPlatform.h"
 #include "PosixFile.h"
 
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#if defined(__APPLE__)
+#include <mach-o/dyld.h>
+#endif
+
 namespace avmshell
 {
     void PosixPartialPlatform::exit(int code)
@@ -24,6 +34,124 @@ namespace avmshell
         mmfx_delete( file );
     }
 
+    static void stampOf(const struct stat& st, FileStamp* stamp)
+    {
+        stamp->volume = uint64_t(st.st_dev);
+        stamp->file = uint64_t(st.st_ino);
+#if defined(__APPLE__)
+        stamp->modified = uint64_t(st.st_mtimespec.tv_sec) * 1000000000 + uint64_t(st.st_mtimespec.tv_nsec);
+#elif defined(__linux__) && !defined(__ANDROID__)
+        stamp->modified = uint64_t(st.st_mtim.tv_sec) * 1000000000 + uint64_t(st.st_mtim.tv_nsec);
+#else
+        stamp->modified = uint64_t(st.st_mtime) * 1000000000;
+#endif
+        stamp->size = uint64_t(st.st_size);
+    }
+
+    bool PosixPartialPlatform::stampFile(const char* filename, FileStamp* stamp)
+    {
+        struct stat st;
+        if (::stat(filename, &st) != 0)
+            return false;
+        stampOf(st, stamp);
+        return true;
+    }
+
+    bool PosixPartialPlatform::stampExecutable(FileStamp* stamp)
+    {
+#if defined(__linux__)
+        return stampFile("/proc/self/exe", stamp);
+#elif defined(__APPLE__)
+        char path[1024];
+        uint32_t size = sizeof(path);
+        if (_NSGetExecutablePath(path, &size) != 0)
+            return false;
+        return stampFile(path, stamp);
+#else
+        (void)stamp;
+        return false;
+#endif
+    }
+
+    bool PosixPartialPlatform::replaceFile(const char* filename, const uint8_t* data, size_t size)
+    {
+        size_t length = VMPI_strlen(filename);
+        char* temp = new char[length + 8];
+        VMPI_strcpy(temp, filename);
+        VMPI_strcpy(temp + length, ".XXXXXX");
+
+        bool written = false;
+        int fd = mkstemp(temp);
+        if (fd >= 0)
+        {
+            // mkstemp makes the file private; give it the usual permissions.
+            mode_t mask = umask(0);
+            umask(mask);
+            written = fchmod(fd, 0666 & ~mask) == 0;
+            size_t done = 0;
+            while (written && done < size)
+            {
+                ssize_t n = ::write(fd, data + done, size - done);
+                if (n > 0)
+                    done += size_t(n);
+                else if (n < 0 && errno == EINTR)
+                    continue;
+                else
+                    written = false;
+            }
+            if (::close(fd) != 0)
+                written = false;
+            if (written && ::rename(temp, filename) != 0)
+                written = false;
+            if (!written)
+                ::unlink(temp);
+        }
+        delete [] temp;
+        return written;
+    }
+
+    const uint8_t* PosixPartialPlatform::mapFile(const char* filename, size_t padding, size_t* fileSize, size_t* mappedSize, FileStamp* stamp)
+    {
+        int fd = ::open(filename, O_RDONLY);
+        if (fd < 0)
+            return NULL;
+
+        const uint8_t* result = NULL;
+        struct stat st;
+        if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0 && (uint64_t)st.st_size < UINT32_T_MAX)
+        {
+            const size_t size = (size_t)st.st_size;
+            const size_t pageSize = (size_t)sysconf(_SC_PAGESIZE);
+            const size_t total = (size + padding + pageSize - 1) & ~(pageSize - 1);
+
+            // Reserve zero pages for the file plus padding, then map the file over
+            // the front of them.  Reading past the end of a file mapping faults
+            // once it crosses into a page the file does not reach.
+            void* base = mmap(NULL, total, PROT_READ, MAP_PRIVATE | MAP_ANON, -1, 0);
+            if (base != MAP_FAILED)
+            {
+                if (mmap(base, size, PROT_READ, MAP_PRIVATE | MAP_FIXED, fd, 0) != MAP_FAILED)
+                {
+                    result = (const uint8_t*)base;
+                    *fileSize = size;
+                    *mappedSize = total;
+                    stampOf(st, stamp);
+                }
+                else
+                {
+                    munmap(base, total);
+                }
+            }
+        }
+        ::close(fd);
+        return result;
+    }
+
+    void PosixPartialPlatform::unmapFile(const uint8_t* addr, size_t mappedSize)
+    {
+        munmap((void*)addr, mappedSize);
+    }
+
     void PosixPartialPlatform::initializeLogging(const char* filename)
     {
         FILE *f = freopen(filename, "w", stdout);
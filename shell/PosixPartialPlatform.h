@@ -21,6 +21,12 @@ namespace avmshell
         virtual File* createFile();
         virtual void destroyFile(File* file);
 
+        virtual const uint8_t* mapFile(const char* filename, size_t padding, size_t* fileSize, size_t* mappedSize, FileStamp* stamp);
+        virtual bool stampFile(const char* filename, FileStamp* stamp);
+        virtual bool stampExecutable(FileStamp* stamp);
+        virtual bool replaceFile(const char* filename, const uint8_t* data, size_t size);
+        virtual void unmapFile(const uint8_t* addr, size_t mappedSize);
+
         virtual void initializeLogging(const char* filename);
 
         virtual int logMessage(const char* message);
@@ -33,6 +33,10 @@ namespace avmshell
         , drc(true)
         , drcValidation(false)
         , markstackAllowance(0)
+        , markerThreads(0)
+        , sweeperThreads(0)
+        , nurserySize(0)
+        , blockCacheSize(-1)
         , fixedcheck(true)
         , gcthreshold(0)
         , langID(-1)
@@ -44,9 +48,20 @@ namespace avmshell
         , jitconfig()
         , osr_enabled(avmplus::AvmCore::osr_enabled_default)
         , osr_threshold(avmplus::AvmCore::osr_threshold_default)
+        , jit_threads(avmplus::AvmCore::jit_threads_default)
+        , regex_jit_threshold(avmplus::AvmCore::regex_jit_threshold_default)
+#ifdef VMCFG_HALFMOON
+        , tierup_threshold(avmplus::AvmCore::tierup_threshold_default)
+        , tierprofile_threshold(avmplus::AvmCore::tierprofile_threshold_default)
+        , tierstats(false)
+#endif
+        , jitProfileFile(NULL)
+        , jitProfile(NULL)
         , jitprof_level(avmplus::AvmCore::jitprof_level_default)
+        , cachestats(false)
         , policyRulesArg(NULL)
 #endif
+        , regexstats(false)
         , st_component(NULL)
         , st_category(NULL)
         , st_name(NULL)
@@ -385,6 +400,13 @@ namespace avmshell
         config.njconfig = settings.njconfig;
         config.jitconfig = settings.jitconfig;
         config.osr_threshold = settings.osr_threshold;
+        config.jit_threads = settings.jit_threads;
+        config.regex_jit_threshold = settings.regex_jit_threshold;
+#ifdef VMCFG_HALFMOON
+        config.tierup_threshold = settings.tierup_threshold;
+        config.tierprofile_threshold = settings.tierprofile_threshold;
+#endif
+        config.jitProfile = settings.jitProfile;
         config.jitprof_level = settings.jitprof_level;
         config.compilePolicyRules = settings.policyRulesArg;
 #endif
@@ -484,16 +506,22 @@ namespace avmshell
             console << "run " << filename << "\n";
 #endif
 
-        FileInputStream f(filename);
-        bool isValid = f.valid() && ((uint64_t)f.length() < UINT32_T_MAX); //currently we cannot read files > 4GB
-        if (!isValid) {
-            console << "cannot open file: " << filename << "\n";
-            return(1);
+        // parse new bytecode, straight from a mapping of the file if we can
+        avmplus::ScriptBuffer code;
+        if (MappedFile* mapped = MappedFile::open(filename)) {
+            code = new (GetGC()) avmplus::SharedScriptBufferImpl(mapped);
         }
+        else {
+            FileInputStream f(filename);
+            bool isValid = f.valid() && ((uint64_t)f.length() < UINT32_T_MAX); //currently we cannot read files > 4GB
+            if (!isValid) {
+                console << "cannot open file: " << filename << "\n";
+                return(1);
+            }
 
-        // parse new bytecode
-        avmplus::ScriptBuffer code = newScriptBuffer((size_t)f.available());
-        f.read(code.getBuffer(), (size_t)f.available());
+            code = newScriptBuffer((size_t)f.available());
+            f.read(code.getBuffer(), (size_t)f.available());
+        }
 
 #ifdef DEBUGGER
         if (settings.enter_debugger_on_launch)
@@ -18,6 +18,10 @@ namespace avmplus
     {
         class ST_mmgc_dependent;
     }
+    namespace ST_avmplus_json
+    {
+        class ST_avmplus_json;
+    }
 }
 
 namespace avmshell
@@ -56,6 +60,10 @@ namespace avmshell
         bool drc;                       // copy to each GC
         bool drcValidation;             // copy to each GC
         int32_t markstackAllowance;     // copy to each GC;
+        uint32_t markerThreads;         // copy to each GC
+        uint32_t sweeperThreads;        // copy to each GC
+        uint32_t nurserySize;           // copy to each GC
+        int32_t blockCacheSize;         // copy to each GC if >= 0
         bool fixedcheck;                // copy to each GC
         int gcthreshold;                // copy to each GC
         int langID;                     // copy to ShellCore?
@@ -67,9 +75,20 @@ namespace avmshell
         avmplus::JitConfig jitconfig;   // copy to config
         bool osr_enabled;               // copy to config
         uint32_t osr_threshold;         // copy to config
+        uint32_t jit_threads;           // copy to config
+        uint32_t regex_jit_threshold;   // copy to config
+#ifdef VMCFG_HALFMOON
+        uint32_t tierup_threshold;      // copy to config
+        uint32_t tierprofile_threshold; // copy to config
+        bool tierstats;                 // dump tiered compilation counters after running
+#endif
+        const char* jitProfileFile;     // -jitprofile file, or NULL
+        avmplus::JitProfile* jitProfile; // copy to config; loaded from and saved to jitProfileFile
         uint32_t jitprof_level;         // Log level for jit profiling
+        bool cachestats;                // dump binding cache counters after running
         const char* policyRulesArg;     // copy to config (raw unprocessed)
 #endif
+        bool regexstats;                // dump regex cache and regex jit counters after running
         avmplus::AvmCore::CacheSizes cacheSizes; // Default to unlimited
         const char* st_component;
         const char* st_category;
@@ -106,6 +125,7 @@ namespace avmshell
         friend class avmplus::DomainObject;
         friend class avmplus::ST_avmplus_vector_accessors::ST_avmplus_vector_accessors;
         friend class avmplus::ST_mmgc_dependent::ST_mmgc_dependent;
+        friend class avmplus::ST_avmplus_json::ST_avmplus_json;
         friend class Shell; // access to shell_toplevel
     public:
         /**
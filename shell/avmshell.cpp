@@ -7,6 +7,7 @@
 #include "avmshell.h"
 #ifdef VMCFG_NANOJIT
 #include "../nanojit/nanojit.h"
+#include "exec-jitprofile.h"
 #endif
 #include <float.h>
 
@@ -109,6 +110,11 @@ namespace avmshell
             if (instance->settings.do_log)
               initializeLogging(instance->settings.numfiles > 0 ? instance->settings.filenames[0] : "AVMLOG");
 
+#ifdef VMCFG_NANOJIT
+            if (instance->settings.jitProfileFile)
+                loadJitProfile(instance->settings);
+#endif
+
 #ifdef VMCFG_WORKERTHREADS
             if (instance->settings.numworkers == 1 && instance->settings.numthreads == 1 && instance->settings.repeats == 1) 
             {
@@ -128,6 +134,11 @@ namespace avmshell
 			isolate->run();
 #endif
             instance->waitUntilNoIsolates();
+            MappedFile::closeAll();
+#ifdef VMCFG_NANOJIT
+            if (instance->settings.jitProfile)
+                saveJitProfile(instance->settings);
+#endif
             // Shell is refcounted now
             //mmfx_delete(instance);
         }
@@ -145,29 +156,33 @@ namespace avmshell
     void ShellIsolate::copyByteCode(avmplus::ByteArrayObject* ba)
     {
         if (ba != NULL) {
-			Isolate::copyByteCode(ba);
+            Isolate::copyByteCode(ba);
+        }
+        else
+        {
+            Shell* shell = static_cast<Shell*> (getAggregate());
+            int numfiles = shell->settings.numfiles;
+            char** filenames = shell->settings.filenames;
+
+            m_code.allocate(numfiles);
+            m_mapped.allocate(numfiles);
+            for (int i = 0; i < numfiles; i++) {
+                char* filename = filenames[i];
+                m_mapped.values[i] = MappedFile::open(filename);
+                if (m_mapped.values[i] != NULL)
+                    continue;
+                FileInputStream f(filename);
+                const bool isValid = f.valid() && ((uint64_t)f.length() < UINT32_T_MAX); //currently we cannot read files > 4GB
+                if (isValid) {
+                    // parse new bytecode
+                    //avmplus::ScriptBuffer code = targetCore()->newScriptBuffer((size_t)f.available());
+                    //(f.read(buf), (size_t)f.available();
+                    size_t avail = (size_t)f.available();
+                    m_code.values[i].allocate((int)avail);
+                    f.read(m_code.values[i].values, avail);
+                }
+            }
         }
-		else 
-		{
-			Shell* shell = static_cast<Shell*> (getAggregate());
-			int numfiles = shell->settings.numfiles;
-			char** filenames = shell->settings.filenames;
-			
-			m_code.allocate(numfiles);
-			for (int i = 0; i < numfiles; i++) {
-				char* filename = filenames[i];
-				FileInputStream f(filename);
-				const bool isValid = f.valid() && ((uint64_t)f.length() < UINT32_T_MAX); //currently we cannot read files > 4GB
-				if (isValid) {
-					// parse new bytecode
-					//avmplus::ScriptBuffer code = targetCore()->newScriptBuffer((size_t)f.available());
-					//(f.read(buf), (size_t)f.available();
-					size_t avail = (size_t)f.available();
-					m_code.values[i].allocate((int)avail);
-					f.read(m_code.values[i].values, avail);
-				}
-			}
-		}
     }
 
     /*virtual*/ void ShellIsolate::doRun()
@@ -236,15 +251,22 @@ namespace avmshell
             // execute event loop at the end of the last script
             if (i == (m_code.length - 1) && !isPrimordial())
                 core->enterEventLoop = true;
-            // parse new bytecode
-			avmplus::ReadOnlyScriptBufferImpl* codeimpl = 
-			new (core->gc) avmplus::ReadOnlyScriptBufferImpl(m_code.values[i].values, m_code.values[i].length);
-			avmplus::ScriptBuffer code(codeimpl);
+            // parse new bytecode.  The PoolObject keeps the buffer, so bytes
+            // that are not mapped are copied into one the GC owns.
+            avmplus::ScriptBuffer code;
+            if (i < m_mapped.length && m_mapped.values[i] != NULL) {
+                code = new (core->gc) avmplus::SharedScriptBufferImpl(m_mapped.values[i]);
+            }
+            else {
+                code = core->newScriptBuffer(m_code.values[i].length);
+                VMPI_memcpy(code.getBuffer(), m_code.values[i].values, m_code.values[i].length);
+            }
             core->evaluateScriptBuffer(code, enter_debugger_on_launch);
             // release bytes regardless of success/failure
             m_code.values[i].deallocate(); 
         }
         m_code.deallocate();
+        m_mapped.deallocate();
     }
 	
 
@@ -265,6 +287,11 @@ namespace avmshell
                 gcconfig.collectionThreshold = settings.gcthreshold;
             gcconfig.exactTracing = settings.exactgc;
             gcconfig.markstackAllowance = settings.markstackAllowance;
+            gcconfig.markerThreads = settings.markerThreads;
+            gcconfig.sweeperThreads = settings.sweeperThreads;
+            gcconfig.nurserySize = settings.nurserySize;
+            if (settings.blockCacheSize >= 0)
+                gcconfig.blockCacheSize = uint32_t(settings.blockCacheSize);
             gcconfig.drc = settings.drc;
             gcconfig.mode = settings.gcMode();
             gcconfig.validateDRC = settings.drcValidation;
@@ -326,6 +353,17 @@ namespace avmshell
                 Platform::GetInstance()->exit(exitCode);
         }
 
+#ifdef VMCFG_NANOJIT
+        if (settings.cachestats)
+            shell->dumpBindingCacheStats();
+#endif
+#ifdef VMCFG_HALFMOON
+        if (settings.tierstats)
+            shell->dumpTierStats();
+#endif
+        if (settings.regexstats)
+            shell->dumpRegexStats();
+
 #ifdef VMCFG_EVAL
         if (settings.do_repl)
                 Shell::repl(shell);
@@ -524,6 +562,11 @@ namespace avmshell
         gcconfig.collectionThreshold = settings.gcthreshold;
         gcconfig.exactTracing = settings.exactgc;
         gcconfig.markstackAllowance = settings.markstackAllowance;
+        gcconfig.markerThreads = settings.markerThreads;
+        gcconfig.sweeperThreads = settings.sweeperThreads;
+        gcconfig.nurserySize = settings.nurserySize;
+        if (settings.blockCacheSize >= 0)
+            gcconfig.blockCacheSize = uint32_t(settings.blockCacheSize);
         gcconfig.mode = settings.gcMode();
 
         // Going multi-threaded.
@@ -779,6 +822,54 @@ namespace avmshell
         delete [] logFilename;
     }
 
+#ifdef VMCFG_NANOJIT
+    // A missing, unreadable or stale profile file just means starting from
+    // an empty profile; the file is (re)written on exit.  A profile is only
+    // good for the executable that wrote it, which is told from a rebuild by
+    // its size and the time it was last written.
+    /* static */
+    void Shell::loadJitProfile(ShellSettings& settings)
+    {
+        FileStamp stamp;
+        if (!Platform::GetInstance()->stampExecutable(&stamp) &&
+            !Platform::GetInstance()->stampFile(settings.programFilename, &stamp)) {
+            avmplus::AvmLog("Could not find the executable, ignoring -jitprofile\n");
+            return;
+        }
+        uint64_t build = avmplus::JitProfile::hashBytes((const uint8_t*)&stamp.modified, sizeof(stamp.modified));
+        build = avmplus::JitProfile::hashBytes((const uint8_t*)&stamp.size, sizeof(stamp.size), build);
+
+        settings.jitProfile = mmfx_new(avmplus::JitProfile(build));
+        File* fp = Platform::GetInstance()->createFile();
+        if (fp == NULL)
+            return;
+        if (fp->open(settings.jitProfileFile, File::OPEN_READ_BINARY)) {
+            int64_t len = fp->size();
+            if (len > 0 && len < 0x10000000) {
+                uint8_t* data = mmfx_new_array(uint8_t, size_t(len));
+                if (fp->read(data, size_t(len)) == size_t(len))
+                    settings.jitProfile->load(data, size_t(len));
+                mmfx_delete_array(data);
+            }
+            fp->close();
+        }
+        Platform::GetInstance()->destroyFile(fp);
+    }
+
+    /* static */
+    void Shell::saveJitProfile(ShellSettings& settings)
+    {
+        // Shells exiting together each replace the whole file; the last one wins.
+        size_t len;
+        uint8_t* data = settings.jitProfile->save(&len);
+        if (!Platform::GetInstance()->replaceFile(settings.jitProfileFile, data, len))
+            avmplus::AvmLog("Could not write the jit profile to %s\n", settings.jitProfileFile);
+        mmfx_delete_array(data);
+        mmfx_delete(settings.jitProfile);
+        settings.jitProfile = NULL;
+    }
+#endif
+
     /* static */
     void Shell::parseCommandLine(int argc, char* argv[])
     {
@@ -937,12 +1028,27 @@ namespace avmshell
                     else if (!VMPI_strcmp(arg+2, "nocse")) {
                         settings.njconfig.cseopt = false;
                     }
+                    else if (!VMPI_strcmp(arg+2, "noglobalopt")) {
+                        settings.njconfig.globalopt = false;
+                    }
+                    else if (!VMPI_strcmp(arg+2, "novectorize")) {
+                        settings.njconfig.vectorize = false;
+                    }
+                    else if (!VMPI_strcmp(arg+2, "nonarrow")) {
+                        settings.njconfig.narrow_counters = false;
+                    }
+                    else if (!VMPI_strcmp(arg+2, "regalloc=intervals")) {
+                        settings.njconfig.regalloc_intervals = true;
+                    }
                     else if (!VMPI_strcmp(arg+2, "checkjitpageflags")) {
                         settings.njconfig.check_page_flags = true;
                     }
                     else if (!VMPI_strcmp(arg+2, "noinline")) {
                         settings.jitconfig.opt_inline = false;
                     }
+                    else if (!VMPI_strcmp(arg+2, "cachestats")) {
+                        settings.cachestats = true;
+                    }
                     else if (!VMPI_strcmp(arg+2, "jitordie")) {
                         settings.runmode = avmplus::RM_jit_all;
                         settings.jitordie = true;
@@ -955,11 +1061,17 @@ namespace avmshell
                         // AvmCore instance using the JitConfig structure or similar.
                         halfmoon::enable_mode = 4;	// use halfmoon to produce LIR
                     }
+                    else if (!VMPI_strcmp(arg+2, "tierstats")) {
+                        settings.tierstats = true;
+                    }
 #endif /* VMCFG_HALFMOON */
 #endif /* VMCFG_NANOJIT */
                     else if (!VMPI_strcmp(arg+2, "interp")) {
                         settings.runmode = avmplus::RM_interp_all;
                     }
+                    else if (!VMPI_strcmp(arg+2, "regexstats")) {
+                        settings.regexstats = true;
+                    }
                     else {
                         avmplus::AvmLog("Unrecognized option %s\n", arg);
                         usage();
@@ -974,6 +1086,9 @@ namespace avmshell
                 else if (!VMPI_strcmp(arg, "-cache_methods") && i+1 < argc ) {
                     settings.cacheSizes.methods = (uint16_t)VMPI_strtol(argv[++i], 0, 10);
                 }
+                else if (!VMPI_strcmp(arg, "-cache_regex") && i+1 < argc ) {
+                    settings.cacheSizes.regex = (uint16_t)VMPI_strtol(argv[++i], 0, 10);
+                }
                 else if (!VMPI_strcmp(arg, "-swfHasAS3")) {
                     settings.do_testSWFHasAS3 = true;
                 }
@@ -1002,6 +1117,58 @@ namespace avmshell
                     if (threshold == 0)
                         settings.osr_enabled = false;
                 }
+                else if (!VMPI_strncmp(arg, "-jitthreads=", 12)) {
+                    // parse the number of background compiler threads
+                    int32_t threads;
+                    if (VMPI_sscanf(arg + 12, "%d", &threads) != 1 ||
+                        threads < 0 || threads > 16) {
+                        avmplus::AvmLog("Bad value to -jitthreads: %s\n", arg + 12);
+                        usage();
+                    }
+                    settings.jit_threads = threads;
+                }
+                else if (!VMPI_strncmp(arg, "-regexjit=", 10)) {
+                    // parse the number of executions before a regex is compiled
+                    int32_t threshold;
+                    if (VMPI_sscanf(arg + 10, "%d", &threshold) != 1 ||
+                        threshold < 0) {
+                        avmplus::AvmLog("Bad value to -regexjit: %s\n", arg + 10);
+                        usage();
+                    }
+                    settings.regex_jit_threshold = threshold;
+                }
+#ifdef VMCFG_HALFMOON
+                else if (!VMPI_strncmp(arg, "-tierup=", 8)) {
+                    // parse the number of baseline calls before tiering up
+                    int32_t threshold;
+                    if (VMPI_sscanf(arg + 8, "%d", &threshold) != 1 ||
+                        threshold < 0) {
+                        avmplus::AvmLog("Bad value to -tierup: %s\n", arg + 8);
+                        usage();
+                    }
+                    settings.tierup_threshold = threshold;
+                    if (threshold > 0) {
+                        // The optimizing tier is halfmoon.  It would only
+                        // read a profile to speculate, which is unfinished,
+                        // so the profiling tier stays off unless PROFILER=1.
+                        // Same dirty hack as -Dhalfmoon (bug 746736).
+                        halfmoon::enable_mode = 4;
+                    }
+                }
+                else if (!VMPI_strncmp(arg, "-tierprofile=", 13)) {
+                    // parse the number of profiled calls before optimizing
+                    int32_t threshold;
+                    if (VMPI_sscanf(arg + 13, "%d", &threshold) != 1 ||
+                        threshold < 1) {
+                        avmplus::AvmLog("Bad value to -tierprofile: %s\n", arg + 13);
+                        usage();
+                    }
+                    settings.tierprofile_threshold = threshold;
+                }
+#endif /* VMCFG_HALFMOON */
+                else if (!VMPI_strncmp(arg, "-jitprofile=", 12)) {
+                    settings.jitProfileFile = arg + 12;
+                }
                 else if (!VMPI_strncmp(arg, "-prof=", 6)) {
                     // parse jit profiling level
                     int32_t level;
@@ -1045,6 +1212,45 @@ namespace avmshell
                         usage();
                     }
                 }
+                else if (!VMPI_strncmp(arg, "-markthreads=", 13)) {
+                    // parse the number of helper marker threads
+                    int32_t threads;
+                    if (VMPI_sscanf(arg + 13, "%d", &threads) != 1 ||
+                        threads < 0 || threads > 16) {
+                        avmplus::AvmLog("Bad value to -markthreads: %s\n", arg + 13);
+                        usage();
+                    }
+                    settings.markerThreads = uint32_t(threads);
+                }
+                else if (!VMPI_strncmp(arg, "-sweepthreads=", 14)) {
+                    // parse the number of helper sweeper threads
+                    int32_t threads;
+                    if (VMPI_sscanf(arg + 14, "%d", &threads) != 1 ||
+                        threads < 0 || threads > 16) {
+                        avmplus::AvmLog("Bad value to -sweepthreads: %s\n", arg + 14);
+                        usage();
+                    }
+                    settings.sweeperThreads = uint32_t(threads);
+                }
+                else if (!VMPI_strncmp(arg, "-nursery=", 9)) {
+                    // parse the nursery size in kilobytes
+                    int32_t kb;
+                    if (VMPI_sscanf(arg + 9, "%d", &kb) != 1 || kb < 0) {
+                        avmplus::AvmLog("Bad value to -nursery: %s\n", arg + 9);
+                        usage();
+                    }
+                    settings.nurserySize = uint32_t(kb);
+                }
+                else if (!VMPI_strncmp(arg, "-blockcache=", 12)) {
+                    // parse the number of blocks each GC keeps in its block cache
+                    int32_t blocks;
+                    if (VMPI_sscanf(arg + 12, "%d", &blocks) != 1 ||
+                        blocks < 0 || blocks > int32_t(MMgc::GC::kMaxBlockCacheSize)) {
+                        avmplus::AvmLog("Bad value to -blockcache: %s\n", arg + 12);
+                        usage();
+                    }
+                    settings.blockCacheSize = blocks;
+                }
 #ifdef MMGC_MARKSTACK_ALLOWANCE
                 else if (!VMPI_strcmp(arg, "-gcstack") && i+1 < argc ) {
                     int stack;
@@ -1258,9 +1464,15 @@ namespace avmshell
 #ifdef MMGC_MARKSTACK_ALLOWANCE
         avmplus::AvmLog("          [-gcstack N]  Mark stack size allowance (# of segments), for testing.\n");
 #endif
+        avmplus::AvmLog("          [-markthreads=N] mark on N helper threads alongside the mutator (0-16); default 0\n");
+        avmplus::AvmLog("          [-sweepthreads=N] sweep on N helper threads alongside the mutator (0-16); default 0\n");
+        avmplus::AvmLog("          [-nursery=KB] generational GC: collect young objects after every KB kilobytes allocated; default 0 (off)\n");
+        avmplus::AvmLog("          [-blockcache=N] keep up to N free blocks per GC to take the heap lock less often (0-32); default 8 with a shared heap\n");
         avmplus::AvmLog("          [-cache_bindings N]   size of bindings cache (0 = unlimited)\n");
         avmplus::AvmLog("          [-cache_metadata N]   size of metadata cache (0 = unlimited)\n");
         avmplus::AvmLog("          [-cache_methods  N]   size of method cache (0 = unlimited)\n");
+        avmplus::AvmLog("          [-cache_regex    N]   size of compiled regex cache (0 = largest, 64)\n");
+        avmplus::AvmLog("          [-Dregexstats] print regex cache and regex jit counters on exit\n");
         avmplus::AvmLog("          [-Dgreedy]    collect before every allocation\n");
         avmplus::AvmLog("          [-Dnogc]      don't collect (including DRC)\n");
         avmplus::AvmLog("          [-Dnodrc]     don't use DRC (only use mark/sweep)\n");
@@ -1315,13 +1527,29 @@ namespace avmshell
         avmplus::AvmLog("          [-Dcheckjitpageflags] check page protection flags on JIT memory allocation (sometimes expensive)\n");
 #ifdef VMCFG_HALFMOON
         avmplus::AvmLog("          [-Dhalfmoon   use experimental 'halfmoon' jit (development only)\n");
+        avmplus::AvmLog("          [-tierup=N]   tiered compilation: after N calls of baseline jit code, recompile\n");
+        avmplus::AvmLog("                        with 'halfmoon'; default 0 disables tiering\n");
+        avmplus::AvmLog("          [-tierprofile=N] number of profiled calls before optimizing, when halfmoon's profiler\n");
+        avmplus::AvmLog("                        is on (PROFILER=1); default is -tierprofile=%d\n",
+                        avmplus::AvmCore::tierprofile_threshold_default);
+        avmplus::AvmLog("          [-Dtierstats] print tiered compilation counters and time spent compiling per tier on exit\n");
 #endif
         avmplus::AvmLog("          [-Djitordie]  use jit always, and abort when the jit fails\n");
         avmplus::AvmLog("          [-Dnocse]     disable CSE optimization\n");
+        avmplus::AvmLog("          [-Dnoglobalopt] disable global CSE and loop-invariant code motion\n");
+        avmplus::AvmLog("          [-Dnovectorize] don't process two Vector.<Number> elements at a time in loops\n");
+        avmplus::AvmLog("          [-Dnonarrow]  don't run Number loop counters as ints\n");
+        avmplus::AvmLog("          [-Dregalloc=intervals] choose registers to spill from live intervals and loop depth\n");
         avmplus::AvmLog("          [-Dnoinline]  disable speculative inlining\n");
+        avmplus::AvmLog("          [-Dcachestats] print jit binding cache miss counters on exit\n");
         avmplus::AvmLog("          [-jitharden]  enable jit hardening techniques\n");
         avmplus::AvmLog("          [-osr=T]      enable OSR with invocation threshold T; disable with -osr=0; default is -osr=%d\n",
                         avmplus::AvmCore::osr_threshold_default);
+        avmplus::AvmLog("          [-jitthreads=N] assemble jit code on N background threads (0-16); default 0 compiles synchronously\n");
+        avmplus::AvmLog("          [-regexjit=N] compile a regex to machine code after N matches; disable with -regexjit=0;\n"
+                        "                        default is -regexjit=%d\n", avmplus::AvmCore::regex_jit_threshold_default);
+        avmplus::AvmLog("          [-jitprofile=file] choose between jit and interp on a method's first call from the outcomes\n");
+        avmplus::AvmLog("                        recorded in file by earlier runs of this executable, and update the file on exit\n");
         avmplus::AvmLog("          [-prof=L]     enable jit profile level L; default 0=disabled; 1=function ranges, 2=functions+native asm)\n");
     #ifdef AVMPLUS_IA32
         avmplus::AvmLog("          [-Dnosse]     use FPU stack instead of SSE2 instructions\n");
@@ -13,8 +13,9 @@
 #include "avmshell-tracers.h"
 
 #ifdef VMCFG_SELFTEST
-// Allow selftests coded directly to nanojit APIs.
+// Allow selftests coded directly to nanojit APIs and to JitProfile.
 #include "../nanojit/nanojit.h"
+#include "exec-jitprofile.h"
 #endif
 
 #if defined AVMPLUS_MAC || defined AVMPLUS_UNIX
@@ -161,6 +162,11 @@ namespace avmshell
         virtual avmplus::ScriptObject* newWorkerObject(avmplus::Toplevel* toplevel);
 		
 		void evalCodeBlobs(bool enter_debugger_on_launch);
+
+    private:
+        // Files from the command line that could be mapped; the code of
+        // the others is read into m_code.  Owned by the MappedFile cache.
+        avmplus::FixedHeapArray<MappedFile*> m_mapped;
     };
 
     /**
@@ -178,6 +184,10 @@ namespace avmshell
 #endif
         static void repl(ShellCore* shellCore);
         static void initializeLogging(const char* basename);
+#ifdef VMCFG_NANOJIT
+        static void loadJitProfile(ShellSettings& settings);
+        static void saveJitProfile(ShellSettings& settings);
+#endif
         void parseCommandLine(int argc, char* argv[]);
         static void usage();
         ShellSettings settings;
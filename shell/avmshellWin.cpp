@@ -38,6 +38,12 @@ namespace avmshell
         virtual File* createFile();
         virtual void destroyFile(File* file);
 
+        virtual const uint8_t* mapFile(const char* filename, size_t padding, size_t* fileSize, size_t* mappedSize, FileStamp* stamp);
+        virtual bool stampFile(const char* filename, FileStamp* stamp);
+        virtual bool stampExecutable(FileStamp* stamp);
+        virtual bool replaceFile(const char* filename, const uint8_t* data, size_t size);
+        virtual void unmapFile(const uint8_t* addr, size_t mappedSize);
+
         virtual void initializeLogging(const char* filename);
 
         virtual int logMessage(const char* message);
@@ -79,6 +85,104 @@ namespace avmshell
         delete file;
     }
 
+    static bool stampOf(HANDLE file, FileStamp* stamp)
+    {
+        BY_HANDLE_FILE_INFORMATION info;
+        if (!GetFileInformationByHandle(file, &info))
+            return false;
+        stamp->volume = info.dwVolumeSerialNumber;
+        stamp->file = (uint64_t(info.nFileIndexHigh) << 32) | info.nFileIndexLow;
+        stamp->modified = (uint64_t(info.ftLastWriteTime.dwHighDateTime) << 32) | info.ftLastWriteTime.dwLowDateTime;
+        stamp->size = (uint64_t(info.nFileSizeHigh) << 32) | info.nFileSizeLow;
+        return true;
+    }
+
+    bool WinPlatform::stampFile(const char* filename, FileStamp* stamp)
+    {
+        HANDLE file = CreateFileA(filename, 0, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (file == INVALID_HANDLE_VALUE)
+            return false;
+        bool result = stampOf(file, stamp);
+        CloseHandle(file);
+        return result;
+    }
+
+    const uint8_t* WinPlatform::mapFile(const char* filename, size_t padding, size_t* fileSize, size_t* mappedSize, FileStamp* stamp)
+    {
+        HANDLE file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (file == INVALID_HANDLE_VALUE)
+            return NULL;
+
+        const uint8_t* result = NULL;
+        LARGE_INTEGER length;
+        if (GetFileSizeEx(file, &length) && length.QuadPart > 0 && (uint64_t)length.QuadPart < UINT32_T_MAX && stampOf(file, stamp))
+        {
+            const size_t size = (size_t)length.QuadPart;
+            SYSTEM_INFO sysinfo;
+            GetSystemInfo(&sysinfo);
+
+            // A view cannot extend past the end of the file, so the padding has
+            // to fit in the zero-filled tail of the last page; otherwise let the
+            // caller read the file.
+            const size_t tail = (sysinfo.dwPageSize - size % sysinfo.dwPageSize) % sysinfo.dwPageSize;
+            if (tail >= padding)
+            {
+                HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+                if (mapping != NULL)
+                {
+                    result = (const uint8_t*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+                    if (result != NULL)
+                    {
+                        *fileSize = size;
+                        *mappedSize = size;
+                    }
+                    // the view keeps the mapping object alive
+                    CloseHandle(mapping);
+                }
+            }
+        }
+        CloseHandle(file);
+        return result;
+    }
+
+    bool WinPlatform::stampExecutable(FileStamp* stamp)
+    {
+        char path[MAX_PATH];
+        DWORD length = GetModuleFileNameA(NULL, path, MAX_PATH);
+        if (length == 0 || length >= MAX_PATH)
+            return false;
+        return stampFile(path, stamp);
+    }
+
+    bool WinPlatform::replaceFile(const char* filename, const uint8_t* data, size_t size)
+    {
+        // No other live process has our id, so no other writer uses this name.
+        size_t length = VMPI_strlen(filename);
+        char* temp = new char[length + 24];
+        VMPI_sprintf(temp, "%s.%lu.tmp", filename, (unsigned long)GetCurrentProcessId());
+
+        bool written = false;
+        HANDLE file = CreateFileA(temp, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (file != INVALID_HANDLE_VALUE)
+        {
+            DWORD count;
+            written = size <= 0xFFFFFFFFU && WriteFile(file, data, DWORD(size), &count, NULL) && count == size;
+            if (!CloseHandle(file))
+                written = false;
+            if (written && !MoveFileExA(temp, filename, MOVEFILE_REPLACE_EXISTING))
+                written = false;
+            if (!written)
+                DeleteFileA(temp);
+        }
+        delete [] temp;
+        return written;
+    }
+
+    void WinPlatform::unmapFile(const uint8_t* addr, size_t /*mappedSize*/)
+    {
+        UnmapViewOfFile(addr);
+    }
+
     int WinPlatform::logMessage(const char* message)
     {
         return fprintf(stdout, "%s", message);
@@ -0,0 +1,65 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+import com.adobe.test.Assert;
+import com.adobe.test.Utils;
+
+// var SECTION="";
+
+// A regular expression that has been run often enough is compiled to native
+// code where the JIT is available; until then, and for what the native code
+// leaves to it, pcre runs it.  These run each pattern many times and check
+// that every run gives the answer the first one (from pcre) gave.
+
+var NL:String = String.fromCharCode(10);
+var CR:String = String.fromCharCode(13);
+var longA:String = "";
+for (var i:int = 0; i < 40; i++)
+    longA += "a";
+
+var patterns:Array = [
+    /abc/, /a.c/, /^abc$/, /a*b/, /a+?b/, /(\d+)-(\d+)/, /\bfoo\b/, /[a-z]+/gi, /x?y{2,3}z/,
+    /(a)?(b)/, /(?:ab|cd)e/, /^\s*(\w+)\s*=\s*(.*?)\s*$/m, /colou?r/i, /[^aeiou]{3}/, /$/m, /^/m,
+    /a\Z/, /\d{3,}/, /(a|ab)(c|bcd)(d*)/, /(x)?y|(z)/, /(?:(a)|b)c/, /a(?:b|)c/, /(a{2,3}?)(.*)/,
+    /.+/, /.+/s, /[à-ÿ]+/, /\B\w/, /a*a*a*a*a*a*a*a*b/, /(foo|foobar)baz/, /\r?\n/, /(a)|(b)|(c)/g
+];
+var subjects:Array = [
+    "abc", "xabcx", "aaab", "abababc", "12-345 and 6-7", "foo bar foobar", "xyyz yyyz", "b ab", "abe cde",
+    "  key = value  " + NL + "k2=v2" + CR + NL + "k3 = v3", "Colour color COLOR", "abbcd", "xy", "z",
+    "line1" + NL + "line2" + CR + NL + NL, "a" + NL, "", "café crème", "Ābc", "foobarbaz foobaz",
+    "ab" + CR + NL + "cd", longA, longA + "b"
+];
+
+function results(p:RegExp, s:String):String {
+    p.lastIndex = 0;
+    return [String(p.exec(s)), s.replace(p, "<$1|$2>"), String(s.match(p)), s.split(p).join("/"), s.search(p)].join(" ");
+}
+
+for each (var p:RegExp in patterns) {
+    for each (var s:String in subjects) {
+        var first:String = results(p, s);
+        var same:Boolean = true;
+        for (i = 0; i < 40; i++)
+            same = same && results(p, s) == first;
+        Assert.expectEq(p + " on " + escape(s), true, same);
+    }
+}
+
+Assert.expectEq("exec", "abc", String(/abc/.exec("ababababc")));
+Assert.expectEq("captures", "ac,a,,c", function():String {
+    var x:Array;
+    for (i = 0; i < 40; i++)
+        x = /(a)(b)?(c)/.exec("xac");
+    return String(x);
+}());
+Assert.expectEq("lastIndex", "2,6,12,ab", function():String {
+    var out:Array;
+    for (i = 0; i < 40; i++) {
+        var re:RegExp = /\w+/g;
+        out = [];
+        while (re.exec("ab cde fghij"))
+            out.push(re.lastIndex);
+        out.push(re.exec("ab cde fghij"));
+    }
+    return out.join(",");
+}());
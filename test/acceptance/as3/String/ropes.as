@@ -0,0 +1,86 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+import com.adobe.test.Assert;
+import com.adobe.test.Utils;
+
+// var SECTION="";
+
+// Long strings built by concatenation that cannot grow in place are kept
+// as a tree of their two halves until the characters are first needed.
+// These build such strings in a few ways and check that every operation
+// sees the same characters as a string built with Array.join.
+
+function piece(i:int):String {
+    return "<" + i + ":" + String.fromCharCode(0x61 + i % 26) + ">";
+}
+
+var pieces:Array = [];
+var prepended:String = "";
+for (var i:int = 0; i < 3000; i++) {
+    prepended = piece(i) + prepended;
+    pieces.unshift(piece(i));
+}
+var joined:String = pieces.join("");
+Assert.expectEq("prepend", true, prepended == joined);
+Assert.expectEq("prepend length", joined.length, prepended.length);
+Assert.expectEq("charCodeAt", joined.charCodeAt(5), prepended.charCodeAt(5));
+Assert.expectEq("indexOf", joined.indexOf("<1500:"), prepended.indexOf("<1500:"));
+Assert.expectEq("substring", joined.substring(100, 120), prepended.substring(100, 120));
+
+var a:String = "x";
+var b:String;
+var ref:String = "x";
+for (i = 0; i < 3000; i++) {
+    a = a + piece(i);
+    b = a + "!";
+    ref = ref.concat(piece(i));
+}
+Assert.expectEq("append to a string that was appended to", ref, a);
+Assert.expectEq("shared prefix", ref + "!", b);
+
+var part:String = joined.substring(10, 5000);
+var grown:String = part;
+for (i = 0; i < 100; i++)
+    grown = grown + piece(i);
+Assert.expectEq("append to a substring", part + pieces.slice(2900).reverse().join(""), grown);
+Assert.expectEq("substring is unchanged", joined.substr(10, 4990), part);
+
+var wide:String = "";
+var wideParts:Array = [];
+for (i = 0; i < 2000; i++) {
+    var c:String = i % 7 == 0 ? "ā" : "q";
+    wide = c + wide + piece(i);
+    wideParts.unshift(c);
+    wideParts.push(piece(i));
+}
+Assert.expectEq("mixed widths", wideParts.join(""), wide);
+Assert.expectEq("mixed widths charCodeAt", 0x101, wide.charCodeAt(4));
+Assert.expectEq("mixed widths lastIndexOf", 1999, wide.lastIndexOf("ā"));
+
+var key:String = "";
+for (i = 0; i < 400; i++)
+    key = piece(i) + key;
+var o:Object = {};
+o[key] = 1;
+var sameKey:String = pieces.slice(2600).join("");
+Assert.expectEq("property name", 1, o[sameKey]);
+Assert.expectEq("in", true, sameKey in o);
+Assert.expectEq("switch", "found", function(s:String):String {
+    switch (s) { case sameKey: return "found"; default: return "not found"; }
+}(key));
+
+var deep:String = "";
+for (i = 0; i < 20000; i++)
+    deep = "ab" + deep;
+Assert.expectEq("deep length", 40000, deep.length);
+Assert.expectEq("deep charAt", "b", deep.charAt(39999));
+Assert.expectEq("deep split", 20000, deep.split("ba").length);
+Assert.expectEq("deep replace", 20000, deep.replace(/ab/g, "c").length);
+
+var wrapped:String = "";
+for (i = 0; i < 500; i++)
+    wrapped = "x" + wrapped + "y";
+Assert.expectEq("toUpperCase", "XXX", wrapped.toUpperCase().substr(0, 3));
+Assert.expectEq("JSON.stringify", 1002, JSON.stringify(wrapped).length);
+Assert.expectEq("localeCompare", 0, wrapped.localeCompare(wrapped + ""));
@@ -0,0 +1,156 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+import com.adobe.test.Assert;
+import com.adobe.test.Utils;
+
+// var SECTION="";
+
+// Objects keep their dynamic properties by shape (shared lists of names)
+// until they get too many or one is made DontEnum; these check that the
+// properties behave the same whichever way they are kept.
+
+function keys(o:Object):String {
+    var a:Array = [];
+    for (var k:String in o)
+        a.push(k);
+    return a.sort().join(",");
+}
+
+dynamic class Dyn {}
+Dyn.prototype.x = "proto";
+
+// deleting leaves a hole that reads as absent and can be filled again
+var h:Object = {};
+h.a = 1; h.b = 2; h.c = 3;
+delete h.b;
+Assert.expectEq("hole: in", false, "b" in h);
+Assert.expectEq("hole: value", undefined, h.b);
+Assert.expectEq("hole: keys", "a,c", keys(h));
+Assert.expectEq("hole: hasOwnProperty", false, h.hasOwnProperty("b"));
+h.b = 4;
+Assert.expectEq("hole: refilled", "a,b,c 4", keys(h) + " " + h.b);
+delete h.a; delete h.b; delete h.c;
+Assert.expectEq("hole: all deleted", "", keys(h));
+h.d = 5;
+Assert.expectEq("hole: added after", "d", keys(h));
+
+// past 32 properties an object keeps them in a hashtable
+var big:Object = {};
+var i:int;
+for (i = 0; i < 40; i++)
+    big["p" + i] = i;
+var sum:int = 0;
+for (i = 0; i < 40; i++)
+    sum += big["p" + i];
+Assert.expectEq("big: values", 780, sum);
+for (i = 0; i < 40; i += 2)
+    delete big["p" + i];
+var n:int = 0;
+for (var k:String in big)
+    n++;
+Assert.expectEq("big: after delete", 20, n);
+Assert.expectEq("big: deleted", false, "p10" in big);
+Assert.expectEq("big: kept", 11, big.p11);
+for (i = 0; i < 200; i++) {
+    big["q" + i] = i;
+    delete big["q" + i];
+}
+Assert.expectEq("big: churn", 20, function():int { var c:int = 0; for (var k:String in big) c++; return c; }());
+var small:Object = {};
+for (i = 0; i < 40; i++)
+    small["p" + i] = -i;
+Assert.expectEq("big: separate objects", "1 -1", big.p1 + " " + small.p1);
+
+// DontEnum properties stay readable but are not enumerated
+var de:Object = {a:1, b:2, c:3};
+de.setPropertyIsEnumerable("b", false);
+Assert.expectEq("dontenum: keys", "a,c", keys(de));
+Assert.expectEq("dontenum: value", 2, de.b);
+Assert.expectEq("dontenum: propertyIsEnumerable", false, de.propertyIsEnumerable("b"));
+Assert.expectEq("dontenum: others", true, de.propertyIsEnumerable("a"));
+Assert.expectEq("dontenum: hasOwnProperty", true, de.hasOwnProperty("b"));
+de.b = 5;
+Assert.expectEq("dontenum: kept on set", "a,c 5", keys(de) + " " + de.b);
+de.setPropertyIsEnumerable("b", true);
+Assert.expectEq("dontenum: cleared", "a,b,c", keys(de));
+de.setPropertyIsEnumerable("c", false);
+delete de.c;
+de.c = 6;
+Assert.expectEq("dontenum: readded", "a,b,c true", keys(de) + " " + de.propertyIsEnumerable("c"));
+var de2:Object = {a:1, b:2, c:3};
+Assert.expectEq("dontenum: shape not shared", "a,b,c", keys(de2));
+de2.setPropertyIsEnumerable("missing", false);
+Assert.expectEq("dontenum: missing", "a,b,c false", keys(de2) + " " + ("missing" in de2));
+
+// an own property shadows the prototype's until it is deleted
+var d:Dyn = new Dyn();
+Assert.expectEq("shadow: inherited", "proto", d.x);
+d.x = "own";
+Assert.expectEq("shadow: own", "own proto", d.x + " " + Dyn.prototype.x);
+delete d.x;
+Assert.expectEq("shadow: deleted", "proto", d.x);
+Object.prototype.shadowed = "object";
+var so:Object = {};
+Assert.expectEq("shadow: Object.prototype", "object", so.shadowed);
+so.shadowed = "own";
+Assert.expectEq("shadow: own on Object", "own", so.shadowed);
+delete so.shadowed;
+Assert.expectEq("shadow: Object.prototype again", "object", so.shadowed);
+delete Object.prototype.shadowed;
+
+// the JIT caches where it found a property by shape; run the same access
+// over objects that have x at different places, not at all, deleted, or
+// in a hashtable
+function getX(o:*):* { return o.x; }
+function setX(o:*, v:*):void { o.x = v; }
+
+var objs:Array = [];
+objs.push({x:1});
+objs.push({a:0, x:2});
+objs.push({a:0, b:0, x:3});
+objs.push({y:0});
+objs.push(new Dyn());
+var del:Object = {x:5, y:0};
+delete del.x;
+objs.push(del);
+var hashed:Object = {};
+for (i = 0; i < 40; i++)
+    hashed["p" + i] = i;
+hashed.x = 7;
+objs.push(hashed);
+var hidden:Object = {x:8};
+hidden.setPropertyIsEnumerable("x", false);
+objs.push(hidden);
+
+var got:Array;
+for (var round:int = 0; round < 3; round++) {
+    got = [];
+    for (var j:int = 0; j < 10; j++)
+        for each (var o:* in objs)
+            got[objs.indexOf(o)] = getX(o);
+}
+Assert.expectEq("cache: get", "1,2,3,,proto,,7,8", got.join(","));
+
+for (j = 0; j < 10; j++)
+    for (i = 0; i < objs.length; i++)
+        setX(objs[i], i * 10 + j);
+got = [];
+for (i = 0; i < objs.length; i++)
+    got.push(getX(objs[i]));
+Assert.expectEq("cache: set", "9,19,29,39,49,59,69,79", got.join(","));
+Assert.expectEq("cache: set on deleted", "x,y", keys(del));
+Assert.expectEq("cache: set on dontenum", "", keys(hidden));
+Assert.expectEq("cache: prototype untouched", "proto", Dyn.prototype.x);
+
+// a shape the cache has seen grows after the fact
+var grow:Object = {x:1};
+for (i = 0; i < 10; i++)
+    getX(grow);
+for (i = 0; i < 40; i++)
+    grow["g" + i] = i;
+for (i = 0; i < 10; i++)
+    setX(grow, i);
+Assert.expectEq("cache: grown", "9 39", getX(grow) + " " + grow.g39);
+delete grow.x;
+Assert.expectEq("cache: grown then deleted", undefined, getX(grow));
@@ -0,0 +1,142 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+import com.adobe.test.Assert;
+import com.adobe.test.Utils;
+
+// var SECTION="";
+
+// Changing an object inside a for-in loop over it may or may not show the
+// properties it adds, but must visit every property it started with and
+// still has exactly once, however the object keeps its properties.
+
+function visit(o:Object, mutate:Function):Object {
+    var seen:Object = {};
+    var n:int = 0;
+    for (var k:String in o) {
+        seen[k] = (seen[k] || 0) + 1;
+        mutate(o, ++n);
+    }
+    return seen;
+}
+
+// names of the first count properties prefix+i that were not seen exactly once
+function missed(seen:Object, prefix:String, count:int, except:Array = null):String {
+    var bad:Array = [];
+    for (var i:int = 0; i < count; i++) {
+        var k:String = prefix + i;
+        if ((except == null || except.indexOf(k) < 0) && seen[k] !== 1)
+            bad.push(k + ":" + seen[k]);
+    }
+    return bad.join(",");
+}
+
+function repeated(seen:Object):String {
+    var bad:Array = [];
+    for (var k:String in seen)
+        if (seen[k] !== 1)
+            bad.push(k);
+    return bad.sort().join(",");
+}
+
+var i:int;
+var seen:Object;
+
+// adding properties takes the object past what a shared shape holds
+var grow:Object = {};
+for (i = 0; i < 30; i++)
+    grow["p" + i] = i;
+seen = visit(grow, function(o:Object, n:int):void {
+    if (n == 6)
+        for (var j:int = 30; j < 35; j++)
+            o["p" + j] = j;
+});
+Assert.expectEq("grow: originals once", "", missed(seen, "p", 30));
+Assert.expectEq("grow: no repeats", "", repeated(seen));
+
+// adding one property at a time on every iteration
+var each:Object = {};
+for (i = 0; i < 20; i++)
+    each["e" + i] = i;
+seen = visit(each, function(o:Object, n:int):void { o["x" + n] = n; });
+Assert.expectEq("add each: originals once", "", missed(seen, "e", 20));
+Assert.expectEq("add each: no repeats", "", repeated(seen));
+
+// making a property DontEnum part way through
+var de:Object = {a:1, b:2, c:3, d:4};
+var order:Array = [];
+for (var k:String in de) {
+    order.push(k);
+    de.setPropertyIsEnumerable("c", false);
+}
+Assert.expectEq("dontenum: no repeats", order.length, order.filter(function(x:String, i:int, a:Array):Boolean { return a.indexOf(x) == i; }).length);
+Assert.expectEq("dontenum: a,b,d visited", "a,b,d", order.filter(function(x:String, i:int, a:Array):Boolean { return x != "c"; }).sort().join(","));
+Assert.expectEq("dontenum: c at most first", true, order.indexOf("c") <= 0);
+
+// deleting properties not yet visited
+var del:Object = {};
+for (i = 0; i < 10; i++)
+    del["d" + i] = i;
+order = [];
+for (k in del) {
+    order.push(k);
+    if (order.length == 1)
+        for (i = 0; i < 10; i++)
+            if ("d" + i != k)
+                delete del["d" + i];
+}
+Assert.expectEq("delete: only the first", 1, order.length);
+
+// deleting and adding back the current property
+var readd:Object = {r0:0, r1:1, r2:2, r3:3};
+seen = visit(readd, function(o:Object, n:int):void {
+    var last:String = "r" + (n - 1);
+    delete o[last];
+    o[last] = n;
+});
+Assert.expectEq("readd: originals once", "", missed(seen, "r", 4));
+Assert.expectEq("readd: no repeats", "", repeated(seen));
+
+// a large object, made DontEnum, added to and deleted from in the middle
+var big:Object = {};
+for (i = 0; i < 100; i++)
+    big["k" + i] = i;
+seen = visit(big, function(o:Object, n:int):void {
+    if (n == 50) {
+        o.setPropertyIsEnumerable("k99", false);
+        o.extra = 1;
+        delete o.k3;
+    }
+});
+Assert.expectEq("big: originals once", "", missed(seen, "k", 99, ["k3"]));
+Assert.expectEq("big: no repeats", "", repeated(seen));
+Assert.expectEq("big: after loop", "false true 99 false",
+                [big.propertyIsEnumerable("k99"), big.propertyIsEnumerable("k98"), big.k99, "k3" in big].join(" "));
+
+// other objects leaving their shapes in the middle of the loop, some of
+// them after a loop over them of their own, before this one does
+var outer:Object = {};
+for (i = 0; i < 10; i++)
+    outer["o" + i] = i;
+var others:Array = [];
+seen = visit(outer, function(o:Object, n:int):void {
+    if (n == 3) {
+        for (var j:int = 0; j < 8; j++) {
+            var other:Object = {a:1, b:2};
+            for (var name:String in other)
+                break;
+            other.setPropertyIsEnumerable("a", false);
+            others.push(other);
+        }
+    }
+    if (n == 5)
+        o.setPropertyIsEnumerable("o9", false);
+});
+Assert.expectEq("others: originals once", "", missed(seen, "o", 9));
+Assert.expectEq("others: no repeats", "", repeated(seen));
+Assert.expectEq("others: their keys", "b", function():String {
+    var a:Array = [];
+    for (var k:String in others[7])
+        a.push(k);
+    return a.join(",");
+}());
@@ -0,0 +1,42 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+import com.adobe.test.Assert;
+import com.adobe.test.Utils;
+
+// var SECTION="";
+
+// An object literal's properties are enumerated, and stringified, in the
+// order they are written; where a name is written twice the first value
+// is kept.  That holds up to 32 properties: a bigger object keeps them in
+// a hashtable, which enumerates them in no particular order.
+
+function keys(o:Object):String {
+    var a:Array = [];
+    for (var k:String in o)
+        a.push(k);
+    return a.join(",");
+}
+
+Assert.expectEq("for-in", "x,y,z", keys({x:1, y:2, z:3}));
+Assert.expectEq("for-in, unsorted", "zeta,alpha,mid", keys({zeta:1, alpha:2, mid:3}));
+Assert.expectEq("JSON", '{"x":1,"y":2,"z":3}', JSON.stringify({x:1, y:2, z:3}));
+Assert.expectEq("JSON, nested", '{"b":{"d":1,"c":2},"a":[{"f":3,"e":4}]}',
+                JSON.stringify({b:{d:1, c:2}, a:[{f:3, e:4}]}));
+Assert.expectEq("added after", "b,a,c", function():String { var o:Object = {b:1, a:2}; o.c = 3; return keys(o); }());
+Assert.expectEq("duplicate", "a,b 1", function():String { var o:Object = {a:1, b:2, a:3}; return keys(o) + " " + o.a; }());
+
+var names:Array = [];
+for (var i:int = 0; i < 40; i++)
+    names.push("p" + i);
+var o32:Object = {p0:0, p1:1, p2:2, p3:3, p4:4, p5:5, p6:6, p7:7, p8:8, p9:9,
+                  p10:10, p11:11, p12:12, p13:13, p14:14, p15:15, p16:16, p17:17, p18:18, p19:19,
+                  p20:20, p21:21, p22:22, p23:23, p24:24, p25:25, p26:26, p27:27, p28:28, p29:29,
+                  p30:30, p31:31};
+Assert.expectEq("32", names.slice(0, 32).join(","), keys(o32));
+var o:Object = {p0:0, p1:1, p2:2, p3:3, p4:4, p5:5, p6:6, p7:7, p8:8, p9:9,
+                p10:10, p11:11, p12:12, p13:13, p14:14, p15:15, p16:16, p17:17, p18:18, p19:19,
+                p20:20, p21:21, p22:22, p23:23, p24:24, p25:25, p26:26, p27:27, p28:28, p29:29,
+                p30:30, p31:31, p32:32, p33:33, p34:34, p35:35, p36:36, p37:37, p38:38, p39:39};
+Assert.expectEq("more than 32: all once", names.sort().join(","), keys(o).split(",").sort().join(","));
+Assert.expectEq("more than 32: values", 780, function():int { var n:int = 0; for each (var v:int in o) n += v; return n; }());
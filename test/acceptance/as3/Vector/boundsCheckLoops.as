@@ -0,0 +1,96 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+import com.adobe.test.Assert;
+import com.adobe.test.Utils;
+
+// var SECTION="";
+
+// Counted loops over typed vectors.  The JIT drops the bounds check on v[i]
+// when the loop condition already proves the index in range; these check
+// that it still throws whenever it can't.
+
+function makeVector(n:int):Vector.<int> {
+    var v:Vector.<int> = new Vector.<int>(n);
+    for (var i:int = 0; i < n; i++)
+        v[i] = i;
+    return v;
+}
+
+function sumAll(v:Vector.<int>):int {
+    var s:int = 0;
+    for (var i:int = 0; i < v.length; i++)
+        s += v[i];
+    return s;
+}
+
+function incrementAll(v:Vector.<int>):void {
+    for (var i:int = 0; i < v.length; i++)
+        v[i] = v[i] + 1;
+}
+
+function sumFrom(v:Vector.<int>, start:int):int {
+    var s:int = 0;
+    for (var i:int = start; i < v.length; i++)
+        s += v[i];
+    return s;
+}
+
+function sumInclusive(v:Vector.<int>):int {
+    var s:int = 0;
+    for (var i:int = 0; i <= v.length; i++)
+        s += v[i];
+    return s;
+}
+
+function sumShrinking(v:Vector.<int>):int {
+    var s:int = 0;
+    for (var i:int = 0; i < v.length; i++) {
+        if (i == 5)
+            v.length = 3;
+        s += v[i];
+    }
+    return s;
+}
+
+function sumOther(v:Vector.<int>, w:Vector.<int>):int {
+    var s:int = 0;
+    for (var i:int = 0; i < v.length; i++)
+        s += w[i];
+    return s;
+}
+
+function sumNext(v:Vector.<int>):int {
+    var s:int = 0;
+    for (var i:int = 0; i < v.length; i += 2)
+        s += v[i + 1];
+    return s;
+}
+
+function rangeError(f:Function, ...args):String {
+    var errormsg = "no error";
+    try {
+        f.apply(null, args);
+    } catch (e) {
+        errormsg = e.toString();
+    }
+    return Utils.parseError(errormsg, "RangeError: Error #1125".length);
+}
+
+var v:Vector.<int> = makeVector(10);
+Assert.expectEq("sum of a counted loop", 45, sumAll(v));
+incrementAll(v);
+Assert.expectEq("increment in a counted loop", 55, sumAll(v));
+Assert.expectEq("counted loop from a non-negative start", 40, sumFrom(v, 5));
+Assert.expectEq("counted loop on an empty vector", 0, sumAll(new Vector.<int>()));
+
+Assert.expectEq("counted loop from a negative start",
+                "RangeError: Error #1125", rangeError(sumFrom, v, -1));
+Assert.expectEq("loop running to the length inclusive",
+                "RangeError: Error #1125", rangeError(sumInclusive, v));
+Assert.expectEq("vector shrinking inside the loop",
+                "RangeError: Error #1125", rangeError(sumShrinking, makeVector(10)));
+Assert.expectEq("loop bounded by another vector",
+                "RangeError: Error #1125", rangeError(sumOther, v, makeVector(4)));
+Assert.expectEq("index past the loop counter",
+                "RangeError: Error #1125", rangeError(sumNext, makeVector(9)));
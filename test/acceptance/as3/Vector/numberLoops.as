@@ -0,0 +1,116 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+import com.adobe.test.Assert;
+import com.adobe.test.Utils;
+
+// var SECTION="";
+
+// Counted loops over Vector.<Number>.  The JIT may run two iterations of
+// these at a time; these check odd lengths, vectors that are the same
+// object, and loops that stop part way through, with a break or an
+// exception.
+
+function makeVector(n:int, step:Number):Vector.<Number> {
+    var v:Vector.<Number> = new Vector.<Number>(n);
+    for (var i:int = 0; i < n; i++)
+        v[i] = i * step;
+    return v;
+}
+
+function scale(v:Vector.<Number>, k:Number):void {
+    for (var i:int = 0; i < v.length; i++)
+        v[i] = v[i] * k;
+}
+
+function zip(a:Vector.<Number>, b:Vector.<Number>, c:Vector.<Number>):void {
+    for (var i:int = 0; i < a.length; i++)
+        a[i] = b[i] + c[i] * 0.5;
+}
+
+function dot(a:Vector.<Number>, b:Vector.<Number>):Number {
+    var s:Number = 0;
+    for (var i:int = 0; i < a.length; i++)
+        s += a[i] * b[i];
+    return s;
+}
+
+function shiftDown(v:Vector.<Number>):void {
+    for (var i:int = 0; i < v.length - 1; i++)
+        v[i] = v[i + 1] + 0;
+}
+
+function fill(v:Vector.<Number>, x:Number):void {
+    for (var i:int = 1; i < v.length; i++)
+        v[i] = x + 0;
+}
+
+function join(v:Vector.<Number>):String {
+    var s:String = "";
+    for (var i:int = 0; i < v.length; i++)
+        s += (i > 0 ? "," : "") + v[i];
+    return s;
+}
+
+// Scales elements until one is over 'limit'; returns how many were scaled.
+function scaleUntil(v:Vector.<Number>, k:Number, limit:Number):int {
+    var i:int = 0;
+    for (; i < v.length; i++) {
+        if (v[i] > limit)
+            break;
+        v[i] = v[i] * k;
+    }
+    return i;
+}
+
+function rangeError(f:Function, ...args):String {
+    var errormsg = "no error";
+    try {
+        f.apply(null, args);
+    } catch (e) {
+        errormsg = e.toString();
+    }
+    return Utils.parseError(errormsg, "RangeError: Error #1125".length);
+}
+
+var v:Vector.<Number> = makeVector(7, 1);
+scale(v, 2);
+Assert.expectEq("scale an odd number of elements", "0,2,4,6,8,10,12", join(v));
+scale(v, 0.5);
+Assert.expectEq("scale back", "0,1,2,3,4,5,6", join(v));
+
+var a:Vector.<Number> = makeVector(9, 1);
+zip(a, makeVector(9, 2), makeVector(9, 4));
+Assert.expectEq("combine three vectors", "0,4,8,12,16,20,24,28,32", join(a));
+zip(a, a, a);
+Assert.expectEq("combine a vector with itself", "0,6,12,18,24,30,36,42,48", join(a));
+
+var small:Vector.<Number> = new Vector.<Number>(5);
+var s:Number = 0;
+for (var i:int = 0; i < 5; i++) {
+    small[i] = 0.1 * (i + 1);
+    s += small[i] * small[i];
+}
+Assert.expectEq("dot product in order", s, dot(small, small));
+Assert.expectEq("dot product of empty vectors", 0, dot(new Vector.<Number>(), new Vector.<Number>()));
+
+var d:Vector.<Number> = makeVector(6, 1);
+shiftDown(d);
+Assert.expectEq("read the next element", "1,2,3,4,5,5", join(d));
+fill(d, 9);
+Assert.expectEq("loop from an odd start", "1,9,9,9,9,9", join(d));
+
+var b:Vector.<Number> = makeVector(10, 1);
+Assert.expectEq("another vector runs out",
+                "RangeError: Error #1125", rangeError(zip, b, makeVector(10, 1), makeVector(5, 1)));
+Assert.expectEq("elements before the failing one are done", "0,1.5,3,4.5,6,5,6,7,8,9", join(b));
+
+var e:Vector.<Number> = makeVector(9, 1);
+Assert.expectEq("break on an even index", 4, scaleUntil(e, 10, 3));
+Assert.expectEq("elements after the break are untouched", "0,10,20,30,4,5,6,7,8", join(e));
+e = makeVector(9, 1);
+Assert.expectEq("break on an odd index", 5, scaleUntil(e, 10, 4));
+Assert.expectEq("the pair's first element is done, the second isn't", "0,10,20,30,40,5,6,7,8", join(e));
+e = makeVector(9, 1);
+Assert.expectEq("no break in an odd length", 9, scaleUntil(e, 2, 100));
+Assert.expectEq("the last, unpaired element is done", "0,2,4,6,8,10,12,14,16", join(e));
@@ -0,0 +1,178 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+import avmplus.Domain;
+import flash.utils.ByteArray;
+import com.adobe.test.Assert;
+
+// var SECTION = "Misc Tests";
+// var VERSION = "";
+// var TITLE = "Calls to trivial getters and setters replaced by slot accesses";
+
+/*
+ *  The JIT replaces an early-bound call to an accessor whose body is just
+ *  'return this._x' or 'this._x = v' by the slot access, guarded by a check
+ *  of the receiver's vtable unless the accessor or the class declaring it
+ *  is final.
+ *  The shell's eval compiler, which runs these tests when asc is not at
+ *  hand, emits neither accessors nor overrides, so the classes and their
+ *  callers are loaded from the hand-assembled bytecode below.  It is
+ *  equivalent to
+ *
+ *  public class Acc {
+ *      public var _i:int; public var _n:Number; public var _s:String;
+ *      public function get i():int { return this._i }
+ *      public function set i(v:int) { this._i = v }
+ *      public function get n():Number { return this._n }
+ *      public function set n(v:Number) { this._n = v }
+ *      public function get s():String { return this._s }
+ *      public function set s(v:String) { this._s = v }
+ *  }
+ *  public class AccSub extends Acc {
+ *      override public function get i():int { return -this._i }
+ *      override public function set i(v:int) { this._i = v * 2 }
+ *  }
+ *  public final class AccFinal {
+ *      public var _i:int;
+ *      public function get i():int { return this._i }
+ *      public function set i(v:int) { this._i = v }
+ *  }
+ *  public class AccTest {
+ *      public static function getI(a:Acc):int { return a.i }
+ *      public static function setI(a:Acc, v) { a.i = v }
+ *      // and likewise getN, setN, getS, setS, and getFinalI and setFinalI
+ *      // taking an AccFinal
+ *  }
+ */
+
+var bytecode:Array = [
+    0x10, 0x00, 0x2E, 0x00, 0x00, 0x00, 0x00, 0x18, 0x00, 0x02, 0x5F, 0x69, 0x03, 0x69, 0x6E, 0x74,
+    0x02, 0x5F, 0x6E, 0x06, 0x4E, 0x75, 0x6D, 0x62, 0x65, 0x72, 0x02, 0x5F, 0x73, 0x06, 0x53, 0x74,
+    0x72, 0x69, 0x6E, 0x67, 0x01, 0x69, 0x01, 0x6E, 0x01, 0x73, 0x03, 0x41, 0x63, 0x63, 0x04, 0x67,
+    0x65, 0x74, 0x49, 0x04, 0x73, 0x65, 0x74, 0x49, 0x04, 0x67, 0x65, 0x74, 0x4E, 0x04, 0x73, 0x65,
+    0x74, 0x4E, 0x04, 0x67, 0x65, 0x74, 0x53, 0x04, 0x73, 0x65, 0x74, 0x53, 0x08, 0x41, 0x63, 0x63,
+    0x46, 0x69, 0x6E, 0x61, 0x6C, 0x09, 0x67, 0x65, 0x74, 0x46, 0x69, 0x6E, 0x61, 0x6C, 0x49, 0x09,
+    0x73, 0x65, 0x74, 0x46, 0x69, 0x6E, 0x61, 0x6C, 0x49, 0x06, 0x4F, 0x62, 0x6A, 0x65, 0x63, 0x74,
+    0x06, 0x41, 0x63, 0x63, 0x53, 0x75, 0x62, 0x07, 0x41, 0x63, 0x63, 0x54, 0x65, 0x73, 0x74, 0x02,
+    0x16, 0x01, 0x00, 0x17, 0x07, 0x01, 0x02, 0x07, 0x01, 0x03, 0x07, 0x01, 0x04, 0x07, 0x01, 0x05,
+    0x07, 0x01, 0x06, 0x07, 0x01, 0x07, 0x07, 0x01, 0x08, 0x07, 0x01, 0x09, 0x07, 0x01, 0x0A, 0x07,
+    0x01, 0x0B, 0x07, 0x01, 0x0C, 0x07, 0x01, 0x0D, 0x07, 0x01, 0x0E, 0x07, 0x01, 0x0F, 0x07, 0x01,
+    0x10, 0x07, 0x01, 0x11, 0x07, 0x01, 0x12, 0x07, 0x01, 0x13, 0x07, 0x01, 0x14, 0x07, 0x01, 0x15,
+    0x07, 0x01, 0x16, 0x07, 0x01, 0x17, 0x1B, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x02, 0x00, 0x00, 0x01, 0x00, 0x02, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x01, 0x00, 0x04, 0x00,
+    0x00, 0x00, 0x06, 0x00, 0x00, 0x01, 0x00, 0x06, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x01, 0x00, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x01, 0x00, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x01, 0x02, 0x0A, 0x00, 0x00, 0x02, 0x00, 0x0A, 0x00, 0x00, 0x00, 0x01,
+    0x04, 0x0A, 0x00, 0x00, 0x02, 0x00, 0x0A, 0x00, 0x00, 0x00, 0x01, 0x06, 0x0A, 0x00, 0x00, 0x02,
+    0x00, 0x0A, 0x00, 0x00, 0x00, 0x01, 0x02, 0x11, 0x00, 0x00, 0x02, 0x00, 0x11, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x04, 0x0A, 0x14, 0x01, 0x00, 0x00, 0x09, 0x01, 0x00, 0x00, 0x02,
+    0x00, 0x03, 0x00, 0x00, 0x04, 0x00, 0x05, 0x00, 0x00, 0x06, 0x00, 0x07, 0x02, 0x00, 0x02, 0x07,
+    0x03, 0x00, 0x03, 0x08, 0x02, 0x00, 0x04, 0x08, 0x03, 0x00, 0x05, 0x09, 0x02, 0x00, 0x06, 0x09,
+    0x03, 0x00, 0x07, 0x15, 0x0A, 0x01, 0x00, 0x08, 0x02, 0x07, 0x22, 0x00, 0x0A, 0x07, 0x23, 0x00,
+    0x0B, 0x11, 0x14, 0x03, 0x00, 0x0C, 0x03, 0x01, 0x00, 0x00, 0x02, 0x00, 0x07, 0x02, 0x00, 0x0E,
+    0x07, 0x03, 0x00, 0x0F, 0x16, 0x14, 0x01, 0x00, 0x10, 0x00, 0x01, 0x00, 0x09, 0x00, 0x0D, 0x00,
+    0x11, 0x08, 0x0B, 0x01, 0x00, 0x12, 0x0C, 0x01, 0x00, 0x13, 0x0D, 0x01, 0x00, 0x14, 0x0E, 0x01,
+    0x00, 0x15, 0x0F, 0x01, 0x00, 0x16, 0x10, 0x01, 0x00, 0x17, 0x12, 0x01, 0x00, 0x18, 0x13, 0x01,
+    0x00, 0x19, 0x01, 0x1A, 0x04, 0x0A, 0x04, 0x00, 0x00, 0x15, 0x04, 0x00, 0x01, 0x11, 0x04, 0x00,
+    0x02, 0x16, 0x04, 0x00, 0x03, 0x1B, 0x00, 0x01, 0x01, 0x03, 0x04, 0x06, 0xD0, 0x30, 0xD0, 0x49,
+    0x00, 0x47, 0x00, 0x00, 0x01, 0x01, 0x01, 0x03, 0x04, 0x03, 0xD0, 0x30, 0x47, 0x00, 0x00, 0x02,
+    0x01, 0x01, 0x03, 0x04, 0x06, 0xD0, 0x30, 0xD0, 0x66, 0x01, 0x48, 0x00, 0x00, 0x03, 0x02, 0x02,
+    0x03, 0x04, 0x07, 0xD0, 0x30, 0xD0, 0xD1, 0x61, 0x01, 0x47, 0x00, 0x00, 0x04, 0x01, 0x01, 0x03,
+    0x04, 0x06, 0xD0, 0x30, 0xD0, 0x66, 0x03, 0x48, 0x00, 0x00, 0x05, 0x02, 0x02, 0x03, 0x04, 0x07,
+    0xD0, 0x30, 0xD0, 0xD1, 0x61, 0x03, 0x47, 0x00, 0x00, 0x06, 0x01, 0x01, 0x03, 0x04, 0x06, 0xD0,
+    0x30, 0xD0, 0x66, 0x05, 0x48, 0x00, 0x00, 0x07, 0x02, 0x02, 0x03, 0x04, 0x07, 0xD0, 0x30, 0xD0,
+    0xD1, 0x61, 0x05, 0x47, 0x00, 0x00, 0x08, 0x01, 0x01, 0x03, 0x04, 0x06, 0xD0, 0x30, 0xD0, 0x49,
+    0x00, 0x47, 0x00, 0x00, 0x09, 0x01, 0x01, 0x03, 0x04, 0x03, 0xD0, 0x30, 0x47, 0x00, 0x00, 0x0A,
+    0x01, 0x01, 0x03, 0x04, 0x07, 0xD0, 0x30, 0xD0, 0x66, 0x01, 0xC4, 0x48, 0x00, 0x00, 0x0B, 0x03,
+    0x02, 0x03, 0x04, 0x0A, 0xD0, 0x30, 0xD0, 0xD1, 0x24, 0x02, 0xC7, 0x61, 0x01, 0x47, 0x00, 0x00,
+    0x0C, 0x01, 0x01, 0x03, 0x04, 0x06, 0xD0, 0x30, 0xD0, 0x49, 0x00, 0x47, 0x00, 0x00, 0x0D, 0x01,
+    0x01, 0x03, 0x04, 0x03, 0xD0, 0x30, 0x47, 0x00, 0x00, 0x0E, 0x01, 0x01, 0x03, 0x04, 0x06, 0xD0,
+    0x30, 0xD0, 0x66, 0x01, 0x48, 0x00, 0x00, 0x0F, 0x02, 0x02, 0x03, 0x04, 0x07, 0xD0, 0x30, 0xD0,
+    0xD1, 0x61, 0x01, 0x47, 0x00, 0x00, 0x10, 0x01, 0x01, 0x03, 0x04, 0x06, 0xD0, 0x30, 0xD0, 0x49,
+    0x00, 0x47, 0x00, 0x00, 0x11, 0x01, 0x01, 0x03, 0x04, 0x03, 0xD0, 0x30, 0x47, 0x00, 0x00, 0x12,
+    0x01, 0x02, 0x00, 0x01, 0x04, 0xD1, 0x66, 0x07, 0x48, 0x00, 0x00, 0x13, 0x02, 0x03, 0x00, 0x01,
+    0x05, 0xD1, 0xD2, 0x61, 0x07, 0x47, 0x00, 0x00, 0x14, 0x01, 0x02, 0x00, 0x01, 0x04, 0xD1, 0x66,
+    0x08, 0x48, 0x00, 0x00, 0x15, 0x02, 0x03, 0x00, 0x01, 0x05, 0xD1, 0xD2, 0x61, 0x08, 0x47, 0x00,
+    0x00, 0x16, 0x01, 0x02, 0x00, 0x01, 0x04, 0xD1, 0x66, 0x09, 0x48, 0x00, 0x00, 0x17, 0x02, 0x03,
+    0x00, 0x01, 0x05, 0xD1, 0xD2, 0x61, 0x09, 0x47, 0x00, 0x00, 0x18, 0x01, 0x02, 0x00, 0x01, 0x04,
+    0xD1, 0x66, 0x07, 0x48, 0x00, 0x00, 0x19, 0x02, 0x03, 0x00, 0x01, 0x05, 0xD1, 0xD2, 0x61, 0x07,
+    0x47, 0x00, 0x00, 0x1A, 0x03, 0x01, 0x00, 0x04, 0x37, 0xD0, 0x30, 0x65, 0x00, 0x60, 0x14, 0x30,
+    0x60, 0x14, 0x58, 0x00, 0x1D, 0x68, 0x0A, 0x65, 0x00, 0x60, 0x14, 0x30, 0x60, 0x0A, 0x30, 0x60,
+    0x0A, 0x58, 0x01, 0x1D, 0x1D, 0x68, 0x15, 0x65, 0x00, 0x60, 0x14, 0x30, 0x60, 0x14, 0x58, 0x02,
+    0x1D, 0x68, 0x11, 0x65, 0x00, 0x60, 0x14, 0x30, 0x60, 0x14, 0x58, 0x03, 0x1D, 0x68, 0x16, 0x47,
+    0x00, 0x00
+];
+
+var ba = new ByteArray();
+for (var k = 0; k < bytecode.length; k++)
+    ba.writeByte(bytecode[k]);
+
+var d = new Domain(Domain.currentDomain);
+d.loadBytes(ba);
+var AccClass:Class = d.getClass("Acc");
+var AccSubClass:Class = d.getClass("AccSub");
+var AccFinalClass:Class = d.getClass("AccFinal");
+var AccTestClass:Class = d.getClass("AccTest");
+
+var a = new AccClass();
+AccTestClass.setI(a, 5);
+Assert.expectEq("getter and setter", 5, AccTestClass.getI(a));
+Assert.expectEq("slot written", 5, a._i);
+
+// the same call sites with a receiver whose class overrides the accessors
+var sub = new AccSubClass();
+AccTestClass.setI(sub, 5);
+Assert.expectEq("overriding setter", 10, sub._i);
+Assert.expectEq("overriding getter", -10, AccTestClass.getI(sub));
+AccTestClass.setI(a, 6);
+Assert.expectEq("base class again", 6, AccTestClass.getI(a));
+
+// the argument is coerced to the setter's parameter type
+AccTestClass.setI(a, 3.7);
+Assert.expectEq("int setter given a Number", 3, AccTestClass.getI(a));
+AccTestClass.setI(a, "12");
+Assert.expectEq("int setter given a String", 12, AccTestClass.getI(a));
+AccTestClass.setI(a, undefined);
+Assert.expectEq("int setter given undefined", 0, AccTestClass.getI(a));
+AccTestClass.setN(a, "2.5");
+Assert.expectEq("Number setter given a String", 2.5, AccTestClass.getN(a));
+AccTestClass.setN(a, 7);
+Assert.expectEq("Number setter given an int", 7, AccTestClass.getN(a));
+AccTestClass.setS(a, 42);
+Assert.expectEq("String setter given an int", "42", AccTestClass.getS(a));
+AccTestClass.setS(a, undefined);
+Assert.expectEq("String setter given undefined", null, AccTestClass.getS(a));
+AccTestClass.setI(sub, 2.9);
+Assert.expectEq("overriding setter given a Number", 4, sub._i);
+
+// one call site alternating between the two classes
+function alternate():String {
+    for (var k:int = 0; k < 20; k++) {
+        var o = (k & 1) ? sub : a;
+        AccTestClass.setI(o, k);
+        var expected:int = (k & 1) ? -2 * k : k;
+        if (AccTestClass.getI(o) !== expected)
+            return "step " + k + " got " + AccTestClass.getI(o);
+    }
+    return "ok";
+}
+Assert.expectEq("alternating receivers", "ok", alternate());
+
+// accessors of a final class need no guard
+var f = new AccFinalClass();
+AccTestClass.setFinalI(f, 8);
+Assert.expectEq("final class setter", 8, f._i);
+Assert.expectEq("final class getter", 8, AccTestClass.getFinalI(f));
+AccTestClass.setFinalI(f, "-3");
+Assert.expectEq("final class setter given a String", -3, AccTestClass.getFinalI(f));
+
+// a receiver of the wrong type, or null, is still rejected
+Assert.expectEq("null receiver", "TypeError", function():String {
+    try { AccTestClass.getI(null); } catch (e:TypeError) { return "TypeError"; }
+    return "none";
+}());
+Assert.expectEq("receiver of another class", "TypeError", function():String {
+    try { AccTestClass.getFinalI(sub); } catch (e:TypeError) { return "TypeError"; }
+    return "none";
+}());
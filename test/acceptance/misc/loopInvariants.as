@@ -0,0 +1,194 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+import com.adobe.test.Assert;
+import com.adobe.test.Utils;
+
+// var SECTION="";
+
+// The JIT's global optimizer reuses values across blocks and moves loop
+// invariant code in front of loops; these loops have values it can move,
+// values it must not, exits to the error and catch paths from inside
+// hoisted-from loops, and values that stay live across loops.  See
+// loopInvariantsOsr.as for loops entered from the interpreter.
+
+class Counter {
+    public var k:int = 3;
+    public var d:Number = 0.5;
+    public function bump():void { k++; }
+}
+
+// hoisting
+
+function invariantInt(n:int, a:int, b:int):int {
+    var s:int = 0;
+    for (var i:int = 0; i < n; i++)
+        s += a * b + (a ^ b) - (a >> 1);
+    return s;
+}
+Assert.expectEq("int invariant", 100 * (6 * 7 + (6 ^ 7) - 3), invariantInt(100, 6, 7));
+Assert.expectEq("int invariant, no trips", 0, invariantInt(0, 6, 7));
+
+function invariantNumber(n:int, x:Number):Number {
+    var s:Number = 0;
+    for (var i:int = 0; i < n; i++)
+        s += x * 2 + x / 4;
+    return s;
+}
+Assert.expectEq("Number invariant", 50 * 4.5, invariantNumber(50, 2));
+
+function fieldRead(n:int, c:Counter):int {
+    var s:int = 0;
+    for (var i:int = 0; i < n; i++)
+        s += c.k;
+    return s;
+}
+Assert.expectEq("field read", 30, fieldRead(10, new Counter()));
+Assert.expectEq("field read, null with no trips", 0, fieldRead(0, null));
+
+function fieldWrittenByCall(n:int, c:Counter):int {
+    var s:int = 0;
+    for (var i:int = 0; i < n; i++) {
+        s += c.k;
+        c.bump();
+    }
+    return s;
+}
+Assert.expectEq("field written by a call", 3 + 4 + 5 + 6 + 7, fieldWrittenByCall(5, new Counter()));
+
+function fieldWrittenInLoop(n:int, c:Counter):Number {
+    var s:Number = 0;
+    for (var i:int = 0; i < n; i++) {
+        s += c.d * 2;
+        c.d = c.d + 1;
+    }
+    return s;
+}
+Assert.expectEq("field written in the loop", 1 + 3 + 5 + 7, fieldWrittenInLoop(4, new Counter()));
+
+function localWrittenPartWay(n:int, a:int, b:int):int {
+    var s:int = 0;
+    for (var i:int = 0; i < n; i++) {
+        if (i == 5)
+            a = 10;
+        s += a * b;
+    }
+    return s;
+}
+Assert.expectEq("local written part way", 5 * 2 * 3 + 5 * 10 * 3, localWrittenPartWay(10, 2, 3));
+
+function moduloByZero(n:int, a:int, b:int):int {
+    var s:int = 0;
+    for (var i:int = 0; i < n; i++)
+        s += a % b;
+    return s;
+}
+Assert.expectEq("modulo, no trips", 0, moduloByZero(0, 7, 0));
+Assert.expectEq("modulo", 3, moduloByZero(3, 7, 3));
+
+function nested(n:int, a:int):int {
+    var s:int = 0;
+    for (var i:int = 0; i < n; i++) {
+        var row:int = i * a;
+        for (var j:int = 0; j < n; j++)
+            s += row + a * 2 + j;
+    }
+    return s;
+}
+Assert.expectEq("nested", 10 * 10 * 6 + 10 * 45 * 3 + 10 * 45, nested(10, 3));
+
+function sameOnBothSides(n:int, a:int, b:int):int {
+    var s:int = 0;
+    for (var i:int = 0; i < n; i++) {
+        if (i & 1)
+            s += a * b + 1;
+        else
+            s -= a * b;
+    }
+    return s + a * b;
+}
+Assert.expectEq("same value on both branches", 5 + 12, sameOnBothSides(10, 3, 4));
+
+// leaving a loop by an exception
+
+function nullInLoop(objs:Array):int {
+    var s:int = 0;
+    for (var i:int = 0; i < objs.length; i++) {
+        var c:Counter = objs[i];
+        s += c.k * 2;
+    }
+    return s;
+}
+var objs:Array = [new Counter(), new Counter(), null, new Counter()];
+Assert.expectEq("null in loop", "TypeError", function():String {
+    try { nullInLoop(objs); } catch (e:TypeError) { return "TypeError"; }
+    return "none";
+}());
+
+function caughtInLoop(n:int, a:int, f:*):String {
+    var s:int = 0;
+    var caught:int = 0;
+    for (var i:int = 0; i < n; i++) {
+        try {
+            s += a * 3;
+            if (i % 3 == 2)
+                f();
+        } catch (e:Error) {
+            caught++;
+        }
+    }
+    return s + " " + caught;
+}
+Assert.expectEq("caught in loop", "60 3", caughtInLoop(10, 2, undefined));
+
+function callErrorAfterLoop(n:int, a:int, f:*):int {
+    var s:int = 0;
+    for (var i:int = 0; i < n; i++)
+        s += a * 5;
+    f(s);
+    return s;
+}
+Assert.expectEq("call error after loop", "TypeError", function():String {
+    try { callErrorAfterLoop(4, 1, 3); } catch (e:TypeError) { return "TypeError"; }
+    return "none";
+}());
+
+function rangeErrorInLoop(v:Vector.<int>, n:int, a:int):int {
+    var s:int = 0;
+    for (var i:int = 0; i < n; i++)
+        s += v[i] * a;
+    return s;
+}
+var v:Vector.<int> = new <int>[1, 2, 3];
+Assert.expectEq("in range", 12, rangeErrorInLoop(v, 3, 2));
+Assert.expectEq("out of range", "RangeError", function():String {
+    try { rangeErrorInLoop(v, 4, 2); } catch (e:RangeError) { return "RangeError"; }
+    return "none";
+}());
+
+// values live across loops: more invariants than registers, used in the
+// loop and after it
+
+function manyInvariants(n:int, a:int, b:int, c:int):String {
+    var x1:int = a * b, x2:int = b * c, x3:int = a * c, x4:int = a + b + c;
+    var y1:Number = a / 2, y2:Number = b / 4, y3:Number = c / 8;
+    var s:int = 0;
+    var t:Number = 0;
+    for (var i:int = 0; i < n; i++) {
+        s += x1 + x2 + x3 + x4 + (a - b) * (b - c) + (a | c) + (b & c);
+        t += y1 + y2 + y3 + a * 0.5 + b * 0.25;
+    }
+    for (var j:int = 0; j < n; j++)
+        s -= x1 + x2;
+    return [s, t, x1, x2, x3, x4, y1, y2, y3].join(",");
+}
+Assert.expectEq("many invariants", "240,40,6,12,8,9,1,0.75,0.5", manyInvariants(10, 2, 3, 4));
+
+// an invariant comparison is folded into the branch that tests it, so its
+// operands have to stay live round the loop too; Vector's _concat picks its
+// insert point by testing a local set before its loop
+var parts:Array = [];
+for (var k:int = 0; k <= 5; k++)
+    parts[k] = new <int>[k];
+Assert.expectEq("invariant comparison in a builtin loop", "0,1,2,3,4,5",
+    parts[0].concat(parts[1], parts[2], parts[3], parts[4], parts[5]).toString());
@@ -0,0 +1,49 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+import com.adobe.test.Assert;
+import com.adobe.test.Utils;
+
+// var SECTION="";
+
+// With -osr, a method runs in the interpreter until its loops have gone
+// round often enough, and is then compiled and entered part way through
+// a loop.  Code moved in front of that loop would never run, so the
+// global optimizer must leave such loops alone; the next call runs the
+// compiled method from the start.
+
+class Counter {
+    public var k:int = 3;
+}
+
+function osrLoop(a:int, b:int):int {
+    var c:Counter = new Counter();
+    var s:int = 0;
+    for (var i:int = 0; i < 10000; i++)
+        s += a * b + c.k;
+    return s;
+}
+Assert.expectEq("OSR", 10000 * 9, osrLoop(2, 3));
+
+function osrNested(a:Number):Number {
+    var s:Number = 0;
+    for (var i:int = 0; i < 200; i++)
+        for (var j:int = 0; j < 50; j++)
+            s += a * 2;
+    return s;
+}
+Assert.expectEq("OSR nested", 200 * 50 * 3, osrNested(1.5));
+
+Assert.expectEq("OSR, then compiled", 10000 * 9, osrLoop(2, 3));
+
+function osrChanging(a:int, b:int):int {
+    var s:int = 0;
+    for (var i:int = 0; i < 1000; i++) {
+        if (i == 500)
+            a = 1;
+        s += a * b;
+    }
+    return s;
+}
+Assert.expectEq("OSR, local changes after entry", 500 * 6 + 500 * 3, osrChanging(2, 3));
+Assert.expectEq("OSR, local changes, compiled", 500 * 6 + 500 * 3, osrChanging(2, 3));
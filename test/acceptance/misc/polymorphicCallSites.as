@@ -0,0 +1,148 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+import com.adobe.test.Assert;
+import com.adobe.test.Utils;
+
+// var SECTION="";
+
+// The JIT's binding caches remember a few receiver types per site besides
+// the primary one, then give up on the site as megamorphic.  Each function
+// below has one site that sees one type, then a few, then more than the
+// cache keeps, then the first types again; the results must not depend on
+// which entry, if any, answered.
+//
+// The shell's eval compiler, which runs these tests when asc is not at
+// hand, neither records the types of vars nor compiles accessors, so the
+// properties are untyped slots at different offsets, consts and dynamic
+// properties.
+
+class A { public var p:int = 1; public function f():int { return 10; } }
+class B { public var q:int = 0; public var p:int = 2; public function f():int { return 20; } }
+class C { public var a = 0; public var b = 0; public var p = 3; public function f():int { return 30; } }
+class D { public const p:int = 4; public function f():int { return 40; } }
+class E { public var p:String = "5"; public function f():String { return "50"; } }
+class F { public var p:Number = 6; public function f():int { return 60; } }
+dynamic class G { public function f():int { return 70; } }
+class H extends A { public function g():int { return 80; } }
+
+function makeG():G { var g:G = new G(); g.p = 7; return g; }
+function makeObj(n:int):Object {
+    // plain objects with properties added in different orders
+    var o:Object = {};
+    if (n & 1) o.z = 0;
+    o.p = 100 + n;
+    o.f = function():int { return 1000 + n; };
+    return o;
+}
+
+var receivers:Array = [ new A(), new B(), new C(), new D(), new E(), new F(), makeG(), new H(),
+                        makeObj(0), makeObj(1), makeObj(2) ];
+var expectedP:Array = [ 1, 2, 3, 4, "5", 6, 7, 1, 100, 101, 102 ];
+var expectedF:Array = [ 10, 20, 30, 40, "50", 60, 70, 10, 1000, 1001, 1002 ];
+
+function getP(o:*):* { return o.p; }
+function callF(o:*):* { return o.f(); }
+
+// Visit receivers[0..k) round robin, for growing k, then go back to the start.
+function visitOrder():Array {
+    var order:Array = [];
+    for (var i:int = 0; i < 20; i++) order.push(0);
+    for (var k:int = 2; k <= receivers.length; k++)
+        for (var r:int = 0; r < 3; r++)
+            for (var j:int = 0; j < k; j++)
+                order.push(j);
+    for (i = 0; i < 20; i++) order.push(i % 2);
+    return order;
+}
+
+function checkGets():String {
+    var order:Array = visitOrder();
+    for (var i:int = 0; i < order.length; i++) {
+        var n:int = order[i];
+        var v:* = getP(receivers[n]);
+        if (v !== expectedP[n])
+            return "step " + i + " receiver " + n + " got " + v;
+    }
+    return "ok";
+}
+Assert.expectEq("getproperty site over many types", "ok", checkGets());
+
+function checkCalls():String {
+    var order:Array = visitOrder();
+    for (var i:int = 0; i < order.length; i++) {
+        var n:int = order[i];
+        var v:* = callF(receivers[n]);
+        if (v !== expectedF[n])
+            return "step " + i + " receiver " + n + " got " + v;
+    }
+    return "ok";
+}
+Assert.expectEq("callproperty site over many types", "ok", checkCalls());
+
+// Slots at different offsets and dynamic properties at one site.
+function setP(o:*, v:*):void { o.p = v; }
+
+function checkSets():String {
+    var targets:Array = [ new A(), new C(), new E(), makeG(), new F(), makeObj(3), new B(), new A(), new C() ];
+    for (var r:int = 0; r < 4; r++) {
+        for (var i:int = 0; i < targets.length; i++) {
+            setP(targets[i], r * 100 + i);
+            if (targets[i].p !== r * 100 + i)
+                return "round " + r + " target " + i + " got " + targets[i].p;
+        }
+        for (i = 0; i < targets.length; i++)
+            if (targets[i].p !== r * 100 + i)
+                return "round " + r + " target " + i + " overwritten with " + targets[i].p;
+    }
+    return "ok";
+}
+Assert.expectEq("setproperty site over many types", "ok", checkSets());
+
+// A receiver whose property moves: a cached binding for one object must not
+// answer for another object of the same class whose dynamic property differs,
+// nor after the property is deleted.
+function checkDynamic():String {
+    var gs:Array = [];
+    for (var i:int = 0; i < 6; i++) {
+        var g:G = new G();
+        g.p = i;
+        gs.push(g);
+    }
+    for (var r:int = 0; r < 3; r++)
+        for (i = 0; i < gs.length; i++)
+            if (getP(gs[i]) !== i)
+                return "round " + r + " g" + i + " got " + getP(gs[i]);
+    delete gs[2].p;
+    if (getP(gs[2]) !== undefined)
+        return "deleted p read as " + getP(gs[2]);
+    return "ok";
+}
+Assert.expectEq("dynamic properties of one class", "ok", checkDynamic());
+
+// A subclass reaches the inherited method and its own through the same sites.
+function callG(o:*):* { return o.g(); }
+function checkInherited():String {
+    var h:H = new H();
+    for (var i:int = 0; i < 10; i++) {
+        if (callF(h) !== 10 || callF(receivers[1]) !== 20 || callG(h) !== 80)
+            return "step " + i;
+    }
+    var threw:Boolean = false;
+    try { callG(receivers[0]); } catch (e:ReferenceError) { threw = true; }
+    return threw ? "ok" : "A has no g";
+}
+Assert.expectEq("inherited methods", "ok", checkInherited());
+
+// Primitive receivers share sites with objects.
+function len(o:*):* { return o.length; }
+function checkPrimitives():String {
+    var values:Array = [ "abc", [1, 2], "", new Array(5), { length: "L" }, "four" ];
+    var expected:Array = [ 3, 2, 0, 5, "L", 4 ];
+    for (var r:int = 0; r < 3; r++)
+        for (var i:int = 0; i < values.length; i++)
+            if (len(values[i]) !== expected[i])
+                return "round " + r + " value " + i + " got " + len(values[i]);
+    return "ok";
+}
+Assert.expectEq("primitive receivers", "ok", checkPrimitives());
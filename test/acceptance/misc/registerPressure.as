@@ -0,0 +1,75 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+import avmplus.Domain;
+import flash.utils.ByteArray;
+import com.adobe.test.Assert;
+
+// var SECTION="";
+
+// A loop using more values than there are registers, so the JIT must spill
+// some of them, including loop invariants.  The shell's eval compiler, which
+// runs these tests when asc is not at hand, keeps locals in an activation
+// object rather than in registers, so the loop is loaded from the
+// hand-assembled bytecode below.  It is equivalent to
+//
+//  public class Bench {
+//      public static function run(iter:int, a:int, b:int, c:int, d:int,
+//                                 e:int, f:int, g:int, h:int):int {
+//          var s0:int = 0, s1:int = 0, s2:int = 0, s3:int = 0;
+//          for (var i:int = 0; i < iter; i++) {
+//              s0 += a * i + b;
+//              s1 += (c * i) ^ d;
+//              s2 += (e + i) & f;
+//              s3 += g - i * h;
+//          }
+//          return s0 ^ s1 ^ s2 ^ s3;
+//      }
+//  }
+
+var bytecode:Array = [
+    0x10, 0x00, 0x2E, 0x00, 0x00, 0x00, 0x00, 0x06, 0x00, 0x03, 0x69, 0x6E, 0x74, 0x03, 0x72, 0x75,
+    0x6E, 0x06, 0x4F, 0x62, 0x6A, 0x65, 0x63, 0x74, 0x05, 0x42, 0x65, 0x6E, 0x63, 0x68, 0x02, 0x16,
+    0x01, 0x00, 0x05, 0x07, 0x01, 0x02, 0x07, 0x01, 0x03, 0x07, 0x01, 0x04, 0x07, 0x01, 0x05, 0x04,
+    0x09, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x04, 0x03, 0x01, 0x00, 0x01,
+    0x00, 0x02, 0x01, 0x02, 0x01, 0x00, 0x00, 0x01, 0x03, 0x01, 0x04, 0x04, 0x00, 0x00, 0x04, 0x00,
+    0x04, 0x0F, 0x00, 0x01, 0x66, 0x24, 0x00, 0x63, 0x0A, 0x24, 0x00, 0x63, 0x0B, 0x24, 0x00, 0x63,
+    0x0C, 0x24, 0x00, 0x63, 0x0D, 0x24, 0x00, 0x63, 0x0E, 0x10, 0x3A, 0x00, 0x00, 0x09, 0x62, 0x0A,
+    0x62, 0x02, 0x62, 0x0E, 0xC7, 0x62, 0x03, 0xC5, 0xC5, 0x63, 0x0A, 0x62, 0x0B, 0x62, 0x04, 0x62,
+    0x0E, 0xC7, 0x62, 0x05, 0xAA, 0xC5, 0x63, 0x0B, 0x62, 0x0C, 0x62, 0x06, 0x62, 0x0E, 0xC5, 0x62,
+    0x07, 0xA8, 0xC5, 0x63, 0x0C, 0x62, 0x0D, 0x62, 0x08, 0xC5, 0x62, 0x0E, 0x62, 0x09, 0xC7, 0xC6,
+    0x63, 0x0D, 0x62, 0x0E, 0xC0, 0x63, 0x0E, 0x62, 0x0E, 0x62, 0x01, 0x15, 0xBE, 0xFF, 0xFF, 0x62,
+    0x0A, 0x62, 0x0B, 0xAA, 0x62, 0x0C, 0xAA, 0x62, 0x0D, 0xAA, 0x48, 0x00, 0x00, 0x01, 0x01, 0x01,
+    0x03, 0x04, 0x06, 0xD0, 0x30, 0xD0, 0x49, 0x00, 0x47, 0x00, 0x00, 0x02, 0x01, 0x01, 0x03, 0x04,
+    0x03, 0xD0, 0x30, 0x47, 0x00, 0x00, 0x03, 0x03, 0x01, 0x00, 0x04, 0x0F, 0xD0, 0x30, 0x65, 0x00,
+    0x60, 0x03, 0x30, 0x60, 0x03, 0x58, 0x00, 0x1D, 0x68, 0x04, 0x47, 0x00, 0x00
+];
+
+var ba = new ByteArray();
+for (var k = 0; k < bytecode.length; k++)
+    ba.writeByte(bytecode[k]);
+
+var d = new Domain(Domain.currentDomain);
+d.loadBytes(ba);
+var BenchClass:Class = d.getClass("Bench");
+
+function expected(iter:int, a:int, b:int, c:int, d:int, e:int, f:int, g:int, h:int):int {
+    var s0:int = 0, s1:int = 0, s2:int = 0, s3:int = 0;
+    for (var i:int = 0; i < iter; i++) {
+        s0 += a * i + b;
+        s1 += (c * i) ^ d;
+        s2 += (e + i) & f;
+        s3 += g - i * h;
+    }
+    return s0 ^ s1 ^ s2 ^ s3;
+}
+
+Assert.expectEq("no iterations", 0, BenchClass.run(0, 3, 5, 7, 11, 13, 17, 19, 23));
+Assert.expectEq("one iteration", expected(1, 3, 5, 7, 11, 13, 17, 19, 23),
+                BenchClass.run(1, 3, 5, 7, 11, 13, 17, 19, 23));
+Assert.expectEq("ten iterations", -700, BenchClass.run(10, 3, 5, 7, 11, 13, 17, 19, 23));
+Assert.expectEq("sums overflow", expected(100000, 3, 5, 7, 11, 13, 17, 19, 23),
+                BenchClass.run(100000, 3, 5, 7, 11, 13, 17, 19, 23));
+Assert.expectEq("other invariants", expected(1000, -1, 0x7fffffff, 65537, -8, 255, 0x5555, -2, 1 << 20),
+                BenchClass.run(1000, -1, 0x7fffffff, 65537, -8, 255, 0x5555, -2, 1 << 20));
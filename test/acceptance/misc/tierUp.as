@@ -0,0 +1,80 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+import com.adobe.test.Assert;
+import com.adobe.test.Utils;
+
+// var SECTION="";
+
+// Run with -tierup=2: each method here runs as baseline code for two calls
+// and is then recompiled by halfmoon, or left in baseline code for good if
+// halfmoon cannot compile it.  Results must not change across the switch.
+
+class Point {
+    public var x:int;
+    public var y:Number;
+    public function Point(x:int, y:Number) { this.x = x; this.y = y; }
+    public function dot(p:Point):Number { return x * p.x + y * p.y; }
+}
+
+function sumTo(n:int):int {
+    var s:int = 0;
+    for (var i:int = 0; i < n; i++)
+        s += i;
+    return s;
+}
+
+function scale(a:Number, b:Number):Number {
+    return a * b + 0.5;
+}
+
+function concat(a:String, n:int):String {
+    var s:String = "";
+    for (var i:int = 0; i < n; i++)
+        s += a;
+    return s;
+}
+
+function guarded(n:int):int {
+    try {
+        if (n % 3 == 0)
+            throw new Error("three");
+        return n;
+    } catch (e:Error) {
+        return -n;
+    }
+    return 0;
+}
+
+function untyped(a, b) {
+    return a + b;
+}
+
+var sums:int = 0;
+var scaled:Number = 0;
+var strings:String = "";
+var thrown:int = 0;
+var dots:Number = 0;
+var mixed:String = "";
+var p:Point = new Point(2, 1.5);
+for (var call:int = 0; call < 10; call++) {
+    sums += sumTo(call);
+    scaled += scale(call, 2);
+    strings += concat("ab", call % 3);
+    thrown += guarded(call);
+    dots += p.dot(new Point(call, 2));
+    // The same site sees ints, then strings, after the tier up.
+    mixed += String(call < 5 ? untyped(call, 1) : untyped("s", call));
+}
+
+Assert.expectEq("int loop across tiers", 0+0+1+3+6+10+15+21+28+36, sums);
+Assert.expectEq("Number arithmetic across tiers", 2 * 45 + 5, scaled);
+Assert.expectEq("String concatenation across tiers", "ababababababababab", strings);
+Assert.expectEq("try/catch across tiers", 1+2-3+4+5-6+7+8-9, thrown);
+Assert.expectEq("method calls across tiers", 2 * 45 + 1.5 * 2 * 10, dots);
+Assert.expectEq("untyped arguments across tiers", "12345s5s6s7s8s9", mixed);
+
+// Calls after the loop run whatever tier the loop left behind.
+Assert.expectEq("int loop, after", 4950, sumTo(100));
+Assert.expectEq("try/catch, after", -99, guarded(99));
+Assert.expectEq("untyped, after", 3.5, untyped(1, 2.5));
@@ -0,0 +1,118 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+import com.adobe.test.Assert;
+import com.adobe.test.Utils;
+
+// var SECTION="";
+
+// Run with a small nursery (-nursery=64), so that minor collections happen
+// all the time.  Old objects are stored into after they have been promoted,
+// and new objects are filled in by the VM while collections promote them;
+// young objects reached only that way must survive.
+
+class Node {
+    public var left:Node;
+    public var right:Node;
+    public var value:int;
+    public function Node(l:Node = null, r:Node = null, v:int = 0) { left = l; right = r; value = v; }
+}
+
+function makeTree(depth:int):Node {
+    if (depth == 0)
+        return new Node(null, null, 1);
+    return new Node(makeTree(depth - 1), makeTree(depth - 1), 1);
+}
+
+function countTree(n:Node):int {
+    return n == null ? 0 : n.value + countTree(n.left) + countTree(n.right);
+}
+
+// Allocate garbage trees.  Each has a cycle so that reference counting
+// cannot free it; only a collection can.
+function churn(n:int):void {
+    for (var i:int = 0; i < n; i++) {
+        var t:Node = makeTree(6);
+        t.left.right = t;
+    }
+}
+
+// Old objects, then young subtrees hung off them after they are old.
+var oldTree:Node = makeTree(10);
+churn(200);
+var leaf:Node = oldTree;
+while (leaf.left != null)
+    leaf = leaf.left;
+for (var i:int = 0; i < 20; i++) {
+    leaf.left = makeTree(3);
+    leaf = leaf.left;
+    while (leaf.left != null)
+        leaf = leaf.left;
+    churn(20);
+}
+churn(200);
+Assert.expectEq("young subtrees stored into old nodes", 2047 + 20 * 15, countTree(oldTree));
+
+// A growing Array: the VM copies the elements into a new buffer without
+// going through the write barrier.
+var arr:Array = [];
+for (i = 0; i < 3000; i++) {
+    arr.push(new Node(null, null, i));
+    if (i % 100 == 0)
+        churn(10);
+}
+churn(200);
+var sumArr:int = 0;
+for (i = 0; i < 3000; i++)
+    sumArr += arr[i].value;
+Assert.expectEq("Array grown across minor collections", 3000 * 2999 / 2, sumArr);
+
+var copies:Array = arr.concat(arr).slice(1000, 5000);
+churn(200);
+var sumCopies:int = 0;
+for (i = 0; i < copies.length; i++)
+    sumCopies += copies[i].value;
+Assert.expectEq("Array copied by concat and slice", (1000 + 2999) * 2000 / 2 + 1999 * 2000 / 2, sumCopies);
+
+// Dynamic properties: the hashtable grows and rehashes in the VM.
+var bag:Object = {};
+for (i = 0; i < 2000; i++) {
+    bag["k" + i] = new Node(null, null, i);
+    if (i % 100 == 0)
+        churn(10);
+}
+churn(200);
+var sumBag:int = 0;
+for (var k:String in bag)
+    sumBag += bag[k].value;
+Assert.expectEq("dynamic properties added across minor collections", 2000 * 1999 / 2, sumBag);
+
+// Strings: concatenation makes ropes and buffers that the VM fills in.
+var s:String = "";
+for (i = 0; i < 2000; i++) {
+    s += String.fromCharCode(97 + i % 26);
+    if (i % 100 == 0)
+        churn(10);
+}
+churn(200);
+Assert.expectEq("string built across minor collections", 2000, s.length);
+Assert.expectEq("string contents", "abcdefghijklmnopqrstuvwxyz", s.substr(26 * 10, 26));
+
+// Closures capture young activation objects.
+function counter():Function {
+    var n:int = 0;
+    return function():int { return ++n; };
+}
+var counters:Array = [];
+for (i = 0; i < 200; i++)
+    counters.push(counter());
+churn(200);
+var total:int = 0;
+for (i = 0; i < 200; i++) {
+    counters[i]();
+    total += counters[i]();
+}
+Assert.expectEq("closures over young activations", 400, total);
+
+// The old tree is still intact after all of that.
+Assert.expectEq("old tree after churn", 2047 + 20 * 15, countTree(oldTree));
@@ -0,0 +1,16 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+var DESC = "'for' loop over integral Number values with int bound, update";
+
+// Compare this to 'for-1' (uint counter) and 'for-2' (non-integral start).
+include "driver.as"
+
+function forloop():Number {
+    for ( var i:Number=0 ; i < 100000 ; i++ )
+        ;
+    return i;
+}
+
+TEST(forloop, "for-4");
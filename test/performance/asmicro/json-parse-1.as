@@ -0,0 +1,23 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+var DESC = "JSON.parse, an array of records with the same keys";
+include "driver.as"
+
+var records:Array = [];
+for ( var i:uint=0 ; i < 200 ; i++ )
+    records.push({ id: i, name: "item" + i, price: i * 0.25 + 0.1, count: i * 7,
+                   tags: ["red", "green"], active: (i & 1) == 0 });
+var text:String = JSON.stringify(records);
+
+function loop():void {
+    loop2(text);
+}
+
+function loop2(s:String):int {
+    var r:Array = JSON.parse(s);
+    return r.length;
+}
+
+TEST(loop, "json-parse-1");
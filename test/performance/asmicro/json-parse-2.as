@@ -0,0 +1,22 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+var DESC = "JSON.parse, an array of numbers";
+include "driver.as"
+
+var values:Array = [];
+for ( var i:uint=0 ; i < 2000 ; i++ )
+    values.push(i % 3 == 0 ? i * 1000 : (i - 1000) / 8);
+var text:String = JSON.stringify(values);
+
+function loop():void {
+    loop2(text);
+}
+
+function loop2(s:String):int {
+    var r:Array = JSON.parse(s);
+    return r.length;
+}
+
+TEST(loop, "json-parse-2");
@@ -0,0 +1,23 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+var DESC = "JSON.parse, long strings with a few escapes";
+include "driver.as"
+
+var values:Array = [];
+for ( var i:uint=0 ; i < 100 ; i++ )
+    values.push("Lorem ipsum dolor sit amet, consectetur adipiscing elit, sed do eiusmod tempor " +
+                "incididunt ut labore et dolore magna aliqua.\n\"" + i + "\"\tUt enim ad minim veniam");
+var text:String = JSON.stringify(values);
+
+function loop():void {
+    loop2(text);
+}
+
+function loop2(s:String):int {
+    var r:Array = JSON.parse(s);
+    return r.length;
+}
+
+TEST(loop, "json-parse-3");
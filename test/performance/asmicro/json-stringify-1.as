@@ -0,0 +1,37 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+var DESC = "JSON.stringify, an array of instances of one class";
+include "driver.as"
+
+class Item {
+    public var id:int;
+    public var name:String;
+    public var price:Number;
+    public var count:uint;
+    public var active:Boolean;
+
+    function Item(i:int) {
+        id = i;
+        name = "item" + i;
+        price = i * 0.25 + 0.1;
+        count = i * 7;
+        active = (i & 1) == 0;
+    }
+}
+
+var items:Array = [];
+for ( var i:int=0 ; i < 200 ; i++ )
+    items.push(new Item(i));
+
+function loop():void {
+    loop2(items);
+}
+
+function loop2(a:Array):int {
+    var s:String = JSON.stringify(a);
+    return s.length;
+}
+
+TEST(loop, "json-stringify-1");
@@ -0,0 +1,25 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+var DESC = "JSON.stringify, an array of numbers and long strings";
+include "driver.as"
+
+var values:Array = [];
+for ( var i:uint=0 ; i < 1000 ; i++ ) {
+    values.push(i % 3 == 0 ? i * 1000 : (i - 500) / 8);
+    if (i % 10 == 0)
+        values.push("Lorem ipsum dolor sit amet, consectetur adipiscing elit, sed do eiusmod tempor " +
+                    "incididunt ut labore et dolore magna aliqua.\n\"" + i + "\"\tUt enim ad minim veniam");
+}
+
+function loop():void {
+    loop2(values);
+}
+
+function loop2(a:Array):int {
+    var s:String = JSON.stringify(a);
+    return s.length;
+}
+
+TEST(loop, "json-stringify-3");
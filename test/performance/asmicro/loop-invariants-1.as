@@ -0,0 +1,28 @@
+/* -*- Mode: C++; c-basic-offset: 4; indent-tabs-mode: nil; tab-width: 4 -*- */
+/* vi: set ts=4 sw=4 expandtab: (add to ~/.vimrc: set modeline modelines=5) */
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+var DESC = "int loop using more loop invariants than there are spare registers.";
+
+// It is appropriate to compare this with -Dregalloc=intervals.
+include "driver.as"
+
+function invariants(iter:int, a:int, b:int, c:int, d:int, e:int, f:int, g:int, h:int):int
+{
+    // Please do not change the type annotations
+    var s0:int = 0;
+    var s1:int = 0;
+    var s2:int = 0;
+    var s3:int = 0;
+    for ( var i:int = 0 ; i < iter ; i++ ) {
+        s0 += a * i + b;
+        s1 += (c * i) ^ d;
+        s2 += (e + i) & f;
+        s3 += g - i * h;
+    }
+    return s0 ^ s1 ^ s2 ^ s3;
+}
+
+TEST(function () { invariants(10000, 3, 5, 7, 11, 13, 17, 19, 23); }, "loop-invariants-1");
@@ -0,0 +1,22 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+var DESC = "String concatenation, two strings appending to the same prefix in turn";
+include "driver.as"
+
+function loop():void {
+    loop2("<p>", "</p>");
+}
+
+function loop2(s:String, t:String):int {
+    var r:String = "";
+    var q:String = "";
+    for ( var i:uint=0 ; i < 5000 ; i++ ) {
+        q = r + t;
+        r = r + s;
+    }
+    return r.charCodeAt(0) + q.charCodeAt(0);
+}
+
+TEST(loop, "string-concat-2");
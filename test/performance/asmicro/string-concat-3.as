@@ -0,0 +1,19 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+var DESC = "String concatenation, appending to substrings of a long string";
+include "driver.as"
+
+function loop():void {
+    loop2("<p>");
+}
+
+function loop2(s:String):int {
+    var r:String = "";
+    for ( var i:uint=0 ; i < 5000 ; i++ )
+        r = r.substring(0, r.length - 1) + s;
+    return r.charCodeAt(0);
+}
+
+TEST(loop, "string-concat-3");
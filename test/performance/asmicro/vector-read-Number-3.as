@@ -0,0 +1,24 @@
+/* -*- Mode: C++; c-basic-offset: 4; indent-tabs-mode: nil; tab-width: 4 -*- */
+/* vi: set ts=4 sw=4 expandtab: (add to ~/.vimrc: set modeline modelines=5) */
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+var DESC = "Sum Vector<Number> with Number index bounded by length, store in local with type Number.";
+include "driver.as"
+
+function vector_read_Number(iter: int, a: Vector.<Number>): Number
+{
+    // Please do not change or remove the type annotation
+    // Please do not change the indexing expressions or updates.
+    var sum:Number = 0;
+    for ( var i:int = 0 ; i < iter ; i++ ) {
+        for ( var j:Number = 0 ; j < a.length ; j++ )
+            sum += a[j];
+    }
+    return sum;
+}
+
+var vn: Vector.<Number> = new Vector.<Number>(1000);
+
+TEST(function () { vector_read_Number(1000, vn); }, "vector-read-Number-3");
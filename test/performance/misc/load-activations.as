@@ -0,0 +1,98 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+// Startup cost of an abc block with many functions that need an
+// activation object, none of which are ever called.  Measures how much
+// of a method body the parser decodes up front.
+
+import avmplus.Domain;
+import flash.utils.ByteArray;
+
+function writeU30(ba:ByteArray, v:uint) {
+    do {
+        var b:uint = v & 0x7F;
+        v >>>= 7;
+        ba.writeByte(v ? (b | 0x80) : b);
+    } while (v);
+}
+
+function makeAbc(nmethods:uint, nslots:uint):ByteArray {
+    var ba:ByteArray = new ByteArray();
+    var i:uint, j:uint;
+    ba.writeByte(0x10); ba.writeByte(0); ba.writeByte(0x2E); ba.writeByte(0);  // 46.16
+
+    writeU30(ba, 0);                    // int pool
+    writeU30(ba, 0);                    // uint pool
+    writeU30(ba, 0);                    // double pool
+    writeU30(ba, nslots + 2);           // strings: "", v0..vN
+    writeU30(ba, 0);
+    for (j = 0; j < nslots; j++) {
+        var s:String = "v" + j;
+        writeU30(ba, s.length);
+        ba.writeUTFBytes(s);
+    }
+    writeU30(ba, 2);                    // namespaces: public
+    ba.writeByte(0x16); writeU30(ba, 1);
+    writeU30(ba, 0);                    // namespace sets
+    writeU30(ba, nslots + 1);           // multinames: public::vN
+    for (j = 0; j < nslots; j++) {
+        ba.writeByte(0x07); writeU30(ba, 1); writeU30(ba, j + 2);
+    }
+
+    writeU30(ba, nmethods + 1);         // method infos; the last one is the script init
+    for (i = 0; i <= nmethods; i++) {
+        writeU30(ba, 0);                // param count
+        writeU30(ba, 0);                // return type
+        writeU30(ba, 0);                // name
+        ba.writeByte(i < nmethods ? 0x02 : 0);  // NEED_ACTIVATION
+    }
+    writeU30(ba, 0);                    // metadata
+    writeU30(ba, 0);                    // classes
+    writeU30(ba, 1);                    // scripts
+    writeU30(ba, nmethods);
+    writeU30(ba, 0);
+
+    writeU30(ba, nmethods + 1);         // method bodies
+    for (i = 0; i <= nmethods; i++) {
+        writeU30(ba, i);
+        writeU30(ba, 1);                // max stack
+        writeU30(ba, 1);                // local count
+        writeU30(ba, 0);                // init scope depth
+        writeU30(ba, 1);                // max scope depth
+        writeU30(ba, 1);                // code length
+        ba.writeByte(0x47);             // returnvoid
+        writeU30(ba, 0);                // exceptions
+        if (i < nmethods) {
+            writeU30(ba, nslots);       // activation slots
+            for (j = 0; j < nslots; j++) {
+                writeU30(ba, j + 1);    // name
+                ba.writeByte(0);        // Trait_Slot
+                writeU30(ba, 0);        // slot id
+                writeU30(ba, 0);        // type
+                writeU30(ba, 0);        // value
+            }
+        } else {
+            writeU30(ba, 0);
+        }
+    }
+    return ba;
+}
+
+if (CONFIG::desktop) {
+    var loads:int = 100;
+    var start:Number = new Date();
+}
+else { // mobile
+    var loads:int = 10;
+    var start:int = getTimer();
+}
+
+var abc:ByteArray = makeAbc(5000, 8);
+for (var k:int = 0; k < loads; k++)
+    Domain.currentDomain.loadBytes(abc);
+
+if (CONFIG::desktop)
+    print("metric time "+(new Date()-start));
+else // mobile
+    print("metric time "+(getTimer()-start));
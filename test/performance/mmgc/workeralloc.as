@@ -0,0 +1,63 @@
+/* -*- mode: java; tab-width: 4 -*- */
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+/* Allocation throughput as the number of workers grows.
+ *
+ * Runs 1, 2, 4 and 8 workers at a time, each of which allocates the same
+ * number of small objects with its own GC, keeping a few of them so that
+ * the collector has something to do.  The workers share the GCHeap, so
+ * this measures how well block acquisition scales: with perfect scaling
+ * (and enough cores) the time per round stays flat and the throughput
+ * grows with the number of workers.
+ *
+ * The metric is the total time of all rounds.  Pass the number of objects
+ * per worker as an argument to change the amount of work.
+ */
+
+package
+{
+    import avmplus.*;
+    import flash.system.Worker;
+    import flash.system.WorkerDomain;
+
+    function allocate(count) {
+        var keep = new Array;
+        for ( var i=0 ; i < count ; i++ ) {
+            var p = { x: i, y: [i] };
+            if ((i & 63) == 0)
+                keep.push(p);
+        }
+        return keep.length;
+    }
+
+    var objects = 500000;
+    if (System.argv.length > 0)
+        objects = parseInt(System.argv[0]);
+
+    if (Worker.current.isPrimordial) {
+        var total = 0;
+        for ( var n=1 ; n <= 8 ; n *= 2 ) {
+            var workers = new Array;
+            var then = new Date();
+            for ( var i=0 ; i < n ; i++ ) {
+                workers[i] = WorkerDomain.current.createWorkerFromPrimordial();
+                workers[i].setSharedProperty("objects", objects);
+                workers[i].start();
+            }
+            // A worker in the shell terminates when its script is done.
+            for ( var i=0 ; i < n ; i++ ) {
+                while (workers[i].state != "terminated")
+                    System.sleep(1);
+            }
+            var elapsed = new Date() - then;
+            total += elapsed;
+            print(n + " workers: " + elapsed + " ms, " +
+                  Math.round(n * objects / Math.max(elapsed, 1)) + " objects/ms");
+        }
+        print("metric time " + total);
+    }
+    else
+        allocate(Worker.current.getSharedProperty("objects"));
+}